@@ -0,0 +1,270 @@
+/*
+ * Mede a gravação e o carregamento da AST binária (--emit-ast) contra a
+ * análise completa do fonte, e confere o round-trip: a árvore mapeada deve
+ * coincidir nó a nó com a analisada, e a árvore reconstruída a partir dela
+ * deve ser gravada com os mesmos bytes; cópias adulteradas do arquivo devem
+ * ser recusadas. Os alertas semânticos da análise e as recusas esperadas do
+ * carregador não vão para stderr; só as falhas do próprio benchmark.
+ * Uso: ast_bench <arquivo-fonte> [repeticoes]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ast_binary.h"
+#include "memmgr.h"
+#include "parser.h"
+#include "semantics.h"
+#include "util.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Manda stderr para /dev/null; retorna o descritor a devolver em
+ * restore_stderr */
+static int quiet_stderr(void) {
+    int saved, null;
+    fflush(stderr);
+    saved = dup(STDERR_FILENO);
+    null = open("/dev/null", O_WRONLY);
+    if (null >= 0) {
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+    return saved;
+}
+
+static void restore_stderr(int saved) {
+    if (saved < 0) return;
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+}
+
+static ASTNode* analyze(const char *path) {
+    Parser *parser;
+    ASTNode *ast;
+    SemaContext *sc;
+    int saved;
+
+    init_scanner(path);
+    parser = parser_init();
+    parser->silent = 1;
+    ast = parse_program(parser);
+    if (parser->had_error) {
+        fprintf(stderr, "Erros de sintaxe em %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    parser_free(parser);
+    close_scanner();
+
+    saved = quiet_stderr();
+    sc = sema_create(mm_max_usage());
+    semantic_analyze(sc, ast);
+    sema_destroy(sc);
+    restore_stderr(saved);
+    return ast;
+}
+
+static int same_string(const char *a, const char *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+/* Percorre a árvore em largura, na mesma ordem dos registros do arquivo */
+static int same_tree(ASTNode *root, const AstFile *file) {
+    uint32_t count = file->header->node_count, head, tail = 1;
+    ASTNode **queue = malloc(count * sizeof(ASTNode*));
+    int ok = 1;
+
+    queue[0] = root;
+    for (head = 0; ok && head < tail; head++) {
+        ASTNode *node = queue[head];
+        const AstBinNode *rec = &file->nodes[head];
+        Type t = ast_file_type(rec);
+        uint32_t first = tail;
+        int i;
+
+        ok = rec->type == (uint32_t)node->type &&
+             rec->token_type == (uint32_t)node->token.type &&
+             rec->line == node->token.line &&
+             rec->offset == node->token.offset &&
+             rec->length == node->token.length &&
+             same_string(ast_file_lexeme(file, rec), node->token.lexeme) &&
+             same_string(ast_file_value(file, rec), node->value) &&
+             type_intern(&t) == node->inferred_type;
+        for (i = 0; ok && i < node->child_count; i++) {
+            if (!node->children[i]) continue;
+            if (tail >= count) ok = 0;
+            else queue[tail++] = node->children[i];
+        }
+        ok = ok && (rec->child_count == 0 ||
+                    (rec->first_child == first && rec->child_count == tail - first));
+        if (!ok) fprintf(stderr, "Nó %u difere da árvore analisada\n", head);
+    }
+    ok = ok && tail == count;
+    free(queue);
+    return ok;
+}
+
+static int same_bytes(const AstFile *a, const AstFile *b) {
+    return a->size == b->size && memcmp(a->map, b->map, a->size) == 0;
+}
+
+/* Grava uma cópia de file com o nó index alterado por change; o carregador
+ * deve recusá-la */
+static int rejects(const AstFile *file, const char *copy, uint32_t index,
+                   void (*change)(AstBinNode *node, const AstFile *file)) {
+    char *bytes = malloc(file->size);
+    AstBinNode *nodes = (AstBinNode*)(bytes + sizeof(AstBinHeader));
+    FILE *f = fopen(copy, "wb");
+    AstFile bad;
+    int ok, saved;
+
+    memcpy(bytes, file->map, file->size);
+    change(&nodes[index], file);
+    ok = f && fwrite(bytes, 1, file->size, f) == file->size;
+    if (f) fclose(f);
+    free(bytes);
+    if (!ok) return 0;
+    saved = quiet_stderr();
+    ok = !ast_file_open(&bad, copy);
+    restore_stderr(saved);
+    if (!ok) ast_file_close(&bad);
+    return ok;
+}
+
+/* Primeiro nó com filhos além da raiz, ou 0 */
+static uint32_t first_parent(const AstFile *file) {
+    uint32_t i;
+    for (i = 1; i < file->header->node_count; i++) {
+        if (file->nodes[i].child_count > 0) return i;
+    }
+    return 0;
+}
+
+static void share_children(AstBinNode *node, const AstFile *file) {
+    const AstBinNode *parent = &file->nodes[first_parent(file)];
+    node->first_child = parent->first_child;
+    node->child_count = parent->child_count;
+}
+
+static void bad_node_type(AstBinNode *node, const AstFile *file) {
+    (void)file;
+    node->type = 999;
+}
+
+static void bad_token_type(AstBinNode *node, const AstFile *file) {
+    (void)file;
+    node->token_type = 999;
+}
+
+static void bad_type_kind(AstBinNode *node, const AstFile *file) {
+    (void)file;
+    node->type_kind = 7;
+}
+
+/* Arquivos adulterados: dois pais com os mesmos filhos, enumerações fora
+ * da faixa */
+static int rejects_corrupted(const AstFile *file, const char *copy) {
+    uint32_t parent = first_parent(file);
+    int ok = rejects(file, copy, 0, bad_node_type) &&
+             rejects(file, copy, 0, bad_token_type) &&
+             rejects(file, copy, 0, bad_type_kind);
+    if (ok && parent > 0 && parent + 1 < file->header->node_count) {
+        ok = rejects(file, copy, parent + 1, share_children);
+    }
+    if (!ok) fprintf(stderr, "Arquivo adulterado aceito pelo carregador\n");
+    return ok;
+}
+
+static volatile unsigned long sink;
+
+/* Visita todos os nós da visão mapeada (só leitura, sem alocações) */
+static unsigned long visit_file(const AstFile *file) {
+    unsigned long sum = 0;
+    uint32_t i;
+    for (i = 0; i < file->header->node_count; i++) {
+        const AstBinNode *rec = &file->nodes[i];
+        const char *lexeme = ast_file_lexeme(file, rec);
+        sum += rec->child_count + (lexeme ? (unsigned char)lexeme[0] : 0);
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    double best_front = -1.0, best_write = -1.0, best_load = -1.0, best_visit = -1.0;
+    char *path = malloc(strlen(argv[1]) + 8);
+    char *copy = malloc(strlen(argv[1]) + 8);
+    AstFile file, again;
+    ASTNode *ast = NULL;
+    int r, ok;
+
+    sprintf(path, "%s.ast", argv[1]);
+    sprintf(copy, "%s.2.ast", argv[1]);
+    mm_init((size_t)1 << 34);
+
+    for (r = 0; r < reps; r++) {
+        double start = now(), elapsed;
+        if (ast) free_ast(ast);
+        ast = analyze(argv[1]);
+        elapsed = now() - start;
+        if (best_front < 0 || elapsed < best_front) best_front = elapsed;
+
+        start = now();
+        if (!ast_binary_write(ast, path)) return EXIT_FAILURE;
+        elapsed = now() - start;
+        if (best_write < 0 || elapsed < best_write) best_write = elapsed;
+    }
+
+    for (r = 0; r < reps; r++) {
+        double start = now(), elapsed;
+        if (!ast_file_open(&file, path)) return EXIT_FAILURE;
+        elapsed = now() - start;
+        if (best_load < 0 || elapsed < best_load) best_load = elapsed;
+
+        start = now();
+        sink += visit_file(&file);
+        elapsed = now() - start;
+        if (best_visit < 0 || elapsed < best_visit) best_visit = elapsed;
+        if (r + 1 < reps) ast_file_close(&file);
+    }
+
+    /* Round-trip: arquivo == árvore analisada; reconstruída -> mesmos bytes */
+    ok = same_tree(ast, &file);
+    if (ok) {
+        ASTNode *rebuilt = ast_file_to_tree(&file);
+        ok = ast_binary_write(rebuilt, copy) && ast_file_open(&again, copy);
+        if (ok) {
+            ok = same_bytes(&file, &again);
+            ast_file_close(&again);
+        }
+        free_ast(rebuilt);
+    }
+    ok = ok && rejects_corrupted(&file, copy);
+    remove(copy);
+
+    printf("%-40s análise %8.3f ms   gravação %8.3f ms   mmap %8.3f ms   visita %8.3f ms   %u nós, %lu bytes\n",
+           argv[1], best_front * 1000.0, best_write * 1000.0, best_load * 1000.0,
+           best_visit * 1000.0, file.header->node_count, (unsigned long)file.size);
+    printf("%-40s round-trip %s\n", argv[1], ok ? "ok" : "FALHOU");
+
+    ast_file_close(&file);
+    free_ast(ast);
+    remove(path);
+    mm_cleanup();
+    free(path);
+    free(copy);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
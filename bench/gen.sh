@@ -0,0 +1,140 @@
+#!/bin/sh
+# Gera programas sintéticos para benchmarks e testes de estresse.
+# Uso: gen.sh <tipo> <n>
+#   expr    n comandos com expressões longas (todos os níveis de precedência)
+#   parens  uma expressão com n níveis de parênteses aninhados
+#   unary   uma expressão com n operadores unários encadeados
+#   chain   uma expressão com n somas encadeadas (árvore com n níveis)
+#   nest    n comandos 'se'/'enquanto' aninhados
+#   funcs   n funções de 11 linhas seguidas de principal()
+#   decls   principal() com n variáveis declaradas e usadas (um escopo enorme)
+#   vars    uma função com n variáveis, em grupos de 8 comandos dentro de 'se'
+#           e 'enquanto' alternados
+set -e
+
+kind="$1"
+n="${2:-1000}"
+
+case "$kind" in
+    expr)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            print "    inteiro !a, !b, !c, !x;"
+            for (i = 0; i < n; i++) {
+                if (i % 2)
+                    print "    se ((!a + !b * 2 - !c / 3) * (!a - 1) > !c && !a <> !b || -!c <= !a ^ 2) !x = !a;"
+                else
+                    print "    !x = (!a + !b * 2 - !c / 3) * (!a - 1) + !b % 7 - -!c ^ 2 * (!a + 1);"
+            }
+            print "}"
+        }'
+        ;;
+    parens)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            print "    inteiro !x;"
+            lp = ""; rp = ""
+            for (i = 0; i < 1000; i++) { lp = lp "("; rp = rp ")" }
+            printf "    !x = "
+            for (i = 0; i + 1000 <= n; i += 1000) printf "%s", lp
+            for (; i < n; i++) printf "("
+            printf "1"
+            for (i = 0; i + 1000 <= n; i += 1000) printf "%s", rp
+            for (; i < n; i++) printf ")"
+            print ";"
+            print "}"
+        }'
+        ;;
+    unary)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            print "    inteiro !x;"
+            chunk = ""
+            for (i = 0; i < 1000; i++) chunk = chunk "- "
+            printf "    !x = "
+            for (i = 0; i + 1000 <= n; i += 1000) printf "%s", chunk
+            for (; i < n; i++) printf "- "
+            print "1;"
+            print "}"
+        }'
+        ;;
+    chain)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            print "    inteiro !x;"
+            chunk = ""
+            for (i = 0; i < 1000; i++) chunk = chunk " + !x"
+            printf "    !x = 1"
+            for (i = 0; i + 1000 <= n; i += 1000) printf "%s", chunk
+            for (; i < n; i++) printf " + !x"
+            print ";"
+            print "}"
+        }'
+        ;;
+    nest)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            print "    inteiro !x;"
+            for (i = 0; i < n; i++)
+                print (i % 2 ? "enquanto (!x < 1) {" : "se (!x > 0) {")
+            print "!x = !x + 1;"
+            for (i = 0; i < n; i++) print "}"
+            print "}"
+        }'
+        ;;
+    decls)
+        awk -v n="$n" 'BEGIN {
+            print "principal() {"
+            for (i = 0; i < n; i++) printf "    inteiro !v%d;\n", i
+            print "    !v0 = 1;"
+            for (i = 1; i < n; i++) printf "    !v%d = !v%d + !v%d;\n", i, i - 1, int(i / 2)
+            print "}"
+        }'
+        ;;
+    vars)
+        awk -v n="$n" 'BEGIN {
+            print "funcao inteiro __f0(inteiro !a, !b) {"
+            for (i = 0; i < n; i++) printf "    inteiro !v%d;\n", i
+            print "    !v0 = !a;"
+            for (i = 1; i < n; i++) {
+                if (i % 8 == 1) {
+                    if (int(i / 8) % 2) printf "    enquanto (!v%d < !b) {\n", i - 1
+                    else printf "    se (!v%d > !a) {\n", i - 1
+                }
+                printf "        !v%d = !v%d + !v%d;\n", i, i - 1, int(i / 2)
+                if (i % 8 == 0 || i == n - 1) print "    }"
+            }
+            printf "    retorne !v%d;\n", n - 1
+            print "}"
+            print "principal() {"
+            print "    escreva(__f0(1, 2));"
+            print "}"
+        }'
+        ;;
+    funcs)
+        awk -v n="$n" 'BEGIN {
+            for (i = 0; i < n; i++) {
+                printf "funcao inteiro __f%d(inteiro !a, !b) {\n", i
+                print "    inteiro !i, !s = 0;"
+                print "    para (!i = 0; !i < !a; !i = !i + 1) {"
+                print "        !s = !s + !b * 2;"
+                print "    }"
+                print "    se (!s > 100) {"
+                print "        !s = !s - 1;"
+                print "    }"
+                print "    retorne !s;"
+                print "}"
+                print ""
+            }
+            print "principal() {"
+            print "    inteiro !x;"
+            print "    !x = __f0(1, 2);"
+            print "    escreva(!x);"
+            print "}"
+        }'
+        ;;
+    *)
+        echo "tipo desconhecido: $kind" >&2
+        exit 1
+        ;;
+esac
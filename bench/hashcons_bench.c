@@ -0,0 +1,172 @@
+/*
+ * Compara a AST com e sem compartilhamento de subexpressões (--hash-cons):
+ * nós alocados, memória após a análise sintática e tempo da análise
+ * semântica. Confere que as duas árvores têm a mesma forma e os mesmos tipos
+ * inferidos, e que free_ast devolve toda a memória dos nós compartilhados.
+ * Uso: hashcons_bench <arquivo-fonte> [repeticoes]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ast_walk.h"
+#include "hashcons.h"
+#include "memmgr.h"
+#include "parser.h"
+#include "semantics.h"
+#include "util.h"
+
+typedef struct {
+    ASTNode *ast;
+    size_t bytes;                   /* memória em uso após a análise sintática */
+    unsigned long shared;           /* nós descartados pela tabela */
+    double sema;                    /* melhor tempo da análise semântica */
+    unsigned long typed;            /* nós tipados na última análise */
+    unsigned long reused;           /* subárvores já anotadas, não percorridas */
+} Run;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static ASTNode* parse(const char *path, unsigned long *shared) {
+    Parser *parser;
+    ASTNode *ast;
+
+    init_scanner(path);
+    parser = parser_init();
+    ast = parse_program(parser);
+    if (parser->had_error) {
+        fprintf(stderr, "Erros de sintaxe em %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    *shared = parser->hashcons ? parser->hashcons->shared : 0;
+    parser_free(parser);
+    close_scanner();
+    return ast;
+}
+
+static void measure(const char *path, int hash_consing, int reps, Run *run) {
+    int r;
+
+    parser_set_hash_consing(hash_consing);
+    run->sema = -1.0;
+    for (r = 0; r < reps; r++) {
+        size_t base;
+        SemaContext *sc;
+        double start, elapsed;
+        unsigned long typed, reused;
+
+        if (run->ast) free_ast(run->ast);
+        base = mm_current_usage();
+        run->ast = parse(path, &run->shared);
+        run->bytes = mm_current_usage() - base;
+
+        sema_type_stats(&typed, &reused);
+        start = now();
+        sc = sema_create(mm_max_usage());
+        semantic_analyze(sc, run->ast);
+        sema_destroy(sc);
+        elapsed = now() - start;
+        sema_type_stats(&run->typed, &run->reused);
+        run->typed -= typed;
+        run->reused -= reused;
+        if (run->sema < 0 || elapsed < run->sema) run->sema = elapsed;
+    }
+    parser_set_hash_consing(0);
+}
+
+static AstWalkAction count_pre(AstWalker *w, ASTNode *node, void *data) {
+    (void)w;
+    (void)node;
+    (*(unsigned long*)data)++;
+    return AST_WALK_CONTINUE;
+}
+
+/* Nós visitados: a árvore lógica, com cada referência contada */
+static unsigned long count_nodes(ASTNode *root) {
+    AstVisitor visitor = {count_pre, NULL, NULL, 0, 0};
+    unsigned long count = 0;
+    visitor.data = &count;
+    ast_walk(root, &visitor);
+    return count;
+}
+
+/* Percorre as duas árvores em largura, lado a lado */
+static int same_shape(ASTNode *a, ASTNode *b, unsigned long count) {
+    ASTNode **queue = malloc(2 * count * sizeof(ASTNode*));
+    unsigned long head, tail = 2;
+    int ok = 1;
+
+    queue[0] = a;
+    queue[1] = b;
+    for (head = 0; ok && head < tail; head += 2) {
+        ASTNode *x = queue[head], *y = queue[head + 1];
+        int i;
+
+        ok = x->type == y->type && x->token.type == y->token.type &&
+             x->child_count == y->child_count &&
+             x->inferred_type == y->inferred_type &&
+             (!x->token.lexeme || !y->token.lexeme
+                  ? x->token.lexeme == y->token.lexeme
+                  : strcmp(x->token.lexeme, y->token.lexeme) == 0);
+        for (i = 0; ok && i < x->child_count; i++) {
+            if (!x->children[i] || !y->children[i]) {
+                ok = x->children[i] == y->children[i];
+            } else if (tail + 2 > 2 * count) {
+                ok = 0;
+            } else {
+                queue[tail++] = x->children[i];
+                queue[tail++] = y->children[i];
+            }
+        }
+    }
+    free(queue);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    Run plain, shared;
+    unsigned long nodes;
+    size_t base, kept;
+    int ok;
+
+    memset(&plain, 0, sizeof(plain));
+    memset(&shared, 0, sizeof(shared));
+    mm_init((size_t)1 << 34);
+
+    measure(argv[1], 0, reps, &plain);
+    measure(argv[1], 1, reps, &shared);
+
+    nodes = count_nodes(plain.ast);
+    ok = count_nodes(shared.ast) == nodes && same_shape(plain.ast, shared.ast, nodes);
+
+    /* Só os lexemas (os mesmos nas duas análises) sobrevivem a free_ast: a
+     * liberação com contagem de referências não pode deixar nós para trás */
+    base = mm_current_usage();
+    free_ast(plain.ast);
+    kept = plain.bytes - (base - mm_current_usage());
+    base = mm_current_usage();
+    free_ast(shared.ast);
+    ok = ok && shared.bytes - (base - mm_current_usage()) == kept;
+
+    printf("%-40s nós %9lu -> %9lu (%5.1f%%)   memória %11lu -> %11lu bytes (%5.1f%%)\n",
+           argv[1], nodes, nodes - shared.shared,
+           100.0 * (double)shared.shared / (double)nodes,
+           (unsigned long)plain.bytes, (unsigned long)shared.bytes,
+           100.0 * (1.0 - (double)shared.bytes / (double)plain.bytes));
+    printf("%-40s sema %8.3f ms -> %8.3f ms   nós tipados %9lu -> %9lu (%lu reaproveitados)   conferência %s\n",
+           argv[1], plain.sema * 1000.0, shared.sema * 1000.0, plain.typed, shared.typed,
+           shared.reused, ok ? "ok" : "FALHOU");
+
+    mm_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+/*
+ * Mede edições incrementais sobre um arquivo grande (ver gen.sh funcs).
+ * Cada rodada troca um literal, insere e remove um espaço e insere e remove
+ * uma quebra de linha dentro de funções espalhadas pelo arquivo. No fim, a
+ * AST incremental é comparada com a de uma análise completa do texto final.
+ * Uso: incr_bench <arquivo-fonte> [rodadas] [verifica]
+ *   verifica: compara as árvores após cada edição (lento)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "memmgr.h"
+#include "incremental.h"
+
+static char *read_file(const char *path, int *length) {
+    FILE *f = fopen(path, "rb");
+    long size;
+    char *text;
+    if (!f) { perror(path); exit(EXIT_FAILURE); }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = malloc(size > 0 ? size : 1);
+    if (!text || fread(text, 1, size, f) != (size_t)size) { perror(path); exit(EXIT_FAILURE); }
+    fclose(f);
+    *length = (int)size;
+    return text;
+}
+
+/* Árvores iguais, incluindo linhas e deslocamentos (árvores rasas aqui) */
+static int same_tree(ASTNode *a, ASTNode *b) {
+    int i;
+    if (!a || !b) return a == b;
+    if (a->type != b->type || a->child_count != b->child_count ||
+        a->token.type != b->token.type || a->token.line != b->token.line ||
+        a->token.offset != b->token.offset ||
+        strcmp(a->token.lexeme, b->token.lexeme) != 0) {
+        fprintf(stderr, "diferença: '%s' linha %d offset %d x '%s' linha %d offset %d\n",
+                a->token.lexeme, a->token.line, a->token.offset,
+                b->token.lexeme, b->token.line, b->token.offset);
+        return 0;
+    }
+    for (i = 0; i < a->child_count; i++) {
+        if (!same_tree(a->children[i], b->children[i])) return 0;
+    }
+    return 1;
+}
+
+static int verify(IncrSession *s) {
+    IncrSession *fresh = incr_open(s->text, s->length);
+    int ok = same_tree(incr_ast(s), incr_ast(fresh));
+    incr_close(fresh);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    static const char *const result_names[] = {
+        "deslocadas", "item reanalisado", "análise completa",
+        "erro sintático", "erro léxico", "inválidas"
+    };
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [rodadas] [verifica]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 1000;
+    int check = argc > 3 && strcmp(argv[3], "verifica") == 0;
+    int length, lines = 0, nsites = 0, i, r;
+    int counts[INCR_INVALID_EDIT + 1] = {0};
+    char *text = read_file(argv[1], &length);
+    int *sites = malloc(sizeof(int) * (length / 8 + 1));
+    const char *mark = "!b * 2";
+
+    for (i = 0; i < length; i++) {
+        if (text[i] == '\n') lines++;
+        if (strncmp(text + i, mark, 6) == 0) sites[nsites++] = i + 5;
+    }
+    if (nsites == 0) {
+        fprintf(stderr, "%s: nenhum '%s' para editar (use gen.sh funcs)\n", argv[1], mark);
+        return EXIT_FAILURE;
+    }
+
+    mm_init((size_t)1 << 34);
+    clock_t start = clock();
+    IncrSession *s = incr_open(text, length);
+    double full = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (!s->valid) {
+        fprintf(stderr, "Erros de sintaxe em %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    int edits = 0;
+    double total = 0.0;
+    for (r = 0; r < rounds; r++) {
+        int at = sites[(int)(((long)r * 7919) % nsites)];
+        char digit = (char)('2' + r % 7);
+        int eol = at;
+        while (s->text[eol] != ';') eol++;
+        eol++;
+
+        start = clock();
+        counts[incr_edit(s, at, 1, &digit, 1)]++;
+        counts[incr_edit(s, at, 0, " ", 1)]++;
+        counts[incr_edit(s, at, 1, "", 0)]++;
+        counts[incr_edit(s, eol, 0, "\n", 1)]++;
+        counts[incr_edit(s, eol, 1, "", 0)]++;
+        total += (double)(clock() - start) / CLOCKS_PER_SEC;
+        edits += 5;
+
+        if (check && !verify(s)) {
+            fprintf(stderr, "AST incremental difere da análise completa (rodada %d)\n", r);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!verify(s)) {
+        fprintf(stderr, "AST incremental difere da análise completa\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-40s %d linhas: completa %8.3f ms   edição %8.4f ms (média de %d)\n",
+           argv[1], lines, full * 1000.0, total * 1000.0 / edits, edits);
+    for (i = 0; i <= INCR_INVALID_EDIT; i++) {
+        if (counts[i]) printf("    %-20s %d\n", result_names[i], counts[i]);
+    }
+
+    incr_close(s);
+    mm_cleanup();
+    free(sites);
+    free(text);
+    return EXIT_SUCCESS;
+}
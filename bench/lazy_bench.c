@@ -0,0 +1,143 @@
+/*
+ * Compara a análise com corpos de função adiados (--lazy) e a completa:
+ * tempo da análise sintática, memória da AST e tempo de análise sintática
+ * mais semântica (que só expande as funções alcançáveis). Ao final expande
+ * os corpos restantes e confere que a árvore é a mesma da análise completa.
+ * Uso: lazy_bench <arquivo-fonte> [repeticoes]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ast_walk.h"
+#include "memmgr.h"
+#include "parse_parallel.h"
+#include "parser.h"
+#include "semantics.h"
+#include "util.h"
+
+typedef struct {
+    double parse;                   /* melhor tempo da análise sintática */
+    double total;                   /* melhor tempo de sintática + semântica */
+    size_t bytes;                   /* memória da AST logo após a análise */
+} Run;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static ASTNode* parse(const Scanner *source, const char *path) {
+    int had_error;
+    ASTNode *ast = parse_program_parallel(source->src, source->len, 1, &had_error);
+    if (had_error) {
+        fprintf(stderr, "Erros de sintaxe em %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    return ast;
+}
+
+static void measure(const Scanner *source, const char *path, int lazy, int reps, Run *run) {
+    int r;
+
+    parser_set_lazy_bodies(lazy ? source->src : NULL);
+    run->parse = run->total = -1.0;
+    for (r = 0; r < reps; r++) {
+        size_t base = mm_current_usage();
+        double start = now(), parsed, elapsed;
+        SemaContext *sc;
+        ASTNode *ast = parse(source, path);
+
+        parsed = now() - start;
+        run->bytes = mm_current_usage() - base;
+        sc = sema_create(mm_max_usage());
+        semantic_analyze(sc, ast);
+        elapsed = now() - start;
+        sema_destroy(sc);
+        free_ast(ast);
+
+        if (run->parse < 0 || parsed < run->parse) run->parse = parsed;
+        if (run->total < 0 || elapsed < run->total) run->total = elapsed;
+    }
+    parser_set_lazy_bodies(NULL);
+}
+
+typedef struct {
+    unsigned long nodes;
+    unsigned long lazy;             /* corpos ainda não expandidos */
+} Count;
+
+static AstWalkAction count_pre(AstWalker *w, ASTNode *node, void *data) {
+    Count *c = (Count*)data;
+    (void)w;
+    if (node->lazy) c->lazy++;
+    c->nodes++;
+    return AST_WALK_CONTINUE;
+}
+
+static AstWalkAction expand_pre(AstWalker *w, ASTNode *node, void *data) {
+    (void)w;
+    if (!ast_expand_body(node)) (*(int*)data)++;
+    return AST_WALK_CONTINUE;
+}
+
+static Count count_nodes(ASTNode *root) {
+    AstVisitor visitor = {count_pre, NULL, NULL, 0, 0};
+    Count c = {0, 0};
+    visitor.data = &c;
+    ast_walk(root, &visitor);
+    return c;
+}
+
+/* Expande todos os corpos adiados; retorna quantos tinham erro */
+static int expand_all(ASTNode *root) {
+    AstVisitor visitor = {expand_pre, NULL, NULL, 0, 0};
+    int errors = 0;
+    visitor.data = &errors;
+    ast_walk(root, &visitor);
+    return errors;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    Run eager, lazy;
+    Scanner source;
+    ASTNode *full, *deferred;
+    Count full_count, skipped, expanded;
+    int errors, ok;
+
+    scanner_open(&source, argv[1]);
+    mm_init((size_t)1 << 34);
+
+    measure(&source, argv[1], 0, reps, &eager);
+    measure(&source, argv[1], 1, reps, &lazy);
+
+    /* Expandidos todos os corpos, a árvore adiada é a completa */
+    full = parse(&source, argv[1]);
+    parser_set_lazy_bodies(source.src);
+    deferred = parse(&source, argv[1]);
+    full_count = count_nodes(full);
+    skipped = count_nodes(deferred);
+    errors = expand_all(deferred);
+    expanded = count_nodes(deferred);
+    parser_set_lazy_bodies(NULL);
+    ok = errors == 0 && expanded.lazy == 0 && expanded.nodes == full_count.nodes;
+    free_ast(full);
+    free_ast(deferred);
+
+    printf("%-40s corpos adiados %6lu   nós %9lu -> %9lu   memória %11lu -> %11lu bytes\n",
+           argv[1], skipped.lazy, full_count.nodes, skipped.nodes,
+           (unsigned long)eager.bytes, (unsigned long)lazy.bytes);
+    printf("%-40s parse %8.3f ms -> %8.3f ms   parse+sema %8.3f ms -> %8.3f ms   conferência %s\n",
+           argv[1], eager.parse * 1000.0, lazy.parse * 1000.0,
+           eager.total * 1000.0, lazy.total * 1000.0, ok ? "ok" : "FALHOU");
+
+    mm_cleanup();
+    scanner_close(&source);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
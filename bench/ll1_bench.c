@@ -0,0 +1,99 @@
+/*
+ * Compara a descida recursiva com o analisador LL(1) dirigido por tabela:
+ * melhor tempo da análise sintática e vazão em MB/s. Cada motor roda em um
+ * processo filho, de modo que a queda de um deles é informada em vez de
+ * derrubar o benchmark.
+ * Uso: ll1_bench <arquivo-fonte> [repeticoes]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "ll1.h"
+#include "memmgr.h"
+#include "parser.h"
+#include "util.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void measure(ParserEngine engine, const char *path, int reps) {
+    const char *name = engine == PARSER_LL1 ? "ll1" : "descent";
+    double best = -1.0;
+    Scanner source;
+    int r;
+
+    scanner_open(&source, path);
+    parser_set_engine(engine);
+    for (r = 0; r < reps; r++) {
+        Scanner sc;
+        Parser *parser;
+        ASTNode *ast;
+        double start, elapsed;
+        int had_error;
+
+        mm_init((size_t)1 << 34);
+        scanner_init_buffer(&sc, source.src, source.len, 1);
+        start = now();
+        parser = parser_init_scanner(&sc);
+        ast = parse_program(parser);
+        elapsed = now() - start;
+        had_error = parser->had_error;
+        parser_free(parser);
+        free_ast(ast);
+        mm_cleanup();
+        if (had_error) {
+            fprintf(stderr, "Erros de sintaxe em %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    printf("%-40s %-8s parse %9.3f ms   %8.1f MB/s\n", path, name, best * 1000.0,
+           (double)source.len / best / 1e6);
+    scanner_close(&source);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    static const ParserEngine engines[] = {PARSER_DESCENT, PARSER_LL1};
+    int status = EXIT_SUCCESS, i;
+
+    for (i = 0; i < 2; i++) {
+        int child_status;
+        pid_t pid;
+
+        fflush(stdout);
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (pid == 0) {
+            measure(engines[i], argv[1], reps);
+            fflush(stdout);
+            _exit(EXIT_SUCCESS);
+        }
+        waitpid(pid, &child_status, 0);
+        if (WIFSIGNALED(child_status)) {
+            printf("%-40s %-8s interrompido pelo sinal %d%s\n", argv[1],
+                   engines[i] == PARSER_LL1 ? "ll1" : "descent", WTERMSIG(child_status),
+                   WTERMSIG(child_status) == SIGSEGV ? " (estouro da pilha)" : "");
+            status = EXIT_FAILURE;
+        } else if (WEXITSTATUS(child_status) != EXIT_SUCCESS) {
+            status = EXIT_FAILURE;
+        }
+    }
+    printf("%-40s tabelas LL(1): %lu bytes\n", argv[1], (unsigned long)ll1_table_size());
+    return status;
+}
@@ -0,0 +1,54 @@
+/*
+ * Mede o tempo da análise sintática isolada (sem a listagem de tokens e a
+ * impressão da AST feitas pelo compilador).
+ * Uso: parse_bench <arquivo-fonte> [repeticoes] [threads]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "memmgr.h"
+#include "parser.h"
+#include "parse_parallel.h"
+#include "util.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes] [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    double best = -1.0;
+    Scanner source;
+    int r, had_error;
+
+    scanner_open(&source, argv[1]);
+    for (r = 0; r < reps; r++) {
+        mm_init((size_t)1 << 31);
+        double start = now();
+        ASTNode *ast = parse_program_parallel(source.src, source.len, threads, &had_error);
+        double elapsed = now() - start;
+        if (had_error) {
+            fprintf(stderr, "Erros de sintaxe em %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        if (best < 0 || elapsed < best) best = elapsed;
+        free_ast(ast);
+        mm_cleanup();
+    }
+    scanner_close(&source);
+
+    if (threads > 1) {
+        printf("%-40s parse %8.3f ms (%d threads)\n", argv[1], best * 1000.0, threads);
+    } else {
+        printf("%-40s parse %8.3f ms\n", argv[1], best * 1000.0);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*
+ * Teste diferencial dos dois motores de análise sintática: cada arquivo é
+ * analisado pela descida recursiva e pelo analisador LL(1) dirigido por
+ * tabela, e as árvores são comparadas nó a nó (tipo, token, linha, lexema,
+ * valor e filhos). Um arquivo com erro de sintaxe passa se os dois motores
+ * acusarem erro (as mensagens e a recuperação diferem; ver ll1.h); um com
+ * erro léxico não é comparado.
+ *
+ * Os arquivos sem erro também passam pela análise em pedaços (push_parser.h),
+ * com a entrada cortada em pedaços de 1, 3, 64 e 4096 bytes: os itens
+ * entregues, na ordem, têm de ser os filhos de AST_PROGRAM da descida
+ * recursiva. Depois dos arquivos vem um programa gerado com um nome e um
+ * número de LONG_TOKEN bytes: em pedaços de 1 byte, um token relido a cada
+ * pedaço levaria minutos.
+ * Uso: parser_diff <arquivo-fonte>...
+ * Retorna falha se alguma árvore diferir.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "memmgr.h"
+#include "parser.h"
+#include "push_parser.h"
+#include "util.h"
+
+#define LONG_TOKEN 200000
+
+static ASTNode* parse_with(ParserEngine engine, const Scanner *source, int *had_error) {
+    Scanner sc;
+    Parser *parser;
+    ASTNode *ast;
+
+    scanner_init_buffer(&sc, source->src, source->len, 1);
+    parser_set_engine(engine);
+    parser = parser_init_scanner(&sc);
+    parser->silent = 1;
+    ast = parse_program(parser);
+    *had_error = parser->had_error;
+    parser_free(parser);
+    parser_set_engine(PARSER_DESCENT);
+    return ast;
+}
+
+/* Retorna 0 se o arquivo tem erro léxico (que interrompe a análise) */
+static int parse_both(const Scanner *source, ASTNode **descent, int *descent_error,
+                      ASTNode **table, int *table_error) {
+    jmp_buf lex_env;
+
+    *descent = *table = NULL;
+    if (setjmp(lex_env)) {
+        lex_error_set_recovery(NULL);
+        parser_set_engine(PARSER_DESCENT);
+        if (*descent) free_ast(*descent);
+        return 0;
+    }
+    lex_error_set_recovery(&lex_env);
+    *descent = parse_with(PARSER_DESCENT, source, descent_error);
+    *table = parse_with(PARSER_LL1, source, table_error);
+    lex_error_set_recovery(NULL);
+    return 1;
+}
+
+static int same_string(const char *a, const char *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static int same_node(const ASTNode *a, const ASTNode *b) {
+    if (!a || !b) return a == b;
+    return a->type == b->type && a->token.type == b->token.type &&
+           a->token.line == b->token.line &&
+           same_string(a->token.lexeme, b->token.lexeme) &&
+           same_string(a->value, b->value) && a->child_count == b->child_count;
+}
+
+/* Compara em pré-ordem com uma pilha explícita (as árvores podem ser fundas);
+ * retorna o número de nós, ou -1 na primeira diferença (linha em *line) */
+static long compare(ASTNode *a, ASTNode *b, int *line) {
+    ASTNode **stack = NULL;
+    int count = 0, capacity = 0, i;
+    long nodes = 0;
+
+    if (!same_node(a, b)) {
+        *line = a ? a->token.line : (b ? b->token.line : 0);
+        return -1;
+    }
+    if (!a) return 0;
+    for (;;) {
+        nodes++;
+        if (count + 2 * a->child_count > capacity) {
+            while (count + 2 * a->child_count > capacity) capacity = capacity ? capacity * 2 : 64;
+            stack = mm_realloc(stack, capacity * sizeof(ASTNode*));
+        }
+        for (i = a->child_count - 1; i >= 0; i--) {
+            if (!same_node(a->children[i], b->children[i])) {
+                *line = a->children[i] ? a->children[i]->token.line : a->token.line;
+                nodes = -1;
+                count = 0;
+                break;
+            }
+            if (!a->children[i]) continue;
+            stack[count++] = a->children[i];
+            stack[count++] = b->children[i];
+        }
+        if (count == 0) break;
+        b = stack[--count];
+        a = stack[--count];
+    }
+    if (stack) mm_free(stack);
+    return nodes;
+}
+
+static void collect_item(ASTNode *item, void *data) {
+    ast_node_add_child((ASTNode*)data, item);
+}
+
+/* Fonte de pedaços: entrega o texto em pedaços de chunk bytes; retorna 0 se
+ * a análise não aceitou o programa */
+static ASTNode* parse_chunks(const Scanner *source, size_t chunk, Token root_token) {
+    ASTNode *program = ast_node_create(AST_PROGRAM, root_token);
+    PushParser *ctx = parser_push_create(collect_item, program);
+    size_t pos = 0;
+    int ok = 1;
+
+    while (ok && pos < source->len) {
+        size_t len = source->len - pos < chunk ? source->len - pos : chunk;
+        ok = parser_feed(ctx, source->src + pos, len);
+        pos += len;
+    }
+    if (ok) ok = parser_finish(ctx);
+    parser_push_free(ctx);
+    if (!ok) {
+        free_ast(program);
+        return NULL;
+    }
+    return program;
+}
+
+/* Retorna o tamanho do primeiro pedaço em que a árvore difere, ou 0 */
+static int compare_chunked(const Scanner *source, ASTNode *expected, int *line) {
+    static const size_t chunks[] = {1, 3, 64, 4096};
+    size_t i;
+
+    for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        ASTNode *program = parse_chunks(source, chunks[i], expected->token);
+        long nodes = program ? compare(expected, program, line) : -1;
+        if (!program) *line = 0;
+        if (program) free_ast(program);
+        if (nodes < 0) return (int)chunks[i];
+    }
+    return 0;
+}
+
+/* Retorna 1 se as árvores diferirem */
+static int check(const Scanner *source, const char *name) {
+    ASTNode *descent, *table;
+    int descent_error, table_error, line = 0, failed = 0;
+    long nodes;
+    int chunk;
+
+    if (!parse_both(source, &descent, &descent_error, &table, &table_error)) {
+        printf("ok      %-44s erro léxico, não comparado\n", name);
+        return 0;
+    }
+
+    if (descent_error || table_error) {
+        if (descent_error && table_error) {
+            printf("ok      %-44s erro de sintaxe nos dois\n", name);
+        } else {
+            printf("DIFERE  %-44s erro de sintaxe só na %s\n", name,
+                   descent_error ? "descida recursiva" : "análise LL(1)");
+            failed = 1;
+        }
+    } else if ((nodes = compare(descent, table, &line)) < 0) {
+        printf("DIFERE  %-44s linha %d\n", name, line);
+        failed = 1;
+    } else if ((chunk = compare_chunked(source, descent, &line)) > 0) {
+        if (line > 0) {
+            printf("DIFERE  %-44s em pedaços de %d bytes, linha %d\n", name, chunk, line);
+        } else {
+            printf("DIFERE  %-44s em pedaços de %d bytes, programa não aceito\n", name, chunk);
+        }
+        failed = 1;
+    } else {
+        printf("ok      %-44s %ld nós\n", name, nodes);
+    }
+
+    free_ast(descent);
+    free_ast(table);
+    return failed;
+}
+
+/* 'principal() { inteiro !abbb...; !abbb... = 111...; }' */
+static char* long_token_source(size_t *len) {
+    static const char *parts[] = {"principal() {\n    inteiro !a", ";\n    !a", " = ", ";\n}\n"};
+    char *text = mm_malloc(3 * LONG_TOKEN + 64), *p = text;
+    int i;
+
+    if (!text) {
+        fprintf(stderr, "Erro: memória insuficiente para o programa gerado\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < 4; i++) {
+        p += sprintf(p, "%s", parts[i]);
+        if (i < 3) {
+            memset(p, i < 2 ? 'b' : '1', LONG_TOKEN);
+            p += LONG_TOKEN;
+        }
+    }
+    *len = (size_t)(p - text);
+    return text;
+}
+
+int main(int argc, char **argv) {
+    int failures = 0, i;
+    Scanner source;
+    size_t len;
+    char *text;
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    mm_init((size_t)1 << 34);
+
+    for (i = 1; i < argc; i++) {
+        scanner_open(&source, argv[i]);
+        failures += check(&source, argv[i]);
+        scanner_close(&source);
+    }
+
+    text = long_token_source(&len);
+    scanner_init_buffer(&source, text, len, 1);
+    failures += check(&source, "(tokens de 200000 bytes)");
+    mm_free(text);
+
+    mm_cleanup();
+    if (failures > 0) {
+        printf("%d de %d arquivos com árvores diferentes\n", failures, argc);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
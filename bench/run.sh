@@ -0,0 +1,138 @@
+#!/bin/sh
+# Executa os benchmarks sobre entradas geradas por bench/gen.sh.
+# Uso: run.sh [diretorio-de-trabalho]
+set -e
+
+BENCH_DIR=$(dirname "$0")
+BUILD_DIR=${BUILD_DIR:-build}
+COMPILER=${COMPILER:-./compiler}
+WORK=${1:-$BUILD_DIR/bench-inputs}
+mkdir -p "$WORK"
+
+echo "== Expressões (análise sintática)"
+for n in 1000 10000 100000; do
+    "$BENCH_DIR/gen.sh" expr "$n" > "$WORK/expr_$n.src"
+    "$BUILD_DIR/parse_bench" "$WORK/expr_$n.src"
+done
+for n in 1000 10000 100000; do
+    "$BENCH_DIR/gen.sh" parens "$n" > "$WORK/parens_$n.src"
+    "$BUILD_DIR/parse_bench" "$WORK/parens_$n.src"
+done
+
+echo "== Análise paralela das funções (--jobs)"
+"$BENCH_DIR/gen.sh" funcs 4546 > "$WORK/funcs_4546.src"
+for t in 1 2 4; do
+    "$BUILD_DIR/parse_bench" "$WORK/funcs_4546.src" 5 "$t"
+done
+
+echo "== Análise semântica paralela das funções (--jobs)"
+"$BENCH_DIR/gen.sh" funcs 20000 > "$WORK/funcs_20000.src"
+for t in 1 2 4 8; do
+    "$BUILD_DIR/walk_bench" "$WORK/funcs_4546.src" 5 "$t" 2>/dev/null
+    "$BUILD_DIR/walk_bench" "$WORK/funcs_20000.src" 3 "$t" 2>/dev/null
+done
+
+echo "== Percursos da AST (semântica e liberação)"
+for n in 1000 10000 100000; do
+    "$BUILD_DIR/walk_bench" "$WORK/expr_$n.src"
+done
+
+echo "== Passadas do pipeline (validações e semântica)"
+"$BUILD_DIR/walk_bench" "$WORK/funcs_4546.src" 1 1 1 2>/dev/null
+"$BUILD_DIR/walk_bench" "$WORK/expr_10000.src" 1 1 1
+
+echo "== AST binária (gravação e carregamento com mmap)"
+"$BUILD_DIR/ast_bench" "$WORK/expr_100000.src"
+"$BUILD_DIR/ast_bench" "$WORK/funcs_4546.src"
+
+echo "== Subexpressões compartilhadas (--hash-cons)"
+for n in 1000 10000; do
+    "$BUILD_DIR/hashcons_bench" "$WORK/expr_$n.src" 2>/dev/null
+done
+"$BUILD_DIR/hashcons_bench" "$WORK/funcs_4546.src" 2>/dev/null
+
+echo "== Corpos de função adiados (--lazy)"
+"$BENCH_DIR/gen.sh" funcs 100 > "$WORK/funcs_100.src"
+"$BUILD_DIR/lazy_bench" "$WORK/funcs_100.src" 2>/dev/null
+"$BUILD_DIR/lazy_bench" "$WORK/funcs_4546.src" 2>/dev/null
+
+echo "== Compilação completa (saída descartada)"
+for n in 1000 10000; do
+    start=$(date +%s%N)
+    MM_LIMIT=4000000000 "$COMPILER" "$WORK/expr_$n.src" > /dev/null 2>&1
+    end=$(date +%s%N)
+    printf "%-40s total %8d ms\n" "$WORK/expr_$n.src" $(( (end - start) / 1000000 ))
+done
+
+echo "== Formatos de listagem (--dump, saída descartada)"
+for d in text json binary none; do
+    start=$(date +%s%N)
+    MM_LIMIT=4000000000 "$COMPILER" --dump=$d "$WORK/expr_10000.src" > /dev/null 2>&1
+    end=$(date +%s%N)
+    printf "%-40s --dump=%-7s %8d ms\n" "$WORK/expr_10000.src" "$d" $(( (end - start) / 1000000 ))
+done
+
+echo "== Regras de espaçamento (--spacing, saída descartada)"
+for r in none all; do
+    start=$(date +%s%N)
+    MM_LIMIT=4000000000 "$COMPILER" --dump=none --spacing=$r "$WORK/expr_10000.src" > /dev/null 2>&1
+    end=$(date +%s%N)
+    printf "%-40s --spacing=%-5s %8d ms\n" "$WORK/expr_10000.src" "$r" $(( (end - start) / 1000000 ))
+done
+
+echo "== Análise dirigida por tabela (--parser=ll1) x descida recursiva"
+"$BUILD_DIR/ll1_bench" "$WORK/expr_10000.src"
+"$BUILD_DIR/ll1_bench" "$WORK/parens_100000.src"
+"$BUILD_DIR/ll1_bench" "$WORK/funcs_4546.src"
+# Comandos aninhados: os dois motores usam pilha explícita, sem recursão
+# por nível (a profundidade de 1 milhão fica em bench/stress.sh)
+for n in 1000 100000; do
+    "$BENCH_DIR/gen.sh" nest "$n" > "$WORK/nest_$n.src"
+    "$BUILD_DIR/ll1_bench" "$WORK/nest_$n.src" 3
+done
+# Tamanho do código (objetos sem otimização): funções parse_*/expr_* da
+# descida recursiva x motor e tabelas LL(1)
+symbol_bytes() {
+    total=0
+    for size in $(nm -S --defined-only "$1" | awk -v t="$2" -v n="$3" '$3 ~ t && $4 ~ n { print $2 }'); do
+        total=$((total + 0x$size))
+    done
+    echo "$total"
+}
+printf "%-40s código %6d bytes\n" "descida recursiva" \
+    "$(symbol_bytes "$BUILD_DIR/parser.o" '^[tT]$' '^(parse_|expr_)')"
+printf "%-40s código %6d bytes   tabelas %6d bytes\n" "LL(1)" \
+    "$(symbol_bytes "$BUILD_DIR/ll1.o" '^[tT]$' '^[a-z]')" \
+    "$(symbol_bytes "$BUILD_DIR/ll1.o" '^[rdRD]$' '^ll1_')"
+
+echo "== Tabela de símbolos: escopos de bloco e buscas por tamanho de escopo"
+"$BUILD_DIR/symtab_bench"
+for n in 10000 100000; do
+    "$BENCH_DIR/gen.sh" decls "$n" > "$WORK/decls_$n.src"
+    start=$(date +%s%N)
+    MM_LIMIT=4000000000 "$COMPILER" --dump=none "$WORK/decls_$n.src" > /dev/null 2>&1
+    end=$(date +%s%N)
+    printf "%-40s %8d ms\n" "$WORK/decls_$n.src" $(( (end - start) / 1000000 ))
+done
+
+echo "== Índice de símbolos (--symbol-at): montagem e consultas"
+"$BUILD_DIR/symindex_bench" "$WORK/funcs_20000.src" 2>/dev/null
+"$BUILD_DIR/symindex_bench" "$WORK/decls_100000.src" 2>/dev/null
+
+echo "== Fluxo de dados (uso de variáveis): funções com milhares de variáveis"
+for n in 1000 2000 4000 8000; do
+    "$BENCH_DIR/gen.sh" vars "$n" > "$WORK/vars_$n.src"
+    "$BUILD_DIR/dataflow_bench" "$WORK/vars_$n.src" 2>/dev/null
+done
+"$BUILD_DIR/dataflow_bench" "$WORK/funcs_20000.src" 2>/dev/null
+
+echo "== Pico de memória: compilação em lote x --stream"
+for n in 100 1000 4546; do
+    "$BENCH_DIR/gen.sh" funcs "$n" > "$WORK/funcs_$n.src"
+    batch=$(MM_LIMIT=4000000000 "$COMPILER" "$WORK/funcs_$n.src" 2>/dev/null | sed -n 's/^Pico de uso: //p')
+    stream=$(MM_LIMIT=4000000000 "$COMPILER" --stream "$WORK/funcs_$n.src" 2>/dev/null | sed -n 's/^Pico de uso: //p')
+    printf "%-40s lote %14s   stream %14s\n" "$WORK/funcs_$n.src" "$batch" "$stream"
+done
+
+echo "== Edição incremental (arquivo de ~50 mil linhas)"
+"$BUILD_DIR/incr_bench" "$WORK/funcs_4546.src"
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Testes de estresse: entradas patologicamente aninhadas devem compilar sem
+# estourar a pilha de C.
+# Uso: stress.sh [profundidade]
+# O aninhamento de comandos ('se'/'enquanto') é exercitado com os dois
+# analisadores sintáticos.
+set -e
+
+BENCH_DIR=$(dirname "$0")
+BUILD_DIR=${BUILD_DIR:-build}
+COMPILER=${COMPILER:-./compiler}
+DEPTH=${1:-1000000}
+WORK=$BUILD_DIR/bench-inputs
+mkdir -p "$WORK"
+
+status=0
+for kind in parens; do
+    input="$WORK/stress_${kind}_$DEPTH.src"
+    "$BENCH_DIR/gen.sh" "$kind" "$DEPTH" > "$input"
+    if MM_LIMIT=4000000000 "$COMPILER" "$input" > /dev/null 2>&1; then
+        echo "ok    $kind ($DEPTH níveis)"
+    else
+        echo "FALHA $kind ($DEPTH níveis)"
+        status=1
+    fi
+done
+
+# Comandos aninhados, sem imprimir a AST (a indentação cresce com a
+# profundidade)
+input="$WORK/stress_nest_$DEPTH.src"
+"$BENCH_DIR/gen.sh" nest "$DEPTH" > "$input"
+for engine in descent ll1; do
+    if MM_LIMIT=4000000000 "$COMPILER" --parser=$engine --dump=none "$input" > /dev/null 2>&1; then
+        echo "ok    nest ($DEPTH níveis, --parser=$engine)"
+    else
+        echo "FALHA nest ($DEPTH níveis, --parser=$engine)"
+        status=1
+    fi
+done
+
+# Árvores profundas: percorridas sem imprimir a AST
+for kind in unary chain; do
+    input="$WORK/stress_${kind}_$DEPTH.src"
+    "$BENCH_DIR/gen.sh" "$kind" "$DEPTH" > "$input"
+    if "$BUILD_DIR/walk_bench" "$input" 1 > /dev/null 2>&1; then
+        echo "ok    $kind ($DEPTH níveis)"
+    else
+        echo "FALHA $kind ($DEPTH níveis)"
+        status=1
+    fi
+done
+
+# Round-trip da AST binária sobre as mesmas árvores profundas
+for kind in unary chain; do
+    input="$WORK/stress_${kind}_$DEPTH.src"
+    if "$BUILD_DIR/ast_bench" "$input" 1 > /dev/null 2>&1; then
+        echo "ok    $kind ($DEPTH níveis, AST binária)"
+    else
+        echo "FALHA $kind ($DEPTH níveis, AST binária)"
+        status=1
+    fi
+done
+
+exit $status
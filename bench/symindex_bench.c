@@ -0,0 +1,108 @@
+/*
+ * Mede o índice de símbolos (symindex.h): o custo de montá-lo junto com a
+ * análise semântica, o tamanho, e as consultas de editor (símbolo na
+ * posição, referências e resolução de um nome na posição) sobre posições
+ * de usos sorteadas. Sem o índice, responder a uma delas exige refazer a
+ * análise semântica inteira.
+ * Uso: symindex_bench <arquivo-fonte> [consultas]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "memmgr.h"
+#include "parser.h"
+#include "semantics.h"
+#include "util.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double analyze(ASTNode *ast, SymIndex **index) {
+    double start = now();
+    SemaContext *sc = sema_create(mm_max_usage());
+    if (index) sema_build_index(sc);
+    semantic_analyze(sc, ast);
+    if (index) *index = sema_take_index(sc);
+    sema_destroy(sc);
+    return now() - start;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [consultas]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int queries = argc > 2 ? atoi(argv[2]) : 1000000;
+    SymIndex *index = NULL;
+    int *positions, i, found = 0;
+    unsigned long seed = 12345, sum = 0;
+    double plain, indexed, start, at_ns, refs_ns, resolve_ns;
+
+    mm_init((size_t)1 << 34);
+    init_scanner(argv[1]);
+    Parser *parser = parser_init();
+    ASTNode *ast = parse_program(parser);
+    if (parser->had_error) {
+        fprintf(stderr, "Erros de sintaxe em %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    parser_free(parser);
+    close_scanner();
+
+    plain = analyze(ast, NULL);
+    indexed = analyze(ast, &index);
+    if (symindex_ref_count(index) == 0) {
+        fprintf(stderr, "Nenhuma referência em %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    /* Posições no meio de usos sorteados */
+    positions = mm_malloc(queries * sizeof(int));
+    for (i = 0; i < queries; i++) {
+        int def, count;
+        const SymRef *refs;
+        seed = seed * 1103515245UL + 12345UL;
+        def = (int)((seed >> 8) % (unsigned long)symindex_def_count(index));
+        refs = symindex_refs(index, def, &count);
+        positions[i] = count > 0 ? refs[(seed >> 4) % (unsigned long)count].offset + 1
+                                 : symindex_def(index, def)->offset;
+    }
+
+    start = now();
+    for (i = 0; i < queries; i++) {
+        if (symindex_symbol_at(index, positions[i]) >= 0) found++;
+    }
+    at_ns = (now() - start) * 1e9 / queries;
+
+    start = now();
+    for (i = 0; i < queries; i++) {
+        int count, def = symindex_symbol_at(index, positions[i]);
+        const SymRef *refs = symindex_refs(index, def, &count);
+        sum += (unsigned long)count;
+        if (count > 0) sum += (unsigned long)refs[count - 1].line;
+    }
+    refs_ns = (now() - start) * 1e9 / queries;
+
+    start = now();
+    for (i = 0; i < queries; i++) {
+        int def = symindex_symbol_at(index, positions[i]);
+        if (symindex_resolve(index, symindex_name(index, def), positions[i]) == def) sum++;
+    }
+    resolve_ns = (now() - start) * 1e9 / queries;
+
+    printf("%-40s sema %8.3f ms   com índice %8.3f ms   índice %9zu bytes (%d definições, %d referências, %d escopos)\n",
+           argv[1], plain * 1000.0, indexed * 1000.0, symindex_size(index),
+           symindex_def_count(index), symindex_ref_count(index), symindex_scope_count(index));
+    printf("%-40s posição %6.1f ns   referências %6.1f ns   resolução %6.1f ns   (%d de %d achadas, %lu)\n",
+           "", at_ns, refs_ns, resolve_ns, found, queries, sum);
+
+    mm_free(positions);
+    symindex_free(index);
+    free_ast(ast);
+    mm_cleanup();
+    return EXIT_SUCCESS;
+}
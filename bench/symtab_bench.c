@@ -0,0 +1,239 @@
+/*
+ * Mede a tabela de símbolos: a taxa de entrada e saída de escopos de bloco
+ * com 0 a 3 símbolos (o caso comum) e o custo de uma busca, com e sem
+ * sucesso, em escopos de 1 a 1.000.000 de símbolos, com a memória ocupada
+ * pelo escopo (estrutura, índice e símbolos, sem os nomes); e, com
+ * escopos aninhados de 1 a 10.000 níveis, a busca de um nome local e de um
+ * global a partir do escopo mais interno; e o padrão cópia-e-ramo de quem
+ * compartilha um escopo grande entre análises (threads, recompilações):
+ * symtab_snapshot de um escopo de 10 a 100.000 símbolos, um escopo novo
+ * com três declarações e três buscas, e a liberação da cópia. Cada medida
+ * é feita com as três organizações da tabela (SymTabDesign).
+ * Uso: symtab_bench [maior-escopo]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "memmgr.h"
+#include "symtab.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Nomes "!v0", "!v1", ... em um só bloco */
+static char** make_names(size_t count, const char *prefix) {
+    char **names = malloc(count * sizeof(char*));
+    char *text = malloc(count * 16);
+    size_t i;
+    for (i = 0; i < count; i++) {
+        names[i] = text + i * 16;
+        sprintf(names[i], "%s%lu", prefix, (unsigned long)i);
+    }
+    return names;
+}
+
+static void free_names(char **names) {
+    free(names[0]);
+    free(names);
+}
+
+static const char *design_name(void) {
+    switch (symtab_design()) {
+        case SYMTAB_GLOBAL: return "global";
+        case SYMTAB_HAMT:   return "hamt";
+        default:            return "scopes";
+    }
+}
+
+static void bench_scopes(char **names) {
+    const long rounds = 1000000;
+    double best = -1.0;
+    int r;
+
+    for (r = 0; r < 3; r++) {
+        SymTab *st;
+        double start, elapsed;
+        long i;
+
+        mm_init((size_t)1 << 34);
+        st = symtab_create();
+        start = now();
+        for (i = 0; i < rounds; i++) {
+            Symbol s = {0};
+            int k;
+            symtab_enter_scope(st);
+            for (k = 0; k < (int)(i % 4); k++) {
+                s.name = names[k];
+                symtab_insert(st, &s);
+                symtab_lookup(st, names[k]);
+            }
+            symtab_leave_scope(st);
+        }
+        elapsed = now() - start;
+        symtab_destroy(st);
+        mm_cleanup();
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    printf("%-7s escopos de bloco (0-3 símbolos)   %8.1f mil/s  %6.1f ns por escopo\n",
+           design_name(), rounds / best / 1e3, best * 1e9 / rounds);
+}
+
+static void bench_lookups(char **names, char **missing, size_t size) {
+    const size_t lookups = 2000000;
+    double insert, hit = 0, miss = 0, start;
+    size_t i, bytes, before;
+    SymTab *st;
+
+    mm_init((size_t)1 << 34);
+    st = symtab_create();
+    before = mm_current_usage();
+    symtab_enter_scope(st);
+    start = now();
+    for (i = 0; i < size; i++) {
+        Symbol s = {0};
+        s.name = names[i];
+        symtab_insert(st, &s);
+    }
+    insert = now() - start;
+    /* Escopo, índice e símbolos, sem os nomes copiados */
+    bytes = mm_current_usage() - before;
+    for (i = 0; i < size; i++) bytes -= strlen(names[i]) + 1;
+
+    start = now();
+    for (i = 0; i < lookups; i++) {
+        if (!symtab_lookup(st, names[(i * 7919) % size])) abort();
+    }
+    hit = now() - start;
+    start = now();
+    for (i = 0; i < lookups; i++) {
+        if (symtab_lookup(st, missing[i % 1000])) abort();
+    }
+    miss = now() - start;
+
+    printf("%-7s escopo com %8lu símbolos   inserção %6.1f ns   busca %6.1f ns   falha %6.1f ns   %10lu bytes\n",
+           design_name(), (unsigned long)size, insert * 1e9 / size, hit * 1e9 / lookups,
+           miss * 1e9 / lookups, (unsigned long)bytes);
+    symtab_destroy(st);
+    mm_cleanup();
+}
+
+/* 100 nomes globais e depth escopos aninhados, cada um declarando de novo
+ * os mesmos dois nomes locais */
+static void bench_depth(char **names, char **globals, size_t depth) {
+    /* Com SYMTAB_SCOPES a busca global percorre todos os níveis */
+    const size_t lookups = depth < 1000 ? 1000000 : 20000;
+    double local, global, start;
+    size_t i;
+    SymTab *st;
+
+    mm_init((size_t)1 << 34);
+    st = symtab_create();
+    for (i = 0; i < 100; i++) {
+        Symbol s = {0};
+        s.name = globals[i];
+        symtab_insert(st, &s);
+    }
+    for (i = 0; i < depth; i++) {
+        Symbol s = {0};
+        symtab_enter_scope(st);
+        s.name = names[0];
+        symtab_insert(st, &s);
+        s.name = names[1];
+        symtab_insert(st, &s);
+    }
+
+    start = now();
+    for (i = 0; i < lookups; i++) {
+        if (!symtab_lookup(st, names[i & 1])) abort();
+    }
+    local = now() - start;
+    start = now();
+    for (i = 0; i < lookups; i++) {
+        if (!symtab_lookup(st, globals[i % 100])) abort();
+    }
+    global = now() - start;
+
+    printf("%-7s profundidade %6lu   busca local %8.1f ns   global %8.1f ns\n",
+           design_name(), (unsigned long)depth, local * 1e9 / lookups, global * 1e9 / lookups);
+    symtab_destroy(st);
+    mm_cleanup();
+}
+
+/* size nomes globais; cada ramo é uma cópia da tabela com um escopo próprio */
+static void bench_branch(char **names, char **locals, size_t size) {
+    const size_t branches = size > 10000 ? 20 : size > 100 ? 500 : 20000;
+    double start, elapsed;
+    size_t i, k;
+    SymTab *st;
+
+    mm_init((size_t)1 << 34);
+    st = symtab_create();
+    for (i = 0; i < size; i++) {
+        Symbol s = {0};
+        s.name = names[i];
+        symtab_insert(st, &s);
+    }
+
+    start = now();
+    for (i = 0; i < branches; i++) {
+        SymTab *branch = symtab_snapshot(st);
+        for (k = 0; k < 3; k++) {
+            Symbol s = {0};
+            s.name = locals[k];
+            symtab_insert(branch, &s);
+        }
+        for (k = 0; k < 3; k++) {
+            if (!symtab_lookup(branch, locals[k]) ||
+                !symtab_lookup(branch, names[(i * 7919 + k) % size])) abort();
+        }
+        symtab_destroy(branch);
+    }
+    elapsed = now() - start;
+
+    printf("%-7s cópia e ramo, escopo de %8lu símbolos   %10.1f ns por ramo\n",
+           design_name(), (unsigned long)size, elapsed * 1e9 / branches);
+    symtab_destroy(st);
+    mm_cleanup();
+}
+
+int main(int argc, char **argv) {
+    size_t largest = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    char **names = make_names(largest, "!v");
+    char **missing = make_names(1000, "!x");
+    char **globals = make_names(100, "!g");
+    static const SymTabDesign designs[] = {SYMTAB_SCOPES, SYMTAB_GLOBAL, SYMTAB_HAMT};
+    size_t size, depth;
+    int d;
+
+    for (d = 0; d < 3; d++) {
+        symtab_set_design(designs[d]);
+        bench_scopes(names);
+    }
+    for (size = 1; size <= largest; size *= 10) {
+        for (d = 0; d < 3; d++) {
+            symtab_set_design(designs[d]);
+            bench_lookups(names, missing, size);
+        }
+    }
+    for (depth = 1; depth <= 10000; depth *= 10) {
+        for (d = 0; d < 3; d++) {
+            symtab_set_design(designs[d]);
+            bench_depth(names, globals, depth);
+        }
+    }
+    for (size = 10; size <= 100000 && size <= largest; size *= 100) {
+        for (d = 0; d < 3; d++) {
+            symtab_set_design(designs[d]);
+            bench_branch(names, missing, size);
+        }
+    }
+    free_names(names);
+    free_names(missing);
+    free_names(globals);
+    return EXIT_SUCCESS;
+}
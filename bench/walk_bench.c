@@ -0,0 +1,98 @@
+/*
+ * Mede os percursos da AST (análise semântica e liberação) sobre uma árvore
+ * já construída e conta quantos percursos a análise semântica faz. Também serve de teste de estresse para árvores profundas,
+ * já que não imprime a AST (a indentação cresce com a profundidade).
+ * Com threads > 1, os corpos das funções são analisados em paralelo
+ * (sema_set_threads); os tempos são de relógio de parede.
+ * Com validar = 1, mede também validate_program antes da análise e soma as
+ * passadas do pipeline inteiro: a das validações pelos itens, uma por corpo
+ * no uso das variáveis, e as da análise semântica. Fica desligado por
+ * padrão porque o fluxo de dados de um corpo 'principal' enorme domina o
+ * tempo (o mesmo da compilação completa).
+ * Uso: walk_bench <arquivo-fonte> [repeticoes] [threads] [validar]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "memmgr.h"
+#include "parser.h"
+#include "semantics.h"
+#include "util.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <arquivo-fonte> [repeticoes] [threads] [validar]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    int validate = argc > 4 ? atoi(argv[4]) : 0;
+    double best_valid = -1.0, best_sema = -1.0, best_free = -1.0;
+    unsigned long checks = 0, walks = 0, typed = 0, reused = 0;
+    int r;
+
+    for (r = 0; r < reps; r++) {
+        mm_init((size_t)1 << 34);
+        init_scanner(argv[1]);
+        Parser *parser = parser_init();
+        ASTNode *ast = parse_program(parser);
+        if (parser->had_error) {
+            fprintf(stderr, "Erros de sintaxe em %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        parser_free(parser);
+        close_scanner();
+
+        if (validate) {
+            /* O uso das variáveis lê o texto de onde a AST veio */
+            Scanner text;
+            unsigned long checks_before = validate_walk_count();
+            scanner_open(&text, argv[1]);
+            double start = now();
+            validate_program(ast, text.src, text.len, NULL);
+            double valid = now() - start;
+            checks = validate_walk_count() - checks_before;
+            scanner_close(&text);
+            if (best_valid < 0 || valid < best_valid) best_valid = valid;
+        }
+
+        unsigned long before = sema_walk_count(), typed_before, reused_before;
+        sema_type_stats(&typed_before, &reused_before);
+        double start = now();
+        SemaContext *sc = sema_create(mm_max_usage());
+        sema_set_threads(threads);
+        semantic_analyze(sc, ast);
+        sema_destroy(sc);
+        double sema = now() - start;
+        walks = sema_walk_count() - before;
+        sema_type_stats(&typed, &reused);
+        typed -= typed_before;
+        reused -= reused_before;
+
+        start = now();
+        free_ast(ast);
+        double freed = now() - start;
+
+        if (best_sema < 0 || sema < best_sema) best_sema = sema;
+        if (best_free < 0 || freed < best_free) best_free = freed;
+        mm_cleanup();
+    }
+
+    if (validate) {
+        printf("%-40s valid %8.3f ms (%lu passadas)   sema %8.3f ms (%lu percursos)   total %lu passadas\n",
+               argv[1], best_valid * 1000.0, checks, best_sema * 1000.0, walks, checks + walks);
+    } else if (threads > 1) {
+        printf("%-40s sema %8.3f ms (%d threads)\n", argv[1], best_sema * 1000.0, threads);
+    } else {
+        printf("%-40s sema %8.3f ms (%lu percursos, %lu nós tipados, %lu reaproveitados)   free %8.3f ms\n",
+               argv[1], best_sema * 1000.0, walks, typed, reused, best_free * 1000.0);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,281 @@
+/* Gerado por tools/ll1gen a partir de grammar/linguagem.ll; não editar. */
+
+#define LL1_NONTERMINALS 33
+#define LL1_PRODUCTIONS  80
+#define LL1_START        LL1_NT(0)
+
+static const unsigned char ll1_rhs[] = {
+    /*   0 programa -> 'principal' '(' ')' '{' comandos '}' */
+    TOK_KW_PRINCIPAL, TOK_LPAREN, TOK_RPAREN, TOK_LBRACE, LL1_NT(2), TOK_RBRACE,
+    /*   1 programa -> definicao @add itens */
+    LL1_NT(3), LL1_ADD, LL1_NT(4),
+    /*   2 programa -> comando @add itens */
+    LL1_NT(5), LL1_ADD, LL1_NT(4),
+    /*   3 programa -> */
+    /*   4 itens -> item @add itens */
+    LL1_NT(6), LL1_ADD, LL1_NT(4),
+    /*   5 itens -> */
+    /*   6 item -> definicao */
+    LL1_NT(3),
+    /*   7 item -> 'principal' @node(FUNCTION_DEF) @node(IDENTIFIER) @add '(' ')' bloco @add */
+    TOK_KW_PRINCIPAL, LL1_NODE(AST_FUNCTION_DEF), LL1_NODE(AST_IDENTIFIER), LL1_ADD, TOK_LPAREN, TOK_RPAREN, LL1_NT(7), LL1_ADD,
+    /*   8 item -> comando */
+    LL1_NT(5),
+    /*   9 definicao -> 'funcao' @node(FUNCTION_DEF) tipo_retorno IDENT @node(IDENTIFIER) @add '(' parametros ')' bloco @add */
+    TOK_KW_FUNCAO, LL1_NODE(AST_FUNCTION_DEF), LL1_NT(8), TOK_IDENTIFIER, LL1_NODE(AST_IDENTIFIER), LL1_ADD, TOK_LPAREN, LL1_NT(9), TOK_RPAREN, LL1_NT(7), LL1_ADD,
+    /*  10 tipo_retorno -> tipo */
+    LL1_NT(10),
+    /*  11 tipo_retorno -> */
+    /*  12 parametros -> declaracao @add */
+    LL1_NT(11), LL1_ADD,
+    /*  13 parametros -> */
+    /*  14 tipo -> 'inteiro' */
+    TOK_KW_INTEIRO,
+    /*  15 tipo -> 'decimal' */
+    TOK_KW_DECIMAL,
+    /*  16 tipo -> 'texto' */
+    TOK_KW_TEXTO,
+    /*  17 bloco -> '{' @node(BLOCK) comandos '}' */
+    TOK_LBRACE, LL1_NODE(AST_BLOCK), LL1_NT(2), TOK_RBRACE,
+    /*  18 comandos -> comando @add comandos */
+    LL1_NT(5), LL1_ADD, LL1_NT(2),
+    /*  19 comandos -> */
+    /*  20 comando -> declaracao ';' */
+    LL1_NT(11), TOK_SEMICOLON,
+    /*  21 comando -> atribuicao ';' */
+    LL1_NT(12), TOK_SEMICOLON,
+    /*  22 comando -> 'se' @node(IF_STMT) '(' expressao @add ')' comando @add senao */
+    TOK_KW_SE, LL1_NODE(AST_IF_STMT), TOK_LPAREN, LL1_NT(13), LL1_ADD, TOK_RPAREN, LL1_NT(5), LL1_ADD, LL1_NT(1),
+    /*  23 comando -> 'enquanto' @node(WHILE_STMT) '(' expressao @add ')' comando @add */
+    TOK_KW_ENQUANTO, LL1_NODE(AST_WHILE_STMT), TOK_LPAREN, LL1_NT(13), LL1_ADD, TOK_RPAREN, LL1_NT(5), LL1_ADD,
+    /*  24 comando -> 'para' @node(FOR_STMT) '(' atribuicao @add ';' expressao @add ';' atribuicao @add ')' comando @add */
+    TOK_KW_PARA, LL1_NODE(AST_FOR_STMT), TOK_LPAREN, LL1_NT(12), LL1_ADD, TOK_SEMICOLON, LL1_NT(13), LL1_ADD, TOK_SEMICOLON, LL1_NT(12), LL1_ADD, TOK_RPAREN, LL1_NT(5), LL1_ADD,
+    /*  25 comando -> 'leia' @node(READ_STMT) '(' IDENT @node(IDENTIFIER) @add ')' ';' */
+    TOK_KW_LEIA, LL1_NODE(AST_READ_STMT), TOK_LPAREN, TOK_IDENTIFIER, LL1_NODE(AST_IDENTIFIER), LL1_ADD, TOK_RPAREN, TOK_SEMICOLON,
+    /*  26 comando -> 'escreva' @node(WRITE_STMT) '(' argumentos ')' ';' */
+    TOK_KW_ESCREVA, LL1_NODE(AST_WRITE_STMT), TOK_LPAREN, LL1_NT(14), TOK_RPAREN, TOK_SEMICOLON,
+    /*  27 comando -> 'retorne' @node(RETURN_STMT) retorno ';' */
+    TOK_KW_RETORNE, LL1_NODE(AST_RETURN_STMT), LL1_NT(15), TOK_SEMICOLON,
+    /*  28 comando -> bloco */
+    LL1_NT(7),
+    /*  29 senao -> 'senao' comando @add */
+    TOK_KW_SENAO, LL1_NT(5), LL1_ADD,
+    /*  30 senao -> */
+    /*  31 retorno -> expressao @add */
+    LL1_NT(13), LL1_ADD,
+    /*  32 retorno -> */
+    /*  33 declaracao -> tipo @node(DECLARATION) IDENT @node(IDENTIFIER) @add inicial variaveis */
+    LL1_NT(10), LL1_NODE(AST_DECLARATION), TOK_IDENTIFIER, LL1_NODE(AST_IDENTIFIER), LL1_ADD, LL1_NT(16), LL1_NT(17),
+    /*  34 inicial -> '=' expressao @add */
+    TOK_ASSIGN, LL1_NT(13), LL1_ADD,
+    /*  35 inicial -> '[' expressao @add ']' */
+    TOK_LBRACKET, LL1_NT(13), LL1_ADD, TOK_RBRACKET,
+    /*  36 inicial -> */
+    /*  37 variaveis -> ',' IDENT @node(IDENTIFIER) @add inicial variaveis */
+    TOK_COMMA, TOK_IDENTIFIER, LL1_NODE(AST_IDENTIFIER), LL1_ADD, LL1_NT(16), LL1_NT(17),
+    /*  38 variaveis -> */
+    /*  39 atribuicao -> IDENT @node(ASSIGNMENT) @node(IDENTIFIER) @add '=' expressao @add */
+    TOK_IDENTIFIER, LL1_NODE(AST_ASSIGNMENT), LL1_NODE(AST_IDENTIFIER), LL1_ADD, TOK_ASSIGN, LL1_NT(13), LL1_ADD,
+    /*  40 expressao -> conjuncao disjuncao_r */
+    LL1_NT(18), LL1_NT(19),
+    /*  41 disjuncao_r -> '||' @node(BINARY_OP) @wrap conjuncao @add disjuncao_r */
+    TOK_OR, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(18), LL1_ADD, LL1_NT(19),
+    /*  42 disjuncao_r -> */
+    /*  43 conjuncao -> igualdade conjuncao_r */
+    LL1_NT(20), LL1_NT(21),
+    /*  44 conjuncao_r -> '&&' @node(BINARY_OP) @wrap igualdade @add conjuncao_r */
+    TOK_AND, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(20), LL1_ADD, LL1_NT(21),
+    /*  45 conjuncao_r -> */
+    /*  46 igualdade -> relacional igualdade_r */
+    LL1_NT(22), LL1_NT(23),
+    /*  47 igualdade_r -> '==' @node(BINARY_OP) @wrap relacional @add igualdade_r */
+    TOK_EQ, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(22), LL1_ADD, LL1_NT(23),
+    /*  48 igualdade_r -> '<>' @node(BINARY_OP) @wrap relacional @add igualdade_r */
+    TOK_NEQ, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(22), LL1_ADD, LL1_NT(23),
+    /*  49 igualdade_r -> */
+    /*  50 relacional -> soma relacional_r */
+    LL1_NT(24), LL1_NT(25),
+    /*  51 relacional_r -> '>' @node(BINARY_OP) @wrap soma @add relacional_r */
+    TOK_GT, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(24), LL1_ADD, LL1_NT(25),
+    /*  52 relacional_r -> '>=' @node(BINARY_OP) @wrap soma @add relacional_r */
+    TOK_GE, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(24), LL1_ADD, LL1_NT(25),
+    /*  53 relacional_r -> '<' @node(BINARY_OP) @wrap soma @add relacional_r */
+    TOK_LT, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(24), LL1_ADD, LL1_NT(25),
+    /*  54 relacional_r -> '<=' @node(BINARY_OP) @wrap soma @add relacional_r */
+    TOK_LE, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(24), LL1_ADD, LL1_NT(25),
+    /*  55 relacional_r -> */
+    /*  56 soma -> termo soma_r */
+    LL1_NT(26), LL1_NT(27),
+    /*  57 soma_r -> '+' @node(BINARY_OP) @wrap termo @add soma_r */
+    TOK_PLUS, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(26), LL1_ADD, LL1_NT(27),
+    /*  58 soma_r -> '-' @node(BINARY_OP) @wrap termo @add soma_r */
+    TOK_MINUS, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(26), LL1_ADD, LL1_NT(27),
+    /*  59 soma_r -> */
+    /*  60 termo -> unario termo_r */
+    LL1_NT(28), LL1_NT(29),
+    /*  61 termo_r -> '*' @node(BINARY_OP) @wrap unario @add termo_r */
+    TOK_STAR, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(28), LL1_ADD, LL1_NT(29),
+    /*  62 termo_r -> '/' @node(BINARY_OP) @wrap unario @add termo_r */
+    TOK_SLASH, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(28), LL1_ADD, LL1_NT(29),
+    /*  63 termo_r -> '%' @node(BINARY_OP) @wrap unario @add termo_r */
+    TOK_MODULO, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(28), LL1_ADD, LL1_NT(29),
+    /*  64 termo_r -> '^' @node(BINARY_OP) @wrap unario @add termo_r */
+    TOK_CARET, LL1_NODE(AST_BINARY_OP), LL1_WRAP, LL1_NT(28), LL1_ADD, LL1_NT(29),
+    /*  65 termo_r -> */
+    /*  66 unario -> '-' @node(UNARY_OP) unario @add */
+    TOK_MINUS, LL1_NODE(AST_UNARY_OP), LL1_NT(28), LL1_ADD,
+    /*  67 unario -> '+' @node(UNARY_OP) unario @add */
+    TOK_PLUS, LL1_NODE(AST_UNARY_OP), LL1_NT(28), LL1_ADD,
+    /*  68 unario -> primario */
+    LL1_NT(30),
+    /*  69 primario -> INTEIRO @node(LITERAL) */
+    TOK_INTEGER_LITERAL, LL1_NODE(AST_LITERAL),
+    /*  70 primario -> DECIMAL @node(LITERAL) */
+    TOK_DECIMAL_LITERAL, LL1_NODE(AST_LITERAL),
+    /*  71 primario -> TEXTO @node(LITERAL) */
+    TOK_STRING_LITERAL, LL1_NODE(AST_LITERAL),
+    /*  72 primario -> '(' expressao ')' */
+    TOK_LPAREN, LL1_NT(13), TOK_RPAREN,
+    /*  73 primario -> IDENT @node(IDENTIFIER) chamada */
+    TOK_IDENTIFIER, LL1_NODE(AST_IDENTIFIER), LL1_NT(31),
+    /*  74 chamada -> '(' @node(FUNCTION_CALL) @wrap argumentos ')' */
+    TOK_LPAREN, LL1_NODE(AST_FUNCTION_CALL), LL1_WRAP, LL1_NT(14), TOK_RPAREN,
+    /*  75 chamada -> */
+    /*  76 argumentos -> expressao @add argumentos_r */
+    LL1_NT(13), LL1_ADD, LL1_NT(32),
+    /*  77 argumentos -> */
+    /*  78 argumentos_r -> ',' expressao @add argumentos_r */
+    TOK_COMMA, LL1_NT(13), LL1_ADD, LL1_NT(32),
+    /*  79 argumentos_r -> */
+    0
+};
+
+static const unsigned short ll1_rhs_start[LL1_PRODUCTIONS + 1] = {
+    0, 6, 9, 12, 12, 15, 15, 16, 24, 25, 36, 37, 37, 39, 39, 40,
+    41, 42, 46, 49, 49, 51, 53, 62, 70, 84, 92, 98, 102, 103, 106, 106,
+    108, 108, 115, 118, 122, 122, 128, 128, 135, 137, 143, 143, 145, 151, 151, 153,
+    159, 165, 165, 167, 173, 179, 185, 191, 191, 193, 199, 205, 205, 207, 213, 219,
+    225, 231, 231, 235, 239, 240, 242, 244, 246, 249, 252, 257, 257, 260, 260, 264,
+    264
+};
+
+static const unsigned char ll1_table[LL1_NONTERMINALS][TOK_ERROR + 1] = {
+    /* programa */ {[TOK_IDENTIFIER] = 3, [TOK_KW_INTEIRO] = 3, [TOK_KW_DECIMAL] = 3, [TOK_KW_TEXTO] = 3, [TOK_KW_SE] = 3, [TOK_KW_ENQUANTO] = 3, [TOK_KW_PARA] = 3, [TOK_KW_RETORNE] = 3, [TOK_KW_PRINCIPAL] = 1, [TOK_KW_FUNCAO] = 2, [TOK_KW_LEIA] = 3, [TOK_KW_ESCREVA] = 3, [TOK_LBRACE] = 3},
+    /* senao */ {[TOK_KW_SENAO] = 30},
+    /* comandos */ {[TOK_IDENTIFIER] = 19, [TOK_KW_INTEIRO] = 19, [TOK_KW_DECIMAL] = 19, [TOK_KW_TEXTO] = 19, [TOK_KW_SE] = 19, [TOK_KW_ENQUANTO] = 19, [TOK_KW_PARA] = 19, [TOK_KW_RETORNE] = 19, [TOK_KW_LEIA] = 19, [TOK_KW_ESCREVA] = 19, [TOK_LBRACE] = 19},
+    /* definicao */ {[TOK_KW_FUNCAO] = 10},
+    /* itens */ {[TOK_IDENTIFIER] = 5, [TOK_KW_INTEIRO] = 5, [TOK_KW_DECIMAL] = 5, [TOK_KW_TEXTO] = 5, [TOK_KW_SE] = 5, [TOK_KW_ENQUANTO] = 5, [TOK_KW_PARA] = 5, [TOK_KW_RETORNE] = 5, [TOK_KW_PRINCIPAL] = 5, [TOK_KW_FUNCAO] = 5, [TOK_KW_LEIA] = 5, [TOK_KW_ESCREVA] = 5, [TOK_LBRACE] = 5},
+    /* comando */ {[TOK_IDENTIFIER] = 22, [TOK_KW_INTEIRO] = 21, [TOK_KW_DECIMAL] = 21, [TOK_KW_TEXTO] = 21, [TOK_KW_SE] = 23, [TOK_KW_ENQUANTO] = 24, [TOK_KW_PARA] = 25, [TOK_KW_RETORNE] = 28, [TOK_KW_LEIA] = 26, [TOK_KW_ESCREVA] = 27, [TOK_LBRACE] = 29},
+    /* item */ {[TOK_IDENTIFIER] = 9, [TOK_KW_INTEIRO] = 9, [TOK_KW_DECIMAL] = 9, [TOK_KW_TEXTO] = 9, [TOK_KW_SE] = 9, [TOK_KW_ENQUANTO] = 9, [TOK_KW_PARA] = 9, [TOK_KW_RETORNE] = 9, [TOK_KW_PRINCIPAL] = 8, [TOK_KW_FUNCAO] = 7, [TOK_KW_LEIA] = 9, [TOK_KW_ESCREVA] = 9, [TOK_LBRACE] = 9},
+    /* bloco */ {[TOK_LBRACE] = 18},
+    /* tipo_retorno */ {[TOK_KW_INTEIRO] = 11, [TOK_KW_DECIMAL] = 11, [TOK_KW_TEXTO] = 11},
+    /* parametros */ {[TOK_KW_INTEIRO] = 13, [TOK_KW_DECIMAL] = 13, [TOK_KW_TEXTO] = 13},
+    /* tipo */ {[TOK_KW_INTEIRO] = 15, [TOK_KW_DECIMAL] = 16, [TOK_KW_TEXTO] = 17},
+    /* declaracao */ {[TOK_KW_INTEIRO] = 34, [TOK_KW_DECIMAL] = 34, [TOK_KW_TEXTO] = 34},
+    /* atribuicao */ {[TOK_IDENTIFIER] = 40},
+    /* expressao */ {[TOK_IDENTIFIER] = 41, [TOK_INTEGER_LITERAL] = 41, [TOK_DECIMAL_LITERAL] = 41, [TOK_STRING_LITERAL] = 41, [TOK_PLUS] = 41, [TOK_MINUS] = 41, [TOK_LPAREN] = 41},
+    /* argumentos */ {[TOK_IDENTIFIER] = 77, [TOK_INTEGER_LITERAL] = 77, [TOK_DECIMAL_LITERAL] = 77, [TOK_STRING_LITERAL] = 77, [TOK_PLUS] = 77, [TOK_MINUS] = 77, [TOK_LPAREN] = 77},
+    /* retorno */ {[TOK_IDENTIFIER] = 32, [TOK_INTEGER_LITERAL] = 32, [TOK_DECIMAL_LITERAL] = 32, [TOK_STRING_LITERAL] = 32, [TOK_PLUS] = 32, [TOK_MINUS] = 32, [TOK_LPAREN] = 32},
+    /* inicial */ {[TOK_ASSIGN] = 35, [TOK_LBRACKET] = 36},
+    /* variaveis */ {[TOK_COMMA] = 38},
+    /* conjuncao */ {[TOK_IDENTIFIER] = 44, [TOK_INTEGER_LITERAL] = 44, [TOK_DECIMAL_LITERAL] = 44, [TOK_STRING_LITERAL] = 44, [TOK_PLUS] = 44, [TOK_MINUS] = 44, [TOK_LPAREN] = 44},
+    /* disjuncao_r */ {[TOK_OR] = 42},
+    /* igualdade */ {[TOK_IDENTIFIER] = 47, [TOK_INTEGER_LITERAL] = 47, [TOK_DECIMAL_LITERAL] = 47, [TOK_STRING_LITERAL] = 47, [TOK_PLUS] = 47, [TOK_MINUS] = 47, [TOK_LPAREN] = 47},
+    /* conjuncao_r */ {[TOK_AND] = 45},
+    /* relacional */ {[TOK_IDENTIFIER] = 51, [TOK_INTEGER_LITERAL] = 51, [TOK_DECIMAL_LITERAL] = 51, [TOK_STRING_LITERAL] = 51, [TOK_PLUS] = 51, [TOK_MINUS] = 51, [TOK_LPAREN] = 51},
+    /* igualdade_r */ {[TOK_EQ] = 48, [TOK_NEQ] = 49},
+    /* soma */ {[TOK_IDENTIFIER] = 57, [TOK_INTEGER_LITERAL] = 57, [TOK_DECIMAL_LITERAL] = 57, [TOK_STRING_LITERAL] = 57, [TOK_PLUS] = 57, [TOK_MINUS] = 57, [TOK_LPAREN] = 57},
+    /* relacional_r */ {[TOK_LT] = 54, [TOK_GT] = 52, [TOK_LE] = 55, [TOK_GE] = 53},
+    /* termo */ {[TOK_IDENTIFIER] = 61, [TOK_INTEGER_LITERAL] = 61, [TOK_DECIMAL_LITERAL] = 61, [TOK_STRING_LITERAL] = 61, [TOK_PLUS] = 61, [TOK_MINUS] = 61, [TOK_LPAREN] = 61},
+    /* soma_r */ {[TOK_PLUS] = 58, [TOK_MINUS] = 59},
+    /* unario */ {[TOK_IDENTIFIER] = 69, [TOK_INTEGER_LITERAL] = 69, [TOK_DECIMAL_LITERAL] = 69, [TOK_STRING_LITERAL] = 69, [TOK_PLUS] = 68, [TOK_MINUS] = 67, [TOK_LPAREN] = 69},
+    /* termo_r */ {[TOK_STAR] = 62, [TOK_SLASH] = 63, [TOK_MODULO] = 64, [TOK_CARET] = 65},
+    /* primario */ {[TOK_IDENTIFIER] = 74, [TOK_INTEGER_LITERAL] = 70, [TOK_DECIMAL_LITERAL] = 71, [TOK_STRING_LITERAL] = 72, [TOK_LPAREN] = 73},
+    /* chamada */ {[TOK_LPAREN] = 75},
+    /* argumentos_r */ {[TOK_COMMA] = 79},
+};
+
+static const unsigned char ll1_empty[LL1_NONTERMINALS] = {
+    4, 31, 20, 0, 6, 0, 0, 0, 12, 14, 0, 0, 0, 0, 78, 33,
+    37, 39, 0, 43, 0, 46, 0, 50, 0, 56, 0, 60, 0, 66, 0, 76,
+    80
+};
+
+static const char *const ll1_expected[LL1_NONTERMINALS] = {
+    "programa",
+    "senao",
+    "comandos",
+    "definicao",
+    "itens",
+    "comando",
+    "item",
+    "'{'",
+    "tipo_retorno",
+    "parametros",
+    "tipo de variável (inteiro, decimal, texto)",
+    "declaracao",
+    "atribuição",
+    "expressão",
+    "argumentos",
+    "retorno",
+    "inicial",
+    "variaveis",
+    "conjuncao",
+    "disjuncao_r",
+    "igualdade",
+    "conjuncao_r",
+    "relacional",
+    "igualdade_r",
+    "soma",
+    "relacional_r",
+    "termo",
+    "soma_r",
+    "expressão",
+    "termo_r",
+    "expressão",
+    "chamada",
+    "argumentos_r",
+};
+
+static const char *const ll1_terminal[TOK_ERROR + 1] = {
+    [TOK_EOF] = "fim do arquivo",
+    [TOK_IDENTIFIER] = "identificador",
+    [TOK_INTEGER_LITERAL] = "literal inteiro",
+    [TOK_DECIMAL_LITERAL] = "literal decimal",
+    [TOK_STRING_LITERAL] = "literal de texto",
+    [TOK_KW_INTEIRO] = "'inteiro'",
+    [TOK_KW_DECIMAL] = "'decimal'",
+    [TOK_KW_TEXTO] = "'texto'",
+    [TOK_KW_SE] = "'se'",
+    [TOK_KW_SENAO] = "'senao'",
+    [TOK_KW_ENQUANTO] = "'enquanto'",
+    [TOK_KW_PARA] = "'para'",
+    [TOK_KW_RETORNE] = "'retorne'",
+    [TOK_KW_PRINCIPAL] = "'principal'",
+    [TOK_KW_FUNCAO] = "'funcao'",
+    [TOK_KW_LEIA] = "'leia'",
+    [TOK_KW_ESCREVA] = "'escreva'",
+    [TOK_PLUS] = "'+'",
+    [TOK_MINUS] = "'-'",
+    [TOK_STAR] = "'*'",
+    [TOK_SLASH] = "'/'",
+    [TOK_MODULO] = "'%'",
+    [TOK_CARET] = "'^'",
+    [TOK_EQ] = "'=='",
+    [TOK_NEQ] = "'<>'",
+    [TOK_LT] = "'<'",
+    [TOK_GT] = "'>'",
+    [TOK_LE] = "'<='",
+    [TOK_GE] = "'>='",
+    [TOK_AND] = "'&&'",
+    [TOK_OR] = "'||'",
+    [TOK_ASSIGN] = "'='",
+    [TOK_LPAREN] = "'('",
+    [TOK_RPAREN] = "')'",
+    [TOK_LBRACE] = "'{'",
+    [TOK_RBRACE] = "'}'",
+    [TOK_LBRACKET] = "'['",
+    [TOK_RBRACKET] = "']'",
+    [TOK_SEMICOLON] = "';'",
+    [TOK_COMMA] = "','",
+};
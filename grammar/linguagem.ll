@@ -0,0 +1,256 @@
+# Gramática LL(1) da linguagem, lida por tools/ll1gen na compilação para
+# gerar as tabelas do analisador dirigido por tabela (src/ll1.c).
+#
+#   %token <nome> <TokenType> ["descrição"]   terminal; 'x' é escrito entre aspas
+#   %start <não-terminal>
+#   %greedy <não-terminal>   conflito FIRST/FOLLOW resolvido pela alternativa
+#                            não vazia (o 'senao' fica com o 'se' mais interno)
+#   nome ["descrição"] : alternativa | alternativa ;
+#
+# As ações constroem a AST em uma pilha de valores, na mesma forma dos
+# parse_* de src/parser.c:
+#   @node(TIPO)  empilha um nó AST_TIPO com o token recém-consumido
+#   @add         desempilha o topo e o acrescenta como filho do novo topo
+#   @wrap        desempilha o topo e põe nele, como primeiro filho, o valor
+#                de baixo (operando esquerdo, nome da função chamada)
+# O nó AST_PROGRAM é criado pelo motor antes de começar, com o primeiro token.
+# Os operadores binários são associativos à esquerda: a repetição fica em uma
+# cauda (..._r) que aplica @wrap ao resultado acumulado.
+
+%token IDENT      TOK_IDENTIFIER      "identificador"
+%token INTEIRO    TOK_INTEGER_LITERAL "literal inteiro"
+%token DECIMAL    TOK_DECIMAL_LITERAL "literal decimal"
+%token TEXTO      TOK_STRING_LITERAL  "literal de texto"
+
+%token 'inteiro'   TOK_KW_INTEIRO
+%token 'decimal'   TOK_KW_DECIMAL
+%token 'texto'     TOK_KW_TEXTO
+%token 'se'        TOK_KW_SE
+%token 'senao'     TOK_KW_SENAO
+%token 'enquanto'  TOK_KW_ENQUANTO
+%token 'para'      TOK_KW_PARA
+%token 'retorne'   TOK_KW_RETORNE
+%token 'principal' TOK_KW_PRINCIPAL
+%token 'funcao'    TOK_KW_FUNCAO
+%token 'leia'      TOK_KW_LEIA
+%token 'escreva'   TOK_KW_ESCREVA
+
+%token '+'  TOK_PLUS
+%token '-'  TOK_MINUS
+%token '*'  TOK_STAR
+%token '/'  TOK_SLASH
+%token '%'  TOK_MODULO
+%token '^'  TOK_CARET
+%token '==' TOK_EQ
+%token '<>' TOK_NEQ
+%token '<'  TOK_LT
+%token '>'  TOK_GT
+%token '<=' TOK_LE
+%token '>=' TOK_GE
+%token '&&' TOK_AND
+%token '||' TOK_OR
+%token '='  TOK_ASSIGN
+%token '('  TOK_LPAREN
+%token ')'  TOK_RPAREN
+%token '{'  TOK_LBRACE
+%token '}'  TOK_RBRACE
+%token '['  TOK_LBRACKET
+%token ']'  TOK_RBRACKET
+%token ';'  TOK_SEMICOLON
+%token ','  TOK_COMMA
+
+%start programa
+%greedy senao
+
+# ---------- Programa ----------
+
+# Arquivo iniciado por 'principal': os comandos do bloco são os itens do
+# programa e o que vier depois da '}' final é ignorado. Nos demais, funções,
+# 'principal() {...}' (como FUNCTION_DEF) e comandos até o fim do arquivo.
+programa "programa"
+    : 'principal' '(' ')' '{' comandos '}'
+    | definicao @add itens
+    | comando @add itens
+    |
+    ;
+
+itens
+    : item @add itens
+    |
+    ;
+
+item
+    : definicao
+    | 'principal' @node(FUNCTION_DEF) @node(IDENTIFIER) @add '(' ')' bloco @add
+    | comando
+    ;
+
+definicao
+    : 'funcao' @node(FUNCTION_DEF) tipo_retorno IDENT @node(IDENTIFIER) @add
+      '(' parametros ')' bloco @add
+    ;
+
+tipo_retorno
+    : tipo
+    |
+    ;
+
+# Uma declaração já consome as vírgulas seguintes ('inteiro !a, !b')
+parametros
+    : declaracao @add
+    |
+    ;
+
+tipo "tipo de variável (inteiro, decimal, texto)"
+    : 'inteiro'
+    | 'decimal'
+    | 'texto'
+    ;
+
+# ---------- Comandos ----------
+
+bloco "'{'"
+    : '{' @node(BLOCK) comandos '}'
+    ;
+
+comandos
+    : comando @add comandos
+    |
+    ;
+
+comando "comando"
+    : declaracao ';'
+    | atribuicao ';'
+    | 'se' @node(IF_STMT) '(' expressao @add ')' comando @add senao
+    | 'enquanto' @node(WHILE_STMT) '(' expressao @add ')' comando @add
+    | 'para' @node(FOR_STMT) '(' atribuicao @add ';' expressao @add ';'
+      atribuicao @add ')' comando @add
+    | 'leia' @node(READ_STMT) '(' IDENT @node(IDENTIFIER) @add ')' ';'
+    | 'escreva' @node(WRITE_STMT) '(' argumentos ')' ';'
+    | 'retorne' @node(RETURN_STMT) retorno ';'
+    | bloco
+    ;
+
+senao
+    : 'senao' comando @add
+    |
+    ;
+
+retorno
+    : expressao @add
+    |
+    ;
+
+declaracao
+    : tipo @node(DECLARATION) IDENT @node(IDENTIFIER) @add inicial variaveis
+    ;
+
+inicial
+    : '=' expressao @add
+    | '[' expressao @add ']'
+    |
+    ;
+
+variaveis
+    : ',' IDENT @node(IDENTIFIER) @add inicial variaveis
+    |
+    ;
+
+atribuicao "atribuição"
+    : IDENT @node(ASSIGNMENT) @node(IDENTIFIER) @add '=' expressao @add
+    ;
+
+# ---------- Expressões (precedência crescente) ----------
+
+expressao "expressão"
+    : conjuncao disjuncao_r
+    ;
+
+disjuncao_r
+    : '||' @node(BINARY_OP) @wrap conjuncao @add disjuncao_r
+    |
+    ;
+
+conjuncao
+    : igualdade conjuncao_r
+    ;
+
+conjuncao_r
+    : '&&' @node(BINARY_OP) @wrap igualdade @add conjuncao_r
+    |
+    ;
+
+igualdade
+    : relacional igualdade_r
+    ;
+
+igualdade_r
+    : '==' @node(BINARY_OP) @wrap relacional @add igualdade_r
+    | '<>' @node(BINARY_OP) @wrap relacional @add igualdade_r
+    |
+    ;
+
+relacional
+    : soma relacional_r
+    ;
+
+relacional_r
+    : '>'  @node(BINARY_OP) @wrap soma @add relacional_r
+    | '>=' @node(BINARY_OP) @wrap soma @add relacional_r
+    | '<'  @node(BINARY_OP) @wrap soma @add relacional_r
+    | '<=' @node(BINARY_OP) @wrap soma @add relacional_r
+    |
+    ;
+
+soma
+    : termo soma_r
+    ;
+
+soma_r
+    : '+' @node(BINARY_OP) @wrap termo @add soma_r
+    | '-' @node(BINARY_OP) @wrap termo @add soma_r
+    |
+    ;
+
+termo
+    : unario termo_r
+    ;
+
+termo_r
+    : '*' @node(BINARY_OP) @wrap unario @add termo_r
+    | '/' @node(BINARY_OP) @wrap unario @add termo_r
+    | '%' @node(BINARY_OP) @wrap unario @add termo_r
+    | '^' @node(BINARY_OP) @wrap unario @add termo_r
+    |
+    ;
+
+# O unário tem precedência maior que qualquer binário: '-!a ^ 2' é (-!a) ^ 2
+unario "expressão"
+    : '-' @node(UNARY_OP) unario @add
+    | '+' @node(UNARY_OP) unario @add
+    | primario
+    ;
+
+primario "expressão"
+    : INTEIRO @node(LITERAL)
+    | DECIMAL @node(LITERAL)
+    | TEXTO @node(LITERAL)
+    | '(' expressao ')'
+    | IDENT @node(IDENTIFIER) chamada
+    ;
+
+# O nó FUNCTION_CALL leva o token '('
+chamada
+    : '(' @node(FUNCTION_CALL) @wrap argumentos ')'
+    |
+    ;
+
+argumentos
+    : expressao @add argumentos_r
+    |
+    ;
+
+argumentos_r
+    : ',' expressao @add argumentos_r
+    |
+    ;
@@ -0,0 +1,80 @@
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "output.h"
+#include "parser.h"
+
+/*
+ * Formato binário da AST (arquivo .ast):
+ *
+ *   AstBinHeader
+ *   AstBinNode[node_count]   nós em largura: a raiz é o nó 0 e os filhos de
+ *                            cada nó são contíguos (first_child..+child_count)
+ *   char[string_size]        lexemas e valores terminados em '\0', sem repetição
+ *
+ * Todos os campos têm 32 bits, na ordem de bytes da máquina que gravou
+ * (conferida por byte_order). O carregador mapeia o arquivo com mmap e o usa
+ * no lugar, sem alocar nada por nó.
+ */
+
+#define AST_BIN_MAGIC      "ASTB"
+#define AST_BIN_VERSION    1
+#define AST_BIN_BYTE_ORDER 0x01020304u
+#define AST_BIN_NONE       0xFFFFFFFFu   /* string ausente */
+
+typedef struct {
+    char magic[4];              /* AST_BIN_MAGIC */
+    uint32_t version;           /* AST_BIN_VERSION */
+    uint32_t byte_order;        /* AST_BIN_BYTE_ORDER */
+    uint32_t node_size;         /* sizeof(AstBinNode) */
+    uint32_t node_count;
+    uint32_t string_size;
+} AstBinHeader;
+
+typedef struct {
+    uint32_t type;              /* ASTNodeType */
+    uint32_t token_type;        /* TokenType */
+    int32_t line;
+    int32_t offset;
+    int32_t length;
+    uint32_t lexeme;            /* posição na tabela de strings */
+    uint32_t value;             /* idem, ou AST_BIN_NONE */
+    uint32_t first_child;       /* índice do primeiro filho */
+    uint32_t child_count;
+    uint32_t type_kind;         /* tipo inferido por extenso: TypeId só vale no processo */
+    int32_t type_a;             /* decimal: precisão; texto: tamanho */
+    int32_t type_b;             /* decimal: escala */
+} AstBinNode;
+
+/* Arquivo .ast mapeado em memória */
+typedef struct {
+    void *map;
+    size_t size;
+    const AstBinHeader *header;
+    const AstBinNode *nodes;
+    const char *strings;
+} AstFile;
+
+/* Grava a árvore; retorna 1 em caso de sucesso (erros vão para stderr) */
+int ast_binary_write(ASTNode *root, const char *path);
+/* Escreve a imagem do arquivo no sink (e o descarrega); retorna 1 se tudo
+ * foi escrito */
+int ast_binary_emit(ASTNode *root, OutSink *out);
+
+/* Mapeia e valida o arquivo; retorna 1 em caso de sucesso */
+int ast_file_open(AstFile *file, const char *path);
+void ast_file_close(AstFile *file);
+
+const AstBinNode* ast_file_root(const AstFile *file);
+const AstBinNode* ast_file_child(const AstFile *file, const AstBinNode *node, uint32_t index);
+const char* ast_file_lexeme(const AstFile *file, const AstBinNode *node);
+const char* ast_file_value(const AstFile *file, const AstBinNode *node);
+Type ast_file_type(const AstBinNode *node);
+
+/* Reconstrói uma AST comum (mm_malloc por nó); os lexemas apontam para o
+ * arquivo, que deve continuar aberto enquanto a árvore for usada */
+ASTNode* ast_file_to_tree(const AstFile *file);
+
+#endif /* AST_BINARY_H */
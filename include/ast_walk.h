@@ -0,0 +1,58 @@
+#ifndef AST_WALK_H
+#define AST_WALK_H
+
+#include "parser.h"
+
+/* Resultado da callback de pré-ordem */
+typedef enum {
+    AST_WALK_CONTINUE,      /* visita os filhos do nó */
+    AST_WALK_SKIP           /* não desce nos filhos (a pós-ordem ainda ocorre) */
+} AstWalkAction;
+
+/* Quadro da pilha explícita de visita */
+typedef struct {
+    ASTNode *node;          /* nó visitado */
+    int next_child;         /* próximo filho a visitar */
+    int tag;                /* valor livre herdado pelos filhos */
+} AstWalkFrame;
+
+#define AST_WALK_INLINE_FRAMES 32
+
+struct AstWalker;
+
+typedef AstWalkAction (*AstPreFn)(struct AstWalker *w, ASTNode *node, void *data);
+typedef void (*AstPostFn)(struct AstWalker *w, ASTNode *node, void *data);
+
+/* Callbacks de um percurso; qualquer uma pode ser NULL */
+typedef struct {
+    AstPreFn pre;
+    AstPostFn post;
+    void *data;
+    int root_tag;           /* tag vista como "do pai" pela raiz */
+    unsigned long prune;    /* máscara de ASTNodeType cujos filhos não são visitados */
+} AstVisitor;
+
+#define AST_WALK_MASK(type) (1UL << (type))
+
+/* Estado do percurso: pilha em heap, com quadros embutidos para árvores rasas */
+typedef struct AstWalker {
+    const AstVisitor *visitor;
+    AstWalkFrame *frames;
+    int depth;
+    int capacity;
+    AstWalkFrame inline_frames[AST_WALK_INLINE_FRAMES];
+} AstWalker;
+
+/* Percorre a árvore em profundidade sem recursão em C */
+void ast_walk(ASTNode *root, const AstVisitor *visitor);
+
+/* Consultas válidas dentro das callbacks (referem-se ao nó corrente) */
+int ast_walk_depth(AstWalker *w);
+ASTNode* ast_walk_parent(AstWalker *w);
+int ast_walk_child_index(AstWalker *w);
+int ast_walk_parent_tag(AstWalker *w);
+int ast_walk_tag(AstWalker *w);
+void ast_walk_set_tag(AstWalker *w, int tag);
+void ast_walk_skip_to_child(AstWalker *w, int index);
+
+#endif /* AST_WALK_H */
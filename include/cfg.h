@@ -0,0 +1,71 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Grafo de fluxo de controle de um corpo de função, no nível das variáveis:
+ * cada bloco básico guarda, na ordem de execução, os eventos das variáveis
+ * locais e dos parâmetros da função (leituras e atribuições). As globais
+ * ficam de fora, pois uma chamada pode lê-las ou alterá-las. Como na
+ * análise semântica, a função tem um único escopo: um nome é a variável
+ * local já declarada com ele (a primeira declaração vale), ou não é
+ * rastreado.
+ *
+ * O bloco 0 é a entrada (com as atribuições dos parâmetros) e o último é a
+ * saída, sem eventos, a que chegam os 'retorne' e o fim do corpo. O código
+ * depois de um 'retorne' fica em blocos sem predecessores.
+ *
+ * O grafo e os conjuntos de dataflow.h são temporários, de uma função por
+ * vez, e alocados com memmgr.h como o resto da análise: entram no pico
+ * informado e no limite de memória.
+ */
+
+typedef enum {
+    CFG_USE,                        /* leitura */
+    CFG_PARAM,                      /* valor do parâmetro, na entrada */
+    CFG_INIT,                       /* inicialização na declaração */
+    CFG_ASSIGN,                     /* atribuição, inclusive as de 'para' */
+    CFG_READ                        /* 'leia' */
+} CfgEventKind;
+
+typedef struct {
+    int var;
+    int kind;                       /* CfgEventKind */
+    int line;
+} CfgEvent;
+
+typedef struct {
+    const char *name;
+    int line;                       /* da declaração */
+    int param;
+} CfgVar;
+
+typedef struct {
+    int first, count;               /* eventos */
+    int succ_first, succ_count;     /* em succs */
+    int pred_first, pred_count;     /* em preds */
+} CfgBlock;
+
+typedef struct {
+    const char *name;
+    int line;
+    CfgVar *vars;
+    int var_count;
+    CfgEvent *events;
+    int event_count;
+    CfgBlock *blocks;
+    int block_count;
+    int *succs, *preds;
+    int edge_count;
+} Cfg;
+
+/* Grafo de um AST_FUNCTION_DEF, ou do programa 'principal() { ... }'
+ * inteiro; source (len bytes) é o texto de onde a AST veio */
+Cfg* cfg_build(ASTNode *func, const char *source, size_t len);
+void cfg_free(Cfg *g);
+/* Bytes dos vetores do grafo */
+size_t cfg_size(const Cfg *g);
+
+#endif /* CFG_H */
@@ -0,0 +1,88 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <limits.h>
+#include <stddef.h>
+#include "cfg.h"
+
+/*
+ * Análise de fluxo de dados sobre o grafo de cfg.h. Os conjuntos são
+ * vetores de bits densos, um por bloco (não por nó da AST), operados uma
+ * palavra por vez; os de todos os blocos ficam num único vetor, words
+ * palavras por bloco. O resolvedor é iterativo com lista de trabalho
+ * ordenada pela pós-ordem reversa (para a frente) ou pela pós-ordem (para
+ * trás): sai sempre o primeiro bloco pendente nessa ordem, e um bloco só
+ * volta à lista quando a entrada de um vizinho muda.
+ */
+
+typedef unsigned long BitWord;
+
+#define BITWORD_BITS ((int)(sizeof(BitWord) * CHAR_BIT))
+#define BITSET_WORDS(bits) (((bits) + BITWORD_BITS - 1) / BITWORD_BITS)
+#define BITSET_TEST(set, i) (((set)[(i) / BITWORD_BITS] >> ((i) % BITWORD_BITS)) & 1UL)
+#define BITSET_SET(set, i) ((set)[(i) / BITWORD_BITS] |= 1UL << ((i) % BITWORD_BITS))
+#define BITSET_CLEAR(set, i) ((set)[(i) / BITWORD_BITS] &= ~(1UL << ((i) % BITWORD_BITS)))
+
+typedef enum {
+    DATAFLOW_FORWARD,               /* da entrada para a saída */
+    DATAFLOW_BACKWARD
+} DataflowDirection;
+
+typedef enum {
+    DATAFLOW_UNION,                 /* em algum caminho */
+    DATAFLOW_INTERSECTION           /* em todos os caminhos */
+} DataflowMeet;
+
+/* Um problema: saída = gen | (entrada & ~kill), no sentido da análise */
+typedef struct {
+    DataflowDirection direction;
+    DataflowMeet meet;
+    int bits;
+    const BitWord *gen, *kill;      /* words palavras por bloco */
+    const BitWord *boundary;        /* na entrada da função (ou na saída, para
+                                     * trás); NULL: vazio */
+} DataflowProblem;
+
+/* in e out no sentido do programa: in[b] na entrada do bloco b */
+typedef struct {
+    int words;
+    BitWord *in, *out;
+    unsigned long visits;           /* blocos processados até o ponto fixo */
+} DataflowSolution;
+
+void dataflow_solve(const Cfg *g, const DataflowProblem *p, DataflowSolution *s);
+void dataflow_free(DataflowSolution *s);
+
+/* Variáveis vivas (lidas adiante antes de nova atribuição), por variável */
+void dataflow_liveness(const Cfg *g, DataflowSolution *s);
+/* Variáveis atribuídas em todos os caminhos desde a entrada */
+void dataflow_definite_assignment(const Cfg *g, DataflowSolution *s);
+
+/* Definições que alcançam cada bloco; uma definição é um evento de
+ * atribuição (CFG_PARAM, CFG_INIT, CFG_ASSIGN ou CFG_READ) */
+typedef struct {
+    DataflowSolution solution;      /* bits: as definições */
+    int def_count;
+    int *def_event;                 /* evento de cada definição */
+    int *var_first, *var_defs;      /* definições da variável v:
+                                     * var_defs[var_first[v] .. var_first[v + 1]) */
+} ReachingDefs;
+
+void dataflow_reaching_definitions(const Cfg *g, ReachingDefs *r);
+void dataflow_reaching_free(ReachingDefs *r);
+
+/* Diagnósticos de uso de variáveis de um grafo */
+typedef struct {
+    unsigned long uninitialized;    /* lidas sem nenhuma atribuição que alcance */
+    unsigned long maybe;            /* lidas sem atribuição em algum caminho */
+    unsigned long dead_stores;      /* valores atribuídos nunca lidos */
+    unsigned long unread;           /* variáveis e parâmetros nunca lidos */
+} VarUsageStats;
+
+/* Imprime os alertas de uso das variáveis, em ordem de linha, e os soma em
+ * stats: leitura antes de atribuição (cada variável uma vez), atribuição
+ * cujo valor não é lido adiante em nenhum caminho, e variável ou
+ * parâmetro nunca lido. O código inalcançável não gera alertas. */
+void dataflow_check_usage(const Cfg *g, VarUsageStats *stats);
+
+#endif /* DATAFLOW_H */
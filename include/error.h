@@ -1,7 +1,19 @@
 #ifndef ERROR_H
 #define ERROR_H
 #include <stdarg.h>
+#include <setjmp.h>
 
 void lex_error(int line, const char *fmt, ...);
 
+/* Com um ponto de recuperação definido, lex_error faz longjmp em vez de
+ * encerrar o processo (usado por quem analisa trechos sob demanda).
+ * NULL restaura o comportamento padrão. */
+void lex_error_set_recovery(jmp_buf *env);
+
+/* Em modo silencioso (só com recuperação) o erro não é impresso; a última
+ * mensagem fica em lex_error_message(), para quem decide depois se ela vale
+ * (push_parser.c: um token cortado pelo fim do pedaço não é erro). */
+void lex_error_set_quiet(int quiet);
+const char* lex_error_message(void);
+
 #endif /* ERROR_H */
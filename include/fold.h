@@ -0,0 +1,64 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Dobramento e propagação de constantes, depois da análise semântica: os
+ * nós AST_BINARY_OP e AST_UNARY_OP cujos operandos são literais inteiros ou
+ * decimais viram um AST_LITERAL com o resultado, no lugar (o tipo inferido
+ * passa a ser o do literal).
+ *
+ * A aritmética é exata. Um inteiro tem 4 bytes: uma operação cujo
+ * resultado não cabe não é dobrada. Um decimal é um inteiro escalado, e o
+ * resultado segue as regras de decimal[a.b] dos literais (b casas depois do
+ * ponto): + e - ficam com a maior escala, * com a soma das escalas, / e %
+ * com a maior, e uma divisão que não é exata nessa escala não é dobrada.
+ * '^' só é dobrado com expoente inteiro não negativo, multiplicando (com
+ * base decimal, a escala vezes o expoente; um decimal de escala 0 sai como
+ * "1.0"). Comparações, && e || não são dobrados na AST, que não tem literal
+ * booleano; fold_binary os dobra (1 ou 0, tipo booleano) para a IR.
+ *
+ * Uma divisão (ou resto) cujo divisor é o zero constante gera o alerta
+ * "divisão por zero em expressão constante" e fica como está.
+ *
+ * Propagação: uma variável inteira ou decimal (sem colchetes, ou decimal
+ * com formato em que o valor cabe) atribuída uma única vez, contando a
+ * inicialização, que não é parâmetro nem aparece em 'leia', tem o valor
+ * constante levado aos usos que a atribuição domina: os comandos seguintes
+ * do mesmo bloco, em qualquer profundidade. Uma global só com a
+ * inicialização na declaração, e só se nenhuma função a atribui. Dentro de
+ * subárvores compartilhadas (--hash-cons) nada é propagado, pois o mesmo
+ * nó aparece em pontos diferentes.
+ *
+ * source (len bytes) é o texto de onde a AST veio (ast_declarator_arg).
+ */
+
+/* Valor constante: inteiro, booleano, ou decimal m / 10^scale */
+typedef struct {
+    TypeKind kind;
+    long m;
+    int scale;
+} FoldValue;
+
+typedef struct {
+    unsigned long folded;       /* operações substituídas pelo resultado */
+    unsigned long propagated;   /* usos substituídos pelo valor da variável */
+    unsigned long constants;    /* variáveis com valor propagado */
+    unsigned long div_zero;     /* divisões por zero constantes */
+} FoldStats;
+
+void fold_constants(ASTNode *program, const char *source, size_t len, FoldStats *stats);
+
+/* A aritmética do dobramento, também usada pela propagação de constantes da
+ * IR (ir.h). fold_binary e fold_unary retornam 1 com o resultado em *r, ou
+ * 0 se a operação não é dobrada (inclusive a divisão por zero). */
+int fold_binary(TokenType op, const FoldValue *x, const FoldValue *y, FoldValue *r);
+int fold_unary(TokenType op, const FoldValue *x, FoldValue *r);
+/* Valor de um AST_LITERAL inteiro ou decimal; 0 se não é um, ou não cabe */
+int fold_literal(const ASTNode *literal, FoldValue *v);
+/* Texto do valor (mm_malloc) e o seu tipo, decimal[a.b] como nos literais */
+char* fold_value_text(const FoldValue *v, TypeId *type);
+
+#endif /* FOLD_H */
@@ -0,0 +1,85 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stddef.h>
+#include "parser.h"
+#include "token.h"
+
+/*
+ * Layout estático dos quadros de pilha, depois da análise semântica: cada
+ * função recebe offsets para os parâmetros, as variáveis locais e os
+ * vetores (inteiro !v[10]), com os tamanhos de symtab.c (inteiro=4B,
+ * decimal=8B, texto[n]=nB).
+ *
+ * Os blocos de uma função ({ ... }) formam regiões aninhadas: uma variável
+ * declarada num bloco e usada só dentro dele (pela última posição em que
+ * aparece) vive na região do bloco, e blocos irmãos ocupam a mesma área,
+ * pois nunca estão vivos juntos. Uma variável usada depois do fim do seu
+ * bloco (a análise semântica a aceita, o escopo é o da função) sobe para a
+ * região que contém o uso. Em cada região as variáveis ficam em ordem
+ * decrescente de alinhamento, com a área dos blocos internos como mais um
+ * item, alinhado pelo seu maior membro, o que dispensa preenchimento entre
+ * elas. O quadro fecha em múltiplo de FRAME_ALIGN, para que a soma dos
+ * quadros de uma cadeia de chamadas seja exata.
+ *
+ * A profundidade de pilha de uma função é o seu quadro mais a da chamada
+ * mais funda. Num componente recursivo do grafo de chamadas cada função
+ * entra uma vez (a soma dos quadros do componente mais a saída mais funda),
+ * o que limita as cadeias sem repetição; a recursão em si não tem limite
+ * estático, e essas funções ficam marcadas.
+ *
+ * O tamanho entre colchetes é reconhecido pelo fonte (a AST não distingue
+ * 'inteiro !a[10]' de 'inteiro !a = 10'): a AST precisa ter vindo inteira
+ * do texto, sem corpos adiados nem nós compartilhados.
+ */
+
+#define FRAME_ALIGN 8
+
+/* Variável posicionada num quadro */
+typedef struct {
+    const char *name;
+    TokenType keyword;          /* TOK_KW_INTEIRO, TOK_KW_DECIMAL ou TOK_KW_TEXTO */
+    int count;                  /* entre colchetes (elementos, capacidade), 0 sem */
+    int size;
+    int align;
+    int offset;                 /* no quadro */
+    int line;
+    unsigned int param : 1;
+    unsigned int block : 1;     /* vive só num bloco interno */
+    unsigned int dynamic : 1;   /* tamanho não constante (conta como 0) */
+} FrameSlot;
+
+/* Quadro de uma função */
+typedef struct {
+    const char *name;
+    int line;
+    int size;                   /* múltiplo de FRAME_ALIGN */
+    int slot_bytes;             /* soma dos tamanhos das variáveis */
+    int first_slot;             /* variáveis em frame_slots, em ordem de offset */
+    int slot_count;
+    long depth;                 /* pior caso da pilha a partir desta função */
+    int next;                   /* chamada que leva ao pior caso (num componente
+                                 * recursivo, a saída dele), ou -1 */
+    unsigned int recursive : 1;
+    unsigned int dynamic : 1;   /* alguma variável de tamanho não constante */
+} FrameFunc;
+
+typedef struct FrameReport FrameReport;
+
+/* Calcula os quadros de um programa sem erros de sintaxe; source (len
+ * bytes) é o texto de onde a AST veio */
+FrameReport* frame_layout(ASTNode *program, const char *source, size_t len);
+
+int frame_func_count(const FrameReport *r);
+const FrameFunc* frame_func(const FrameReport *r, int i);
+/* Variáveis globais, posicionadas como um quadro sem reaproveitamento */
+const FrameFunc* frame_globals(const FrameReport *r);
+const FrameSlot* frame_slots(const FrameReport *r, const FrameFunc *f);
+/* principal(), ou a função de maior profundidade; -1 sem funções */
+int frame_entry(const FrameReport *r);
+/* Funções recursivas alcançáveis a partir da entrada, em ordem de
+ * definição, e quantas são */
+const int* frame_recursion(const FrameReport *r, int *count);
+void frame_free(FrameReport *r);
+
+#endif /* FRAME_H */
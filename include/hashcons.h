@@ -0,0 +1,60 @@
+#ifndef HASHCONS_H
+#define HASHCONS_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Compartilhamento de subexpressões idênticas (hash-consing). Com
+ * parser_set_hash_consing(1), cada Parser criado depois disso mantém uma
+ * tabela em que BINARY_OP, UNARY_OP, LITERAL e IDENTIFIER (fora de chamadas)
+ * são registrados de baixo para cima: um nó igual a outro já registrado (mesmo
+ * tipo, mesmo token e os mesmos filhos, por ponteiro) é descartado e o
+ * registrado passa a ser referenciado mais uma vez (ASTNode.refcount).
+ *
+ * O escopo do compartilhamento é o trecho de um item de nível superior entre
+ * duas declarações: dentro dele o tipo de um identificador não muda (a versão
+ * dos escopos da análise semântica é a mesma), então o tipo de cada subárvore
+ * compartilhada é inferido uma só vez.
+ * A raiz de cada expressão nunca é compartilhada (hashcons_unshare), e os
+ * alertas dos comandos continuam com a linha certa; um nó interno
+ * compartilhado guarda o token da primeira ocorrência, e um alerta de
+ * comparação nele é emitido uma vez.
+ *
+ * free_ast respeita as referências. Quem altera nós já construídos (a sessão
+ * incremental desloca linhas nó a nó) não deve usar o compartilhamento.
+ */
+
+typedef struct {
+    ASTNode *node;
+    unsigned long generation;       /* entrada válida só na geração atual */
+} HashConsSlot;
+
+typedef struct HashCons {
+    HashConsSlot *slots;
+    size_t slot_count;              /* potência de 2 */
+    size_t used;                    /* entradas da geração atual */
+    unsigned long generation;
+
+    ASTNode *last_hit;              /* último nó devolvido por já existir */
+    Token last_token;               /* token da ocorrência descartada */
+
+    unsigned long nodes;            /* nós candidatos registrados */
+    unsigned long shared;           /* nós descartados por já existirem */
+} HashCons;
+
+HashCons* hashcons_create(void);
+void hashcons_destroy(HashCons *hc);
+
+/* Encerra o escopo atual em O(1): as entradas antigas deixam de valer */
+void hashcons_reset(HashCons *hc);
+
+/* Devolve o nó equivalente já registrado (liberando node) ou o próprio node */
+ASTNode* hashcons_intern(HashCons *hc, ASTNode *node);
+
+/* Se node acabou de ser devolvido por hashcons_intern como já existente,
+ * devolve uma cópia própria dele (filhos compartilhados) com o token da
+ * ocorrência descartada */
+ASTNode* hashcons_unshare(HashCons *hc, ASTNode *node);
+
+#endif /* HASHCONS_H */
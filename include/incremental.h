@@ -0,0 +1,82 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "parser.h"
+
+/*
+ * Sessão de reanálise incremental (integração com editores).
+ *
+ * A sessão guarda o texto, os tokens e a AST do último estado. Cada item de
+ * nível superior (filho de AST_PROGRAM: função, 'principal()' ou comando do
+ * corpo de 'principal') tem seus próprios tokens, com deslocamentos e linhas
+ * relativos ao início do item. Numa edição, apenas os tokens do item afetado
+ * são relexados (até ressincronizar com os tokens antigos) e só esse item é
+ * reanalisado; os demais nós da AST são reaproveitados. Se a edição cruzar
+ * itens ou mudar suas fronteiras, a sessão refaz a análise completa.
+ *
+ * Nos nós da AST, token.line é absoluto e token.offset é relativo ao início
+ * do item que os contém (incr_item_start). Quando uma edição muda o número de
+ * linhas, as linhas dos itens seguintes são corrigidas só no acesso
+ * (incr_item_node ou incr_ast), para que a edição em si não percorra o resto
+ * do arquivo.
+ */
+
+/* Resultado de incr_edit */
+typedef enum {
+    INCR_SHIFTED,           /* só espaços entre itens: nenhuma reanálise */
+    INCR_REPARSED_ITEM,     /* um item relexado e reanalisado */
+    INCR_FULL_PARSE,        /* análise completa refeita sem erros */
+    INCR_PARSE_ERROR,       /* análise completa com erros sintáticos */
+    INCR_LEX_ERROR,         /* erro léxico: a AST anterior foi descartada */
+    INCR_INVALID_EDIT       /* intervalo fora do texto: nada mudou */
+} IncrResult;
+
+typedef struct {
+    ASTNode *node;          /* filho correspondente de AST_PROGRAM */
+    int start;              /* deslocamento absoluto do primeiro token */
+    int end;                /* deslocamento absoluto após o último token */
+    int line;               /* linha do primeiro token */
+    int line_pending;       /* deslocamento de linha ainda não aplicado aos nós */
+    Token *tokens;          /* tokens relativos a start/line, + TOK_EOF */
+    int token_count;        /* sem contar o TOK_EOF final */
+} IncrItem;
+
+typedef struct {
+    char *text;             /* texto atual (não terminado em '\0') */
+    int length;
+    int capacity;
+
+    ASTNode *program;       /* NULL após erro léxico */
+    ProgramMode mode;       /* forma do programa na última análise completa */
+    int valid;              /* 0: a próxima edição refaz a análise completa */
+
+    IncrItem *items;
+    int item_count;
+    int item_capacity;
+
+    /* Tokens fora dos itens (cabeçalho de 'principal', '}' final, TOK_EOF);
+     * com erros sintáticos, todos os tokens ficam aqui */
+    Token *outer;
+    int outer_count;
+    int outer_header;       /* quantos de outer vêm antes do primeiro item */
+
+    int full_parses;        /* estatísticas */
+    int item_parses;
+} IncrSession;
+
+/* Cria a sessão e faz a análise completa de text (copiado) */
+IncrSession* incr_open(const char *text, int length);
+void incr_close(IncrSession *s);
+
+/* Substitui delete_len bytes em offset por insert[0..insert_len) */
+IncrResult incr_edit(IncrSession *s, int offset, int delete_len,
+                     const char *insert, int insert_len);
+
+/* AST atual (com erros sintáticos, a AST parcial da análise completa);
+ * aplica as correções de linha pendentes de todos os itens */
+ASTNode* incr_ast(IncrSession *s);
+/* Nó de um item, com as linhas corrigidas */
+ASTNode* incr_item_node(IncrSession *s, int index);
+int incr_item_start(IncrSession *s, int index);
+
+#endif /* INCREMENTAL_H */
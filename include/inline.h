@@ -0,0 +1,92 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include <stddef.h>
+#include "parser.h"
+#include "symtab.h"
+
+/*
+ * Expansão em linha de funções pequenas (--inline), depois da análise
+ * semântica e antes de --fold, --frames e --ir. Cada chamada é resolvida
+ * pelo símbolo SYM_FUNC do escopo global, cujo extra aponta para o
+ * AST_FUNCTION_DEF, e as funções são processadas das chamadas para as que
+ * chamam (componentes fortemente conexos do grafo de chamadas): o corpo
+ * copiado já traz as expansões feitas nele.
+ *
+ * Uma chamada expandida vira, antes do comando em que aparece:
+ *
+ *     inteiro !a.3;              parâmetros, um por um, com os argumentos
+ *     !a.3 = <argumento>;        na ordem das chamadas
+ *     ...                        o corpo, menos o 'retorne' final
+ *     inteiro !_f.3;             o resultado, com o tipo da expressão
+ *     !_f.3 = <expressão do 'retorne'>;
+ *
+ * e a chamada passa a ser o identificador do resultado. Os nomes locais da
+ * função ganham o sufixo .N da expansão no chamador, que não é escrevível
+ * no fonte e não colide com nada. Um comando único no corpo de 'se',
+ * 'enquanto' ou 'para' ganha um bloco em volta. Chamadas nos argumentos
+ * saem antes (a ordem de avaliação da IR, que avalia && e || por inteiro).
+ *
+ * Custo e limite: o custo é o número de nós do corpo (sem o bloco). Fora de
+ * laços o limite é INLINE_BASE_LIMIT, e cada nível de laço em volta da
+ * chamada (a frequência estimada) o dobra, até INLINE_MAX_LIMIT. Um
+ * chamador cresce no máximo o seu próprio tamanho ou INLINE_GROWTH_MIN
+ * nós, o que for maior.
+ *
+ * Não são expandidas: funções recursivas (num ciclo do grafo de chamadas),
+ * com 'retorne' fora do fim do corpo (ou sem ele), com parâmetro texto ou
+ * vetor, que retornam texto, chamadas com outro número de argumentos,
+ * chamadas na condição de 'enquanto' ou na condição e no passo de 'para'
+ * (avaliadas a cada volta), funções que usam uma global com o nome de
+ * uma variável do chamador, e chamadas cujo comando, fora delas, lê uma
+ * global ou chama outra função quando a função grava globais, lê, escreve
+ * ou chama (o corpo iria antes dessas leituras), ou lê globais e o comando
+ * chama outra função. Só os corpos de funções e de 'principal' são
+ * processados; as chamadas nos itens globais ficam.
+ *
+ * Como --frames, precisa da AST inteira, sem corpos adiados nem nós
+ * compartilhados; source (len bytes) é o texto de onde ela veio.
+ */
+
+#define INLINE_BASE_LIMIT 20
+#define INLINE_MAX_LIMIT  160
+#define INLINE_GROWTH_MIN 256
+
+typedef enum {
+    INLINE_EXPANDED,
+    INLINE_RECURSIVE,
+    INLINE_TOO_LARGE,
+    INLINE_GROWTH,
+    INLINE_LOOP_CONDITION,
+    INLINE_RETURN,
+    INLINE_PARAMS,
+    INLINE_RESULT,
+    INLINE_ARGUMENTS,
+    INLINE_SHADOWED,
+    INLINE_ORDER,
+    INLINE_UNKNOWN
+} InlineDecision;
+
+/* Uma chamada no fonte */
+typedef struct {
+    const char *caller;
+    const char *callee;
+    int line;
+    int loop_depth;             /* laços em volta, no chamador */
+    int cost;                   /* nós do corpo; 0 se não avaliado */
+    int limit;
+    InlineDecision decision;
+} InlineSite;
+
+typedef struct {
+    InlineSite *sites;          /* por função, as dos argumentos antes */
+    int site_count;
+    int expanded;
+    long nodes_added;
+} InlineReport;
+
+InlineReport* inline_functions(ASTNode *program, SymTab *symtab, const char *source, size_t len);
+const char* inline_decision_str(InlineDecision d);
+void inline_report_free(InlineReport *r);
+
+#endif /* INLINE_H */
@@ -0,0 +1,179 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stddef.h>
+#include "fold.h"
+#include "parser.h"
+#include "token.h"
+#include "types.h"
+
+/*
+ * Representação intermediária em SSA, gerada da AST já analisada. Cada
+ * função vira um grafo de blocos básicos cujas instruções definem um valor
+ * cada uma (vN, o índice da instrução), com nós phi no início dos blocos de
+ * junção. Variáveis locais e parâmetros viram valores SSA pela construção
+ * de Braun et al. (sem dominadores: o valor de uma variável num bloco é
+ * procurado nos predecessores, e um phi cujos argumentos são todos o mesmo
+ * valor é trocado por ele). As globais são lidas e gravadas com IR_LOAD e
+ * IR_STORE, pois uma chamada pode alterá-las; os comandos de nível
+ * superior de um programa com funções formam a função "(globais)".
+ * '&&' e '||' avaliam os dois lados, como na AST.
+ *
+ * Tudo fica em vetores planos por função: as instruções, os operandos
+ * variáveis de phi, chamada e escreva (args), os blocos, e os predecessores
+ * de cada bloco, na ordem dos argumentos dos phis. code lista as
+ * instruções de cada bloco em ordem, phis primeiro; depois de ir_compact
+ * as instruções removidas saem e os valores são renumerados na ordem de
+ * code, de modo que insts[i] é o i-ésimo de code.
+ */
+
+typedef enum {
+    IR_CONST,       /* a: valor em consts */
+    IR_LITERAL,     /* texto, ou número fora da faixa: lexema em name */
+    IR_PARAM,       /* a: posição do parâmetro */
+    IR_UNDEF,       /* variável name lida antes de receber valor */
+    IR_PHI,         /* um argumento por predecessor */
+    IR_BINARY,      /* a sub b */
+    IR_UNARY,       /* sub a */
+    IR_LOAD,        /* global name */
+    IR_STORE,       /* global name = a */
+    IR_CALL,        /* name(args) */
+    IR_READ,        /* leia(name): o valor lido */
+    IR_WRITE,       /* escreva(args) */
+    IR_NOP          /* removida; sai em ir_compact */
+} IrOp;
+
+typedef enum {
+    IR_JUMP,        /* para succ[0] */
+    IR_BRANCH,      /* value ? succ[0] : succ[1] */
+    IR_RETURN       /* value, ou -1 */
+} IrTerm;
+
+typedef struct {
+    unsigned char op;           /* IrOp */
+    unsigned char sub;          /* TokenType do operador */
+    int block;
+    TypeId type;
+    int a, b;                   /* operandos; em PHI, CALL e WRITE, o primeiro
+                                 * e a quantidade em args */
+    int line;
+    const char *name;
+} IrInst;
+
+typedef struct {
+    int first, count;           /* instruções em code */
+    int phi_count;              /* as primeiras de count */
+    int pred_first, pred_count; /* predecessores em preds */
+    unsigned char term;         /* IrTerm */
+    unsigned char dead;         /* removido; sai em ir_compact */
+    int value;                  /* condição, ou valor retornado (-1 sem) */
+    int succ[2];
+    int next_part;              /* bloco absorvido (passo cfg), cujas
+                                 * instruções seguem as deste; -1 sem */
+} IrBlock;
+
+typedef struct {
+    const char *name;
+    int line;
+    int param_count;
+    IrInst *insts;
+    int inst_count, inst_capacity;
+    int *args;
+    int arg_count, arg_capacity;
+    IrBlock *blocks;            /* o bloco 0 é a entrada */
+    int block_count, block_capacity;
+    int *preds;
+    int pred_total;
+    int *code;
+    int code_count;
+    FoldValue *consts;
+    int const_count, const_capacity;
+} IrFunc;
+
+typedef struct {
+    IrFunc *funcs;
+    int func_count;
+} IrModule;
+
+/* Gera a IR de um programa sem erros de sintaxe (corpos adiados já
+ * expandidos); source (len bytes) é o texto de onde a AST veio */
+IrModule* ir_lower(ASTNode *program, const char *source, size_t len);
+void ir_free(IrModule *m);
+
+/* Imprime as funções, blocos e instruções */
+void ir_print(const IrModule *m);
+/* Confere uma função compactada: operandos definidos e não removidos, cada
+ * definição dominando os usos (num argumento de phi, o fim do
+ * predecessor), um argumento de phi por predecessor e predecessores
+ * coerentes com os sucessores. Imprime cada problema e retorna quantos
+ * achou. */
+int ir_verify_func(const IrFunc *f);
+int ir_verify(const IrModule *m);
+/* Instruções, blocos e bytes dos vetores */
+void ir_measure(const IrModule *m, long *insts, long *blocks, size_t *bytes);
+
+/* ---------- Para os passes ---------- */
+
+/* Acrescenta uma constante; retorna o índice em consts */
+int ir_add_const(IrFunc *f, const FoldValue *v);
+/* Instrução sem efeito além do valor (pode ser removida) */
+int ir_is_pure(const IrInst *inst);
+/* Operandos de uma instrução (os de phi, chamada e escreva ficam em args) */
+int ir_operand_count(const IrInst *inst);
+int ir_operand(const IrFunc *f, const IrInst *inst, int i);
+void ir_set_operand(IrFunc *f, IrInst *inst, int i, int value);
+/* Sucessores de um bloco pelo terminador */
+int ir_succ_count(const IrBlock *b);
+/* Remove o predecessor index de block e o argumento correspondente dos
+ * seus phis */
+void ir_remove_pred(IrFunc *f, int block, int index);
+/* Troca cada operando v por forward[v] (seguindo a cadeia) */
+void ir_replace_uses(IrFunc *f, int *forward);
+/* Tira instruções e blocos removidos e renumera */
+void ir_compact(IrFunc *f);
+
+/* Árvore de dominadores dos blocos alcançáveis a partir da entrada */
+typedef struct {
+    int *idom;                  /* -1 nos inalcançáveis; a entrada é o próprio */
+    int *order;                 /* alcançáveis em pré-ordem da árvore */
+    int count;
+    int *pre, *post;            /* a domina b sse pre[a] <= pre[b] e post[b] <= post[a] */
+    int *child_first;           /* filhos de b: children[child_first[b] .. child_first[b + 1]) */
+    int *children;
+} IrDomTree;
+
+void ir_dominators(const IrFunc *f, IrDomTree *t);
+void ir_dom_free(IrDomTree *t);
+int ir_dominates(const IrDomTree *t, int a, int b);
+
+/* ---------- Passes ---------- */
+
+#define IR_MAX_PASSES 16
+
+/* Passes, em ordem */
+typedef struct {
+    int count;
+    int pass[IR_MAX_PASSES];
+} IrPipeline;
+
+/* Acumulado de um passo em todas as funções */
+typedef struct {
+    const char *name;
+    unsigned long changes;      /* instruções trocadas, desvios resolvidos,
+                                 * blocos removidos ou unidos */
+    double seconds;
+} IrPassStat;
+
+/* Os passos, separados por vírgula: sccp (propagação esparsa de
+ * constantes condicional), gvn (numeração global de valores pela árvore de
+ * dominadores), dce (remoção de código morto) e cfg (une um bloco ao
+ * predecessor único que só salta para ele); "none" para nenhum. Retorna 0
+ * se inválido. */
+int ir_parse_pipeline(const char *list, IrPipeline *p);
+#define IR_DEFAULT_PIPELINE "sccp,gvn,dce,cfg"
+/* Roda os passos em cada função, conferindo a IR depois de cada um;
+ * stats[i] recebe o acumulado do i-ésimo. Retorna 0 se a IR ficou
+ * inválida (já relatado). */
+int ir_run_pipeline(IrModule *m, const IrPipeline *p, IrPassStat *stats);
+
+#endif /* IR_H */
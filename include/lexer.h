@@ -1,9 +1,17 @@
 #ifndef LEXER_H
 #define LEXER_H
 #include "token.h"
+#include "util.h"
 
 int lex_file(const char *path);
+/* Como lex_file, liberando cada lexema depois de listá-lo (memória constante) */
+int lex_file_release(const char *path);
 
+/* Próximo token do scanner global */
 Token next_token(void);
+Token scanner_next_token(Scanner *sc);
+
+/* 1 se o lexema de tokens deste tipo foi alocado pelo lexer (mm_malloc) */
+int token_owns_lexeme(TokenType type);
 
 #endif /* LEXER_H */
@@ -0,0 +1,47 @@
+#ifndef LL1_H
+#define LL1_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Analisador sintático dirigido por tabela (--parser=ll1). As tabelas são
+ * geradas na compilação por tools/ll1gen a partir de grammar/linguagem.ll; o
+ * motor só tem uma pilha explícita de símbolos e outra de valores, então
+ * nenhum aninhamento (expressões, blocos, 'se' dentro de 'se') consome a
+ * pilha de C.
+ *
+ * Para programas válidos a AST é a mesma de parse_program (os mesmos nós,
+ * tokens e filhos; bench/parser_diff.c confere). Diferenças:
+ *  - só o primeiro erro de sintaxe é informado, e a análise para nele (a
+ *    descida recursiva sincroniza e continua);
+ *  - não há compartilhamento de subexpressões (--hash-cons) nem corpos
+ *    adiados (--lazy).
+ */
+
+/* Analisa o programa com os tokens de parser; erros vão para parser->had_error */
+ASTNode* ll1_parse_program(Parser *parser);
+
+/*
+ * Análise com os tokens entregues um a um (push_parser.h). O estado inteiro
+ * está nas pilhas, então a análise pode parar a qualquer token e continuar
+ * quando o próximo chegar. Cada item de nível superior concluído (filho de
+ * PROGRAM) é entregue a on_item, que passa a ser dono dele; o primeiro token
+ * já deve estar em parser->current_token na criação.
+ */
+typedef struct LL1Parser LL1Parser;
+typedef void (*LL1ItemHandler)(ASTNode *item, void *data);
+
+LL1Parser* ll1_create(Parser *parser, LL1ItemHandler on_item, void *data);
+/* Processa o token até precisar do seguinte; retorna 0 após um erro de
+ * sintaxe (já impresso). Depois do programa aceito, os tokens são ignorados
+ * (como o que vem após a '}' de 'principal() {...}'). */
+int ll1_feed(LL1Parser *p, Token token);
+/* O programa foi aceito (o último token entregue deve ser TOK_EOF) */
+int ll1_accepted(const LL1Parser *p);
+void ll1_free(LL1Parser *p);
+
+/* Bytes ocupados pelas tabelas geradas */
+size_t ll1_table_size(void);
+
+#endif /* LL1_H */
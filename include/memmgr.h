@@ -5,6 +5,8 @@
 #include <stddef.h>
 
 void mm_init(size_t max_bytes);
+/* Liga a serialização das alocações enquanto houver threads alocando */
+void mm_set_threaded(int on);
 
 void *mm_malloc(size_t size);
 void mm_free(void *ptr);
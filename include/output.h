@@ -0,0 +1,80 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Saída das listagens (tokens, AST e tabela de símbolos) sem stdio: os bytes
+ * são acumulados em um buffer e escritos direto no descritor com writev.
+ * Blocos grandes (ex.: os vetores da AST binária) não passam pelo buffer: vão
+ * no mesmo writev que o conteúdo pendente.
+ *
+ * As mensagens de estado continuam em printf. Para as duas saídas não se
+ * misturarem, cada listagem termina com out_flush, e out_flush descarrega
+ * stdout antes quando o descritor é o da saída padrão. Com json e binary,
+ * feitos para ferramentas, dump_claim_stdout deixa a saída padrão só para
+ * as listagens e manda as mensagens de estado para stderr.
+ *
+ * Formatos (--dump=):
+ *   none    nenhuma listagem (compilação de produção)
+ *   text    o formato legível de sempre (padrão)
+ *   json    cada listagem é um objeto JSON em uma linha
+ *   binary  tokens:  "TOKS", e por token u32 linha, u32 tipo, u32 tamanho e
+ *                    o lexema, até o registro de TOK_EOF
+ *           AST:     a imagem de include/ast_binary.h
+ *           símbolos: "SYMS", u32 escopos, e por escopo u32 id, u32 símbolos
+ *                    e por símbolo u32 classe, u32 tipo, i32 a, i32 b,
+ *                    i32 linha, u32 tamanho e o nome
+ *           (inteiros na ordem de bytes da máquina)
+ */
+
+typedef enum {
+    DUMP_NONE,
+    DUMP_TEXT,
+    DUMP_JSON,
+    DUMP_BINARY
+} DumpFormat;
+
+#define OUT_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    int fd;
+    char *buf;                      /* fornecido por quem cria o sink */
+    size_t cap;
+    size_t len;
+    int failed;                     /* alguma escrita falhou */
+} OutSink;
+
+/* Formato das listagens, escolhido por --dump= */
+void dump_set_format(DumpFormat format);
+DumpFormat dump_format(void);
+/* Converte "none", "text", "json" ou "binary"; retorna 0 se inválido */
+int dump_parse_format(const char *name, DumpFormat *format);
+
+/* Reserva o descritor da saída padrão para as listagens: daí em diante
+ * stdout (printf) escreve em stderr */
+void dump_claim_stdout(void);
+/* Sink das listagens (a saída padrão), com buffer estático de
+ * OUT_BUFFER_SIZE bytes */
+OutSink* out_stdout(void);
+
+void out_init(OutSink *out, int fd, char *buf, size_t cap);
+/* Escreve o conteúdo pendente; retorna 0 se alguma escrita falhou */
+int out_flush(OutSink *out);
+
+void out_write(OutSink *out, const void *data, size_t len);
+void out_str(OutSink *out, const char *s);
+void out_char(OutSink *out, char c);
+void out_long(OutSink *out, long value);
+/* s alinhado à esquerda (espaços até width), como "%-*s" */
+void out_str_pad(OutSink *out, const char *s, int width);
+/* value alinhado à direita, como "%*ld" */
+void out_long_pad(OutSink *out, long value, int width);
+/* String JSON entre aspas, com escapes; NULL vira null */
+void out_json_str(OutSink *out, const char *s);
+/* Inteiros de 32 bits em binário */
+void out_u32(OutSink *out, uint32_t value);
+void out_i32(OutSink *out, int32_t value);
+
+#endif /* OUTPUT_H */
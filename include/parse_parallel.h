@@ -0,0 +1,39 @@
+#ifndef PARSE_PARALLEL_H
+#define PARSE_PARALLEL_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Análise sintática com as definições de nível superior repartidas entre
+ * threads. O texto é dividido antes de qualquer análise em regiões que
+ * começam em 'funcao' ou 'principal' fora de chaves e de strings; cada região
+ * é analisada por uma thread com seu próprio Scanner e Parser, e os itens são
+ * reunidos sob AST_PROGRAM na ordem do fonte.
+ *
+ * Se alguma região tiver erro sintático (ou o programa for da forma
+ * 'principal() { ... }', que não tem regiões independentes), o texto todo é
+ * reanalisado sequencialmente: as mensagens saem exatamente como em
+ * parse_program, na ordem do fonte. Com threads <= 1, ou com o analisador
+ * dirigido por tabela (parser_set_engine), a análise é sempre sequencial.
+ */
+ASTNode* parse_program_parallel(const char *text, size_t len, int threads, int *had_error);
+
+/* Trecho do fonte iniciado por uma definição de nível superior */
+typedef struct {
+    size_t start;
+    size_t end;
+    int line;                       /* linha de text[start] */
+} SourceRegion;
+
+/* Divide o texto em regiões iniciadas por 'funcao'/'principal' de nível
+ * superior; a primeira região vai do início do texto à primeira definição.
+ * Retorna o número de regiões; *regions é alocado com mm_malloc. Com
+ * regions == NULL apenas verifica se há mais de uma região (retorna no
+ * máximo 2, sem alocar). */
+int split_top_level(const char *text, size_t len, SourceRegion **regions);
+
+/* O programa é da forma 'principal() { ... }' (sem regiões independentes) */
+int starts_with_principal(const char *text, size_t len);
+
+#endif /* PARSE_PARALLEL_H */
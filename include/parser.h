@@ -3,6 +3,7 @@
 
 #include "token.h"
 #include "types.h"
+#include "util.h"
 
 /* Tipos de nós da árvore sintática */
 typedef enum {
@@ -28,32 +29,118 @@ typedef enum {
 /* Estrutura para nó da árvore sintática abstrata */
 typedef struct ASTNode {
     ASTNodeType type;
-    Token token;                    /* Token associado ao nó */
+    unsigned int refcount : 31;     /* Referências além da primeira (hashcons.h) */
+    unsigned int lazy : 1;          /* BLOCK de corpo adiado (ast_expand_body) */
+    Token token;                    /* Token associado ao nó; num corpo adiado,
+                                       length cobre de '{' até o '}' final */
     struct ASTNode **children;      /* Array de ponteiros para filhos */
     int child_count;                /* Número de filhos */
     int child_capacity;             /* Capacidade do array de filhos */
     char *value;                    /* Valor opcional do nó */
-    Type inferred_type;             /* Tipo inferido pelo analisador semântico */
+    TypeId inferred_type;           /* Tipo inferido pelo analisador semântico */
+    unsigned int typed_version;     /* Versão dos escopos de inferred_type (0: não tipado) */
 } ASTNode;
 
+/* Entrada da pilha de operadores do analisador de expressões */
+struct ExprOp;
+
+/* Quadro da pilha de comandos aninhados */
+struct StmtFrame;
+
+/* Tabela de subexpressões compartilhadas (hashcons.h) */
+struct HashCons;
+
+/* Forma do programa no nível superior (ver parse_program_begin) */
+typedef enum {
+    PROGRAM_FUNCTIONS,              /* funções, 'principal()' e comandos globais */
+    PROGRAM_PRINCIPAL,              /* arquivo iniciado por 'principal() {' */
+    PROGRAM_DONE                    /* cabeçalho inválido: nada mais a analisar */
+} ProgramMode;
+
 /* Estrutura do analisador sintático */
 typedef struct {
     Token current_token;            /* Token atual sendo processado */
     Token previous_token;           /* Token anterior */
     int had_error;                  /* Flag de erro durante parsing */
     int panic_mode;                 /* Flag de modo pânico para recuperação de erro */
+    int silent;                     /* Não imprime erros (análise especulativa) */
+    ProgramMode program_mode;       /* Definido por parse_program_begin */
+
+    /* Fonte de tokens: vetor terminado por TOK_EOF, ou um scanner próprio;
+     * sem nenhum dos dois, o scanner global */
+    const Token *tokens;
+    int token_pos;
+    Scanner *scanner;
+
+    /* Pilhas explícitas do analisador de expressões (reutilizadas) */
+    struct ExprOp *expr_ops;        /* Pilha de operadores e agrupamentos */
+    int expr_op_count;
+    int expr_op_capacity;
+    ASTNode **expr_operands;        /* Pilha de operandos */
+    int expr_operand_count;
+    int expr_operand_capacity;
+    struct StmtFrame *stmt_frames;  /* 'se', laços e blocos abertos */
+    int stmt_frame_count;
+    int stmt_frame_capacity;
+
+    struct HashCons *hashcons;      /* NULL sem compartilhamento de expressões */
 } Parser;
 
 /* Funções principais do analisador sintático */
 Parser* parser_init(void);
+/* Analisa um vetor de tokens já produzido; o último deve ser TOK_EOF */
+Parser* parser_init_tokens(const Token *tokens);
+/* Lê tokens de um scanner próprio (permite vários analisadores simultâneos) */
+Parser* parser_init_scanner(Scanner *scanner);
+/* Reaproveita o parser (e suas pilhas) para outra entrada */
+void parser_set_scanner(Parser *parser, Scanner *scanner);
+void parser_set_tokens(Parser *parser, const Token *tokens);
 void parser_free(Parser *parser);
+/* Parsers criados depois da chamada compartilham subexpressões idênticas */
+void parser_set_hash_consing(int on);
+
+/* Motor de parse_program: a descida recursiva (padrão) ou o analisador
+ * dirigido por tabela de ll1.h */
+typedef enum {
+    PARSER_DESCENT,
+    PARSER_LL1
+} ParserEngine;
+
+void parser_set_engine(ParserEngine engine);
+ParserEngine parser_engine(void);
+/* Converte "descent" ou "ll1"; retorna 0 se inválido */
+int parser_parse_engine(const char *name, ParserEngine *engine);
+
+/* Corpos de 'funcao' adiados (--lazy): com source != NULL, o corpo vira um
+ * BLOCK marcado com lazy que guarda só o intervalo até a '}' correspondente.
+ * source é o texto a que os offsets dos tokens se referem e deve continuar
+ * válido até os corpos serem expandidos. Erros de sintaxe de um corpo só
+ * aparecem quando ele é expandido. */
+void parser_set_lazy_bodies(const char *source);
+int parser_lazy_bodies(void);
+/* Analisa agora um corpo adiado (nada faz nos demais nós); retorna 0 se
+ * houve erro de sintaxe, já impresso */
+int ast_expand_body(ASTNode *block);
+/* Corpos expandidos com erro de sintaxe até aqui */
+int parser_lazy_errors(void);
 ASTNode* parse_program(Parser *parser);
+
+/* parse_program em etapas, um item de nível superior por vez */
+ASTNode* parse_program_begin(Parser *parser);
+int parse_program_at_end(Parser *parser);
+ASTNode* parse_program_item(Parser *parser);
+void parse_program_end(Parser *parser);
 void print_ast(ASTNode *node, int depth);
 void free_ast(ASTNode *node);
 
 /* Funções auxiliares */
 ASTNode* ast_node_create(ASTNodeType type, Token token);
 void ast_node_add_child(ASTNode *parent, ASTNode *child);
+/* Papel do filho que segue o nome declarado no filho index de uma
+ * DECLARATION, pelo caractere seguinte no fonte (source, len bytes, de onde
+ * a AST veio): '=' inicialização, '[' tamanho ou formato, '\0' quando o
+ * próximo filho, se houver, é outro nome. A AST não guarda a diferença. */
+char ast_declarator_arg(const ASTNode *decl, int index, const char *source, size_t len);
 
 /* Funções de parsing específicas */
 ASTNode* parse_declaration(Parser *parser);
@@ -76,8 +163,34 @@ void synchronize(Parser *parser);
 void parser_error(Parser *parser, const char *message);
 
 /* Funções de validação sintática */
+
+/* Regras violadas, como máscara de bits */
+#define VALIDATE_DECLARATION_SEQUENCE 1
+#define VALIDATE_SPACING              2
+#define VALIDATE_VARIABLE_USAGE       4
+
+/* Alertas das regras que não reprovam o programa */
+typedef struct {
+    unsigned long spacing;          /* violações de espaçamento fora do modo estrito */
+    unsigned long variable_usage;   /* achados de dataflow_check_usage */
+} ValidationAlerts;
+
+/* Todas as validações em uma só passada pelos itens de nível superior;
+ * retorna a máscara das regras violadas (0 se o programa é válido) e, se
+ * alerts não é NULL, a contagem dos alertas.
+ * source (len bytes) é o texto de onde a AST veio; sem ele (NULL), o uso
+ * das variáveis não é analisado. O uso das variáveis gera alertas (leitura
+ * antes de atribuição, atribuição nunca lida, variável nunca lida) e não
+ * reprova o programa; o espaçamento também, fora do modo estrito
+ * (spacing.h). */
+int validate_program(ASTNode *program, const char *source, size_t len, ValidationAlerts *alerts);
+/* Passadas das validações até aqui (medições): uma pelos itens de nível
+ * superior por validate_program e uma por corpo no grafo do uso das
+ * variáveis */
+unsigned long validate_walk_count(void);
+
 int validate_declaration_sequence(ASTNode *program);
 int validate_spacing_rules(ASTNode *program);
-int validate_variable_usage(ASTNode *program);
+int validate_variable_usage(ASTNode *program, const char *source, size_t len);
 
 #endif /* PARSER_H */
@@ -0,0 +1,40 @@
+#ifndef PUSH_PARSER_H
+#define PUSH_PARSER_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/*
+ * Análise sintática com a entrada chegando em pedaços (push): quem recebe o
+ * fonte pela rede entrega cada pedaço a parser_feed assim que ele chega, e a
+ * análise avança até onde o pedaço permite. O léxico para no último token que
+ * o pedaço pode ter cortado ('!con' + 'tador', '=' + '=', uma string aberta)
+ * e o guarda para juntar ao próximo pedaço; o resto do pedaço é descartado.
+ * A análise sintática é a do motor LL(1) (ll1.h), cujo estado está todo em
+ * pilhas explícitas e por isso pode ser suspenso entre dois tokens; a descida
+ * recursiva guarda o estado na pilha de C.
+ *
+ * Cada item de nível superior (funcao, 'principal() {...}', comando global,
+ * ou comando do bloco de um programa 'principal() {') é entregue a on_item
+ * assim que se fecha; quem recebe passa a ser dono da subárvore. Com tokens
+ * e nós na mesma forma de parse_program, os itens na ordem de entrega são os
+ * filhos de AST_PROGRAM na análise em lote (bench/parser_diff.c confere).
+ *
+ * Erros léxicos e de sintaxe são impressos como na compilação em lote; só o
+ * primeiro erro de sintaxe é informado (ver ll1.h).
+ */
+
+typedef void (*PushItemHandler)(ASTNode *item, void *data);
+
+typedef struct PushParser PushParser;
+
+PushParser* parser_push_create(PushItemHandler on_item, void *data);
+/* Retorna 0 depois de um erro (este ou anterior); os pedaços seguintes são
+ * ignorados */
+int parser_feed(PushParser *ctx, const char *bytes, size_t len);
+/* Fim da entrada: analisa o token guardado e confere que o programa terminou.
+ * Retorna 1 se o programa inteiro foi aceito. */
+int parser_finish(PushParser *ctx);
+void parser_push_free(PushParser *ctx);
+
+#endif /* PUSH_PARSER_H */
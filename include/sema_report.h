@@ -4,4 +4,22 @@
 void sema_report_error(const char *msg);
 void sema_report_alert(const char *msg, int line);
 
+/* Alertas guardados para impressão posterior, na ordem em que foram
+ * gravados (a análise paralela imprime os de cada função na ordem do
+ * fonte). As mensagens são literais e não são copiadas. */
+typedef struct {
+    const char *msg;
+    int line;
+} SemaAlert;
+
+typedef struct SemaAlerts {
+    SemaAlert *items;
+    int count;
+    int capacity;
+} SemaAlerts;
+
+void sema_alerts_add(SemaAlerts *alerts, const char *msg, int line);
+/* Imprime com sema_report_alert e libera os alertas */
+void sema_alerts_flush(SemaAlerts *alerts);
+
 #endif /* SEMA_REPORT_H */
@@ -6,14 +6,53 @@
 #include "parser.h"
 #include "symtab.h"
 #include "types.h"
+#include "symindex.h"
+
+struct SemaAlerts;
 
 typedef struct {
     size_t mem_limit;
     SymTab *symtab;
+    unsigned int scope_version;     /* versão dos escopos (ASTNode.typed_version) */
+    struct SemaAlerts *alerts;      /* NULL: alertas impressos na hora */
+    SymIndexBuilder *index;         /* NULL: sem índice de símbolos */
+    unsigned long walks;            /* medições, somadas em sema_destroy */
+    unsigned long typed;
+    unsigned long reused;
 } SemaContext;
 
 SemaContext* sema_create(size_t mem_limit_bytes);
+/* Com corpos adiados (parser_set_lazy_bodies), só as funções alcançáveis a
+ * partir de principal() e dos itens globais são expandidas e analisadas */
 bool semantic_analyze(SemaContext* sc, ASTNode* ast);
+/* Com threads > 1, semantic_analyze analisa os corpos das funções em até
+ * threads threads (ver semantics.c); a saída é a mesma da análise
+ * sequencial */
+void sema_set_threads(int threads);
+/* Monta o índice de símbolos (symindex.h) durante a análise deste
+ * contexto; os corpos passam a ser analisados em sequência. O índice
+ * cobre o que foi analisado: com corpos adiados, só as funções
+ * alcançáveis, e com --hash-cons, uma subexpressão repetida só na primeira
+ * ocorrência. sema_take_index devolve o índice (liberado por quem chama
+ * com symindex_free), ou NULL sem sema_build_index. */
+void sema_build_index(SemaContext* sc);
+SymIndex* sema_take_index(SemaContext* sc);
+
+/* semantic_analyze em etapas, para quem não mantém a AST inteira (stream.h):
+ * sema_declare_item registra a assinatura de uma função (retorna true,
+ * contando as principal() em *principal_count) ou analisa um item global;
+ * o símbolo não guarda o nó, que pode ser liberado em seguida.
+ * sema_analyze_function analisa o corpo de uma função já registrada e
+ * sema_check_principal confere, ao final, que houve exatamente uma
+ * principal(). */
+bool sema_declare_item(SemaContext* sc, ASTNode* item, int* principal_count);
+void sema_analyze_function(SemaContext* sc, ASTNode* func);
+void sema_check_principal(int principal_count, int line);
+/* Percursos da AST feitos pelas análises semânticas já destruídas (medições) */
+unsigned long sema_walk_count(void);
+/* Nós de expressão tipados e subárvores já anotadas na versão atual dos
+ * escopos (reaproveitadas sem percorrer), idem */
+void sema_type_stats(unsigned long *resolved, unsigned long *reused);
 /* Imprime a tabela de símbolos acumulada e relatório de memória. */
 void symtab_print(SemaContext* sc);
 void sema_destroy(SemaContext* sc);
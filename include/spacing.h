@@ -0,0 +1,80 @@
+#ifndef SPACING_H
+#define SPACING_H
+
+#include "token.h"
+
+/*
+ * Regras de espaçamento verificadas sobre o fluxo de tokens, em uma passada e
+ * sem reler o fonte: o espaço entre dois tokens é o intervalo entre o fim de
+ * um (offset + length) e o início do seguinte, e a linha dos tokens diz se
+ * esse intervalo contém quebra de linha. A listagem de tokens (lex_file)
+ * alimenta o verificador global, e validate_program consulta o resultado.
+ *
+ * "Sem espaço" proíbe só espaços na mesma linha: quebrar a linha antes de
+ * ')' ou ';' é permitido. "Com espaço" aceita espaços ou quebra de linha.
+ *
+ * As violações são alertas e não reprovam o programa, a menos que o modo
+ * estrito (--spacing-strict) esteja ligado.
+ */
+
+typedef enum {
+    SPACING_OPERATORS    = 1 << 0,  /* operadores binários e '=' entre espaços */
+    SPACING_COMMAS       = 1 << 1,  /* ',' sem espaço antes e com espaço depois */
+    SPACING_SEMICOLONS   = 1 << 2,  /* ';' sem espaço antes */
+    SPACING_PARENS       = 1 << 3,  /* sem espaço após '(' '[' e antes de ')' ']' */
+    SPACING_KEYWORDS     = 1 << 4,  /* 'se', 'enquanto', 'para' seguidos de espaço;
+                                       chamadas, 'leia', 'escreva' e 'principal'
+                                       colados ao '(' */
+    SPACING_BRACES       = 1 << 5,  /* '{' com espaço antes */
+    SPACING_DECLARATIONS = 1 << 6   /* tipo seguido de espaço */
+} SpacingRule;
+
+#define SPACING_ALL_RULES  0x7Fu
+/* Padrão: todas menos chaves ('principal(){' é comum nos exemplos) */
+#define SPACING_DEFAULT_RULES (SPACING_ALL_RULES & ~(unsigned)SPACING_BRACES)
+#define SPACING_MAX_REPORTED 16
+
+typedef struct {
+    int line;
+    SpacingRule rule;
+    const char *message;
+} SpacingViolation;
+
+typedef struct {
+    unsigned rules;                 /* máscara de SpacingRule ativas */
+    int has_prev;
+    TokenType prev_type;
+    int prev_end;                   /* offset logo após o token anterior */
+    int prev_line;
+    int prev_operand;               /* o anterior encerra um operando */
+    unsigned after_rule;            /* regra sobre o espaço após o anterior (0: nenhuma) */
+    int after_space;                /* 1: exige espaço; 0: proíbe */
+    const char *after_message;
+    unsigned long violations;
+    int reported;                   /* guardadas em violation[] */
+    SpacingViolation violation[SPACING_MAX_REPORTED];
+} SpacingChecker;
+
+/* Regras ativas nos verificadores iniciados depois da chamada
+ * (padrão: SPACING_DEFAULT_RULES) */
+void spacing_set_rules(unsigned rules);
+unsigned spacing_rules(void);
+/* Modo estrito: violações viram erros e reprovam o programa (padrão: 0) */
+void spacing_set_strict(int strict);
+int spacing_strict(void);
+/* Converte "all", "none" ou uma lista separada por vírgulas de operadores,
+ * virgulas, ponto-e-virgula, parenteses, palavras-chave, chaves e
+ * declaracoes; retorna 0 se inválido */
+int spacing_parse_rules(const char *spec, unsigned *rules);
+
+void spacing_init(SpacingChecker *sc, unsigned rules);
+/* O(1) por token; os tokens chegam na ordem do fonte, até TOK_EOF */
+void spacing_feed(SpacingChecker *sc, const Token *tok);
+/* Imprime as violações guardadas em stderr, como alertas ou, no modo
+ * estrito, erros; retorna o total */
+unsigned long spacing_report(const SpacingChecker *sc);
+
+/* Verificador alimentado pela listagem de tokens */
+SpacingChecker* spacing_checker(void);
+
+#endif /* SPACING_H */
@@ -0,0 +1,36 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include "semantics.h"
+
+/*
+ * Compilação função a função (--stream). Em vez de montar a AST do programa
+ * inteiro, o texto é dividido nas regiões de split_top_level e percorrido
+ * uma região por vez, em três passadas:
+ *
+ *  1. sintaxe: cada item é analisado e descartado, conferindo a ordem das
+ *     declarações; com erro, nada da análise semântica é emitido;
+ *  2. assinaturas: as funções entram no escopo global e os itens globais são
+ *     analisados, como no índice de funções de semantic_analyze (os alertas
+ *     saem na mesma ordem);
+ *  3. corpos: cada item tem sua AST impressa e cada função passa por
+ *     sema_analyze_function antes de ser liberada.
+ *
+ * Tokens, lexemas e nós de uma região são liberados ao fim dela, então o
+ * pico de memória acompanha a maior região (uma função e os itens globais
+ * que a seguem) mais as assinaturas, e não o programa inteiro. O custo é
+ * analisar sintaticamente o texto três vezes.
+ */
+
+typedef enum {
+    STREAM_OK,
+    STREAM_SYNTAX_ERROR,    /* mensagens já impressas, como em parse_program */
+    STREAM_INVALID,         /* sequência de declarações inválida */
+    STREAM_SPACING,         /* regras de espaçamento (spacing.h) violadas */
+    STREAM_UNSUPPORTED      /* 'principal() { ... }': só em lote; nada impresso */
+} StreamResult;
+
+StreamResult compile_streaming(const char *text, size_t len, SemaContext *sc);
+
+#endif /* STREAM_H */
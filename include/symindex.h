@@ -0,0 +1,91 @@
+#ifndef SYMINDEX_H
+#define SYMINDEX_H
+
+#include <stddef.h>
+#include "symtab.h"
+#include "token.h"
+#include "types.h"
+
+/*
+ * Índice de símbolos por posição, para consultas de editor depois da
+ * análise (ir para a definição, achar as referências, tipo sob o cursor),
+ * quando a tabela de símbolos já desfez os escopos. É montado durante a
+ * análise semântica (sema_build_index) e, pronto, é imutável: um único
+ * bloco com as definições, as referências agrupadas por definição, os
+ * escopos e os nomes. As posições são offsets em bytes no fonte, como em
+ * Token.
+ *
+ * Os escopos (o global e o de cada função, do primeiro ao último token
+ * analisado) formam intervalos aninhados, guardados em ordem de início com
+ * o pai de cada um: o escopo mais interno que contém uma posição sai de uma
+ * busca binária e da subida pelos pais que terminam antes dela.
+ */
+
+/* Definição (declaração de variável, parâmetro ou função) */
+typedef struct {
+    unsigned int name;     /* posição do nome (symindex_name) */
+    SymClass sclass;
+    TypeId type;
+    int line;
+    int offset;            /* do identificador declarado */
+    int length;
+    int scope;             /* escopo da declaração */
+    int first_ref;         /* referências em symindex_refs */
+    int ref_count;
+} SymDef;
+
+/* Uso de um identificador resolvido pela análise */
+typedef struct {
+    int offset;
+    int line;
+    int def;
+} SymRef;
+
+/* Escopo: intervalo [start, end) do fonte */
+typedef struct {
+    int start;
+    int end;
+    int parent;            /* -1 no global */
+    int first_def;         /* definições do escopo, em ordem de nome */
+    int def_count;
+} SymScope;
+
+typedef struct SymIndex SymIndex;
+typedef struct SymIndexBuilder SymIndexBuilder;
+
+/* Montagem (semantics.c). Começa com o escopo global aberto; cada
+ * definição e referência fica no escopo aberto mais interno. */
+SymIndexBuilder* symindex_builder_create(void);
+/* Retorna o identificador da definição */
+int symindex_add_def(SymIndexBuilder *b, const Symbol *sym, const Token *id);
+void symindex_add_ref(SymIndexBuilder *b, int def, const Token *id);
+void symindex_enter_scope(SymIndexBuilder *b, const Token *start);
+/* Estende o escopo aberto até o fim do token */
+void symindex_extend(SymIndexBuilder *b, const Token *tok);
+void symindex_leave_scope(SymIndexBuilder *b);
+/* Compacta o que foi montado em um índice e libera o construtor */
+SymIndex* symindex_finish(SymIndexBuilder *b);
+void symindex_builder_free(SymIndexBuilder *b);
+
+/* Consultas, em O(log n) */
+/* Definição do símbolo cujo nome (uso ou declaração) cobre a posição, ou -1 */
+int symindex_symbol_at(const SymIndex *idx, int offset);
+const SymDef* symindex_def(const SymIndex *idx, int def);
+const char* symindex_name(const SymIndex *idx, int def);
+/* Usos da definição, em ordem de posição */
+const SymRef* symindex_refs(const SymIndex *idx, int def, int *count);
+/* Escopo mais interno que contém a posição (0 é o global) */
+int symindex_scope_at(const SymIndex *idx, int offset);
+const SymScope* symindex_scope(const SymIndex *idx, int scope);
+/* Definição que o nome teria na posição, do escopo mais interno ao global,
+ * ou -1 */
+int symindex_resolve(const SymIndex *idx, const char *name, int offset);
+
+int symindex_def_count(const SymIndex *idx);
+int symindex_ref_count(const SymIndex *idx);
+int symindex_scope_count(const SymIndex *idx);
+/* Bytes ocupados pelo índice */
+size_t symindex_size(const SymIndex *idx);
+void symindex_free(SymIndex *idx);
+
+#endif /* SYMINDEX_H */
@@ -16,27 +16,70 @@ typedef enum {
 typedef struct Symbol {
     char *name;            /* nome do símbolo */
     SymClass sclass;       /* var, param ou func */
-    Type *type;            /* tipo associado */
+    TypeId type;           /* tipo associado (types.h) */
     size_t scope_id;       /* escopo onde foi declarado */
     int line_decl;         /* linha da declaração */
+    unsigned int index_id; /* definição no índice de símbolos + 1 (0: sem índice) */
     void *extra;           /* informação adicional */
-    struct Symbol *next;   /* próximo na lista do bucket */
 } Symbol;
 
-/* Escopo com tabela de dispersão de símbolos */
+/* Até SCOPE_INLINE símbolos, o escopo os guarda em um vetor dentro da
+ * própria estrutura e a busca é linear (a maioria dos blocos tem de zero a
+ * três); acima disso ganha um índice por endereçamento aberto */
+#define SCOPE_INLINE 4
+
+/* Vaga do índice: o hash fica guardado, e só hashes iguais comparam nomes */
+typedef struct {
+    unsigned long hash;
+    Symbol *sym;           /* NULL: vaga livre */
+} ScopeSlot;
+
+/* Escopo de símbolos */
 typedef struct Scope {
     size_t id;             /* identificador do escopo */
-    Symbol **buckets;      /* buckets da hash table */
-    size_t bucket_count;   /* quantidade de buckets */
+    Symbol **symbols;      /* símbolos em ordem de declaração */
+    size_t count;
+    size_t capacity;
+    ScopeSlot *slots;      /* índice (NULL até passar de SCOPE_INLINE) */
+    size_t slot_count;     /* potência de 2, ocupação até 1/2 */
     struct Scope *parent;  /* escopo pai (aninhamento) */
+    struct HamtNode *map;  /* SYMTAB_HAMT: todos os nomes visíveis no escopo */
+    Symbol *inline_symbols[SCOPE_INLINE];
 } Scope;
 
+/* Organização das buscas. Com SYMTAB_SCOPES, cada escopo tem o seu índice e
+ * a busca percorre os escopos do atual até o global: O(profundidade). Com
+ * SYMTAB_GLOBAL (LeBlanc-Cook), uma só tabela leva cada nome à pilha das
+ * suas ligações ativas, a busca é O(1) em qualquer profundidade e os
+ * símbolos de cada escopo servem de lista para desfazer as ligações ao sair.
+ * Com SYMTAB_HAMT, cada escopo guarda um mapa persistente (hash array
+ * mapped trie) de todos os nomes que enxerga: entrar em um escopo só
+ * compartilha o mapa do pai, uma declaração copia o caminho da raiz até a
+ * folha (ou o altera no lugar, se ninguém mais o enxerga) e a busca é
+ * O(log32 n) em qualquer profundidade. */
+typedef enum {
+    SYMTAB_SCOPES,
+    SYMTAB_GLOBAL,
+    SYMTAB_HAMT
+} SymTabDesign;
+
+/* Tabela de nomes de SYMTAB_GLOBAL (symtab.c) */
+struct SymNames;
+
 /* Tabela de símbolos contendo pilha de escopos */
 typedef struct SymTab {
     Scope *current;        /* escopo atual (topo da pilha) */
     size_t next_id;        /* próximo id de escopo */
+    struct SymNames *names; /* só com SYMTAB_GLOBAL */
+    SymTabDesign design;
 } SymTab;
 
+/* Organização das tabelas criadas depois da chamada */
+void symtab_set_design(SymTabDesign design);
+SymTabDesign symtab_design(void);
+/* Converte "scopes", "global" ou "hamt"; retorna 0 se inválido */
+int symtab_parse_design(const char *name, SymTabDesign *design);
+
 SymTab* symtab_create(void);
 void symtab_destroy(SymTab *st);
 
@@ -46,6 +89,35 @@ void symtab_leave_scope(SymTab *st);
 bool symtab_insert(SymTab *st, const Symbol *sym);
 Symbol* symtab_lookup(SymTab *st, const char *name);
 
+/*
+ * Leitura por várias threads (análise semântica paralela). symtab_freeze
+ * prepara o escopo atual para ser consultado ao mesmo tempo por várias
+ * visões; symtab_view cria a tabela privada de uma thread, cujo escopo
+ * mais externo é o congelado: os escopos em que a visão entra e os seus
+ * símbolos são dela, e as buscas chegam ao escopo congelado sem alterá-lo.
+ * A tabela congelada não pode mudar enquanto houver visões, e a visão só é
+ * liberada depois de sair de todos os escopos em que entrou.
+ */
+void symtab_freeze(SymTab *st);
+SymTab* symtab_view(SymTab *frozen);
+void symtab_view_free(SymTab *view);
+
+/*
+ * Tabela nova que enxerga os nomes visíveis agora em st, a partir de um
+ * escopo próprio: as declarações feitas nela escondem as de st, e as feitas
+ * depois em st não aparecem nela. Com SYMTAB_HAMT ela compartilha o mapa
+ * (O(1)) e pode ser usada por outra thread ao mesmo tempo que st, mas st
+ * não pode sair dos escopos que ela enxerga antes de symtab_destroy da
+ * cópia; nas outras organizações os símbolos visíveis são copiados (O(n))
+ * e as duas tabelas são independentes.
+ */
+SymTab* symtab_snapshot(SymTab *st);
+
+/* Nomes da classe e do tipo, como nas listagens (o do tipo vale até a
+ * próxima chamada) */
+const char* symtab_class_str(SymClass c);
+const char* symtab_type_str(TypeId id);
+
 /* Imprime a tabela de símbolos. Usado internamente pela camada semântica. */
 void symtab_dump(SymTab *st);
 
@@ -57,11 +57,13 @@ typedef enum {
     TOK_ERROR
 } TokenType;
 
-/* Representa um token com tipo, lexema e linha */
+/* Representa um token com tipo, lexema, linha e posição (em bytes) no fonte */
 typedef struct {
     TokenType type;
-    char *lexeme;
     int line;
+    char *lexeme;
+    int offset;
+    int length;
 } Token;
 
 /* lookup de palavra-chave */
@@ -2,6 +2,7 @@
 #define TYPES_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 /* Tipos básicos suportados pelo compilador */
 typedef enum {
@@ -31,5 +32,29 @@ typedef struct Type {
     } info; /* informações adicionais */
 } Type;
 
-#endif /* TYPES_H */
+/*
+ * Tipos internados: cada Type distinto é guardado uma única vez, e símbolos
+ * e nós da AST guardam só o identificador de 4 bytes. Dois identificadores
+ * são iguais se e somente se os tipos são iguais (mesma categoria e mesmos
+ * metadados). Os tipos básicos, com metadados zerados, têm identificadores
+ * fixos e não passam pela tabela; a categoria sai do próprio identificador.
+ */
+typedef uint32_t TypeId;
+
+#define TYPE_INT  ((TypeId)0)
+#define TYPE_DEC  ((TypeId)1)   /* decimal[0.0] */
+#define TYPE_TXT  ((TypeId)2)   /* texto[0] */
+#define TYPE_BOOL ((TypeId)3)
 
+/* Identificador do tipo, internando-o na primeira vez */
+TypeId type_intern(const Type *t);
+/* O tipo de um identificador; o ponteiro vale até o fim do processo (o
+ * Type internado nunca muda de lugar), mesmo com outras threads internando */
+const Type* type_get(TypeId id);
+TypeKind type_kind(TypeId id);
+/* Quantidade de tipos distintos internados (inclui os básicos) */
+size_t type_count(void);
+/* Enquanto ligado, type_intern pode ser chamado de várias threads */
+void types_set_threaded(int threaded);
+
+#endif /* TYPES_H */
@@ -1,13 +1,37 @@
 #ifndef UTIL_H
 #define UTIL_H
 
-void init_scanner(const char *path);
+#include <stddef.h>
 
-void close_scanner(void);
+/* Estado de leitura de caracteres; cada analisador pode ter o seu */
+typedef struct {
+    const char *src;
+    size_t len;                     /* fim da região lida */
+    size_t pos;
+    int line;
+    char *owned;                    /* buffer lido de arquivo (liberado no close) */
+} Scanner;
+
+void scanner_open(Scanner *sc, const char *path);
+/* Lê a partir de um buffer em memória (não copiado) */
+void scanner_init_buffer(Scanner *sc, const char *text, size_t len, int first_line);
+/* Lê text[start..end); os deslocamentos continuam relativos a text */
+void scanner_init_range(Scanner *sc, const char *text, size_t start, size_t end, int first_line);
+void scanner_close(Scanner *sc);
 
-int peek_char(void);
-int advance_char(void);
-void retreat_char(void);
+int scanner_peek(Scanner *sc);
+int scanner_advance(Scanner *sc);
+void scanner_retreat(Scanner *sc);
+int scanner_line(const Scanner *sc);
+/* Deslocamento em bytes a partir do início do buffer */
+size_t scanner_offset(const Scanner *sc);
+
+/* Scanner global, usado por next_token() */
+Scanner *global_scanner(void);
+void init_scanner(const char *path);
+void init_scanner_buffer(const char *text, size_t len, int first_line);
+void close_scanner(void);
 int current_line(void);
+size_t current_offset(void);
 
 #endif /* UTIL_H */
@@ -0,0 +1,336 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ast_binary.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+
+/* ========== Gravação ========== */
+
+/* Tabela de strings com deduplicação (endereçamento aberto) */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    uint32_t *slots;                /* posição + 1 na tabela; 0 = vazio */
+    size_t slot_count;
+    size_t used;
+} StringTable;
+
+static void *writer_alloc(void *ptr, size_t size) {
+    void *p = mm_realloc(ptr, size);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para gravar a AST\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static unsigned long string_hash(const char *s) {
+    unsigned long h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+static void strtab_rehash(StringTable *st, size_t slot_count) {
+    uint32_t *slots = writer_alloc(NULL, slot_count * sizeof(uint32_t));
+    size_t i;
+    memset(slots, 0, slot_count * sizeof(uint32_t));
+    for (i = 0; i < st->slot_count; i++) {
+        uint32_t pos = st->slots[i];
+        size_t j;
+        if (!pos) continue;
+        j = string_hash(st->data + pos - 1) & (slot_count - 1);
+        while (slots[j]) j = (j + 1) & (slot_count - 1);
+        slots[j] = pos;
+    }
+    if (st->slots) mm_free(st->slots);
+    st->slots = slots;
+    st->slot_count = slot_count;
+}
+
+static uint32_t strtab_add(StringTable *st, const char *s) {
+    size_t len, j;
+
+    if (!s) return AST_BIN_NONE;
+    if ((st->used + 1) * 2 > st->slot_count) {
+        strtab_rehash(st, st->slot_count ? st->slot_count * 2 : 256);
+    }
+    j = string_hash(s) & (st->slot_count - 1);
+    while (st->slots[j]) {
+        if (strcmp(st->data + st->slots[j] - 1, s) == 0) return st->slots[j] - 1;
+        j = (j + 1) & (st->slot_count - 1);
+    }
+
+    len = strlen(s) + 1;
+    if (st->size + len > st->capacity) {
+        while (st->size + len > st->capacity) {
+            st->capacity = st->capacity ? st->capacity * 2 : 1024;
+        }
+        st->data = writer_alloc(st->data, st->capacity);
+    }
+    memcpy(st->data + st->size, s, len);
+    st->slots[j] = (uint32_t)st->size + 1;
+    st->used++;
+    st->size += len;
+    return st->slots[j] - 1;
+}
+
+static AstWalkAction count_pre(AstWalker *w, ASTNode *node, void *data) {
+    (void)w;
+    /* A imagem leva a árvore inteira: corpos adiados são expandidos aqui */
+    ast_expand_body(node);
+    (*(uint32_t*)data)++;
+    return AST_WALK_CONTINUE;
+}
+
+int ast_binary_emit(ASTNode *root, OutSink *out) {
+    AstVisitor counter = {count_pre, NULL, NULL, 0, 0};
+    AstBinHeader header;
+    StringTable st;
+    ASTNode **queue;
+    AstBinNode *nodes;
+    uint32_t count = 0, head, tail;
+
+    if (!root) return 0;
+    counter.data = &count;
+    ast_walk(root, &counter);
+
+    /* Ordem em largura: os filhos de cada nó ocupam posições consecutivas */
+    queue = writer_alloc(NULL, count * sizeof(ASTNode*));
+    nodes = writer_alloc(NULL, count * sizeof(AstBinNode));
+    memset(&st, 0, sizeof(st));
+    queue[0] = root;
+    tail = 1;
+    for (head = 0; head < tail; head++) {
+        ASTNode *node = queue[head];
+        AstBinNode *rec = &nodes[head];
+        const Type *type;
+        int i;
+
+        rec->type = node->type;
+        rec->token_type = node->token.type;
+        rec->line = node->token.line;
+        rec->offset = node->token.offset;
+        rec->length = node->token.length;
+        rec->lexeme = strtab_add(&st, node->token.lexeme);
+        rec->value = strtab_add(&st, node->value);
+        rec->first_child = tail;
+        rec->child_count = 0;
+        type = type_get(node->inferred_type);
+        rec->type_kind = type->kind;
+        if (type->kind == TY_TXT) {
+            rec->type_a = (int32_t)type->info.txt.n;
+            rec->type_b = 0;
+        } else {
+            rec->type_a = type->info.dec.a;
+            rec->type_b = type->info.dec.b;
+        }
+        for (i = 0; i < node->child_count; i++) {
+            if (!node->children[i]) continue;
+            queue[tail++] = node->children[i];
+            rec->child_count++;
+        }
+    }
+
+    memcpy(header.magic, AST_BIN_MAGIC, 4);
+    header.version = AST_BIN_VERSION;
+    header.byte_order = AST_BIN_BYTE_ORDER;
+    header.node_size = sizeof(AstBinNode);
+    header.node_count = count;
+    header.string_size = (uint32_t)st.size;
+
+    /* Os vetores grandes seguem direto para writev, sem cópia no buffer */
+    out_write(out, &header, sizeof(header));
+    out_write(out, nodes, count * sizeof(AstBinNode));
+    out_write(out, st.data, st.size);
+
+    mm_free(queue);
+    mm_free(nodes);
+    if (st.data) mm_free(st.data);
+    if (st.slots) mm_free(st.slots);
+    return out_flush(out);
+}
+
+int ast_binary_write(ASTNode *root, const char *path) {
+    char buffer[4096];
+    OutSink out;
+    int fd, ok;
+
+    if (!root) return 0;
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok = fd >= 0;
+    if (ok) {
+        out_init(&out, fd, buffer, sizeof(buffer));
+        ok = ast_binary_emit(root, &out);
+        ok = (close(fd) == 0) && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "Erro: não foi possível gravar a AST em '%s'\n", path);
+    }
+    return ok;
+}
+
+/* ========== Carregamento ========== */
+
+static int load_error(const char *path, const char *reason) {
+    fprintf(stderr, "Erro: '%s' não é uma AST binária válida (%s)\n", path, reason);
+    return 0;
+}
+
+/* Confere cabeçalho, tamanhos, referências e enumerações: depois disso os
+ * acessores não precisam de verificações. Como na gravação (ordem em
+ * largura), os filhos de cada pai começam no primeiro nó ainda sem pai, e
+ * todo nó além da raiz tem exatamente um pai anterior a ele: a árvore não
+ * tem ciclos nem subárvores compartilhadas. */
+static int validate(AstFile *file, const char *path) {
+    const AstBinHeader *h = file->header;
+    uint32_t i, next = 1;           /* primeiro nó ainda sem pai */
+
+    if (file->size < sizeof(AstBinHeader)) return load_error(path, "arquivo truncado");
+    if (memcmp(h->magic, AST_BIN_MAGIC, 4) != 0) return load_error(path, "assinatura");
+    if (h->version != AST_BIN_VERSION) return load_error(path, "versão");
+    if (h->byte_order != AST_BIN_BYTE_ORDER) return load_error(path, "ordem de bytes");
+    if (h->node_size != sizeof(AstBinNode)) return load_error(path, "tamanho do nó");
+    if (h->node_count == 0 ||
+        file->size != sizeof(AstBinHeader) + (size_t)h->node_count * sizeof(AstBinNode) + h->string_size) {
+        return load_error(path, "tamanho do arquivo");
+    }
+    file->strings = (const char*)(file->nodes + h->node_count);
+    if (h->string_size > 0 && file->strings[h->string_size - 1] != '\0') {
+        return load_error(path, "tabela de strings");
+    }
+
+    for (i = 0; i < h->node_count; i++) {
+        const AstBinNode *n = &file->nodes[i];
+        if ((n->lexeme != AST_BIN_NONE && n->lexeme >= h->string_size) ||
+            (n->value != AST_BIN_NONE && n->value >= h->string_size)) {
+            return load_error(path, "referência de string");
+        }
+        if (n->type > AST_RETURN_STMT || n->token_type > TOK_ERROR || n->type_kind > TY_BOOL) {
+            return load_error(path, "tipo de nó, de token ou inferido");
+        }
+        /* Um nó sem pai até aqui ficaria fora da árvore */
+        if (i > 0 && i >= next) return load_error(path, "nó sem pai");
+        if (n->child_count > 0 &&
+            (n->first_child != next || n->child_count > h->node_count - next)) {
+            return load_error(path, "referência de filho");
+        }
+        next += n->child_count;
+    }
+    if (next != h->node_count) return load_error(path, "nó sem pai");
+    return 1;
+}
+
+int ast_file_open(AstFile *file, const char *path) {
+    struct stat info;
+    int fd;
+
+    memset(file, 0, sizeof(*file));
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Erro: não foi possível abrir '%s'\n", path);
+        return 0;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return load_error(path, "arquivo vazio");
+    }
+
+    file->size = (size_t)info.st_size;
+    file->map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file->map == MAP_FAILED) {
+        file->map = NULL;
+        fprintf(stderr, "Erro: não foi possível mapear '%s'\n", path);
+        return 0;
+    }
+
+    file->header = file->map;
+    file->nodes = (const AstBinNode*)((const char*)file->map + sizeof(AstBinHeader));
+    if (!validate(file, path)) {
+        ast_file_close(file);
+        return 0;
+    }
+    return 1;
+}
+
+void ast_file_close(AstFile *file) {
+    if (file->map) munmap(file->map, file->size);
+    memset(file, 0, sizeof(*file));
+}
+
+const AstBinNode* ast_file_root(const AstFile *file) {
+    return &file->nodes[0];
+}
+
+const AstBinNode* ast_file_child(const AstFile *file, const AstBinNode *node, uint32_t index) {
+    if (index >= node->child_count) return NULL;
+    return &file->nodes[node->first_child + index];
+}
+
+const char* ast_file_lexeme(const AstFile *file, const AstBinNode *node) {
+    return node->lexeme == AST_BIN_NONE ? NULL : file->strings + node->lexeme;
+}
+
+const char* ast_file_value(const AstFile *file, const AstBinNode *node) {
+    return node->value == AST_BIN_NONE ? NULL : file->strings + node->value;
+}
+
+Type ast_file_type(const AstBinNode *node) {
+    Type t;
+    t.kind = (TypeKind)node->type_kind;
+    if (t.kind == TY_TXT) {
+        t.info.txt.n = (size_t)node->type_a;
+    } else {
+        t.info.dec.a = node->type_a;
+        t.info.dec.b = node->type_b;
+    }
+    return t;
+}
+
+ASTNode* ast_file_to_tree(const AstFile *file) {
+    uint32_t count = file->header->node_count, i, j;
+    ASTNode **built = writer_alloc(NULL, count * sizeof(ASTNode*));
+    ASTNode *root;
+
+    for (i = 0; i < count; i++) {
+        const AstBinNode *rec = &file->nodes[i];
+        const char *value = ast_file_value(file, rec);
+        Token token;
+        Type type;
+
+        token.type = (TokenType)rec->token_type;
+        token.line = rec->line;
+        token.lexeme = (char*)ast_file_lexeme(file, rec);
+        token.offset = rec->offset;
+        token.length = rec->length;
+        built[i] = ast_node_create((ASTNodeType)rec->type, token);
+        type = ast_file_type(rec);
+        built[i]->inferred_type = type_intern(&type);
+        if (value) {
+            /* free_ast libera value: precisa ser uma cópia própria */
+            built[i]->value = writer_alloc(NULL, strlen(value) + 1);
+            strcpy(built[i]->value, value);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        const AstBinNode *rec = &file->nodes[i];
+        if (rec->child_count == 0) continue;
+        built[i]->children = writer_alloc(NULL, rec->child_count * sizeof(ASTNode*));
+        built[i]->child_capacity = (int)rec->child_count;
+        for (j = 0; j < rec->child_count; j++) {
+            built[i]->children[built[i]->child_count++] = built[rec->first_child + j];
+        }
+    }
+
+    root = built[0];
+    mm_free(built);
+    return root;
+}
@@ -0,0 +1,98 @@
+#include "ast_walk.h"
+#include "memmgr.h"
+#include <string.h>
+
+static void walk_grow(AstWalker *w) {
+    int new_capacity = w->capacity * 2;
+    if (w->frames == w->inline_frames) {
+        AstWalkFrame *frames = mm_malloc(new_capacity * sizeof(AstWalkFrame));
+        memcpy(frames, w->inline_frames, w->depth * sizeof(AstWalkFrame));
+        w->frames = frames;
+    } else {
+        w->frames = mm_realloc(w->frames, new_capacity * sizeof(AstWalkFrame));
+    }
+    w->capacity = new_capacity;
+}
+
+/* Empilha o nó e chama a pré-ordem; devolve 1 se os filhos devem ser visitados.
+   Nós ignorados (ou sem filhos) recebem a pós-ordem e saem da pilha na hora. */
+static int walk_enter(AstWalker *w, ASTNode *node, int tag) {
+    const AstVisitor *v = w->visitor;
+    AstWalkFrame *frame;
+
+    if (w->depth == w->capacity) walk_grow(w);
+    frame = &w->frames[w->depth++];
+    frame->node = node;
+    frame->next_child = 0;
+    frame->tag = tag;
+
+    if ((!v->pre || v->pre(w, node, v->data) == AST_WALK_CONTINUE) &&
+        node->child_count > 0 && !(v->prune & AST_WALK_MASK(node->type))) {
+        return 1;
+    }
+    if (v->post) v->post(w, node, v->data);
+    w->depth--;
+    return 0;
+}
+
+void ast_walk(ASTNode *root, const AstVisitor *visitor) {
+    AstWalker w;
+    if (!root || !visitor) return;
+
+    w.visitor = visitor;
+    w.frames = w.inline_frames;
+    w.depth = 0;
+    w.capacity = AST_WALK_INLINE_FRAMES;
+
+    walk_enter(&w, root, visitor->root_tag);
+    while (w.depth > 0) {
+        AstWalkFrame *top = &w.frames[w.depth - 1];
+        ASTNode *node = top->node;
+        int descended = 0;
+
+        /* Visita os filhos em sequência até encontrar um que precise descer */
+        while (top->next_child < node->child_count) {
+            ASTNode *child = node->children[top->next_child++];
+            if (child && walk_enter(&w, child, top->tag)) {
+                descended = 1;
+                break;
+            }
+            top = &w.frames[w.depth - 1];   /* a pilha pode ter sido realocada */
+        }
+
+        if (!descended) {
+            if (visitor->post) visitor->post(&w, node, visitor->data);
+            w.depth--;
+        }
+    }
+
+    if (w.frames != w.inline_frames) mm_free(w.frames);
+}
+
+int ast_walk_depth(AstWalker *w) {
+    return w->depth - 1;
+}
+
+ASTNode* ast_walk_parent(AstWalker *w) {
+    return w->depth > 1 ? w->frames[w->depth - 2].node : NULL;
+}
+
+int ast_walk_child_index(AstWalker *w) {
+    return w->depth > 1 ? w->frames[w->depth - 2].next_child - 1 : -1;
+}
+
+int ast_walk_parent_tag(AstWalker *w) {
+    return w->depth > 1 ? w->frames[w->depth - 2].tag : w->visitor->root_tag;
+}
+
+int ast_walk_tag(AstWalker *w) {
+    return w->frames[w->depth - 1].tag;
+}
+
+void ast_walk_set_tag(AstWalker *w, int tag) {
+    w->frames[w->depth - 1].tag = tag;
+}
+
+void ast_walk_skip_to_child(AstWalker *w, int index) {
+    w->frames[w->depth - 1].next_child = index;
+}
@@ -0,0 +1,429 @@
+#include "cfg.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* alloc(size_t size) {
+    void *p = mm_malloc(size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para o grafo de fluxo de controle\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) {
+        fprintf(stderr, "Erro: memória insuficiente para o grafo de fluxo de controle\n");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+typedef struct {
+    int from, to;                   /* to == -1: para a saída */
+} Edge;
+
+/* Comando de controle em curso */
+typedef struct {
+    int join;                       /* 'se': junção; laços: cabeçalho */
+    int other;                      /* 'se': senão; laços: saída */
+} Ctx;
+
+typedef struct {
+    Cfg *g;
+    const char *source;
+    size_t len;
+    AstVisitor visitor;
+    int var_capacity, event_capacity, block_capacity;
+    Edge *edges;
+    int edge_count, edge_capacity;
+    int *slots;                     /* nome -> variável, endereçamento aberto */
+    int slot_capacity;
+    Ctx *ctx;
+    int ctx_count, ctx_capacity;
+    ASTNode *decl;                  /* declaração em curso */
+    int next_declarator;
+    int format_child;               /* o formato [a.b] do declarador, não lido */
+    int cur;                        /* bloco corrente */
+} Builder;
+
+/* ----- Variáveis ----- */
+
+static unsigned name_hash(const char *name) {
+    unsigned h = 2166136261u;
+    while (*name) h = (h ^ (unsigned char)*name++) * 16777619u;
+    return h;
+}
+
+static int* find_slot(Builder *b, const char *name) {
+    unsigned mask = (unsigned)b->slot_capacity - 1, h;
+    for (h = name_hash(name) & mask; b->slots[h] >= 0; h = (h + 1) & mask) {
+        if (strcmp(b->g->vars[b->slots[h]].name, name) == 0) break;
+    }
+    return &b->slots[h];
+}
+
+static int lookup(Builder *b, const char *name) {
+    return b->slot_capacity > 0 && name ? *find_slot(b, name) : -1;
+}
+
+/* A primeira declaração do nome vale (a análise semântica acusa as outras) */
+static int declare(Builder *b, const ASTNode *id, int param) {
+    Cfg *g = b->g;
+    int *slot, i;
+    if (lookup(b, id->token.lexeme) >= 0) return -1;
+    if ((g->var_count + 1) * 2 > b->slot_capacity) {
+        b->slot_capacity = b->slot_capacity ? b->slot_capacity * 2 : 64;
+        if (b->slots) mm_free(b->slots);
+        b->slots = alloc(sizeof(int) * (size_t)b->slot_capacity);
+        if (!b->slots) {
+            fprintf(stderr, "Erro: memória insuficiente para o grafo de fluxo de controle\n");
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < b->slot_capacity; i++) b->slots[i] = -1;
+        for (i = 0; i < g->var_count; i++) *find_slot(b, g->vars[i].name) = i;
+    }
+    g->vars = grow(g->vars, g->var_count, &b->var_capacity, sizeof(CfgVar));
+    g->vars[g->var_count].name = id->token.lexeme;
+    g->vars[g->var_count].line = id->token.line;
+    g->vars[g->var_count].param = param;
+    slot = find_slot(b, id->token.lexeme);
+    *slot = g->var_count;
+    return g->var_count++;
+}
+
+static void event(Builder *b, int var, CfgEventKind kind, int line) {
+    Cfg *g = b->g;
+    if (var < 0) return;
+    g->events = grow(g->events, g->event_count, &b->event_capacity, sizeof(CfgEvent));
+    g->events[g->event_count].var = var;
+    g->events[g->event_count].kind = kind;
+    g->events[g->event_count].line = line;
+    g->event_count++;
+}
+
+/* ----- Blocos ----- */
+
+static int new_block(Builder *b) {
+    Cfg *g = b->g;
+    g->blocks = grow(g->blocks, g->block_count, &b->block_capacity, sizeof(CfgBlock));
+    memset(&g->blocks[g->block_count], 0, sizeof(CfgBlock));
+    return g->block_count++;
+}
+
+/* Os eventos de cada bloco são contíguos: um bloco só começa quando o
+ * anterior termina, e nunca é retomado */
+static void enter(Builder *b, int block) {
+    Cfg *g = b->g;
+    g->blocks[b->cur].count = g->event_count - g->blocks[b->cur].first;
+    g->blocks[block].first = g->event_count;
+    b->cur = block;
+}
+
+static void edge(Builder *b, int from, int to) {
+    b->edges = grow(b->edges, b->edge_count, &b->edge_capacity, sizeof(Edge));
+    b->edges[b->edge_count].from = from;
+    b->edges[b->edge_count].to = to;
+    b->edge_count++;
+}
+
+static Ctx* top_ctx(Builder *b) {
+    return &b->ctx[b->ctx_count - 1];
+}
+
+static void push_ctx(Builder *b) {
+    b->ctx = grow(b->ctx, b->ctx_count, &b->ctx_capacity, sizeof(Ctx));
+    b->ctx[b->ctx_count].join = b->ctx[b->ctx_count].other = -1;
+    b->ctx_count++;
+}
+
+/* Condição de 'se' avaliada: desvia para o então (e o senão) */
+static void if_then(Builder *b, const ASTNode *stmt) {
+    Ctx *c = top_ctx(b);
+    int then_block = new_block(b);
+    c->other = stmt->child_count > 2 ? new_block(b) : -1;
+    c->join = new_block(b);
+    edge(b, b->cur, then_block);
+    edge(b, b->cur, c->other >= 0 ? c->other : c->join);
+    enter(b, then_block);
+}
+
+static void loop_header(Builder *b) {
+    int header = new_block(b);
+    edge(b, b->cur, header);
+    enter(b, header);
+    top_ctx(b)->join = header;
+}
+
+/* Condição do laço avaliada: desvia para o corpo ou a saída */
+static void loop_body(Builder *b) {
+    Ctx *c = top_ctx(b);
+    int body = new_block(b);
+    c->other = new_block(b);
+    edge(b, b->cur, body);
+    edge(b, b->cur, c->other);
+    enter(b, body);
+}
+
+static void loop_end(Builder *b) {
+    Ctx *c = top_ctx(b);
+    edge(b, b->cur, c->join);
+    enter(b, c->other);
+    b->ctx_count--;
+}
+
+/* ----- Percurso ----- */
+
+static AstWalkAction build_pre(AstWalker *w, ASTNode *node, void *data) {
+    Builder *b = (Builder*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w);
+
+    ast_walk_set_tag(w, 0);
+    if (parent) {
+        switch (parent->type) {
+            case AST_IF_STMT:
+                if (index == 1) {
+                    if_then(b, parent);
+                } else if (index == 2) {
+                    edge(b, b->cur, top_ctx(b)->join);
+                    enter(b, top_ctx(b)->other);
+                }
+                break;
+            case AST_WHILE_STMT:
+                if (index == 1) loop_body(b);
+                break;
+            case AST_FOR_STMT:
+                /* O incremento vem depois do corpo (em build_post) */
+                if (index == 1) {
+                    loop_header(b);
+                } else if (index == 2) {
+                    loop_body(b);
+                    return AST_WALK_SKIP;
+                }
+                break;
+            case AST_DECLARATION:
+                if (parent == b->decl && index == b->next_declarator) {
+                    char arg = ast_declarator_arg(parent, index, b->source, b->len);
+                    b->next_declarator += arg ? 2 : 1;
+                    b->format_child = arg == '[' ? index + 1 : -1;
+                    if (node->type == AST_IDENTIFIER && node->token.lexeme) declare(b, node, 0);
+                    ast_walk_set_tag(w, 1);
+                    return AST_WALK_SKIP;
+                } else if (parent == b->decl && index == b->format_child) {
+                    ast_walk_set_tag(w, 1);
+                    return AST_WALK_SKIP;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (node->type) {
+        case AST_IF_STMT:
+        case AST_FOR_STMT:
+            push_ctx(b);
+            break;
+        case AST_WHILE_STMT:
+            push_ctx(b);
+            loop_header(b);
+            break;
+        case AST_DECLARATION:
+            b->decl = node;
+            b->next_declarator = 0;
+            b->format_child = -1;
+            break;
+        case AST_FUNCTION_CALL:
+            /* O nome não é lido */
+            ast_walk_skip_to_child(w, 1);
+            break;
+        default:
+            break;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void build_post(AstWalker *w, ASTNode *node, void *data) {
+    Builder *b = (Builder*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w), i;
+
+    if (ast_walk_tag(w)) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            if (parent && ((parent->type == AST_ASSIGNMENT && index == 0) ||
+                           parent->type == AST_READ_STMT)) break;
+            event(b, lookup(b, node->token.lexeme), CFG_USE, node->token.line);
+            break;
+
+        case AST_ASSIGNMENT:
+            if (parent && parent->type == AST_FOR_STMT && index == 2) break;
+            if (node->child_count > 0 && node->children[0]) {
+                const ASTNode *id = node->children[0];
+                event(b, lookup(b, id->token.lexeme), CFG_ASSIGN, id->token.line);
+            }
+            break;
+
+        case AST_READ_STMT:
+            for (i = 0; i < node->child_count; i++) {
+                const ASTNode *id = node->children[i];
+                if (id && id->type == AST_IDENTIFIER) {
+                    event(b, lookup(b, id->token.lexeme), CFG_READ, id->token.line);
+                }
+            }
+            break;
+
+        case AST_DECLARATION:
+            b->decl = NULL;
+            break;
+
+        case AST_RETURN_STMT:
+            /* O que segue no bloco é inalcançável */
+            edge(b, b->cur, -1);
+            enter(b, new_block(b));
+            break;
+
+        case AST_IF_STMT:
+            edge(b, b->cur, top_ctx(b)->join);
+            enter(b, top_ctx(b)->join);
+            b->ctx_count--;
+            break;
+
+        case AST_WHILE_STMT:
+            loop_end(b);
+            break;
+
+        case AST_FOR_STMT:
+            if (node->child_count > 2) ast_walk(node->children[2], &b->visitor);
+            loop_end(b);
+            break;
+
+        default:
+            break;
+    }
+
+    /* Inicialização avaliada: atribui o declarador anterior */
+    if (parent && parent == b->decl && index > 0 && index == b->next_declarator - 1 &&
+        ast_declarator_arg(parent, index - 1, b->source, b->len) == '=') {
+        const ASTNode *id = parent->children[index - 1];
+        event(b, lookup(b, id->token.lexeme), CFG_INIT, id->token.line);
+    }
+}
+
+static void add_params(Builder *b, const ASTNode *def) {
+    int i, k;
+    for (i = 1; i < def->child_count; i++) {
+        const ASTNode *decl = def->children[i];
+        if (!decl || decl->type != AST_DECLARATION) continue;
+        for (k = 0; k < decl->child_count; k++) {
+            const ASTNode *id = decl->children[k];
+            if (!id || id->type != AST_IDENTIFIER || !id->token.lexeme) continue;
+            event(b, declare(b, id, 1), CFG_PARAM, id->token.line);
+        }
+    }
+}
+
+/* Arestas em CSR: sucessores e predecessores de cada bloco */
+static void link_edges(Builder *b, int exit_block) {
+    Cfg *g = b->g;
+    int *succ_fill, *pred_fill, i;
+
+    g->edge_count = b->edge_count;
+    g->succs = alloc(sizeof(int) * (size_t)(b->edge_count + 1));
+    g->preds = alloc(sizeof(int) * (size_t)(b->edge_count + 1));
+    succ_fill = alloc(sizeof(int) * (size_t)(g->block_count + 1));
+    pred_fill = alloc(sizeof(int) * (size_t)(g->block_count + 1));
+    if (!g->succs || !g->preds || !succ_fill || !pred_fill) {
+        fprintf(stderr, "Erro: memória insuficiente para o grafo de fluxo de controle\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < b->edge_count; i++) {
+        if (b->edges[i].to < 0) b->edges[i].to = exit_block;
+        g->blocks[b->edges[i].from].succ_count++;
+        g->blocks[b->edges[i].to].pred_count++;
+    }
+    for (i = 0; i < g->block_count; i++) {
+        g->blocks[i].succ_first = i > 0 ? g->blocks[i - 1].succ_first + g->blocks[i - 1].succ_count : 0;
+        g->blocks[i].pred_first = i > 0 ? g->blocks[i - 1].pred_first + g->blocks[i - 1].pred_count : 0;
+        succ_fill[i] = g->blocks[i].succ_first;
+        pred_fill[i] = g->blocks[i].pred_first;
+    }
+    for (i = 0; i < b->edge_count; i++) {
+        g->succs[succ_fill[b->edges[i].from]++] = b->edges[i].to;
+        g->preds[pred_fill[b->edges[i].to]++] = b->edges[i].from;
+    }
+    mm_free(succ_fill);
+    mm_free(pred_fill);
+}
+
+Cfg* cfg_build(ASTNode *func, const char *source, size_t len) {
+    Builder b;
+    Cfg *g = alloc(sizeof(Cfg));
+    int exit_block, i;
+
+    if (!g) {
+        fprintf(stderr, "Erro: memória insuficiente para o grafo de fluxo de controle\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(g, 0, sizeof(Cfg));
+    memset(&b, 0, sizeof(Builder));
+    b.g = g;
+    b.source = source;
+    b.len = len;
+    b.visitor.pre = build_pre;
+    b.visitor.post = build_post;
+    b.visitor.data = &b;
+    b.format_child = -1;
+    g->line = func->token.line;
+    b.cur = new_block(&b);
+
+    if (func->type == AST_FUNCTION_DEF) {
+        g->name = func->child_count > 0 && func->children[0] ? func->children[0]->token.lexeme : "?";
+        add_params(&b, func);
+        for (i = 1; i < func->child_count; i++) {
+            if (func->children[i] && func->children[i]->type == AST_BLOCK) {
+                ast_walk(func->children[i], &b.visitor);
+            }
+        }
+    } else {
+        g->name = "principal";
+        for (i = 0; i < func->child_count; i++) {
+            if (func->children[i]) ast_walk(func->children[i], &b.visitor);
+        }
+    }
+
+    edge(&b, b.cur, -1);
+    exit_block = new_block(&b);
+    enter(&b, exit_block);
+    g->blocks[exit_block].count = 0;
+    link_edges(&b, exit_block);
+
+    if (b.edges) mm_free(b.edges);
+    if (b.slots) mm_free(b.slots);
+    if (b.ctx) mm_free(b.ctx);
+    return g;
+}
+
+void cfg_free(Cfg *g) {
+    if (!g) return;
+    if (g->vars) mm_free(g->vars);
+    if (g->events) mm_free(g->events);
+    if (g->blocks) mm_free(g->blocks);
+    if (g->succs) mm_free(g->succs);
+    if (g->preds) mm_free(g->preds);
+    mm_free(g);
+}
+
+size_t cfg_size(const Cfg *g) {
+    return sizeof(Cfg) + (size_t)g->var_count * sizeof(CfgVar) +
+           (size_t)g->event_count * sizeof(CfgEvent) + (size_t)g->block_count * sizeof(CfgBlock) +
+           2 * (size_t)g->edge_count * sizeof(int);
+}
@@ -0,0 +1,453 @@
+#include "dataflow.h"
+#include "memmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void* alloc(size_t size) {
+    void *p = mm_malloc(size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a análise de fluxo de dados\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static BitWord* alloc_sets(int blocks, int words) {
+    size_t size = sizeof(BitWord) * (size_t)blocks * (size_t)words;
+    BitWord *p = alloc(size);
+    memset(p, 0, size);
+    return p;
+}
+
+/* Todos os bits do conjunto, sem os da sobra da última palavra */
+static void fill_all(BitWord *set, int bits, int words) {
+    int i;
+    for (i = 0; i < words; i++) set[i] = ~0UL;
+    if (bits % BITWORD_BITS) set[words - 1] = (1UL << (bits % BITWORD_BITS)) - 1;
+}
+
+/*
+ * Blocos em pós-ordem reversa a partir da entrada, por busca em
+ * profundidade sem recursão; os inalcançáveis vêm depois, na ordem dos
+ * índices. Os sucessores são visitados do último para o primeiro: a saída
+ * de um laço termina antes do corpo, que fica logo depois do cabeçalho.
+ * Retorna quantos são alcançáveis.
+ */
+static int block_order(const Cfg *g, int *order, unsigned char *reachable) {
+    int n = g->block_count, count = 0, top = 0, i;
+    int *stack = alloc(sizeof(int) * (size_t)(n + 1));
+    int *next = alloc(sizeof(int) * (size_t)(n + 1));
+
+    memset(reachable, 0, (size_t)n);
+    if (n > 0) {
+        reachable[0] = 1;
+        stack[top] = 0;
+        next[top++] = g->blocks[0].succ_count;
+    }
+    while (top > 0) {
+        int b = stack[top - 1];
+        if (next[top - 1] > 0) {
+            int s = g->succs[g->blocks[b].succ_first + --next[top - 1]];
+            if (!reachable[s]) {
+                reachable[s] = 1;
+                stack[top] = s;
+                next[top++] = g->blocks[s].succ_count;
+            }
+            continue;
+        }
+        order[count++] = b;
+        top--;
+    }
+    for (i = 0; i < count / 2; i++) {
+        int t = order[i];
+        order[i] = order[count - 1 - i];
+        order[count - 1 - i] = t;
+    }
+    top = count;
+    for (i = 0; i < n; i++) {
+        if (!reachable[i]) order[top++] = i;
+    }
+    mm_free(stack);
+    mm_free(next);
+    return count;
+}
+
+void dataflow_solve(const Cfg *g, const DataflowProblem *p, DataflowSolution *s) {
+    int n = g->block_count, words = BITSET_WORDS(p->bits), forward = p->direction == DATAFLOW_FORWARD;
+    int *order = alloc(sizeof(int) * (size_t)(n + 1));
+    int *position = alloc(sizeof(int) * (size_t)(n + 1));
+    unsigned char *reachable = alloc((size_t)n + 1);
+    BitWord *pending = alloc_sets(1, BITSET_WORDS(n) + 1);
+    BitWord *meet = alloc(sizeof(BitWord) * (size_t)(words + 1));
+    int cursor = 0, i, b, k;
+
+    s->words = words;
+    s->in = alloc_sets(n, words);
+    s->out = alloc_sets(n, words);
+    s->visits = 0;
+
+    /* Para a frente, a pós-ordem reversa; para trás, a pós-ordem. A lista
+     * de trabalho é um conjunto de posições nessa ordem, e sai sempre a
+     * menor: uma volta de laço se estabiliza antes de o resto seguir. */
+    block_order(g, order, reachable);
+    for (i = 0; !forward && i < n / 2; i++) {
+        b = order[i];
+        order[i] = order[n - 1 - i];
+        order[n - 1 - i] = b;
+    }
+    for (i = 0; i < n; i++) position[order[i]] = i;
+    if (n > 0) fill_all(pending, n, BITSET_WORDS(n));
+    if (p->meet == DATAFLOW_INTERSECTION && words > 0) {
+        /* O que a análise produz começa cheio: só encolhe */
+        for (b = 0; b < n; b++) fill_all((forward ? s->out : s->in) + (size_t)b * words, p->bits, words);
+    }
+
+    for (;;) {
+        int edges, first, changed = 0;
+        const int *nbr;
+        BitWord *src, *dst;
+        const BitWord *gen, *kill;
+
+        /* Próxima posição pendente a partir do cursor */
+        while (cursor < n && !(pending[cursor / BITWORD_BITS] >> (cursor % BITWORD_BITS))) {
+            cursor = (cursor / BITWORD_BITS + 1) * BITWORD_BITS;
+        }
+        if (cursor >= n) break;
+        while (!BITSET_TEST(pending, cursor)) cursor++;
+        BITSET_CLEAR(pending, cursor);
+        b = order[cursor];
+        s->visits++;
+
+        /* Encontro sobre os vizinhos de onde o fluxo vem */
+        edges = forward ? g->blocks[b].pred_count : g->blocks[b].succ_count;
+        first = forward ? g->blocks[b].pred_first : g->blocks[b].succ_first;
+        nbr = forward ? g->preds : g->succs;
+        if ((forward && b == 0) || (!forward && edges == 0 && b == n - 1)) {
+            for (i = 0; i < words; i++) meet[i] = p->boundary ? p->boundary[i] : 0;
+        } else if (p->meet == DATAFLOW_INTERSECTION) {
+            if (words > 0) fill_all(meet, p->bits, words);
+            for (k = 0; k < edges; k++) {
+                const BitWord *x = (forward ? s->out : s->in) + (size_t)nbr[first + k] * words;
+                for (i = 0; i < words; i++) meet[i] &= x[i];
+            }
+        } else {
+            for (i = 0; i < words; i++) meet[i] = 0;
+            for (k = 0; k < edges; k++) {
+                const BitWord *x = (forward ? s->out : s->in) + (size_t)nbr[first + k] * words;
+                for (i = 0; i < words; i++) meet[i] |= x[i];
+            }
+        }
+
+        /* src recebe o encontro; dst = gen | (src & ~kill) */
+        src = (forward ? s->in : s->out) + (size_t)b * words;
+        dst = (forward ? s->out : s->in) + (size_t)b * words;
+        gen = p->gen + (size_t)b * words;
+        kill = p->kill + (size_t)b * words;
+        for (i = 0; i < words; i++) {
+            BitWord x = gen[i] | (meet[i] & ~kill[i]);
+            src[i] = meet[i];
+            if (x != dst[i]) {
+                dst[i] = x;
+                changed = 1;
+            }
+        }
+        if (!changed) continue;
+
+        /* Os vizinhos para onde o fluxo vai voltam à lista; uma aresta de
+         * retorno faz o cursor recuar */
+        edges = forward ? g->blocks[b].succ_count : g->blocks[b].pred_count;
+        first = forward ? g->blocks[b].succ_first : g->blocks[b].pred_first;
+        nbr = forward ? g->succs : g->preds;
+        for (k = 0; k < edges; k++) {
+            int x = position[nbr[first + k]];
+            BITSET_SET(pending, x);
+            if (x < cursor) cursor = x;
+        }
+    }
+
+    mm_free(order);
+    mm_free(position);
+    mm_free(reachable);
+    mm_free(pending);
+    mm_free(meet);
+}
+
+void dataflow_free(DataflowSolution *s) {
+    mm_free(s->in);
+    mm_free(s->out);
+    s->in = s->out = NULL;
+}
+
+static int is_def(const CfgEvent *e) {
+    return e->kind != CFG_USE;
+}
+
+void dataflow_liveness(const Cfg *g, DataflowSolution *s) {
+    DataflowProblem p;
+    int words = BITSET_WORDS(g->var_count), b, i;
+    BitWord *gen = alloc_sets(g->block_count, words), *kill = alloc_sets(g->block_count, words);
+
+    /* gen: lidas antes de atribuídas no bloco; kill: atribuídas */
+    for (b = 0; b < g->block_count; b++) {
+        BitWord *bg = gen + (size_t)b * words, *bk = kill + (size_t)b * words;
+        for (i = g->blocks[b].first; i < g->blocks[b].first + g->blocks[b].count; i++) {
+            const CfgEvent *e = &g->events[i];
+            if (is_def(e)) BITSET_SET(bk, e->var);
+            else if (!BITSET_TEST(bk, e->var)) BITSET_SET(bg, e->var);
+        }
+    }
+    p.direction = DATAFLOW_BACKWARD;
+    p.meet = DATAFLOW_UNION;
+    p.bits = g->var_count;
+    p.gen = gen;
+    p.kill = kill;
+    p.boundary = NULL;
+    dataflow_solve(g, &p, s);
+    mm_free(gen);
+    mm_free(kill);
+}
+
+void dataflow_definite_assignment(const Cfg *g, DataflowSolution *s) {
+    DataflowProblem p;
+    int words = BITSET_WORDS(g->var_count), b, i;
+    BitWord *gen = alloc_sets(g->block_count, words), *kill = alloc_sets(g->block_count, words);
+
+    /* Os parâmetros são atribuídos pelos eventos do bloco de entrada */
+    for (b = 0; b < g->block_count; b++) {
+        BitWord *bg = gen + (size_t)b * words;
+        for (i = g->blocks[b].first; i < g->blocks[b].first + g->blocks[b].count; i++) {
+            if (is_def(&g->events[i])) BITSET_SET(bg, g->events[i].var);
+        }
+    }
+    p.direction = DATAFLOW_FORWARD;
+    p.meet = DATAFLOW_INTERSECTION;
+    p.bits = g->var_count;
+    p.gen = gen;
+    p.kill = kill;
+    p.boundary = NULL;
+    dataflow_solve(g, &p, s);
+    mm_free(gen);
+    mm_free(kill);
+}
+
+void dataflow_reaching_definitions(const Cfg *g, ReachingDefs *r) {
+    DataflowProblem p;
+    int *def_of = alloc(sizeof(int) * (size_t)(g->event_count + 1));
+    int *stamp = alloc(sizeof(int) * (size_t)(g->var_count + 1));
+    int *fill, words, b, i, k;
+    BitWord *gen, *kill;
+
+    /* Definições numeradas na ordem dos eventos, e agrupadas por variável */
+    r->def_count = 0;
+    r->var_first = alloc(sizeof(int) * (size_t)(g->var_count + 1));
+    memset(r->var_first, 0, sizeof(int) * (size_t)(g->var_count + 1));
+    for (i = 0; i < g->event_count; i++) {
+        def_of[i] = is_def(&g->events[i]) ? r->def_count++ : -1;
+        if (def_of[i] >= 0) r->var_first[g->events[i].var + 1]++;
+    }
+    for (i = 0; i < g->var_count; i++) r->var_first[i + 1] += r->var_first[i];
+    r->def_event = alloc(sizeof(int) * (size_t)(r->def_count + 1));
+    r->var_defs = alloc(sizeof(int) * (size_t)(r->def_count + 1));
+    fill = alloc(sizeof(int) * (size_t)(g->var_count + 1));
+    memcpy(fill, r->var_first, sizeof(int) * (size_t)(g->var_count + 1));
+    for (i = 0; i < g->event_count; i++) {
+        if (def_of[i] < 0) continue;
+        r->def_event[def_of[i]] = i;
+        r->var_defs[fill[g->events[i].var]++] = def_of[i];
+    }
+
+    /* gen: a última definição de cada variável no bloco; kill: todas as
+     * definições das variáveis atribuídas nele */
+    words = BITSET_WORDS(r->def_count);
+    gen = alloc_sets(g->block_count, words);
+    kill = alloc_sets(g->block_count, words);
+    for (i = 0; i < g->var_count; i++) stamp[i] = -1;
+    for (b = 0; b < g->block_count; b++) {
+        BitWord *bg = gen + (size_t)b * words, *bk = kill + (size_t)b * words;
+        for (i = g->blocks[b].first + g->blocks[b].count - 1; i >= g->blocks[b].first; i--) {
+            int v = g->events[i].var;
+            if (def_of[i] < 0 || stamp[v] == b) continue;
+            stamp[v] = b;
+            BITSET_SET(bg, def_of[i]);
+            for (k = r->var_first[v]; k < r->var_first[v + 1]; k++) BITSET_SET(bk, r->var_defs[k]);
+        }
+    }
+    p.direction = DATAFLOW_FORWARD;
+    p.meet = DATAFLOW_UNION;
+    p.bits = r->def_count;
+    p.gen = gen;
+    p.kill = kill;
+    p.boundary = NULL;
+    dataflow_solve(g, &p, &r->solution);
+
+    mm_free(gen);
+    mm_free(kill);
+    mm_free(fill);
+    mm_free(stamp);
+    mm_free(def_of);
+}
+
+void dataflow_reaching_free(ReachingDefs *r) {
+    dataflow_free(&r->solution);
+    mm_free(r->def_event);
+    mm_free(r->var_first);
+    mm_free(r->var_defs);
+}
+
+/* ---------- Uso de variáveis ---------- */
+
+enum { DIAG_UNINITIALIZED, DIAG_MAYBE, DIAG_DEAD_STORE, DIAG_UNREAD };
+
+typedef struct {
+    int line;
+    int seq;                        /* ordem de detecção, para empates */
+    int kind;
+    int var;
+} Diag;
+
+typedef struct {
+    Diag *items;
+    int count, capacity;
+} DiagList;
+
+static void add_diag(DiagList *list, int line, int kind, int var) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->items = mm_realloc(list->items, sizeof(Diag) * (size_t)list->capacity);
+        if (!list->items) {
+            fprintf(stderr, "Erro: memória insuficiente para a análise de fluxo de dados\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->items[list->count].line = line;
+    list->items[list->count].seq = list->count;
+    list->items[list->count].kind = kind;
+    list->items[list->count].var = var;
+    list->count++;
+}
+
+static int compare_diag(const void *a, const void *b) {
+    const Diag *x = (const Diag*)a, *y = (const Diag*)b;
+    if (x->line != y->line) return x->line < y->line ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static void print_diag(const Cfg *g, const Diag *d) {
+    const CfgVar *v = &g->vars[d->var];
+    fprintf(stderr, "\033[33mAlerta de uso de variáveis (linha %d): ", d->line);
+    switch (d->kind) {
+        case DIAG_UNINITIALIZED:
+            fprintf(stderr, "variável %s lida sem ter recebido valor", v->name);
+            break;
+        case DIAG_MAYBE:
+            fprintf(stderr, "variável %s pode ser lida sem ter recebido valor", v->name);
+            break;
+        case DIAG_DEAD_STORE:
+            fprintf(stderr, "valor atribuído a %s nunca é lido", v->name);
+            break;
+        default:
+            fprintf(stderr, v->param ? "parâmetro %s nunca é lido" : "variável %s declarada e nunca lida",
+                    v->name);
+            break;
+    }
+    fprintf(stderr, "\033[0m\n");
+}
+
+/* Alguma definição de var alcança a entrada do bloco */
+static int reaches(const ReachingDefs *r, int block, int var) {
+    const BitWord *in = r->solution.in + (size_t)block * r->solution.words;
+    int k;
+    for (k = r->var_first[var]; k < r->var_first[var + 1]; k++) {
+        if (BITSET_TEST(in, r->var_defs[k])) return 1;
+    }
+    return 0;
+}
+
+void dataflow_check_usage(const Cfg *g, VarUsageStats *stats) {
+    DataflowSolution assigned, live;
+    ReachingDefs reaching;
+    DiagList diags = {NULL, 0, 0};
+    int words = BITSET_WORDS(g->var_count), have_reaching = 0, b, i;
+    int *order = alloc(sizeof(int) * (size_t)(g->block_count + 1));
+    unsigned char *reachable = alloc((size_t)g->block_count + 1);
+    unsigned char *read = alloc((size_t)g->var_count + 1);
+    unsigned char *reported = alloc((size_t)g->var_count + 1);
+    BitWord *cur = alloc(sizeof(BitWord) * (size_t)(words + 1));
+
+    memset(read, 0, (size_t)g->var_count + 1);
+    memset(reported, 0, (size_t)g->var_count + 1);
+    for (i = 0; i < g->event_count; i++) {
+        if (g->events[i].kind == CFG_USE) read[g->events[i].var] = 1;
+    }
+    block_order(g, order, reachable);
+    dataflow_definite_assignment(g, &assigned);
+    dataflow_liveness(g, &live);
+
+    for (b = 0; b < g->block_count; b++) {
+        const CfgBlock *blk = &g->blocks[b];
+        if (!reachable[b]) continue;
+
+        /* Leituras sem atribuição em todos os caminhos até elas */
+        memcpy(cur, assigned.in + (size_t)b * words, sizeof(BitWord) * (size_t)words);
+        for (i = blk->first; i < blk->first + blk->count; i++) {
+            const CfgEvent *e = &g->events[i];
+            if (is_def(e)) {
+                BITSET_SET(cur, e->var);
+            } else if (!BITSET_TEST(cur, e->var) && !reported[e->var]) {
+                /* As definições que alcançam só separam "pode ser" de
+                 * "nunca": calculadas na primeira leitura suspeita */
+                if (!have_reaching) {
+                    dataflow_reaching_definitions(g, &reaching);
+                    have_reaching = 1;
+                }
+                reported[e->var] = 1;
+                add_diag(&diags, e->line, reaches(&reaching, b, e->var) ? DIAG_MAYBE : DIAG_UNINITIALIZED,
+                         e->var);
+            }
+        }
+
+        /* Atribuições não lidas adiante, de trás para a frente */
+        memcpy(cur, live.out + (size_t)b * words, sizeof(BitWord) * (size_t)words);
+        for (i = blk->first + blk->count - 1; i >= blk->first; i--) {
+            const CfgEvent *e = &g->events[i];
+            if (!is_def(e)) {
+                BITSET_SET(cur, e->var);
+                continue;
+            }
+            if ((e->kind == CFG_INIT || e->kind == CFG_ASSIGN) && read[e->var] &&
+                !BITSET_TEST(cur, e->var)) {
+                add_diag(&diags, e->line, DIAG_DEAD_STORE, e->var);
+            }
+            BITSET_CLEAR(cur, e->var);
+        }
+    }
+    for (i = 0; i < g->var_count; i++) {
+        if (!read[i]) add_diag(&diags, g->vars[i].line, DIAG_UNREAD, i);
+    }
+
+    if (diags.count > 0) {
+        qsort(diags.items, (size_t)diags.count, sizeof(Diag), compare_diag);
+        /* Depois do que já foi impresso em stdout */
+        fflush(stdout);
+        for (i = 0; i < diags.count; i++) {
+            print_diag(g, &diags.items[i]);
+            switch (diags.items[i].kind) {
+                case DIAG_UNINITIALIZED: stats->uninitialized++; break;
+                case DIAG_MAYBE:         stats->maybe++; break;
+                case DIAG_DEAD_STORE:    stats->dead_stores++; break;
+                default:                 stats->unread++; break;
+            }
+        }
+        mm_free(diags.items);
+    }
+
+    dataflow_free(&assigned);
+    dataflow_free(&live);
+    if (have_reaching) dataflow_reaching_free(&reaching);
+    mm_free(order);
+    mm_free(reachable);
+    mm_free(read);
+    mm_free(reported);
+    mm_free(cur);
+}
@@ -1,14 +1,33 @@
+#define _POSIX_C_SOURCE 200112L
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include "error.h"
 
+static jmp_buf *lex_recovery = NULL;
+static int lex_quiet = 0;
+static char lex_message[512];
+
+void lex_error_set_recovery(jmp_buf *env) {
+    lex_recovery = env;
+}
+
+void lex_error_set_quiet(int quiet) {
+    lex_quiet = quiet;
+}
+
+const char* lex_error_message(void) {
+    return lex_message;
+}
+
 void lex_error(int line, const char *fmt, ...) {
     va_list ap;
-    fprintf(stderr, "Erro léxico na linha (line %d): ", line);
+    int n = snprintf(lex_message, sizeof(lex_message),
+                     "Erro léxico na linha (line %d): ", line);
     va_start(ap, fmt);
-    vfprintf(stderr, fmt, ap);
+    vsnprintf(lex_message + n, sizeof(lex_message) - n, fmt, ap);
     va_end(ap);
-    fprintf(stderr, "\n");
+    if (!lex_quiet) fprintf(stderr, "%s\n", lex_message);
+    if (lex_recovery) longjmp(*lex_recovery, 1);
     exit(EXIT_FAILURE);
 }
@@ -0,0 +1,685 @@
+#include "fold.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+#include "sema_report.h"
+#include "types.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Maior escala de um decimal dobrado (o inteiro escalado cabe em long) */
+#define MAX_SCALE 18
+
+typedef struct {
+    const char *name;
+    int offset;                     /* do nome declarado */
+    int unit;                       /* 0: itens globais; depois, uma por função */
+    int order;
+    TypeKind kind;
+    int a, b;                       /* decimal[a.b] declarado; 0.0 sem formato */
+    int assigns;                    /* atribuições, contando a inicialização */
+    unsigned int scalar : 1;        /* inteiro ou decimal sem vetor */
+    unsigned int param : 1;
+    unsigned int read : 1;          /* aparece em 'leia' */
+    unsigned int dropped : 1;       /* redeclarada: não é símbolo */
+    unsigned int known : 1;         /* valor disponível no ponto do percurso */
+    unsigned int counted : 1;       /* já contada em FoldStats.constants */
+    FoldValue value;
+} FoldVar;
+
+/* Atribuição ou 'leia' de um nome, contada depois de ordenar as variáveis */
+typedef struct {
+    const char *name;
+    int unit;
+    int read;
+} Target;
+
+/* Valor válido até o fim do bloco em que foi atribuído */
+typedef struct {
+    FoldVar *var;
+    int depth;
+} Known;
+
+/* Tags do percurso */
+#define TAG_SHARED 1                /* dentro de subárvore compartilhada */
+#define TAG_NAME   2                /* nome declarado, atribuído, lido ou chamado */
+
+typedef struct {
+    const char *source;
+    size_t len;
+    FoldStats *stats;
+    int unit;
+    int principal;                  /* programa 'principal() { ... }' */
+    FoldVar *vars;
+    int var_count, var_capacity;
+    int *unit_first;                /* variáveis da unidade u: [unit_first[u], unit_first[u + 1]) */
+    int unit_count;
+    Target *targets;
+    int target_count, target_capacity;
+    Known *known;
+    int known_count, known_capacity;
+    const ASTNode **alerted;        /* nós compartilhados já alertados */
+    int alerted_count, alerted_capacity;
+    int depth;                      /* blocos abertos */
+    ASTNode *decl;                  /* declaração em curso */
+    int next_declarator;            /* filho dela que é o próximo nome */
+} Fold;
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) {
+        fprintf(stderr, "Erro: memória insuficiente para o dobramento de constantes\n");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+/* ---------- Aritmética exata ---------- */
+
+static int fits_int(long v) {
+    return v >= INT_MIN && v <= INT_MAX;
+}
+
+/* m * 10^n, ou 0 se não cabe */
+static int scale_up(long m, int n, long *out) {
+    while (n-- > 0) {
+        if (__builtin_mul_overflow(m, 10L, &m)) return 0;
+    }
+    *out = m;
+    return 1;
+}
+
+/* Os dois mantissas na escala maior */
+static int align_scales(const FoldValue *x, const FoldValue *y, long *mx, long *my, int *scale) {
+    *scale = x->scale > y->scale ? x->scale : y->scale;
+    return scale_up(x->m, *scale - x->scale, mx) && scale_up(y->m, *scale - y->scale, my);
+}
+
+static int literal_digits(const ASTNode *node, FoldValue *c) {
+    const char *s = node->token.lexeme;
+    int negative = 0, seen_dot = 0, digits = 0;
+
+    c->m = 0;
+    c->scale = 0;
+    if (*s == '-') {
+        negative = 1;
+        s++;
+    }
+    for (; *s; s++) {
+        if (*s == '.' && !seen_dot) {
+            seen_dot = 1;
+            continue;
+        }
+        if (*s < '0' || *s > '9') return 0;
+        if (__builtin_mul_overflow(c->m, 10L, &c->m) ||
+            __builtin_add_overflow(c->m, (long)(*s - '0'), &c->m)) return 0;
+        if (seen_dot && ++c->scale > MAX_SCALE) return 0;
+        digits++;
+    }
+    if (digits == 0) return 0;
+    if (negative) c->m = -c->m;
+    return 1;
+}
+
+int fold_literal(const ASTNode *node, FoldValue *c) {
+    if (!node || node->type != AST_LITERAL || !node->token.lexeme) return 0;
+    switch (node->token.type) {
+        case TOK_INTEGER_LITERAL:
+            c->kind = node->inferred_type == TYPE_BOOL ? TY_BOOL : TY_INT;
+            return literal_digits(node, c) && c->scale == 0 && fits_int(c->m);
+        case TOK_DECIMAL_LITERAL:
+            c->kind = TY_DEC;
+            return literal_digits(node, c);
+        default:
+            return 0;
+    }
+}
+
+/* Valor de um literal numérico, também por trás de AST_EXPRESSION; um
+ * negativo é '-' sobre o literal (make_literal) */
+static int const_of(const ASTNode *node, FoldValue *c) {
+    while (node && node->type == AST_EXPRESSION && node->child_count == 1) {
+        node = node->children[0];
+    }
+    if (node && node->type == AST_UNARY_OP && node->token.type == TOK_MINUS &&
+        node->child_count == 1 && fold_literal(node->children[0], c)) {
+        c->m = -c->m;
+        return 1;
+    }
+    return fold_literal(node, c);
+}
+
+/* x ^ e, e >= 0 */
+static int power(const FoldValue *x, long e, FoldValue *r) {
+    long m = 1;
+    r->kind = x->kind == TY_DEC ? TY_DEC : TY_INT;
+    if (x->kind == TY_DEC && (long)x->scale * e > MAX_SCALE) return 0;
+    r->scale = x->kind == TY_DEC ? (int)(x->scale * e) : 0;
+    if (x->m == 0 || x->m == 1 || x->m == -1) {
+        /* Sem laço de e passos */
+        r->m = e == 0 ? 1 : (x->m == -1 && e % 2 == 0 ? 1 : x->m);
+        return 1;
+    }
+    while (e-- > 0) {
+        if (__builtin_mul_overflow(m, x->m, &m)) return 0;
+    }
+    r->m = m;
+    return r->kind == TY_DEC || fits_int(m);
+}
+
+int fold_binary(TokenType op, const FoldValue *x, const FoldValue *y, FoldValue *r) {
+    long mx, my;
+    int scale, decimal = x->kind == TY_DEC || y->kind == TY_DEC;
+
+    switch (op) {
+        case TOK_EQ: case TOK_NEQ: case TOK_LT: case TOK_GT: case TOK_LE: case TOK_GE:
+            if ((x->kind == TY_DEC) != (y->kind == TY_DEC)) return 0;
+            if (!align_scales(x, y, &mx, &my, &scale)) return 0;
+            r->kind = TY_BOOL;
+            r->scale = 0;
+            switch (op) {
+                case TOK_EQ:  r->m = mx == my; break;
+                case TOK_NEQ: r->m = mx != my; break;
+                case TOK_LT:  r->m = mx < my; break;
+                case TOK_GT:  r->m = mx > my; break;
+                case TOK_LE:  r->m = mx <= my; break;
+                default:      r->m = mx >= my; break;
+            }
+            return 1;
+        case TOK_AND:
+        case TOK_OR:
+            r->kind = TY_BOOL;
+            r->scale = 0;
+            r->m = op == TOK_AND ? (x->m != 0 && y->m != 0) : (x->m != 0 || y->m != 0);
+            return 1;
+        case TOK_CARET:
+            if (y->kind == TY_DEC || y->m < 0) return 0;
+            return power(x, y->m, r);
+        default:
+            break;
+    }
+
+    if (!align_scales(x, y, &mx, &my, &scale)) return 0;
+    r->kind = decimal ? TY_DEC : TY_INT;
+    r->scale = scale;
+    switch (op) {
+        case TOK_PLUS:
+            if (__builtin_add_overflow(mx, my, &r->m)) return 0;
+            break;
+        case TOK_MINUS:
+            if (__builtin_sub_overflow(mx, my, &r->m)) return 0;
+            break;
+        case TOK_STAR:
+            /* Sem alinhar: a escala é a soma */
+            r->scale = x->scale + y->scale;
+            if (r->scale > MAX_SCALE || __builtin_mul_overflow(x->m, y->m, &r->m)) return 0;
+            break;
+        case TOK_SLASH:
+            if (my == 0) return 0;
+            if (decimal) {
+                /* (mx / my) na escala: mx * 10^scale / my, se exato */
+                if (!scale_up(mx, scale, &mx) || mx % my != 0) return 0;
+            }
+            if (mx == LONG_MIN && my == -1) return 0;
+            r->m = mx / my;
+            break;
+        case TOK_MODULO:
+            if (my == 0) return 0;
+            if (mx == LONG_MIN && my == -1) return 0;
+            r->m = mx % my;
+            break;
+        default:
+            return 0;
+    }
+    return decimal || fits_int(r->m);
+}
+
+int fold_unary(TokenType op, const FoldValue *x, FoldValue *r) {
+    *r = *x;
+    if (r->kind == TY_BOOL) r->kind = TY_INT;
+    if (op == TOK_MINUS) {
+        if (x->m == LONG_MIN) return 0;
+        r->m = -x->m;
+    } else if (op != TOK_PLUS) {
+        return 0;
+    }
+    return r->kind == TY_DEC || fits_int(r->m);
+}
+
+/* ---------- Reescrita da AST ---------- */
+
+char* fold_value_text(const FoldValue *c, TypeId *type) {
+    char digits[32], *text;
+    int len, int_digits;
+
+    if (c->kind != TY_DEC) {
+        sprintf(digits, "%ld", c->m);
+        *type = c->kind == TY_BOOL ? TYPE_BOOL : TYPE_INT;
+    } else {
+        unsigned long v = c->m < 0 ? 0UL - (unsigned long)c->m : (unsigned long)c->m;
+        Type t;
+        len = sprintf(digits, "%s%0*lu", c->m < 0 ? "-" : "", c->scale + 1, v);
+        int_digits = len - c->scale - (c->m < 0);
+        if (c->scale > 0) {
+            memmove(digits + len - c->scale + 1, digits + len - c->scale, (size_t)c->scale + 1);
+            digits[len - c->scale] = '.';
+        } else {
+            /* Escala 0 (1.5 ^ 0): o ponto mantém o literal decimal */
+            strcpy(digits + len, ".0");
+        }
+        t.kind = TY_DEC;
+        t.info.dec.a = int_digits;
+        t.info.dec.b = c->scale > 0 ? c->scale : 1;
+        *type = type_intern(&t);
+    }
+    text = mm_malloc(strlen(digits) + 1);
+    if (!text) {
+        fprintf(stderr, "Erro: memória insuficiente para o dobramento de constantes\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(text, digits);
+    return text;
+}
+
+/* O nó vira o literal, no lugar; os filhos são liberados (os compartilhados
+ * só perdem esta referência). O léxico não tem literal negativo: um valor
+ * negativo vira '-' sobre o literal do módulo, e o menor inteiro, cujo
+ * módulo não cabe em 'inteiro', fica sem dobrar (retorna 0) */
+static int make_literal(ASTNode *node, const FoldValue *c) {
+    FoldValue magnitude = *c;
+    ASTNode *literal = node;
+    int i;
+
+    if (c->m < 0) {
+        if (c->m == LONG_MIN || (c->kind != TY_DEC && c->m == INT_MIN)) return 0;
+        magnitude.m = -c->m;
+    }
+    for (i = 0; i < node->child_count; i++) {
+        if (node->children[i]) free_ast(node->children[i]);
+    }
+    if (node->children) mm_free(node->children);
+    node->children = NULL;
+    node->child_count = node->child_capacity = 0;
+    if (c->m < 0) {
+        node->type = AST_UNARY_OP;
+        node->token.type = TOK_MINUS;
+        node->token.lexeme = "-";
+        literal = ast_node_create(AST_LITERAL, node->token);
+        ast_node_add_child(node, literal);
+    }
+    literal->type = AST_LITERAL;
+    literal->token.type = c->kind == TY_DEC ? TOK_DECIMAL_LITERAL : TOK_INTEGER_LITERAL;
+    literal->token.lexeme = fold_value_text(&magnitude, &literal->inferred_type);
+    node->inferred_type = literal->inferred_type;
+    return 1;
+}
+
+/* ---------- Variáveis ---------- */
+
+static int compare_var(const void *a, const void *b) {
+    const FoldVar *x = (const FoldVar*)a, *y = (const FoldVar*)b;
+    int c;
+    if (x->unit != y->unit) return x->unit - y->unit;
+    c = strcmp(x->name, y->name);
+    return c ? c : x->order - y->order;
+}
+
+/* Primeira variável com o nome na unidade (a que a análise semântica
+ * aceitou), ou NULL */
+static FoldVar* find_var(Fold *f, int unit, const char *name) {
+    int lo, hi;
+    if (unit >= f->unit_count) return NULL;
+    lo = f->unit_first[unit];
+    hi = f->unit_first[unit + 1];
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(f->vars[mid].name, name) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < f->unit_first[unit + 1] && strcmp(f->vars[lo].name, name) == 0 ? &f->vars[lo] : NULL;
+}
+
+/* Variável que um uso na posição enxerga: a local já declarada, senão a
+ * global já declarada */
+static FoldVar* resolve(Fold *f, const char *name, int offset) {
+    FoldVar *v = find_var(f, f->unit, name);
+    if (v && v->offset < offset) return v;
+    if (f->unit == 0) return NULL;
+    v = find_var(f, 0, name);
+    return v && v->offset < offset ? v : NULL;
+}
+
+static int candidate(const FoldVar *v) {
+    return v->scalar && !v->param && !v->read && v->assigns == 1;
+}
+
+/* Guarda o valor atribuído, se a variável é constante e ele cabe nela */
+static void assign(Fold *f, FoldVar *v, const ASTNode *value) {
+    FoldValue c;
+    if (!v || !candidate(v) || !const_of(value, &c)) return;
+    if (c.kind == TY_BOOL) c.kind = TY_INT;
+    if (v->kind == TY_INT && c.kind != TY_INT) return;
+    if (v->kind == TY_DEC) {
+        if (c.kind == TY_INT) c.kind = TY_DEC;
+        if (v->a > 0 || v->b > 0) {
+            /* decimal[a.b]: no máximo b casas e a dígitos inteiros */
+            long limit;
+            if (c.scale > v->b || !scale_up(1, v->a + c.scale, &limit)) return;
+            if (c.m >= limit || c.m <= -limit) return;
+        }
+    }
+    v->value = c;
+    v->known = 1;
+    f->known = grow(f->known, f->known_count, &f->known_capacity, sizeof(Known));
+    f->known[f->known_count].var = v;
+    f->known[f->known_count++].depth = f->depth;
+}
+
+/* Formato de decimal !d[a.b] */
+static void decimal_format(FoldVar *v, const ASTNode *format) {
+    FoldValue c;
+    if (!const_of(format, &c)) return;
+    if (c.kind == TY_DEC) {
+        long unit;
+        scale_up(1, c.scale, &unit);
+        v->a = (int)(c.m / unit);
+        v->b = (int)(c.m % unit);
+    } else {
+        v->a = (int)c.m;
+    }
+}
+
+/* ---------- Percursos ---------- */
+
+static void declare(Fold *f, ASTNode *decl, int param) {
+    int i = 0;
+    while (i < decl->child_count && decl->children[i] &&
+           decl->children[i]->type == AST_IDENTIFIER && decl->children[i]->token.lexeme) {
+        char arg = ast_declarator_arg(decl, i, f->source, f->len);
+        FoldVar *v;
+        f->vars = grow(f->vars, f->var_count, &f->var_capacity, sizeof(FoldVar));
+        v = &f->vars[f->var_count];
+        memset(v, 0, sizeof(FoldVar));
+        v->name = decl->children[i]->token.lexeme;
+        v->offset = decl->children[i]->token.offset;
+        v->unit = f->unit;
+        v->order = f->var_count++;
+        v->param = param;
+        v->assigns = arg == '=';
+        switch (decl->token.type) {
+            case TOK_KW_DECIMAL:
+                v->kind = TY_DEC;
+                v->scalar = 1;
+                if (arg == '[') decimal_format(v, decl->children[i + 1]);
+                break;
+            case TOK_KW_TEXTO:
+                v->kind = TY_TXT;
+                break;
+            default:
+                v->kind = TY_INT;
+                v->scalar = arg != '[';
+                break;
+        }
+        i += arg ? 2 : 1;
+    }
+}
+
+static void add_target(Fold *f, const ASTNode *id, int read) {
+    if (!id || id->type != AST_IDENTIFIER || !id->token.lexeme) return;
+    f->targets = grow(f->targets, f->target_count, &f->target_capacity, sizeof(Target));
+    f->targets[f->target_count].name = id->token.lexeme;
+    f->targets[f->target_count].unit = f->unit;
+    f->targets[f->target_count++].read = read;
+}
+
+static AstWalkAction collect_pre(AstWalker *w, ASTNode *node, void *data) {
+    Fold *f = (Fold*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int i;
+
+    switch (node->type) {
+        case AST_DECLARATION:
+            declare(f, node, parent && parent->type == AST_FUNCTION_DEF);
+            break;
+        case AST_ASSIGNMENT:
+            if (node->child_count > 0) add_target(f, node->children[0], 0);
+            break;
+        case AST_READ_STMT:
+            for (i = 0; i < node->child_count; i++) add_target(f, node->children[i], 1);
+            break;
+        default:
+            break;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+/* Marca a atribuição (ou 'leia') em toda variável com o nome na unidade e
+ * nas globais: sem olhar posições, para não deixar passar nenhuma */
+static void count_target(Fold *f, const Target *t) {
+    int unit = t->unit, pass;
+    for (pass = 0; pass < 2; pass++, unit = 0) {
+        FoldVar *v = find_var(f, unit, t->name);
+        for (; v && v < f->vars + f->unit_first[unit + 1] && strcmp(v->name, t->name) == 0; v++) {
+            if (t->read) v->read = 1;
+            else v->assigns++;
+        }
+        if (t->unit == 0) break;
+    }
+}
+
+/* Papel do filho pela posição no pai (antes de visitá-lo) */
+static int name_position(Fold *f, AstWalker *w, ASTNode *parent) {
+    int index = ast_walk_child_index(w);
+    if (!parent) return 0;
+    switch (parent->type) {
+        case AST_DECLARATION:
+            if (parent != f->decl || index != f->next_declarator) return 0;
+            f->next_declarator += ast_declarator_arg(parent, index, f->source, f->len) ? 2 : 1;
+            return 1;
+        case AST_ASSIGNMENT:
+        case AST_FUNCTION_CALL:
+        case AST_FUNCTION_DEF:
+            return index == 0;
+        case AST_READ_STMT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static AstWalkAction fold_pre(AstWalker *w, ASTNode *node, void *data) {
+    Fold *f = (Fold*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int tag = ast_walk_parent_tag(w) & TAG_SHARED;
+
+    if (node->refcount > 0) tag |= TAG_SHARED;
+    if (name_position(f, w, parent)) tag |= TAG_NAME;
+    ast_walk_set_tag(w, tag);
+
+    if (node->type == AST_DECLARATION) {
+        f->decl = node;
+        f->next_declarator = 0;
+    } else if (node->type == AST_BLOCK) {
+        f->depth++;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void div_zero(Fold *f, const ASTNode *node) {
+    int i;
+    if (node->refcount > 0) {
+        for (i = 0; i < f->alerted_count; i++) {
+            if (f->alerted[i] == node) return;
+        }
+        f->alerted = grow(f->alerted, f->alerted_count, &f->alerted_capacity, sizeof(ASTNode*));
+        f->alerted[f->alerted_count++] = node;
+    }
+    f->stats->div_zero++;
+    sema_report_alert("divisão por zero em expressão constante", node->token.line);
+}
+
+static void fold_post(AstWalker *w, ASTNode *node, void *data) {
+    Fold *f = (Fold*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int statement = !parent || parent->type == AST_BLOCK || parent->type == AST_PROGRAM;
+    FoldValue x, y, r;
+    int i;
+
+    switch (node->type) {
+        case AST_IDENTIFIER: {
+            FoldVar *v;
+            if (ast_walk_tag(w) || !node->token.lexeme) break;
+            v = resolve(f, node->token.lexeme, node->token.offset);
+            if (!v || !v->known || !make_literal(node, &v->value)) break;
+            if (!v->counted) f->stats->constants++;
+            v->counted = 1;
+            f->stats->propagated++;
+            break;
+        }
+
+        case AST_BINARY_OP:
+            if (node->child_count != 2) break;
+            if ((node->token.type == TOK_SLASH || node->token.type == TOK_MODULO) &&
+                const_of(node->children[1], &y) && y.m == 0) {
+                /* Com qualquer dividendo */
+                div_zero(f, node);
+                break;
+            }
+            if (!const_of(node->children[0], &x) || !const_of(node->children[1], &y) ||
+                !fold_binary(node->token.type, &x, &y, &r)) break;
+            /* Sem literal booleano na linguagem, comparações, && e || ficam
+             * (um 1 ou 0 inteiro mudaria o tipo da expressão no fonte) */
+            if (r.kind == TY_BOOL || !make_literal(node, &r)) break;
+            f->stats->folded++;
+            break;
+
+        case AST_UNARY_OP:
+            /* '-' sobre um literal já é a forma dobrada */
+            if (node->child_count != 1 || const_of(node, &r) ||
+                !const_of(node->children[0], &x) ||
+                !fold_unary(node->token.type, &x, &r) || !make_literal(node, &r)) break;
+            f->stats->folded++;
+            break;
+
+        case AST_ASSIGNMENT:
+            /* Globais só pela inicialização */
+            if (statement && f->unit > 0 && node->child_count == 2 && node->children[0]) {
+                assign(f, resolve(f, node->children[0]->token.lexeme, node->children[0]->token.offset),
+                       node->children[1]);
+            }
+            break;
+
+        case AST_DECLARATION:
+            if (!statement) break;
+            for (i = 0; i < node->child_count; i++) {
+                char arg;
+                if (!node->children[i] || node->children[i]->type != AST_IDENTIFIER) break;
+                arg = ast_declarator_arg(node, i, f->source, f->len);
+                if (arg == '=') {
+                    assign(f, find_var(f, f->unit, node->children[i]->token.lexeme),
+                           node->children[i + 1]);
+                }
+                if (arg) i++;
+            }
+            break;
+
+        case AST_BLOCK:
+            while (f->known_count > 0 && f->known[f->known_count - 1].depth == f->depth) {
+                f->known[--f->known_count].var->known = 0;
+            }
+            f->depth--;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Percorre as unidades na ordem em que foram numeradas: os itens globais
+ * (0) e cada função */
+static void walk_units(Fold *f, ASTNode *program, const AstVisitor *visitor) {
+    int i, unit = 1;
+
+    f->decl = NULL;
+    if (f->principal) {
+        f->unit = 1;
+        ast_walk(program, visitor);
+        return;
+    }
+    f->unit = 0;
+    for (i = 0; i < program->child_count; i++) {
+        ASTNode *item = program->children[i];
+        if (item && item->type != AST_FUNCTION_DEF) ast_walk(item, visitor);
+    }
+    for (i = 0; i < program->child_count; i++) {
+        ASTNode *item = program->children[i];
+        if (!item || item->type != AST_FUNCTION_DEF) continue;
+        f->unit = unit++;
+        ast_walk(item, visitor);
+        /* Os valores locais acabam com a função */
+        while (f->known_count > 0 && f->known[f->known_count - 1].depth > 0) {
+            f->known[--f->known_count].var->known = 0;
+        }
+    }
+}
+
+void fold_constants(ASTNode *program, const char *source, size_t len, FoldStats *stats) {
+    AstVisitor collect = {collect_pre, NULL, NULL, 0, 0};
+    AstVisitor fold = {fold_pre, fold_post, NULL, 0, 0};
+    Fold f;
+    int i, units = 1;
+
+    memset(stats, 0, sizeof(FoldStats));
+    if (!program) return;
+    memset(&f, 0, sizeof(Fold));
+    f.source = source;
+    f.len = len;
+    f.stats = stats;
+    f.principal = program->token.type == TOK_KW_PRINCIPAL;
+    collect.data = fold.data = &f;
+
+    /* Declarações, atribuições e 'leia' de cada unidade */
+    walk_units(&f, program, &collect);
+    if (f.principal) {
+        units = 2;
+    } else {
+        for (i = 0; i < program->child_count; i++) {
+            if (program->children[i] && program->children[i]->type == AST_FUNCTION_DEF) units++;
+        }
+    }
+    qsort(f.vars, (size_t)f.var_count, sizeof(FoldVar), compare_var);
+    f.unit_count = units;
+    f.unit_first = mm_malloc(sizeof(int) * (size_t)(units + 1));
+    if (!f.unit_first) {
+        fprintf(stderr, "Erro: memória insuficiente para o dobramento de constantes\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i <= units; i++) f.unit_first[i] = 0;
+    for (i = 0; i < f.var_count; i++) f.unit_first[f.vars[i].unit + 1]++;
+    for (i = 0; i < units; i++) f.unit_first[i + 1] += f.unit_first[i];
+
+    /* Uma redeclaração não é outro símbolo: a inicialização dela conta
+     * para a primeira */
+    for (i = 1; i < f.var_count; i++) {
+        FoldVar *v = &f.vars[i];
+        int first = i;
+        while (first > 0 && f.vars[first - 1].unit == v->unit &&
+               strcmp(f.vars[first - 1].name, v->name) == 0) first--;
+        if (first == i) continue;
+        v->dropped = 1;
+        f.vars[first].assigns += v->assigns;
+        v->assigns = 0;
+    }
+    for (i = 0; i < f.target_count; i++) count_target(&f, &f.targets[i]);
+
+    walk_units(&f, program, &fold);
+
+    if (f.vars) mm_free(f.vars);
+    if (f.targets) mm_free(f.targets);
+    if (f.known) mm_free(f.known);
+    if (f.alerted) mm_free(f.alerted);
+    mm_free(f.unit_first);
+}
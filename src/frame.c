@@ -0,0 +1,654 @@
+#include "frame.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Região: um bloco interno, ou a função inteira (região 0, com os
+ * parâmetros e o corpo) */
+typedef struct {
+    int parent;                 /* -1 na região 0 */
+    int end;                    /* fim do último token do bloco */
+    int size;                   /* variáveis próprias mais a área interna */
+    int align;
+    int inner_size;             /* maior bloco interno */
+    int inner_align;
+    int inner_offset;           /* da área interna, na região */
+    int base;                   /* da região, no quadro */
+} Region;
+
+typedef struct {
+    FrameSlot slot;
+    int pos;                    /* do nome, no fonte */
+    int last;                   /* fim do último uso */
+    int region;                 /* da declaração; depois, a que a contém viva */
+    int order;
+    int dropped;                /* redeclarada: não é símbolo */
+} Var;
+
+typedef struct {
+    const char *name;
+    int offset;
+    int end;
+} Use;
+
+typedef struct {
+    int caller;
+    const char *callee;
+} Call;
+
+struct FrameReport {
+    FrameFunc *funcs;
+    int func_count, func_capacity;
+    FrameSlot *slots;
+    int slot_count, slot_capacity;
+    FrameFunc globals;
+    int entry;
+    int *recursion;
+    int recursion_count;
+};
+
+/* Estado do percurso de uma função (os vetores são reaproveitados) */
+typedef struct {
+    const char *source;
+    size_t len;
+    ASTNode *root;
+    int func;                   /* função percorrida, -1 nos itens globais */
+    Var *vars;
+    int var_count, var_capacity;
+    Region *regions;
+    int region_count, region_capacity;
+    int *open;                  /* pilha das regiões abertas */
+    int open_count, open_capacity;
+    Use *uses;
+    int use_count, use_capacity;
+    Call *calls;                /* de todas as funções, em ordem de função */
+    int call_count, call_capacity;
+    int *order;
+    int order_capacity;
+    ASTNode *decl;              /* declaração em curso */
+    int next_declarator;        /* filho dela que é o próximo nome declarado */
+    int param;                  /* a declaração é de parâmetros */
+} Layout;
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+static int align_up(int offset, int align) {
+    return (offset + align - 1) / align * align;
+}
+
+static void open_region(Layout *l) {
+    Region *r;
+    l->regions = grow(l->regions, l->region_count, &l->region_capacity, sizeof(Region));
+    l->open = grow(l->open, l->open_count, &l->open_capacity, sizeof(int));
+    r = &l->regions[l->region_count];
+    memset(r, 0, sizeof(Region));
+    r->parent = l->open_count > 0 ? l->open[l->open_count - 1] : -1;
+    r->align = r->inner_align = 1;
+    l->open[l->open_count++] = l->region_count++;
+}
+
+static void close_region(Layout *l) {
+    Region *r = &l->regions[l->open[--l->open_count]];
+    if (r->parent >= 0 && r->end > l->regions[r->parent].end) {
+        l->regions[r->parent].end = r->end;
+    }
+}
+
+static void touch(Layout *l, const Token *tok) {
+    Region *r = &l->regions[l->open[l->open_count - 1]];
+    if (tok->offset + tok->length > r->end) r->end = tok->offset + tok->length;
+}
+
+/* Literal por trás de parênteses, ou NULL */
+static const ASTNode* literal(const ASTNode *node) {
+    while (node && node->type == AST_EXPRESSION && node->child_count == 1) {
+        node = node->children[0];
+    }
+    return node && node->type == AST_LITERAL ? node : NULL;
+}
+
+/* Valor de um literal inteiro entre colchetes, ou -1 */
+static int constant_count(const ASTNode *node) {
+    const ASTNode *lit = literal(node);
+    long n;
+    if (!lit || lit->token.type != TOK_INTEGER_LITERAL || !lit->token.lexeme) return -1;
+    n = strtol(lit->token.lexeme, NULL, 10);
+    return n < 0 || n > INT_MAX / 8 ? -1 : (int)n;
+}
+
+/* Bytes de um literal de texto (o lexema guarda os escapes) */
+static int text_length(const ASTNode *node) {
+    const ASTNode *lit = literal(node);
+    const char *s;
+    int n = 0;
+    if (!lit || lit->token.type != TOK_STRING_LITERAL || !lit->token.lexeme) return 0;
+    for (s = lit->token.lexeme; *s; s++, n++) {
+        if (*s == '\\' && s[1]) s++;
+    }
+    return n;
+}
+
+static void declare(Layout *l, ASTNode *decl, int index) {
+    ASTNode *id = decl->children[index];
+    char next = ast_declarator_arg(decl, index, l->source, l->len);
+    ASTNode *arg = next ? decl->children[index + 1] : NULL;
+    Var *v;
+
+    l->next_declarator = index + (arg ? 2 : 1);
+    l->vars = grow(l->vars, l->var_count, &l->var_capacity, sizeof(Var));
+    v = &l->vars[l->var_count];
+    memset(v, 0, sizeof(Var));
+    v->slot.name = id->token.lexeme;
+    v->slot.keyword = decl->token.type;
+    v->slot.line = id->token.line;
+    v->slot.param = l->param;
+    v->pos = id->token.offset;
+    v->last = id->token.offset + id->token.length;
+    v->region = l->open[l->open_count - 1];
+    v->order = l->var_count++;
+
+    switch (decl->token.type) {
+        case TOK_KW_DECIMAL:
+            /* decimal !d[3.2]: formato, não elementos */
+            v->slot.size = v->slot.align = 8;
+            break;
+        case TOK_KW_TEXTO:
+            v->slot.align = 1;
+            if (next == '[') {
+                v->slot.count = constant_count(arg);
+                v->slot.dynamic = v->slot.count < 0;
+                v->slot.size = v->slot.dynamic ? 0 : v->slot.count;
+                if (v->slot.dynamic) v->slot.count = 0;
+            } else if (next == '=') {
+                v->slot.size = text_length(arg);
+            }
+            break;
+        case TOK_KW_INTEIRO: default:
+            v->slot.size = v->slot.align = 4;
+            if (next == '[') {
+                v->slot.count = constant_count(arg);
+                v->slot.dynamic = v->slot.count < 0;
+                v->slot.size = v->slot.dynamic ? 0 : 4 * v->slot.count;
+                if (v->slot.dynamic) v->slot.count = 0;
+            }
+            break;
+    }
+}
+
+/* O corpo de uma função fica na região 0, com os parâmetros */
+static int is_body(const Layout *l, const ASTNode *node, const ASTNode *parent) {
+    return node == l->root || (parent == l->root && l->root->type == AST_FUNCTION_DEF);
+}
+
+static AstWalkAction layout_pre(AstWalker *w, ASTNode *node, void *data) {
+    Layout *l = (Layout*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w);
+
+    if (node->type == AST_BLOCK && !is_body(l, node, parent)) open_region(l);
+    touch(l, &node->token);
+
+    if (node->type == AST_DECLARATION) {
+        l->decl = node;
+        l->next_declarator = 0;
+        l->param = parent == l->root && l->root->type == AST_FUNCTION_DEF;
+    } else if (node->type == AST_IDENTIFIER && node->token.lexeme) {
+        if (parent && parent == l->decl && index == l->next_declarator) {
+            declare(l, parent, index);
+        } else if (parent && parent->type == AST_FUNCTION_DEF && index == 0) {
+            /* nome da função */
+        } else if (parent && parent->type == AST_FUNCTION_CALL && index == 0) {
+            if (l->func >= 0) {
+                l->calls = grow(l->calls, l->call_count, &l->call_capacity, sizeof(Call));
+                l->calls[l->call_count].caller = l->func;
+                l->calls[l->call_count++].callee = node->token.lexeme;
+            }
+        } else {
+            l->uses = grow(l->uses, l->use_count, &l->use_capacity, sizeof(Use));
+            l->uses[l->use_count].name = node->token.lexeme;
+            l->uses[l->use_count].offset = node->token.offset;
+            l->uses[l->use_count++].end = node->token.offset + node->token.length;
+        }
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void layout_post(AstWalker *w, ASTNode *node, void *data) {
+    Layout *l = (Layout*)data;
+    if (node->type == AST_BLOCK && !is_body(l, node, ast_walk_parent(w))) close_region(l);
+}
+
+static void walk(Layout *l, ASTNode *node) {
+    AstVisitor visitor = {layout_pre, layout_post, NULL, 0, 0};
+    visitor.data = l;
+    l->decl = NULL;
+    ast_walk(node, &visitor);
+}
+
+/* ---------- Posicionamento ---------- */
+
+static const Var *sort_vars;
+
+/* Por nome; o primeiro declarado vem antes */
+static int compare_name(const void *a, const void *b) {
+    const Var *x = &sort_vars[*(const int*)a], *y = &sort_vars[*(const int*)b];
+    int c = strcmp(x->slot.name, y->slot.name);
+    return c ? c : x->order - y->order;
+}
+
+/* Por região, alinhamento decrescente e ordem de declaração */
+static int compare_place(const void *a, const void *b) {
+    const Var *x = &sort_vars[*(const int*)a], *y = &sort_vars[*(const int*)b];
+    if (x->region != y->region) return x->region - y->region;
+    if (x->slot.align != y->slot.align) return y->slot.align - x->slot.align;
+    return x->order - y->order;
+}
+
+static int compare_offset(const void *a, const void *b) {
+    const Var *x = &sort_vars[*(const int*)a], *y = &sort_vars[*(const int*)b];
+    if (x->slot.offset != y->slot.offset) return x->slot.offset - y->slot.offset;
+    return x->order - y->order;
+}
+
+/* Primeira posição de order[0..count) com o nome, ou -1 */
+static int find_name(const Layout *l, int count, const char *name) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(l->vars[l->order[mid]].slot.name, name) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < count && strcmp(l->vars[l->order[lo]].slot.name, name) == 0 ? lo : -1;
+}
+
+/* Liga os usos à primeira declaração do nome (a que a análise semântica
+ * aceitou), se ela vem antes do uso; retorna quantas variáveis ficam */
+static int resolve_uses(Layout *l) {
+    int i, kept = 0;
+
+    for (i = 0; i < l->var_count; i++) l->order[i] = i;
+    sort_vars = l->vars;
+    qsort(l->order, (size_t)l->var_count, sizeof(int), compare_name);
+    for (i = 0; i < l->var_count; i++) {
+        Var *v = &l->vars[l->order[i]];
+        v->dropped = i > 0 && strcmp(l->vars[l->order[i - 1]].slot.name, v->slot.name) == 0;
+        if (!v->dropped) kept++;
+    }
+    for (i = 0; i < l->use_count; i++) {
+        int at = find_name(l, l->var_count, l->uses[i].name);
+        Var *v;
+        if (at < 0) continue;
+        v = &l->vars[l->order[at]];
+        if (v->pos < l->uses[i].offset && l->uses[i].end > v->last) v->last = l->uses[i].end;
+    }
+    return kept;
+}
+
+/* Posiciona as variáveis próprias da região e a área dos blocos internos,
+ * em ordem decrescente de alinhamento */
+static void place_region(Layout *l, int r, const int *vars, int count) {
+    Region *g = &l->regions[r];
+    int offset = 0, i, inner = g->inner_size > 0;
+
+    for (i = 0; i <= count; i++) {
+        Var *v = i < count ? &l->vars[vars[i]] : NULL;
+        if (inner && (!v || v->slot.align < g->inner_align)) {
+            offset = align_up(offset, g->inner_align);
+            g->inner_offset = offset;
+            offset += g->inner_size;
+            if (g->inner_align > g->align) g->align = g->inner_align;
+            inner = 0;
+        }
+        if (!v) break;
+        offset = align_up(offset, v->slot.align);
+        v->slot.offset = offset;
+        offset += v->slot.size;
+        if (v->slot.align > g->align) g->align = v->slot.align;
+    }
+    g->size = offset;
+    if (g->parent >= 0) {
+        Region *p = &l->regions[g->parent];
+        if (g->size > p->inner_size) p->inner_size = g->size;
+        if (g->align > p->inner_align) p->inner_align = g->align;
+    }
+}
+
+/* Fecha o quadro percorrido em f e guarda as variáveis em r; sem reuse,
+ * tudo fica na região 0 */
+static void place(Layout *l, FrameReport *rep, FrameFunc *f, int reuse) {
+    int i, kept, first, r;
+
+    while (l->order_capacity <= l->var_count) {
+        l->order = grow(l->order, l->order_capacity, &l->order_capacity, sizeof(int));
+    }
+    kept = resolve_uses(l);
+
+    /* Região em que a variável fica viva: sobe enquanto o último uso passa
+     * do fim do bloco */
+    for (i = 0, first = 0; i < l->var_count; i++) {
+        Var *v = &l->vars[i];
+        if (v->dropped) continue;
+        r = reuse ? v->region : 0;
+        while (r > 0 && l->regions[r].end < v->last) r = l->regions[r].parent;
+        v->region = r;
+        v->slot.block = r > 0;
+        l->order[first++] = i;
+    }
+
+    /* Das regiões internas para fora (cada uma foi aberta depois da mãe) */
+    sort_vars = l->vars;
+    qsort(l->order, (size_t)kept, sizeof(int), compare_place);
+    first = kept;
+    for (r = l->region_count - 1; r >= 0; r--) {
+        int end = first;
+        while (first > 0 && l->vars[l->order[first - 1]].region == r) first--;
+        place_region(l, r, l->order + first, end - first);
+    }
+    for (r = 1; r < l->region_count; r++) {
+        const Region *p = &l->regions[l->regions[r].parent];
+        l->regions[r].base = p->base + p->inner_offset;
+    }
+
+    f->size = align_up(l->regions[0].size, FRAME_ALIGN);
+    f->slot_bytes = 0;
+    f->first_slot = rep->slot_count;
+    f->slot_count = kept;
+    f->dynamic = 0;
+    for (i = 0; i < kept; i++) {
+        Var *v = &l->vars[l->order[i]];
+        v->slot.offset += l->regions[v->region].base;
+        f->slot_bytes += v->slot.size;
+        if (v->slot.dynamic) f->dynamic = 1;
+    }
+    qsort(l->order, (size_t)kept, sizeof(int), compare_offset);
+    for (i = 0; i < kept; i++) {
+        rep->slots = grow(rep->slots, rep->slot_count, &rep->slot_capacity, sizeof(FrameSlot));
+        rep->slots[rep->slot_count++] = l->vars[l->order[i]].slot;
+    }
+}
+
+static void reset(Layout *l, ASTNode *root, int func) {
+    l->root = root;
+    l->func = func;
+    l->var_count = l->region_count = l->open_count = l->use_count = 0;
+    open_region(l);
+    l->regions[0].end = root->token.offset;
+}
+
+static void layout_function(Layout *l, FrameReport *rep, ASTNode *root, const char *name) {
+    FrameFunc *f;
+
+    rep->funcs = grow(rep->funcs, rep->func_count, &rep->func_capacity, sizeof(FrameFunc));
+    reset(l, root, rep->func_count);
+    walk(l, root);
+    f = &rep->funcs[rep->func_count++];
+    memset(f, 0, sizeof(FrameFunc));
+    f->name = name;
+    f->line = root->token.line;
+    f->next = -1;
+    place(l, rep, f, 1);
+}
+
+/* ---------- Grafo de chamadas ---------- */
+
+static const FrameFunc *sort_funcs;
+
+static int compare_func(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    int c = strcmp(sort_funcs[x].name, sort_funcs[y].name);
+    return c ? c : x - y;
+}
+
+/* Função chamada pelo nome (a primeira definida), ou -1 */
+static int find_func(const FrameReport *rep, const int *by_name, const char *name) {
+    int lo = 0, hi = rep->func_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(rep->funcs[by_name[mid]].name, name) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < rep->func_count && strcmp(rep->funcs[by_name[lo]].name, name) == 0
+           ? by_name[lo] : -1;
+}
+
+/* Componentes fortemente conexos (Tarjan, com pilha explícita). Cada
+ * componente sai depois dos que ele chama, que já têm a profundidade */
+static void stack_depths(FrameReport *rep, const int *first, const int *callee) {
+    int n = rep->func_count;
+    int *index = mm_malloc(sizeof(int) * (size_t)n * 6);
+    int *low = index + n, *comp = low + n, *edge = comp + n, *scc = edge + n, *path = scc + n;
+    char *on_stack;
+    int counter = 0, sp = 0, fp = 0, s, i;
+
+    if (!index) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    on_stack = mm_malloc((size_t)n);
+    if (!on_stack) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < n; i++) {
+        index[i] = comp[i] = -1;
+        on_stack[i] = 0;
+    }
+
+    for (s = 0; s < n; s++) {
+        if (index[s] >= 0) continue;
+        index[s] = low[s] = counter++;
+        edge[s] = first[s];
+        scc[sp++] = path[fp++] = s;
+        on_stack[s] = 1;
+        while (fp > 0) {
+            int v = path[fp - 1], w;
+            if (edge[v] < first[v + 1]) {
+                w = callee[edge[v]++];
+                if (w < 0) continue;
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    edge[w] = first[w];
+                    scc[sp++] = path[fp++] = w;
+                    on_stack[w] = 1;
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            fp--;
+            if (fp > 0 && low[v] < low[path[fp - 1]]) low[path[fp - 1]] = low[v];
+            if (low[v] == index[v]) {
+                int top = sp, m, e, exit = -1, recursive;
+                long total = 0;
+                do {
+                    w = scc[--sp];
+                    on_stack[w] = 0;
+                    comp[w] = v;
+                } while (w != v);
+                recursive = top - sp > 1;
+                /* Cada função do componente entra uma vez, e a cadeia sai
+                 * pela chamada mais funda de algum deles */
+                for (m = sp; m < top; m++) {
+                    total += rep->funcs[scc[m]].size;
+                    for (e = first[scc[m]]; e < first[scc[m] + 1]; e++) {
+                        w = callee[e];
+                        if (w < 0) continue;
+                        if (comp[w] == v) {
+                            recursive = 1;
+                        } else if (exit < 0 || rep->funcs[w].depth > rep->funcs[exit].depth) {
+                            exit = w;
+                        }
+                    }
+                }
+                for (m = sp; m < top; m++) {
+                    FrameFunc *f = &rep->funcs[scc[m]];
+                    f->recursive = recursive;
+                    f->depth = total + (exit >= 0 ? rep->funcs[exit].depth : 0);
+                    f->next = exit;
+                }
+            }
+        }
+    }
+    mm_free(on_stack);
+    mm_free(index);
+}
+
+/* Funções recursivas alcançáveis a partir da entrada */
+static void find_recursion(FrameReport *rep, const int *first, const int *callee) {
+    int n = rep->func_count, count = 0, i;
+    int *queue = mm_malloc(sizeof(int) * (size_t)n);
+    char *seen = mm_malloc((size_t)n);
+
+    if (!queue || !seen) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(seen, 0, (size_t)n);
+    queue[count++] = rep->entry;
+    seen[rep->entry] = 1;
+    for (i = 0; i < count; i++) {
+        int e;
+        for (e = first[queue[i]]; e < first[queue[i] + 1]; e++) {
+            if (callee[e] >= 0 && !seen[callee[e]]) {
+                seen[callee[e]] = 1;
+                queue[count++] = callee[e];
+            }
+        }
+    }
+    rep->recursion_count = 0;
+    for (i = 0; i < n; i++) {
+        if (seen[i] && rep->funcs[i].recursive) queue[rep->recursion_count++] = i;
+    }
+    rep->recursion = queue;
+    mm_free(seen);
+}
+
+static void call_graph(FrameReport *rep, const Layout *l) {
+    int n = rep->func_count, i;
+    int *by_name, *first, *callee;
+
+    if (n == 0) return;
+    by_name = mm_malloc(sizeof(int) * (size_t)n);
+    first = mm_malloc(sizeof(int) * (size_t)(n + 1));
+    callee = mm_malloc(sizeof(int) * (size_t)(l->call_count + 1));
+    if (!by_name || !first || !callee) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < n; i++) by_name[i] = i;
+    sort_funcs = rep->funcs;
+    qsort(by_name, (size_t)n, sizeof(int), compare_func);
+
+    /* As chamadas já estão em ordem de função */
+    for (i = 0; i <= n; i++) first[i] = 0;
+    for (i = 0; i < l->call_count; i++) {
+        first[l->calls[i].caller + 1]++;
+        callee[i] = find_func(rep, by_name, l->calls[i].callee);
+    }
+    for (i = 0; i < n; i++) first[i + 1] += first[i];
+
+    stack_depths(rep, first, callee);
+    i = find_func(rep, by_name, "principal");
+    if (i < 0) {
+        for (i = 0, rep->entry = 0; i < n; i++) {
+            if (rep->funcs[i].depth > rep->funcs[rep->entry].depth) rep->entry = i;
+        }
+    } else {
+        rep->entry = i;
+    }
+    find_recursion(rep, first, callee);
+
+    mm_free(callee);
+    mm_free(first);
+    mm_free(by_name);
+}
+
+FrameReport* frame_layout(ASTNode *program, const char *source, size_t len) {
+    FrameReport *rep = mm_malloc(sizeof(FrameReport));
+    Layout l;
+    int i;
+
+    if (!rep) {
+        fprintf(stderr, "Erro: memória insuficiente para os quadros de pilha\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(rep, 0, sizeof(FrameReport));
+    memset(&l, 0, sizeof(Layout));
+    rep->entry = -1;
+    rep->globals.name = "globais";
+    rep->globals.next = -1;
+    l.source = source;
+    l.len = len;
+
+    if (program->token.type == TOK_KW_PRINCIPAL) {
+        /* 'principal() { ... }': os itens são o corpo de principal */
+        layout_function(&l, rep, program, "principal");
+    } else {
+        reset(&l, program, -1);
+        for (i = 0; i < program->child_count; i++) {
+            ASTNode *item = program->children[i];
+            if (item && item->type != AST_FUNCTION_DEF) walk(&l, item);
+        }
+        place(&l, rep, &rep->globals, 0);
+        for (i = 0; i < program->child_count; i++) {
+            ASTNode *item = program->children[i];
+            if (!item || item->type != AST_FUNCTION_DEF) continue;
+            layout_function(&l, rep, item, item->child_count > 0 && item->children[0]
+                                           ? item->children[0]->token.lexeme : "?");
+        }
+    }
+    call_graph(rep, &l);
+
+    if (l.vars) mm_free(l.vars);
+    if (l.regions) mm_free(l.regions);
+    if (l.open) mm_free(l.open);
+    if (l.uses) mm_free(l.uses);
+    if (l.calls) mm_free(l.calls);
+    if (l.order) mm_free(l.order);
+    return rep;
+}
+
+int frame_func_count(const FrameReport *r) {
+    return r->func_count;
+}
+
+const FrameFunc* frame_func(const FrameReport *r, int i) {
+    return &r->funcs[i];
+}
+
+const FrameFunc* frame_globals(const FrameReport *r) {
+    return &r->globals;
+}
+
+const FrameSlot* frame_slots(const FrameReport *r, const FrameFunc *f) {
+    return r->slots + f->first_slot;
+}
+
+int frame_entry(const FrameReport *r) {
+    return r->entry;
+}
+
+const int* frame_recursion(const FrameReport *r, int *count) {
+    *count = r->recursion_count;
+    return r->recursion;
+}
+
+void frame_free(FrameReport *r) {
+    if (!r) return;
+    if (r->funcs) mm_free(r->funcs);
+    if (r->slots) mm_free(r->slots);
+    if (r->recursion) mm_free(r->recursion);
+    mm_free(r);
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashcons.h"
+#include "memmgr.h"
+
+#define HASHCONS_INITIAL_SLOTS 16
+
+static void *hashcons_alloc(size_t size) {
+    void *p = mm_malloc(size);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para o compartilhamento de expressões\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/* Só nós de expressão completos: filhos ausentes (erros) não são registrados */
+static int internable(const ASTNode *node) {
+    switch (node->type) {
+        case AST_LITERAL:
+        case AST_IDENTIFIER:
+            return node->child_count == 0;
+        case AST_UNARY_OP:
+            return node->child_count == 1;
+        case AST_BINARY_OP:
+            return node->child_count == 2;
+        default:
+            return 0;
+    }
+}
+
+static unsigned long node_hash(const ASTNode *node) {
+    unsigned long h = (unsigned long)node->type * 31 + (unsigned long)node->token.type;
+    int i;
+
+    if (node->child_count == 0) {
+        const char *s = node->token.lexeme;
+        if (s) while (*s) h = h * 33 + (unsigned char)*s++;
+    }
+    for (i = 0; i < node->child_count; i++) {
+        /* Os filhos já foram registrados: o ponteiro identifica a subárvore */
+        h = h * 31 + (unsigned long)(size_t)node->children[i] / sizeof(ASTNode);
+    }
+    return h ^ (h >> 16);
+}
+
+static int same_node(const ASTNode *a, const ASTNode *b) {
+    int i;
+
+    if (a->type != b->type || a->token.type != b->token.type ||
+        a->child_count != b->child_count) {
+        return 0;
+    }
+    if (a->child_count == 0) {
+        if (!a->token.lexeme || !b->token.lexeme) return a->token.lexeme == b->token.lexeme;
+        return strcmp(a->token.lexeme, b->token.lexeme) == 0;
+    }
+    for (i = 0; i < a->child_count; i++) {
+        if (a->children[i] != b->children[i]) return 0;
+    }
+    return 1;
+}
+
+static void hashcons_rehash(HashCons *hc, size_t slot_count) {
+    HashConsSlot *slots = hashcons_alloc(slot_count * sizeof(HashConsSlot));
+    size_t i;
+
+    memset(slots, 0, slot_count * sizeof(HashConsSlot));
+    for (i = 0; i < hc->slot_count; i++) {
+        size_t j;
+        if (hc->slots[i].generation != hc->generation) continue;
+        j = node_hash(hc->slots[i].node) & (slot_count - 1);
+        while (slots[j].generation == hc->generation) j = (j + 1) & (slot_count - 1);
+        slots[j] = hc->slots[i];
+    }
+    if (hc->slots) mm_free(hc->slots);
+    hc->slots = slots;
+    hc->slot_count = slot_count;
+}
+
+HashCons* hashcons_create(void) {
+    HashCons *hc = hashcons_alloc(sizeof(HashCons));
+    hc->slots = NULL;
+    hc->slot_count = 0;
+    hc->used = 0;
+    hc->generation = 1;             /* slots zerados nunca são da geração atual */
+    hc->last_hit = NULL;
+    hc->nodes = 0;
+    hc->shared = 0;
+    hashcons_rehash(hc, HASHCONS_INITIAL_SLOTS);
+    return hc;
+}
+
+void hashcons_destroy(HashCons *hc) {
+    if (!hc) return;
+    mm_free(hc->slots);
+    mm_free(hc);
+}
+
+void hashcons_reset(HashCons *hc) {
+    if (hc->used == 0) return;
+    hc->generation++;
+    hc->used = 0;
+}
+
+ASTNode* hashcons_intern(HashCons *hc, ASTNode *node) {
+    size_t j;
+    int i;
+
+    hc->last_hit = NULL;
+    if (!node || !internable(node)) return node;
+    for (i = 0; i < node->child_count; i++) {
+        if (!node->children[i]) return node;
+    }
+    hc->nodes++;
+
+    if ((hc->used + 1) * 2 > hc->slot_count) hashcons_rehash(hc, hc->slot_count * 2);
+    j = node_hash(node) & (hc->slot_count - 1);
+    while (hc->slots[j].generation == hc->generation) {
+        ASTNode *existing = hc->slots[j].node;
+        if (same_node(existing, node)) {
+            /* A cópia sai da árvore: seus filhos (os mesmos do nó registrado)
+             * perdem a referência que ela tinha */
+            for (i = 0; i < node->child_count; i++) node->children[i]->refcount--;
+            hc->last_hit = existing;
+            hc->last_token = node->token;
+            if (node->children) mm_free(node->children);
+            if (node->value) mm_free(node->value);
+            mm_free(node);
+            existing->refcount++;
+            hc->shared++;
+            return existing;
+        }
+        j = (j + 1) & (hc->slot_count - 1);
+    }
+
+    hc->slots[j].node = node;
+    hc->slots[j].generation = hc->generation;
+    hc->used++;
+    return node;
+}
+
+ASTNode* hashcons_unshare(HashCons *hc, ASTNode *node) {
+    ASTNode *copy;
+    int i;
+
+    if (!node || node != hc->last_hit) return node;
+    copy = ast_node_create(node->type, hc->last_token);
+    for (i = 0; i < node->child_count; i++) {
+        node->children[i]->refcount++;
+        ast_node_add_child(copy, node->children[i]);
+    }
+    node->refcount--;
+    hc->last_hit = NULL;
+    hc->shared--;
+    return copy;
+}
@@ -0,0 +1,517 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <setjmp.h>
+#include "incremental.h"
+#include "ast_walk.h"
+#include "lexer.h"
+#include "memmgr.h"
+#include "util.h"
+#include "error.h"
+
+/* ========== Vetores de tokens ========== */
+
+typedef struct {
+    Token *data;
+    int count;
+    int capacity;
+} TokenVec;
+
+static void *incr_alloc(void *ptr, size_t size) {
+    void *p = mm_realloc(ptr, size);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a sessão incremental\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void vec_push(TokenVec *v, Token t) {
+    if (v->count >= v->capacity) {
+        v->capacity = v->capacity ? v->capacity * 2 : 64;
+        v->data = incr_alloc(v->data, v->capacity * sizeof(Token));
+    }
+    v->data[v->count++] = t;
+}
+
+/* Os tokens da sessão são donos dos lexemas alocados pelo lexer */
+static void release_lexemes(Token *tokens, int count) {
+    int i;
+    for (i = 0; i < count; i++) {
+        if (token_owns_lexeme(tokens[i].type)) mm_free(tokens[i].lexeme);
+    }
+}
+
+static Token eof_after(const Token *last, int line) {
+    Token eof = {TOK_EOF, 0, "", 0, 0};
+    if (last) {
+        eof.line = last->line;
+        eof.offset = last->offset + last->length;
+    } else {
+        eof.line = line;
+    }
+    return eof;
+}
+
+/* ========== Relexação com ressincronização ========== */
+
+/* Uma execução do lexer sobre base[0..length). Os tokens saem com
+ * deslocamentos relativos a base. Se old != NULL, para no primeiro token que
+ * coincide em posição com um token antigo: a partir dali o texto é idêntico e
+ * os tokens antigos (deslocados de shift) continuam válidos. */
+typedef struct {
+    const char *base;
+    int length;
+    int first_line;
+    int stop;               /* para no primeiro token que começa em >= stop */
+    const Token *old;
+    int old_count;
+    int old_pos;            /* primeiro token antigo candidato */
+    int shift;              /* soma-se aos tokens antigos para compará-los */
+    int sync_from;          /* só ressincroniza em tokens a partir daqui */
+    int synced;             /* token antigo onde ressincronizou, ou -1 */
+    int end_line;           /* linha do scanner ao terminar */
+    TokenVec out;
+} LexJob;
+
+static jmp_buf lex_env;
+
+static int run_lexer(LexJob *job) {
+    Scanner sc;
+    if (setjmp(lex_env)) {
+        lex_error_set_recovery(NULL);
+        return 0;
+    }
+    lex_error_set_recovery(&lex_env);
+    scanner_init_buffer(&sc, job->base, (size_t)job->length, job->first_line);
+
+    for (;;) {
+        Token t = scanner_next_token(&sc);
+        if (t.type == TOK_EOF) break;
+        if (t.offset >= job->stop) {
+            release_lexemes(&t, 1);
+            break;
+        }
+        if (job->old && t.offset >= job->sync_from) {
+            while (job->old_pos < job->old_count &&
+                   job->old[job->old_pos].offset + job->shift < t.offset) {
+                job->old_pos++;
+            }
+            if (job->old_pos < job->old_count &&
+                job->old[job->old_pos].offset + job->shift == t.offset) {
+                release_lexemes(&t, 1);
+                job->synced = job->old_pos;
+                break;
+            }
+        }
+        vec_push(&job->out, t);
+    }
+
+    job->end_line = scanner_line(&sc);
+    lex_error_set_recovery(NULL);
+    return 1;
+}
+
+/* ========== Ajuste de posições nos nós ========== */
+
+typedef struct {
+    int offset;
+    int line;
+} NodeShift;
+
+static AstWalkAction shift_node_pre(AstWalker *w, ASTNode *node, void *data) {
+    NodeShift *shift = data;
+    (void)w;
+    node->token.offset += shift->offset;
+    node->token.line += shift->line;
+    return AST_WALK_CONTINUE;
+}
+
+static void shift_nodes(ASTNode *node, int offset, int line) {
+    NodeShift shift;
+    AstVisitor visitor = {shift_node_pre, NULL, NULL, 0, 0};
+    shift.offset = offset;
+    shift.line = line;
+    visitor.data = &shift;
+    ast_walk(node, &visitor);
+}
+
+/* ========== Estado da sessão ========== */
+
+static void release_state(IncrSession *s) {
+    int i;
+    if (s->program) free_ast(s->program);
+    s->program = NULL;
+    for (i = 0; i < s->item_count; i++) {
+        release_lexemes(s->items[i].tokens, s->items[i].token_count);
+        mm_free(s->items[i].tokens);
+    }
+    s->item_count = 0;
+    if (s->outer) {
+        release_lexemes(s->outer, s->outer_count);
+        mm_free(s->outer);
+    }
+    s->outer = NULL;
+    s->outer_count = 0;
+    s->outer_header = 0;
+    s->valid = 0;
+}
+
+/* O nó PROGRAM compartilha o primeiro token do arquivo */
+static void refresh_program_token(IncrSession *s) {
+    if (s->outer_header > 0) {
+        s->program->token = s->outer[0];
+    } else if (s->item_count > 0) {
+        s->program->token = s->items[0].tokens[0];
+        s->program->token.offset = s->items[0].start;
+        s->program->token.line = s->items[0].line;
+    }
+}
+
+static int suffix_start(IncrSession *s) {
+    return s->outer[s->outer_header].offset;
+}
+
+static void shift_following(IncrSession *s, int from, int delta, int line_delta) {
+    int i;
+    for (i = from; i < s->item_count; i++) {
+        s->items[i].start += delta;
+        s->items[i].end += delta;
+        s->items[i].line += line_delta;
+        s->items[i].line_pending += line_delta;
+    }
+    for (i = s->outer_header; i < s->outer_count; i++) {
+        s->outer[i].offset += delta;
+        s->outer[i].line += line_delta;
+    }
+}
+
+static IncrResult full_parse(IncrSession *s) {
+    LexJob job;
+    Parser *parser;
+    Token *tokens;
+    int header, last = 0, i;
+
+    release_state(s);
+    s->full_parses++;
+
+    memset(&job, 0, sizeof(job));
+    job.base = s->text;
+    job.length = s->length;
+    job.first_line = 1;
+    job.stop = INT_MAX;
+    job.synced = -1;
+    if (!run_lexer(&job)) {
+        release_lexemes(job.out.data, job.out.count);
+        if (job.out.data) mm_free(job.out.data);
+        return INCR_LEX_ERROR;
+    }
+    vec_push(&job.out, eof_after(job.out.count ? &job.out.data[job.out.count - 1] : NULL,
+                                 job.end_line));
+    tokens = job.out.data;
+
+    parser = parser_init_tokens(tokens);
+    s->program = parse_program_begin(parser);
+    header = parser->token_pos - 1;
+    while (!parse_program_at_end(parser)) {
+        int first = parser->token_pos - 1;
+        ASTNode *node = parse_program_item(parser);
+        if (!node) continue;
+        ast_node_add_child(s->program, node);
+        if (s->item_count >= s->item_capacity) {
+            s->item_capacity = s->item_capacity ? s->item_capacity * 2 : 16;
+            s->items = incr_alloc(s->items, s->item_capacity * sizeof(IncrItem));
+        }
+        /* start/end guardam provisoriamente os índices dos tokens */
+        s->items[s->item_count].node = node;
+        s->items[s->item_count].start = first;
+        s->items[s->item_count].end = parser->token_pos - 1;
+        s->item_count++;
+    }
+    parse_program_end(parser);
+    s->mode = parser->program_mode == PROGRAM_DONE ? PROGRAM_PRINCIPAL : parser->program_mode;
+    s->valid = !parser->had_error;
+    parser_free(parser);
+
+    if (!s->valid) {
+        /* Sem itens: a AST parcial fica disponível, e os tokens em outer */
+        s->item_count = 0;
+        s->outer = tokens;
+        s->outer_count = job.out.count;
+        s->outer_header = job.out.count - 1;
+        return INCR_PARSE_ERROR;
+    }
+
+    for (i = 0; i < s->item_count; i++) {
+        IncrItem *it = &s->items[i];
+        int a = it->start, b = it->end, k;
+        int base = tokens[a].offset, line = tokens[a].line;
+        it->token_count = b - a;
+        it->tokens = incr_alloc(NULL, (it->token_count + 1) * sizeof(Token));
+        for (k = 0; k < it->token_count; k++) {
+            it->tokens[k] = tokens[a + k];
+            it->tokens[k].offset -= base;
+            it->tokens[k].line -= line;
+        }
+        it->tokens[k] = eof_after(&it->tokens[k - 1], 0);
+        it->start = base;
+        it->end = tokens[b - 1].offset + tokens[b - 1].length;
+        it->line = line;
+        it->line_pending = 0;
+        shift_nodes(it->node, -base, 0);
+        last = b;
+    }
+    if (s->item_count == 0) last = header;
+
+    s->outer_header = header;
+    s->outer_count = header + (job.out.count - last);
+    s->outer = incr_alloc(NULL, s->outer_count * sizeof(Token));
+    memcpy(s->outer, tokens, header * sizeof(Token));
+    memcpy(s->outer + header, tokens + last, (job.out.count - last) * sizeof(Token));
+    mm_free(tokens);
+    refresh_program_token(s);
+    return INCR_FULL_PARSE;
+}
+
+/* ========== Reanálise de um item ========== */
+
+static IncrResult reparse_item(IncrSession *s, int index, int offset, int delete_len,
+                               int insert_len, int line_delta) {
+    IncrItem *it = &s->items[index];
+    int delta = insert_len - delete_len;
+    int r = offset - it->start;
+    int lo = 0, hi = it->token_count, from, lex_start, next_start, kept, n, k;
+    int new_start, new_line, base_offset, base_line;
+    Token *tokens, *absolute;
+    LexJob job;
+    Parser *parser;
+    ASTNode *node = NULL;
+    int ok;
+
+    /* Primeiro token que termina em r ou depois; o anterior também é
+     * relexado, pois um token encostado na edição pode crescer */
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (it->tokens[mid].offset + it->tokens[mid].length < r) lo = mid + 1;
+        else hi = mid;
+    }
+    from = lo > 0 ? lo - 1 : 0;
+    lex_start = it->tokens[from].offset;
+    next_start = (index + 1 < s->item_count ? s->items[index + 1].start : suffix_start(s)) + delta;
+
+    memset(&job, 0, sizeof(job));
+    job.base = s->text + it->start + lex_start;
+    job.length = s->length - (it->start + lex_start);
+    job.first_line = it->line + it->tokens[from].line;
+    job.stop = (it->end - it->start) + delta - lex_start;
+    job.old = it->tokens;
+    job.old_count = it->token_count;
+    job.old_pos = lo;
+    while (job.old_pos < job.old_count && it->tokens[job.old_pos].offset < r + delete_len) {
+        job.old_pos++;
+    }
+    job.shift = delta - lex_start;
+    job.sync_from = r + insert_len - lex_start;
+    job.synced = -1;
+
+    if (!run_lexer(&job)) {
+        release_lexemes(job.out.data, job.out.count);
+        if (job.out.data) mm_free(job.out.data);
+        release_state(s);
+        return INCR_LEX_ERROR;
+    }
+
+    /* Monta os tokens novos: prefixo antigo + relexados + sufixo antigo */
+    kept = job.synced >= 0 ? it->token_count - job.synced : 0;
+    n = from + job.out.count + kept;
+    tokens = incr_alloc(NULL, (n + 1) * sizeof(Token));
+    memcpy(tokens, it->tokens, from * sizeof(Token));
+    for (k = 0; k < job.out.count; k++) {
+        tokens[from + k] = job.out.data[k];
+        tokens[from + k].offset += lex_start;
+        tokens[from + k].line -= it->line;
+    }
+    for (k = 0; k < kept; k++) {
+        tokens[from + job.out.count + k] = it->tokens[job.synced + k];
+        tokens[from + job.out.count + k].offset += delta;
+        tokens[from + job.out.count + k].line += line_delta;
+    }
+
+    ok = n > 0 && it->start + tokens[n - 1].offset + tokens[n - 1].length <= next_start;
+    new_start = it->start;
+    new_line = it->line;
+    if (ok) {
+        /* O item pode ter passado a começar em outro ponto */
+        base_offset = tokens[0].offset;
+        base_line = tokens[0].line;
+        for (k = 0; k < n; k++) {
+            tokens[k].offset -= base_offset;
+            tokens[k].line -= base_line;
+        }
+        tokens[n] = eof_after(&tokens[n - 1], 0);
+        new_start += base_offset;
+        new_line += base_line;
+
+        absolute = incr_alloc(NULL, (n + 1) * sizeof(Token));
+        for (k = 0; k <= n; k++) {
+            absolute[k] = tokens[k];
+            absolute[k].line += new_line;
+        }
+        parser = parser_init_tokens(absolute);
+        parser->silent = 1;
+        parser->program_mode = s->mode;
+        if (!parse_program_at_end(parser)) {
+            node = parse_program_item(parser);
+        }
+        ok = node && !parser->had_error && check_token(parser, TOK_EOF);
+        parser_free(parser);
+        mm_free(absolute);
+    }
+
+    if (!ok) {
+        if (node) free_ast(node);
+        release_lexemes(job.out.data, job.out.count);
+        if (job.out.data) mm_free(job.out.data);
+        mm_free(tokens);
+        return full_parse(s);
+    }
+
+    release_lexemes(it->tokens + from, (job.synced >= 0 ? job.synced : it->token_count) - from);
+    if (job.out.data) mm_free(job.out.data);
+    mm_free(it->tokens);
+    free_ast(it->node);
+
+    s->program->children[index] = node;
+    it->node = node;
+    it->tokens = tokens;
+    it->token_count = n;
+    it->start = new_start;
+    it->line = new_line;
+    it->line_pending = 0;
+    it->end = new_start + tokens[n].offset;
+    shift_following(s, index + 1, delta, line_delta);
+    refresh_program_token(s);
+    s->item_parses++;
+    return INCR_REPARSED_ITEM;
+}
+
+/* ========== Interface pública ========== */
+
+static int count_lines(const char *text, int length) {
+    int i, lines = 0;
+    for (i = 0; i < length; i++) {
+        if (text[i] == '\n') lines++;
+    }
+    return lines;
+}
+
+static int is_blank(const char *text, int length) {
+    int i;
+    for (i = 0; i < length; i++) {
+        if (!isspace((unsigned char)text[i])) return 0;
+    }
+    return 1;
+}
+
+static void replace_text(IncrSession *s, int offset, int delete_len,
+                         const char *insert, int insert_len) {
+    int new_length = s->length - delete_len + insert_len;
+    if (new_length > s->capacity) {
+        s->capacity = new_length > s->capacity * 2 ? new_length : s->capacity * 2;
+        s->text = incr_alloc(s->text, s->capacity);
+    }
+    memmove(s->text + offset + insert_len, s->text + offset + delete_len,
+            s->length - offset - delete_len);
+    memcpy(s->text + offset, insert, insert_len);
+    s->length = new_length;
+}
+
+/* Último item que começa em offset ou antes, ou -1 */
+static int find_item(IncrSession *s, int offset) {
+    int lo = 0, hi = s->item_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s->items[mid].start <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo - 1;
+}
+
+IncrSession* incr_open(const char *text, int length) {
+    IncrSession *s = incr_alloc(NULL, sizeof(IncrSession));
+    memset(s, 0, sizeof(*s));
+    s->capacity = length > 0 ? length : 1;
+    s->text = incr_alloc(NULL, s->capacity);
+    memcpy(s->text, text, length);
+    s->length = length;
+    full_parse(s);
+    return s;
+}
+
+void incr_close(IncrSession *s) {
+    if (!s) return;
+    release_state(s);
+    if (s->items) mm_free(s->items);
+    mm_free(s->text);
+    mm_free(s);
+}
+
+IncrResult incr_edit(IncrSession *s, int offset, int delete_len,
+                     const char *insert, int insert_len) {
+    int delta, line_delta, blank, i, gap_start, gap_end;
+
+    if (!s || offset < 0 || delete_len < 0 || insert_len < 0 ||
+        offset + delete_len > s->length) {
+        return INCR_INVALID_EDIT;
+    }
+    delta = insert_len - delete_len;
+    line_delta = count_lines(insert, insert_len) - count_lines(s->text + offset, delete_len);
+    blank = is_blank(insert, insert_len) && is_blank(s->text + offset, delete_len);
+    replace_text(s, offset, delete_len, insert, insert_len);
+
+    if (!s->valid || s->item_count == 0) return full_parse(s);
+
+    i = find_item(s, offset);
+    gap_start = i >= 0 ? s->items[i].end
+                       : (s->outer_header > 0 ? s->outer[s->outer_header - 1].offset +
+                                                s->outer[s->outer_header - 1].length : 0);
+    gap_end = i + 1 < s->item_count ? s->items[i + 1].start : suffix_start(s);
+
+    /* Espaços entre itens: só desloca o que vem depois */
+    if (blank && offset >= gap_start && offset + delete_len <= gap_end) {
+        shift_following(s, i + 1, delta, line_delta);
+        refresh_program_token(s);
+        return INCR_SHIFTED;
+    }
+    if (i >= 0 && offset + delete_len <= s->items[i].end) {
+        return reparse_item(s, i, offset, delete_len, insert_len, line_delta);
+    }
+    return full_parse(s);
+}
+
+ASTNode* incr_item_node(IncrSession *s, int index) {
+    IncrItem *it;
+    if (!s || index < 0 || index >= s->item_count) return NULL;
+    it = &s->items[index];
+    if (it->line_pending) {
+        shift_nodes(it->node, 0, it->line_pending);
+        it->line_pending = 0;
+    }
+    return it->node;
+}
+
+ASTNode* incr_ast(IncrSession *s) {
+    int i;
+    if (!s) return NULL;
+    for (i = 0; i < s->item_count; i++) {
+        incr_item_node(s, i);
+    }
+    return s->program;
+}
+
+int incr_item_start(IncrSession *s, int index) {
+    if (!s || index < 0 || index >= s->item_count) return -1;
+    return s->items[index].start;
+}
@@ -0,0 +1,877 @@
+#include "inline.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Corpo processado: uma função, ou o programa 'principal() { ... }' */
+typedef struct {
+    ASTNode *node;
+    ASTNode *body;                  /* BLOCK, ou o próprio PROGRAM */
+    const char *name;
+    int first_site, site_count;     /* chamadas feitas no corpo */
+    int recursive;
+    /* Como função chamada, calculado na primeira vez (depois de o corpo já
+     * ter as suas expansões) */
+    int ready;
+    InlineDecision shape;           /* INLINE_EXPANDED: o corpo pode ser copiado */
+    int cost;
+    int param_count;
+    TypeId result;
+    const char **names;             /* declarados, ordenados */
+    int name_count;
+    const char **free_names;        /* usados e não declarados, ordenados */
+    int free_count;
+    int effects;                    /* grava global, lê, escreve ou chama */
+} Unit;
+
+typedef struct {
+    ASTNode *call;
+    ASTNode *stmt;                  /* comando que recebe o código antes dele */
+    ASTNode *parent;                /* pai dele quando registrado */
+    int callee;                     /* unidade, ou -1 */
+    int depth;
+    int loop_control;
+} Site;
+
+/* Código a inserir antes de stmt, na lista de comandos list */
+typedef struct {
+    ASTNode *list;
+    ASTNode *stmt;
+    int first, count;               /* em Inliner.hoisted */
+    int order;
+} Insert;
+
+typedef struct {
+    ASTNode *node;
+    int unit;
+} UnitKey;
+
+typedef struct {
+    ASTNode *stmt, *parent;
+} Enclosing;
+
+/* Nomes e tamanho de um corpo */
+typedef struct {
+    const char *source;
+    size_t len;
+    ASTNode *decl;                  /* declaração em curso */
+    int next_declarator;            /* filho dela que é o próximo nome */
+    int format_child;               /* filho dela que é um formato [..] */
+    int nodes;
+    int returns;
+    int io_calls;                   /* 'leia', 'escreva' e chamadas */
+    const char **names;
+    int name_count, name_capacity;
+    const char **uses;
+    int use_count, use_capacity;
+    const char **writes;            /* alvos de atribuição */
+    int write_count, write_capacity;
+} Scan;
+
+typedef struct {
+    SymTab *symtab;
+    const char *source;
+    size_t len;
+    Unit *units;
+    int unit_count, unit_capacity;
+    UnitKey *keys;                  /* unidades por nó, para as chamadas */
+    Site *sites;
+    int site_count, site_capacity;
+    Enclosing *stack;               /* comandos abertos no percurso */
+    int stack_count, stack_capacity;
+    int collecting;                 /* unidade percorrida */
+    ASTNode **hoisted;
+    int hoisted_count, hoisted_capacity;
+    Insert *inserts;
+    int insert_count, insert_capacity;
+    long created;                   /* nós criados pelas expansões */
+    InlineReport *report;
+} Inliner;
+
+/* Tags do percurso de registro */
+#define TAG_LOOP_CONTROL 1          /* condição de 'enquanto', condição ou passo de 'para' */
+#define TAG_DEPTH        2          /* um nível de laço (tag / TAG_DEPTH) */
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) {
+        fprintf(stderr, "Erro: memória insuficiente para a expansão em linha\n");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+static void* alloc(size_t size) {
+    void *p = mm_malloc(size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a expansão em linha\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static int is_statement(const ASTNode *node) {
+    switch (node->type) {
+        case AST_DECLARATION:
+        case AST_ASSIGNMENT:
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+        case AST_FOR_STMT:
+        case AST_READ_STMT:
+        case AST_WRITE_STMT:
+        case AST_RETURN_STMT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int is_list(const ASTNode *node) {
+    return node->type == AST_BLOCK || node->type == AST_PROGRAM;
+}
+
+static int compare_key(const void *a, const void *b) {
+    const ASTNode *x = ((const UnitKey*)a)->node, *y = ((const UnitKey*)b)->node;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_name(const void *a, const void *b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static int find_name(const char **names, int count, const char *name) {
+    return name && count > 0 && bsearch(&name, names, (size_t)count, sizeof(const char*), compare_name) != NULL;
+}
+
+/* Ordena e tira as repetições; retorna quantos ficam */
+static int sort_names(const char **names, int count) {
+    int i, out = 0;
+    if (count == 0) return 0;
+    qsort(names, (size_t)count, sizeof(const char*), compare_name);
+    for (i = 0; i < count; i++) {
+        if (out == 0 || strcmp(names[out - 1], names[i]) != 0) names[out++] = names[i];
+    }
+    return out;
+}
+
+/* ---------- Nomes e tamanho de um corpo ---------- */
+
+static AstWalkAction scan_pre(AstWalker *w, ASTNode *node, void *data) {
+    Scan *s = (Scan*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w);
+
+    s->nodes++;
+    if (parent && parent == s->decl) {
+        if (index == s->next_declarator) {
+            char arg = ast_declarator_arg(parent, index, s->source, s->len);
+            s->next_declarator += arg ? 2 : 1;
+            s->format_child = arg == '[' ? index + 1 : -1;
+            if (node->type == AST_IDENTIFIER && node->token.lexeme) {
+                s->names = grow(s->names, s->name_count, &s->name_capacity, sizeof(const char*));
+                s->names[s->name_count++] = node->token.lexeme;
+            }
+            return AST_WALK_SKIP;
+        }
+        if (index == s->format_child) return AST_WALK_SKIP;
+    }
+
+    switch (node->type) {
+        case AST_DECLARATION:
+            s->decl = node;
+            s->next_declarator = 0;
+            s->format_child = -1;
+            break;
+        case AST_FUNCTION_CALL:
+            /* O nome é de função */
+            s->nodes++;
+            s->io_calls++;
+            ast_walk_skip_to_child(w, 1);
+            break;
+        case AST_READ_STMT:
+        case AST_WRITE_STMT:
+            s->io_calls++;
+            break;
+        case AST_ASSIGNMENT:
+            if (node->token.lexeme) {
+                s->writes = grow(s->writes, s->write_count, &s->write_capacity, sizeof(const char*));
+                s->writes[s->write_count++] = node->token.lexeme;
+            }
+            break;
+        case AST_RETURN_STMT:
+            s->returns++;
+            break;
+        case AST_IDENTIFIER:
+            if (node->token.lexeme) {
+                s->uses = grow(s->uses, s->use_count, &s->use_capacity, sizeof(const char*));
+                s->uses[s->use_count++] = node->token.lexeme;
+            }
+            break;
+        default:
+            break;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void scan_post(AstWalker *w, ASTNode *node, void *data) {
+    Scan *s = (Scan*)data;
+    (void)w;
+    if (node == s->decl) s->decl = NULL;
+}
+
+static void scan(Scan *s, ASTNode *node) {
+    AstVisitor visitor = {scan_pre, scan_post, NULL, 0, 0};
+    visitor.data = s;
+    ast_walk(node, &visitor);
+}
+
+static void scan_init(Scan *s, const Inliner *in) {
+    memset(s, 0, sizeof(Scan));
+    s->source = in->source;
+    s->len = in->len;
+}
+
+static void scan_free(Scan *s) {
+    if (s->names) mm_free(s->names);
+    if (s->uses) mm_free(s->uses);
+    if (s->writes) mm_free(s->writes);
+}
+
+/* Parâmetros: os filhos entre o nome (0) e o corpo */
+static int param_end(const Unit *u) {
+    return u->node->type == AST_FUNCTION_DEF ? u->node->child_count - 1 : 1;
+}
+
+/* Nomes declarados no chamador, para a verificação das globais */
+static void caller_names(Inliner *in, const Unit *u, Scan *s) {
+    int i;
+    scan_init(s, in);
+    for (i = 1; i < param_end(u); i++) scan(s, u->node->children[i]);
+    scan(s, u->body);
+    s->name_count = sort_names(s->names, s->name_count);
+}
+
+/* Forma, custo e nomes de uma função, como chamada */
+static void unit_info(Inliner *in, Unit *u) {
+    Scan s;
+    ASTNode *last;
+    int i, j;
+
+    if (u->ready) return;
+    u->ready = 1;
+    u->shape = INLINE_EXPANDED;
+
+    scan_init(&s, in);
+    for (i = 1; i < param_end(u); i++) {
+        ASTNode *decl = u->node->children[i];
+        int before = s.name_count;
+        if (decl->type != AST_DECLARATION ||
+            (decl->token.type != TOK_KW_INTEIRO && decl->token.type != TOK_KW_DECIMAL)) {
+            u->shape = INLINE_PARAMS;
+        }
+        for (j = 0; j < decl->child_count; j++) {
+            if (ast_declarator_arg(decl, j, in->source, in->len)) u->shape = INLINE_PARAMS;
+        }
+        scan(&s, decl);
+        if (s.name_count - before != decl->child_count) u->shape = INLINE_PARAMS;
+    }
+    u->param_count = s.name_count;
+    s.nodes = 0;
+    scan(&s, u->body);
+    u->cost = s.nodes - 1;
+
+    /* Um único 'retorne', no fim do corpo */
+    last = u->body->child_count > 0 ? u->body->children[u->body->child_count - 1] : NULL;
+    if (u->body->lazy || s.returns != 1 || !last || last->type != AST_RETURN_STMT ||
+        last->child_count != 1) {
+        if (u->shape == INLINE_EXPANDED) u->shape = INLINE_RETURN;
+    } else {
+        u->result = last->children[0]->inferred_type;
+        if (type_kind(u->result) == TY_TXT && u->shape == INLINE_EXPANDED) u->shape = INLINE_RESULT;
+    }
+
+    u->name_count = sort_names(s.names, s.name_count);
+    u->names = s.names;
+    for (i = 0, j = 0; i < s.use_count; i++) {
+        if (!find_name(u->names, u->name_count, s.uses[i])) s.uses[j++] = s.uses[i];
+    }
+    u->free_count = sort_names(s.uses, j);
+    u->free_names = s.uses;
+
+    u->effects = s.io_calls > 0;
+    for (i = 0; i < s.write_count; i++) {
+        if (!find_name(u->names, u->name_count, s.writes[i])) u->effects = 1;
+    }
+    if (s.writes) mm_free(s.writes);
+}
+
+/* ---------- Registro das chamadas ---------- */
+
+static int find_unit(const Inliner *in, const ASTNode *func) {
+    UnitKey key, *found;
+    key.node = (ASTNode*)func;
+    found = bsearch(&key, in->keys, (size_t)in->unit_count, sizeof(UnitKey), compare_key);
+    return found ? found->unit : -1;
+}
+
+static int resolve(Inliner *in, const ASTNode *call) {
+    Symbol *sym;
+    if (call->child_count == 0 || !call->children[0] || !call->children[0]->token.lexeme) return -1;
+    sym = symtab_lookup(in->symtab, call->children[0]->token.lexeme);
+    if (!sym || sym->sclass != SYM_FUNC || !sym->extra) return -1;
+    return find_unit(in, (const ASTNode*)sym->extra);
+}
+
+static AstWalkAction collect_pre(AstWalker *w, ASTNode *node, void *data) {
+    Inliner *in = (Inliner*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w);
+    int tag = ast_walk_parent_tag(w);
+
+    if (parent && parent->type == AST_WHILE_STMT) {
+        if (index == 0) tag |= TAG_LOOP_CONTROL;
+        else tag += TAG_DEPTH;
+    } else if (parent && parent->type == AST_FOR_STMT) {
+        if (index == 1 || index == 2) tag |= TAG_LOOP_CONTROL;
+        else if (index == 3) tag += TAG_DEPTH;
+    }
+    ast_walk_set_tag(w, tag);
+
+    /* A inicialização de 'para' é avaliada antes dele: o código vai antes
+     * do 'para' */
+    if (parent && is_statement(node) && !(parent->type == AST_FOR_STMT && index != 3)) {
+        in->stack = grow(in->stack, in->stack_count, &in->stack_capacity, sizeof(Enclosing));
+        in->stack[in->stack_count].stmt = node;
+        in->stack[in->stack_count++].parent = parent;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+/* Na pós-ordem: as chamadas dos argumentos vêm antes */
+static void collect_post(AstWalker *w, ASTNode *node, void *data) {
+    Inliner *in = (Inliner*)data;
+    int tag = ast_walk_tag(w);
+
+    if (node->type == AST_FUNCTION_CALL && in->stack_count > 0) {
+        Site *s;
+        in->sites = grow(in->sites, in->site_count, &in->site_capacity, sizeof(Site));
+        s = &in->sites[in->site_count++];
+        s->call = node;
+        s->stmt = in->stack[in->stack_count - 1].stmt;
+        s->parent = in->stack[in->stack_count - 1].parent;
+        s->callee = resolve(in, node);
+        s->depth = tag / TAG_DEPTH;
+        s->loop_control = tag & TAG_LOOP_CONTROL;
+        in->units[in->collecting].site_count++;
+    }
+    if (in->stack_count > 0 && in->stack[in->stack_count - 1].stmt == node) in->stack_count--;
+}
+
+static void add_unit(Inliner *in, ASTNode *node, ASTNode *body, const char *name) {
+    Unit *u;
+    in->units = grow(in->units, in->unit_count, &in->unit_capacity, sizeof(Unit));
+    u = &in->units[in->unit_count++];
+    memset(u, 0, sizeof(Unit));
+    u->node = node;
+    u->body = body;
+    u->name = name;
+}
+
+static void collect(Inliner *in, ASTNode *program) {
+    AstVisitor visitor = {NULL, collect_post, NULL, 0, 0};
+    int i;
+
+    if (program->token.type == TOK_KW_PRINCIPAL) {
+        add_unit(in, program, program, "principal");
+    } else {
+        for (i = 0; i < program->child_count; i++) {
+            ASTNode *item = program->children[i];
+            ASTNode *body;
+            if (item->type != AST_FUNCTION_DEF || item->child_count < 2) continue;
+            body = item->children[item->child_count - 1];
+            if (!body || body->type != AST_BLOCK || body->lazy) continue;
+            add_unit(in, item, body, item->children[0]->token.lexeme);
+        }
+    }
+
+    in->keys = alloc(sizeof(UnitKey) * (size_t)(in->unit_count + 1));
+    for (i = 0; i < in->unit_count; i++) {
+        in->keys[i].node = in->units[i].node;
+        in->keys[i].unit = i;
+    }
+    qsort(in->keys, (size_t)in->unit_count, sizeof(UnitKey), compare_key);
+
+    visitor.pre = collect_pre;
+    visitor.data = in;
+    for (i = 0; i < in->unit_count; i++) {
+        in->collecting = i;
+        in->units[i].first_site = in->site_count;
+        in->stack_count = 0;
+        ast_walk(in->units[i].body, &visitor);
+    }
+}
+
+/* ---------- Grafo de chamadas ---------- */
+
+/* Componentes fortemente conexos (Tarjan, com pilha explícita): order
+ * recebe as unidades com cada componente depois dos que ele chama */
+static void call_order(Inliner *in, int *order) {
+    int n = in->unit_count, counter = 0, sp = 0, fp = 0, count = 0, s, i;
+    int *index = alloc(sizeof(int) * (size_t)(n + 1) * 5);
+    int *low = index + n + 1, *edge = low + n + 1, *scc = edge + n + 1, *path = scc + n + 1;
+    char *on_stack = alloc((size_t)n + 1);
+
+    for (i = 0; i < n; i++) {
+        index[i] = -1;
+        on_stack[i] = 0;
+    }
+    for (s = 0; s < n; s++) {
+        if (index[s] >= 0) continue;
+        index[s] = low[s] = counter++;
+        edge[s] = in->units[s].first_site;
+        scc[sp++] = path[fp++] = s;
+        on_stack[s] = 1;
+        while (fp > 0) {
+            int v = path[fp - 1], w;
+            if (edge[v] < in->units[v].first_site + in->units[v].site_count) {
+                w = in->sites[edge[v]++].callee;
+                if (w < 0) continue;
+                if (w == v) in->units[v].recursive = 1;
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    edge[w] = in->units[w].first_site;
+                    scc[sp++] = path[fp++] = w;
+                    on_stack[w] = 1;
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            fp--;
+            if (fp > 0 && low[v] < low[path[fp - 1]]) low[path[fp - 1]] = low[v];
+            if (low[v] == index[v]) {
+                int top = sp, m;
+                do {
+                    w = scc[--sp];
+                    on_stack[w] = 0;
+                } while (w != v);
+                for (m = sp; m < top; m++) {
+                    if (top - sp > 1) in->units[scc[m]].recursive = 1;
+                    order[count++] = scc[m];
+                }
+            }
+        }
+    }
+    mm_free(on_stack);
+    mm_free(index);
+}
+
+/* ---------- Expansão ---------- */
+
+/* Como no dobramento, o lexema novo é do gerenciador de memória e fica
+ * até o fim da compilação */
+static char* copy_text(const char *text) {
+    size_t n = strlen(text);
+    char *copy = alloc(n + 1);
+    memcpy(copy, text, n + 1);
+    return copy;
+}
+
+static void set_name(ASTNode *node, const char *name) {
+    node->token.lexeme = copy_text(name);
+}
+
+/* nome.N, o nome de um local da função na expansão N */
+static char* renamed(const char *name, int expansion) {
+    size_t n = strlen(name);
+    char *s = alloc(n + 16);
+    sprintf(s, "%s.%d", name, expansion);
+    return s;
+}
+
+static ASTNode* new_node(Inliner *in, ASTNodeType type, Token token) {
+    in->created++;
+    return ast_node_create(type, token);
+}
+
+/* Cópia de uma subárvore do corpo (pequena: até INLINE_MAX_LIMIT nós), com
+ * os locais da função renomeados */
+static ASTNode* clone(Inliner *in, const ASTNode *node, const Unit *callee, int expansion) {
+    ASTNode *copy = new_node(in, node->type, node->token);
+    int i;
+
+    copy->inferred_type = node->inferred_type;
+    copy->typed_version = node->typed_version;
+    if (node->value) copy->value = copy_text(node->value);
+    if ((node->type == AST_IDENTIFIER || node->type == AST_ASSIGNMENT) &&
+        find_name(callee->names, callee->name_count, node->token.lexeme)) {
+        char *name = renamed(node->token.lexeme, expansion);
+        set_name(copy, name);
+        mm_free(name);
+    }
+    for (i = 0; i < node->child_count; i++) {
+        ast_node_add_child(copy, clone(in, node->children[i], callee, expansion));
+    }
+    return copy;
+}
+
+static void hoist(Inliner *in, ASTNode *node) {
+    in->hoisted = grow(in->hoisted, in->hoisted_count, &in->hoisted_capacity, sizeof(ASTNode*));
+    in->hoisted[in->hoisted_count++] = node;
+}
+
+/* name = value; */
+static ASTNode* assignment(Inliner *in, Token at, const char *name, TypeId type, ASTNode *value) {
+    ASTNode *assign = new_node(in, AST_ASSIGNMENT, at);
+    ASTNode *target = new_node(in, AST_IDENTIFIER, at);
+    set_name(assign, name);
+    set_name(target, name);
+    assign->token.type = TOK_IDENTIFIER;
+    target->token.type = TOK_IDENTIFIER;
+    target->inferred_type = type;
+    assign->inferred_type = type;
+    ast_node_add_child(assign, target);
+    ast_node_add_child(assign, value);
+    return assign;
+}
+
+static void expand(Inliner *in, Site *site, const Unit *callee, int expansion) {
+    ASTNode *call = site->call, *name = call->children[0];
+    ASTNode *body = callee->body, *decl, *id;
+    Token at = name->token;
+    char *result;
+    int arg = 1, i, j;
+
+    /* Parâmetros: declarados como na assinatura, recebendo os argumentos */
+    for (i = 1; i < param_end(callee); i++) {
+        ASTNode *param = callee->node->children[i];
+        TypeId type = param->token.type == TOK_KW_DECIMAL ? TYPE_DEC : TYPE_INT;
+        hoist(in, clone(in, param, callee, expansion));
+        for (j = 0; j < param->child_count; j++) {
+            char *local = renamed(param->children[j]->token.lexeme, expansion);
+            hoist(in, assignment(in, param->children[j]->token, local, type, call->children[arg]));
+            call->children[arg++] = NULL;
+            mm_free(local);
+        }
+    }
+
+    for (i = 0; i < body->child_count - 1; i++) hoist(in, clone(in, body->children[i], callee, expansion));
+
+    /* O resultado, com o tipo da expressão do 'retorne' */
+    result = alloc(strlen(callee->name) + 18);
+    sprintf(result, "!%s.%d", callee->name, expansion);
+    at.type = type_kind(callee->result) == TY_DEC ? TOK_KW_DECIMAL : TOK_KW_INTEIRO;
+    at.lexeme = at.type == TOK_KW_DECIMAL ? "decimal" : "inteiro";
+    decl = new_node(in, AST_DECLARATION, at);
+    id = new_node(in, AST_IDENTIFIER, name->token);
+    set_name(id, result);
+    id->inferred_type = callee->result;
+    ast_node_add_child(decl, id);
+    hoist(in, decl);
+    hoist(in, assignment(in, name->token, result, callee->result,
+                         clone(in, body->children[body->child_count - 1]->children[0], callee,
+                               expansion)));
+
+    /* A chamada vira o identificador do resultado */
+    free_ast(name);
+    mm_free(call->children);
+    call->children = NULL;
+    call->child_count = call->child_capacity = 0;
+    call->type = AST_IDENTIFIER;
+    call->token = at;
+    call->token.type = TOK_IDENTIFIER;
+    set_name(call, result);
+    call->inferred_type = callee->result;
+    mm_free(result);
+}
+
+/* Lista de comandos que recebe o código da chamada; um comando único no
+ * corpo de 'se', 'enquanto' ou 'para' ganha um bloco */
+static ASTNode* statement_list(Inliner *in, Site *site) {
+    ASTNode *parent = site->parent, *block;
+    Token brace;
+    int i;
+
+    if (is_list(parent)) return parent;
+    for (i = 0; i < parent->child_count && parent->children[i] != site->stmt; i++) {
+    }
+    brace = site->stmt->token;
+    brace.type = TOK_LBRACE;
+    brace.lexeme = "{";
+    block = new_node(in, AST_BLOCK, brace);
+    ast_node_add_child(block, site->stmt);
+    parent->children[i] = block;
+    return block;
+}
+
+static void add_insert(Inliner *in, ASTNode *list, ASTNode *stmt, int first) {
+    Insert *last = in->insert_count > 0 ? &in->inserts[in->insert_count - 1] : NULL;
+    if (last && last->list == list && last->stmt == stmt) {
+        last->count = in->hoisted_count - last->first;
+        return;
+    }
+    in->inserts = grow(in->inserts, in->insert_count, &in->insert_capacity, sizeof(Insert));
+    last = &in->inserts[in->insert_count];
+    last->list = list;
+    last->stmt = stmt;
+    last->first = first;
+    last->count = in->hoisted_count - first;
+    last->order = in->insert_count++;
+}
+
+static int compare_insert(const void *a, const void *b) {
+    const Insert *x = (const Insert*)a, *y = (const Insert*)b;
+    if (x->list != y->list) return x->list < y->list ? -1 : 1;
+    return x->order - y->order;
+}
+
+/* Insere o código antes dos comandos, uma passada por lista */
+static void apply_inserts(Inliner *in) {
+    int i = 0;
+    if (in->insert_count == 0) return;
+    qsort(in->inserts, (size_t)in->insert_count, sizeof(Insert), compare_insert);
+    while (i < in->insert_count) {
+        ASTNode *list = in->inserts[i].list;
+        ASTNode **children;
+        int end = i, total = list->child_count, out = 0, j = 0, k;
+        while (end < in->insert_count && in->inserts[end].list == list) total += in->inserts[end++].count;
+        children = alloc(sizeof(ASTNode*) * (size_t)total);
+        for (; i < end; i++) {
+            while (j < list->child_count && list->children[j] != in->inserts[i].stmt) {
+                children[out++] = list->children[j++];
+            }
+            for (k = 0; k < in->inserts[i].count; k++) {
+                children[out++] = in->hoisted[in->inserts[i].first + k];
+            }
+        }
+        while (j < list->child_count) children[out++] = list->children[j++];
+        if (list->children) mm_free(list->children);
+        list->children = children;
+        list->child_count = list->child_capacity = total;
+    }
+    in->insert_count = 0;
+    in->hoisted_count = 0;
+}
+
+static int count_nodes(Inliner *in, ASTNode *node) {
+    Scan s;
+    int nodes;
+    scan_init(&s, in);
+    scan(&s, node);
+    nodes = s.nodes;
+    scan_free(&s);
+    return nodes;
+}
+
+static int shadowed(const Unit *callee, const Scan *caller) {
+    int i;
+    for (i = 0; i < callee->free_count; i++) {
+        if (find_name(caller->names, caller->name_count, callee->free_names[i])) return 1;
+    }
+    return 0;
+}
+
+/* O resto do comando, que seria avaliado junto com a chamada */
+typedef struct {
+    ASTNode *call;
+    ASTNode *decl;                  /* o comando, se for uma declaração */
+    const Scan *caller;
+    int in_call;
+    int globals;                    /* globais lidas fora da chamada */
+    int calls;                      /* outras chamadas */
+    int declared;                   /* argumento com um nome declarado no comando */
+} Order;
+
+static int declared_by(const ASTNode *decl, const char *name) {
+    int i;
+    for (i = 0; i < decl->child_count; i++) {
+        const ASTNode *c = decl->children[i];
+        if (c->type == AST_IDENTIFIER && c->token.lexeme && strcmp(c->token.lexeme, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static AstWalkAction order_pre(AstWalker *w, ASTNode *node, void *data) {
+    Order *o = (Order*)data;
+    ASTNode *parent = ast_walk_parent(w);
+
+    if (node == o->call) o->in_call = 1;
+    switch (node->type) {
+        case AST_FUNCTION_CALL:
+            if (!o->in_call) o->calls++;
+            ast_walk_skip_to_child(w, 1);
+            break;
+        case AST_IDENTIFIER:
+            if (!node->token.lexeme) break;
+            if (o->in_call) {
+                if (o->decl && declared_by(o->decl, node->token.lexeme)) o->declared = 1;
+            } else if (!(parent && parent->type == AST_ASSIGNMENT && ast_walk_child_index(w) == 0) &&
+                       !strchr(node->token.lexeme, '.') &&
+                       !find_name(o->caller->names, o->caller->name_count, node->token.lexeme)) {
+                /* Os resultados de expansões anteriores têm '.' e não são globais */
+                o->globals++;
+            }
+            break;
+        default:
+            break;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void order_post(AstWalker *w, ASTNode *node, void *data) {
+    Order *o = (Order*)data;
+    (void)w;
+    if (node == o->call) o->in_call = 0;
+}
+
+/* O corpo vai antes do comando: o que o comando lê ou chama fora da chamada
+ * passaria a ver os efeitos da função antes da hora (e o argumento que usa
+ * um nome declarado no mesmo comando, o nome ainda sem declaração) */
+static int out_of_order(const Site *site, const Unit *callee, const Scan *caller) {
+    AstVisitor visitor = {order_pre, order_post, NULL, 0, 0};
+    ASTNode *stmt = site->stmt, *head = stmt;
+    Order o;
+
+    memset(&o, 0, sizeof(Order));
+    o.call = site->call;
+    o.caller = caller;
+    if (stmt->type == AST_DECLARATION) o.decl = stmt;
+    /* De 'se' e 'para', só a condição e a inicialização vêm com o comando */
+    if ((stmt->type == AST_IF_STMT || stmt->type == AST_FOR_STMT) && stmt->child_count > 0) {
+        head = stmt->children[0];
+    }
+    visitor.data = &o;
+    ast_walk(head, &visitor);
+    return o.declared || (callee->effects && (o.globals || o.calls)) ||
+           (callee->free_count > 0 && o.calls);
+}
+
+static int depth_limit(int depth) {
+    long limit = INLINE_BASE_LIMIT;
+    while (depth-- > 0 && limit < INLINE_MAX_LIMIT) limit *= 2;
+    return limit < INLINE_MAX_LIMIT ? (int)limit : INLINE_MAX_LIMIT;
+}
+
+static void process_unit(Inliner *in, int u) {
+    Unit *caller = &in->units[u];
+    Scan names;
+    long budget, added = 0;
+    int end = caller->first_site + caller->site_count, expansions = 0, i, j;
+
+    if (caller->site_count == 0) return;
+    caller_names(in, caller, &names);
+    budget = count_nodes(in, caller->body);
+    if (budget < INLINE_GROWTH_MIN) budget = INLINE_GROWTH_MIN;
+
+    for (i = caller->first_site; i < end; i++) {
+        Site *site = &in->sites[i];
+        InlineSite *r = &in->report->sites[i];
+        Unit *callee = site->callee >= 0 ? &in->units[site->callee] : NULL;
+        ASTNode *list;
+        int first;
+
+        r->caller = caller->name;
+        r->callee = callee ? callee->name : site->call->children[0]->token.lexeme;
+        r->line = site->call->token.line;
+        r->loop_depth = site->depth;
+        r->limit = depth_limit(site->depth);
+        if (!callee) {
+            r->decision = INLINE_UNKNOWN;
+            continue;
+        }
+        if (!callee->recursive) {
+            unit_info(in, callee);
+            r->cost = callee->cost;
+        }
+        if (site->loop_control) r->decision = INLINE_LOOP_CONDITION;
+        else if (callee->recursive) r->decision = INLINE_RECURSIVE;
+        else if (callee->shape != INLINE_EXPANDED) r->decision = callee->shape;
+        else if (site->call->child_count - 1 != callee->param_count) r->decision = INLINE_ARGUMENTS;
+        else if (shadowed(callee, &names)) r->decision = INLINE_SHADOWED;
+        else if (out_of_order(site, callee, &names)) r->decision = INLINE_ORDER;
+        else if (callee->cost > r->limit) r->decision = INLINE_TOO_LARGE;
+        else if (added + callee->cost > budget) r->decision = INLINE_GROWTH;
+        else r->decision = INLINE_EXPANDED;
+        if (r->decision != INLINE_EXPANDED) continue;
+
+        /* As próximas chamadas do mesmo comando vão para a mesma lista */
+        list = statement_list(in, site);
+        for (j = i + 1; j < end && in->sites[j].stmt == site->stmt; j++) in->sites[j].parent = list;
+        first = in->hoisted_count;
+        expand(in, site, callee, ++expansions);
+        add_insert(in, list, site->stmt, first);
+        added += callee->cost;
+        in->report->expanded++;
+    }
+    apply_inserts(in);
+    scan_free(&names);
+}
+
+InlineReport* inline_functions(ASTNode *program, SymTab *symtab, const char *source, size_t len) {
+    InlineReport *report = alloc(sizeof(InlineReport));
+    Inliner in;
+    int *order, i;
+
+    memset(report, 0, sizeof(InlineReport));
+    if (!program || program->type != AST_PROGRAM) return report;
+
+    memset(&in, 0, sizeof(Inliner));
+    in.symtab = symtab;
+    in.source = source;
+    in.len = len;
+    in.report = report;
+    collect(&in, program);
+
+    report->site_count = in.site_count;
+    report->sites = alloc(sizeof(InlineSite) * (size_t)(in.site_count + 1));
+    memset(report->sites, 0, sizeof(InlineSite) * (size_t)(in.site_count + 1));
+
+    /* As funções chamadas antes das que chamam */
+    order = alloc(sizeof(int) * (size_t)(in.unit_count + 1));
+    call_order(&in, order);
+    for (i = 0; i < in.unit_count; i++) process_unit(&in, order[i]);
+    report->nodes_added = in.created;
+
+    for (i = 0; i < in.unit_count; i++) {
+        if (in.units[i].names) mm_free(in.units[i].names);
+        if (in.units[i].free_names) mm_free(in.units[i].free_names);
+    }
+    mm_free(order);
+    if (in.units) mm_free(in.units);
+    if (in.keys) mm_free(in.keys);
+    if (in.sites) mm_free(in.sites);
+    if (in.stack) mm_free(in.stack);
+    if (in.hoisted) mm_free(in.hoisted);
+    if (in.inserts) mm_free(in.inserts);
+    return report;
+}
+
+const char* inline_decision_str(InlineDecision d) {
+    switch (d) {
+        case INLINE_EXPANDED:       return "expandida";
+        case INLINE_RECURSIVE:      return "recursiva";
+        case INLINE_TOO_LARGE:      return "corpo acima do limite";
+        case INLINE_GROWTH:         return "chamador já cresceu o máximo";
+        case INLINE_LOOP_CONDITION: return "na condição ou no passo de um laço";
+        case INLINE_RETURN:         return "'retorne' fora do fim do corpo";
+        case INLINE_PARAMS:         return "parâmetro texto ou vetor";
+        case INLINE_RESULT:         return "retorna texto";
+        case INLINE_ARGUMENTS:      return "número de argumentos diferente";
+        case INLINE_SHADOWED:       return "usa uma global escondida no chamador";
+        case INLINE_ORDER:          return "mudaria a ordem de avaliação do comando";
+        default:                    return "função sem definição";
+    }
+}
+
+void inline_report_free(InlineReport *r) {
+    if (!r) return;
+    if (r->sites) mm_free(r->sites);
+    mm_free(r);
+}
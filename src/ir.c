@@ -0,0 +1,1562 @@
+#include "ir.h"
+#include "ast_walk.h"
+#include "memmgr.h"
+#include "symtab.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void out_of_memory(void) {
+    fprintf(stderr, "Erro: memória insuficiente para a representação intermediária\n");
+    exit(EXIT_FAILURE);
+}
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) out_of_memory();
+    return items;
+}
+
+static void* alloc(size_t size) {
+    void *p = mm_malloc(size ? size : 1);
+    if (!p) out_of_memory();
+    return p;
+}
+
+static int* alloc_ints(int count, int fill) {
+    int *p = alloc(sizeof(int) * (size_t)count), i;
+    for (i = 0; i < count; i++) p[i] = fill;
+    return p;
+}
+
+/* ---------- Instruções e blocos ---------- */
+
+int ir_is_pure(const IrInst *inst) {
+    switch (inst->op) {
+        case IR_STORE:
+        case IR_CALL:
+        case IR_READ:
+        case IR_WRITE:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+int ir_operand_count(const IrInst *inst) {
+    switch (inst->op) {
+        case IR_BINARY:
+            return 2;
+        case IR_UNARY:
+        case IR_STORE:
+            return 1;
+        case IR_PHI:
+        case IR_CALL:
+        case IR_WRITE:
+            return inst->b;
+        default:
+            return 0;
+    }
+}
+
+int ir_operand(const IrFunc *f, const IrInst *inst, int i) {
+    switch (inst->op) {
+        case IR_PHI:
+        case IR_CALL:
+        case IR_WRITE:
+            return f->args[inst->a + i];
+        default:
+            return i == 0 ? inst->a : inst->b;
+    }
+}
+
+void ir_set_operand(IrFunc *f, IrInst *inst, int i, int value) {
+    switch (inst->op) {
+        case IR_PHI:
+        case IR_CALL:
+        case IR_WRITE:
+            f->args[inst->a + i] = value;
+            break;
+        default:
+            if (i == 0) inst->a = value;
+            else inst->b = value;
+            break;
+    }
+}
+
+int ir_succ_count(const IrBlock *b) {
+    switch (b->term) {
+        case IR_JUMP:   return 1;
+        case IR_BRANCH: return 2;
+        default:        return 0;
+    }
+}
+
+int ir_add_const(IrFunc *f, const FoldValue *v) {
+    f->consts = grow(f->consts, f->const_count, &f->const_capacity, sizeof(FoldValue));
+    f->consts[f->const_count] = *v;
+    return f->const_count++;
+}
+
+static int new_inst(IrFunc *f, IrOp op, int block, TypeId type, int line) {
+    IrInst *inst;
+    f->insts = grow(f->insts, f->inst_count, &f->inst_capacity, sizeof(IrInst));
+    inst = &f->insts[f->inst_count];
+    memset(inst, 0, sizeof(IrInst));
+    inst->op = (unsigned char)op;
+    inst->block = block;
+    inst->type = type;
+    inst->a = inst->b = -1;
+    inst->line = line;
+    return f->inst_count++;
+}
+
+static int new_block(IrFunc *f) {
+    IrBlock *b;
+    f->blocks = grow(f->blocks, f->block_count, &f->block_capacity, sizeof(IrBlock));
+    b = &f->blocks[f->block_count];
+    memset(b, 0, sizeof(IrBlock));
+    b->term = IR_RETURN;
+    b->value = -1;
+    b->succ[0] = b->succ[1] = -1;
+    b->next_part = -1;
+    return f->block_count++;
+}
+
+void ir_remove_pred(IrFunc *f, int block, int index) {
+    IrBlock *b = &f->blocks[block];
+    int i, j;
+    for (i = index; i + 1 < b->pred_count; i++) {
+        f->preds[b->pred_first + i] = f->preds[b->pred_first + i + 1];
+    }
+    b->pred_count--;
+    for (i = b->first; i < b->first + b->count; i++) {
+        IrInst *phi = &f->insts[f->code[i]];
+        if (phi->op != IR_PHI) continue;
+        for (j = index; j + 1 < phi->b; j++) f->args[phi->a + j] = f->args[phi->a + j + 1];
+        phi->b--;
+    }
+}
+
+static int chase(int *forward, int v) {
+    int root = v;
+    if (v < 0) return v;
+    while (forward[root] != root) root = forward[root];
+    while (forward[v] != root) {
+        int next = forward[v];
+        forward[v] = root;
+        v = next;
+    }
+    return root;
+}
+
+void ir_replace_uses(IrFunc *f, int *forward) {
+    int v, i;
+    for (v = 0; v < f->inst_count; v++) {
+        IrInst *inst = &f->insts[v];
+        int n = inst->op == IR_NOP ? 0 : ir_operand_count(inst);
+        for (i = 0; i < n; i++) ir_set_operand(f, inst, i, chase(forward, ir_operand(f, inst, i)));
+    }
+    for (i = 0; i < f->block_count; i++) {
+        if (!f->blocks[i].dead) f->blocks[i].value = chase(forward, f->blocks[i].value);
+    }
+}
+
+/* Acrescenta a new_code as instruções do trecho de code, phis ou não */
+static int take_code(const IrFunc *f, const IrBlock *b, int phis, int *new_code, int n) {
+    int i;
+    for (i = b->first; i < b->first + b->count; i++) {
+        const IrInst *inst = &f->insts[f->code[i]];
+        if (inst->op == IR_NOP || (inst->op == IR_PHI) != phis) continue;
+        new_code[n++] = f->code[i];
+    }
+    return n;
+}
+
+void ir_compact(IrFunc *f) {
+    int *block_map = alloc_ints(f->block_count, -1);
+    int *owner = alloc_ints(f->block_count, -1);
+    int *inst_map = alloc_ints(f->inst_count, -1);
+    int *const_map = alloc_ints(f->const_count, -1);
+    int *order = alloc(sizeof(int) * (size_t)(f->inst_count + 1));
+    IrBlock *blocks;
+    IrInst *insts;
+    int *args, *preds;
+    FoldValue *consts;
+    int b, p, i, n = 0, blocks_kept = 0, arg_count = 0, pred_count = 0, const_count = 0;
+
+    /* Blocos absorvidos seguem a cadeia de quem os absorveu */
+    for (b = 0; b < f->block_count; b++) {
+        if (f->blocks[b].dead) continue;
+        for (p = f->blocks[b].next_part; p >= 0; p = f->blocks[p].next_part) block_map[p] = -2;
+    }
+    for (b = 0; b < f->block_count; b++) {
+        block_map[b] = f->blocks[b].dead || block_map[b] == -2 ? -1 : blocks_kept++;
+    }
+
+    /* Nova ordem: por bloco, phis primeiro, depois as partes absorvidas */
+    blocks = alloc(sizeof(IrBlock) * (size_t)blocks_kept);
+    for (b = 0; b < f->block_count; b++) {
+        IrBlock *nb;
+        int start = n;
+        if (block_map[b] < 0) continue;
+        nb = &blocks[block_map[b]];
+        *nb = f->blocks[b];
+        n = take_code(f, &f->blocks[b], 1, order, n);
+        nb->phi_count = n - start;
+        for (p = b; p >= 0; p = f->blocks[p].next_part) {
+            owner[p] = block_map[b];
+            n = take_code(f, &f->blocks[p], 0, order, n);
+        }
+        nb->first = start;
+        nb->count = n - start;
+        nb->next_part = -1;
+    }
+    for (i = 0; i < n; i++) inst_map[order[i]] = i;
+
+    /* Instruções renumeradas, com os operandos e args recompactados */
+    insts = alloc(sizeof(IrInst) * (size_t)n);
+    for (i = 0; i < n; i++) {
+        IrInst *inst = &insts[i];
+        int k, count;
+        *inst = f->insts[order[i]];
+        inst->block = owner[inst->block];
+        count = ir_operand_count(inst);
+        if (inst->op == IR_PHI || inst->op == IR_CALL || inst->op == IR_WRITE) {
+            arg_count += count;
+        } else {
+            for (k = 0; k < count; k++) {
+                int v = ir_operand(f, inst, k);
+                ir_set_operand(f, inst, k, v >= 0 ? inst_map[v] : v);
+            }
+        }
+        if (inst->op == IR_CONST) {
+            if (const_map[inst->a] < 0) const_map[inst->a] = const_count++;
+            inst->a = const_map[inst->a];
+        }
+    }
+    args = alloc(sizeof(int) * (size_t)arg_count);
+    arg_count = 0;
+    for (i = 0; i < n; i++) {
+        IrInst *inst = &insts[i];
+        int k, count;
+        if (inst->op != IR_PHI && inst->op != IR_CALL && inst->op != IR_WRITE) continue;
+        count = inst->b;
+        for (k = 0; k < count; k++) {
+            int v = f->args[inst->a + k];
+            args[arg_count + k] = v >= 0 ? inst_map[v] : v;
+        }
+        inst->a = arg_count;
+        arg_count += count;
+    }
+    consts = alloc(sizeof(FoldValue) * (size_t)const_count);
+    for (i = 0; i < f->const_count; i++) {
+        if (const_map[i] >= 0) consts[const_map[i]] = f->consts[i];
+    }
+
+    /* Blocos: predecessores, sucessores e terminador renumerados */
+    for (b = 0; b < f->block_count; b++) {
+        if (block_map[b] >= 0) pred_count += f->blocks[b].pred_count;
+    }
+    preds = alloc(sizeof(int) * (size_t)pred_count);
+    pred_count = 0;
+    for (b = 0; b < f->block_count; b++) {
+        IrBlock *nb;
+        if (block_map[b] < 0) continue;
+        nb = &blocks[block_map[b]];
+        for (i = 0; i < nb->pred_count; i++) {
+            preds[pred_count + i] = block_map[f->preds[nb->pred_first + i]];
+        }
+        nb->pred_first = pred_count;
+        pred_count += nb->pred_count;
+        for (i = 0; i < 2; i++) nb->succ[i] = nb->succ[i] >= 0 ? block_map[nb->succ[i]] : -1;
+        nb->value = nb->value >= 0 ? inst_map[nb->value] : -1;
+    }
+
+    if (f->insts) mm_free(f->insts);
+    if (f->args) mm_free(f->args);
+    if (f->blocks) mm_free(f->blocks);
+    if (f->preds) mm_free(f->preds);
+    if (f->code) mm_free(f->code);
+    if (f->consts) mm_free(f->consts);
+    f->insts = insts;
+    f->inst_count = f->inst_capacity = n;
+    f->args = args;
+    f->arg_count = f->arg_capacity = arg_count;
+    f->blocks = blocks;
+    f->block_count = f->block_capacity = blocks_kept;
+    f->preds = preds;
+    f->pred_total = pred_count;
+    for (i = 0; i < n; i++) order[i] = i;
+    f->code = order;
+    f->code_count = n;
+    f->consts = consts;
+    f->const_count = f->const_capacity = const_count;
+
+    mm_free(block_map);
+    mm_free(owner);
+    mm_free(inst_map);
+    mm_free(const_map);
+}
+
+/* ---------- Dominadores ---------- */
+
+/* Cooper, Harvey e Kennedy: idom iterado em pós-ordem reversa */
+void ir_dominators(const IrFunc *f, IrDomTree *t) {
+    int n = f->block_count, count = 0, changed = 1, i, b;
+    int *post_num = alloc_ints(n, -1), *rpo = alloc(sizeof(int) * (size_t)(n + 1));
+    int *stack = alloc(sizeof(int) * (size_t)(n + 1)), *next = alloc_ints(n, 0), top = 0;
+
+    t->idom = alloc_ints(n, -1);
+    t->pre = alloc_ints(n, -1);
+    t->post = alloc_ints(n, -1);
+    t->child_first = alloc_ints(n + 1, 0);
+    t->order = alloc(sizeof(int) * (size_t)(n + 1));
+    t->children = alloc(sizeof(int) * (size_t)(n + 1));
+    t->count = 0;
+    if (n == 0) {
+        mm_free(post_num);
+        mm_free(rpo);
+        mm_free(stack);
+        mm_free(next);
+        return;
+    }
+
+    /* Pós-ordem por busca em profundidade sem recursão */
+    post_num[0] = -2;
+    stack[top++] = 0;
+    while (top > 0) {
+        int cur = stack[top - 1];
+        const IrBlock *blk = &f->blocks[cur];
+        if (next[cur] < ir_succ_count(blk)) {
+            int s = blk->succ[next[cur]++];
+            if (s >= 0 && post_num[s] == -1) {
+                post_num[s] = -2;
+                stack[top++] = s;
+            }
+            continue;
+        }
+        post_num[cur] = count;
+        rpo[count++] = cur;
+        top--;
+    }
+    /* rpo guardou a pós-ordem; inverte */
+    for (i = 0; i < count / 2; i++) {
+        int tmp = rpo[i];
+        rpo[i] = rpo[count - 1 - i];
+        rpo[count - 1 - i] = tmp;
+    }
+
+    t->idom[0] = 0;
+    while (changed) {
+        changed = 0;
+        for (i = 1; i < count; i++) {
+            const IrBlock *blk;
+            int new_idom = -1, k;
+            b = rpo[i];
+            blk = &f->blocks[b];
+            for (k = 0; k < blk->pred_count; k++) {
+                int p = f->preds[blk->pred_first + k];
+                if (p < 0 || post_num[p] < 0 || t->idom[p] < 0) continue;
+                if (new_idom < 0) {
+                    new_idom = p;
+                    continue;
+                }
+                while (p != new_idom) {
+                    while (post_num[p] < post_num[new_idom]) p = t->idom[p];
+                    while (post_num[new_idom] < post_num[p]) new_idom = t->idom[new_idom];
+                }
+            }
+            if (new_idom >= 0 && t->idom[b] != new_idom) {
+                t->idom[b] = new_idom;
+                changed = 1;
+            }
+        }
+    }
+
+    /* Filhos de cada bloco na árvore */
+    for (b = 1; b < n; b++) {
+        if (t->idom[b] >= 0) t->child_first[t->idom[b] + 1]++;
+    }
+    for (b = 0; b < n; b++) t->child_first[b + 1] += t->child_first[b];
+    for (b = 0; b < n; b++) next[b] = t->child_first[b];
+    for (b = 1; b < n; b++) {
+        if (t->idom[b] >= 0) t->children[next[t->idom[b]]++] = b;
+    }
+
+    /* Numeração em pré e pós-ordem da árvore */
+    {
+        int pre = 0, post = 0;
+        for (b = 0; b < n; b++) next[b] = t->child_first[b];
+        top = 0;
+        stack[top++] = 0;
+        t->pre[0] = pre++;
+        t->order[t->count++] = 0;
+        while (top > 0) {
+            int cur = stack[top - 1];
+            if (next[cur] < t->child_first[cur + 1]) {
+                int c = t->children[next[cur]++];
+                t->pre[c] = pre++;
+                t->order[t->count++] = c;
+                stack[top++] = c;
+                continue;
+            }
+            t->post[cur] = post++;
+            top--;
+        }
+    }
+
+    mm_free(post_num);
+    mm_free(rpo);
+    mm_free(stack);
+    mm_free(next);
+}
+
+void ir_dom_free(IrDomTree *t) {
+    mm_free(t->idom);
+    mm_free(t->pre);
+    mm_free(t->post);
+    mm_free(t->child_first);
+    mm_free(t->order);
+    mm_free(t->children);
+}
+
+int ir_dominates(const IrDomTree *t, int a, int b) {
+    return t->pre[a] >= 0 && t->pre[b] >= 0 && t->pre[a] <= t->pre[b] && t->post[b] <= t->post[a];
+}
+
+/* ---------- Geração a partir da AST ---------- */
+
+#define VAR_GLOBAL (-2)
+#define VAR_NONE   (-1)
+
+/* Variável local (ou global, na lista do módulo) pela primeira declaração */
+typedef struct {
+    const char *name;
+    int offset;
+    TypeId type;
+} LowVar;
+
+typedef struct {
+    int from, next;
+} LowEdge;
+
+/* Estado de um bloco durante a geração */
+typedef struct {
+    int head, tail, count;          /* predecessores em edges, em ordem */
+    int incomplete;                 /* phis à espera de sealed, em phis */
+    unsigned char sealed;           /* todos os predecessores conhecidos */
+} LowBlock;
+
+typedef struct {
+    int var, phi, next;
+} LowPhi;
+
+typedef struct {
+    int block, var, value;
+} LowDef;
+
+/* Comando de controle em curso */
+typedef struct {
+    int join;                       /* 'se': junção; laços: cabeçalho */
+    int other;                      /* 'se': senão; laços: saída */
+} LowCtx;
+
+typedef struct {
+    IrFunc *f;
+    const char *source;
+    size_t len;
+    AstVisitor visitor;
+    LowVar *vars;                   /* locais da função, por nome */
+    int var_count, var_capacity;
+    const LowVar *globals;
+    int global_count;
+    int *undef;                     /* IR_UNDEF de cada local, ou -1 */
+    LowBlock *lb;
+    int lb_capacity;
+    LowEdge *edges;
+    int edge_count, edge_capacity;
+    LowPhi *phis;
+    int phi_count, phi_capacity;
+    LowPhi *pending;                /* phis selados sem argumentos */
+    int pending_count, pending_capacity;
+    LowDef *defs;                   /* (bloco, variável) -> valor, endereçamento aberto */
+    int def_capacity, def_count;
+    int *forward;                   /* phi trivial -> o valor que o substitui */
+    int *phi_var;
+    int forward_capacity;
+    int *path;
+    int path_count, path_capacity;
+    int *stack;                     /* valores das expressões em curso */
+    int stack_count, stack_capacity;
+    LowCtx *ctx;
+    int ctx_count, ctx_capacity;
+    ASTNode *decl;                  /* declaração em curso */
+    int decl_base;                  /* altura de stack ao entrar nela */
+    int next_declarator;
+    int format_child;               /* o formato [a.b] do declarador, não lido */
+    int cur;                        /* bloco corrente */
+} Lower;
+
+static int compare_low_var(const void *a, const void *b) {
+    const LowVar *x = (const LowVar*)a, *y = (const LowVar*)b;
+    int c = strcmp(x->name, y->name);
+    return c ? c : x->offset - y->offset;
+}
+
+/* Ordena e fica com a primeira declaração de cada nome */
+static int sort_vars(LowVar *vars, int count) {
+    int i, n = 0;
+    qsort(vars, (size_t)count, sizeof(LowVar), compare_low_var);
+    for (i = 0; i < count; i++) {
+        if (n > 0 && strcmp(vars[n - 1].name, vars[i].name) == 0) continue;
+        vars[n++] = vars[i];
+    }
+    return n;
+}
+
+static const LowVar* find_name(const LowVar *vars, int count, const char *name) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strcmp(vars[mid].name, name) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < count && strcmp(vars[lo].name, name) == 0 ? &vars[lo] : NULL;
+}
+
+/* A local já declarada, senão a global já declarada, senão a local
+ * declarada adiante (erro semântico: lida como indefinida) */
+static int lookup(Lower *L, const char *name, int offset) {
+    const LowVar *v = find_name(L->vars, L->var_count, name);
+    const LowVar *g = find_name(L->globals, L->global_count, name);
+    if (v && v->offset <= offset) return (int)(v - L->vars);
+    if (g && g->offset <= offset) return VAR_GLOBAL;
+    return v ? (int)(v - L->vars) : VAR_NONE;
+}
+
+static TypeId keyword_type(TokenType keyword) {
+    switch (keyword) {
+        case TOK_KW_DECIMAL: return TYPE_DEC;
+        case TOK_KW_TEXTO:   return TYPE_TXT;
+        default:             return TYPE_INT;
+    }
+}
+
+static void add_var(LowVar **vars, int *count, int *capacity, const ASTNode *id, TokenType keyword) {
+    *vars = grow(*vars, *count, capacity, sizeof(LowVar));
+    (*vars)[*count].name = id->token.lexeme;
+    (*vars)[*count].offset = id->token.offset;
+    (*vars)[*count].type = keyword_type(keyword);
+    (*count)++;
+}
+
+/* Nomes declarados numa DECLARATION */
+static void collect_declaration(Lower *L, const ASTNode *decl, LowVar **vars, int *count, int *capacity) {
+    int i = 0;
+    while (i < decl->child_count && decl->children[i] &&
+           decl->children[i]->type == AST_IDENTIFIER && decl->children[i]->token.lexeme) {
+        char arg = ast_declarator_arg(decl, i, L->source, L->len);
+        add_var(vars, count, capacity, decl->children[i], decl->token.type);
+        i += arg ? 2 : 1;
+    }
+}
+
+static AstWalkAction collect_pre(AstWalker *w, ASTNode *node, void *data) {
+    Lower *L = (Lower*)data;
+    (void)w;
+    if (node->type == AST_DECLARATION) {
+        collect_declaration(L, node, &L->vars, &L->var_count, &L->var_capacity);
+        return AST_WALK_SKIP;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static int emit(Lower *L, IrOp op, int block, TypeId type, int line) {
+    int v = new_inst(L->f, op, block, type, line);
+    if (v >= L->forward_capacity) {
+        L->forward_capacity = L->forward_capacity ? L->forward_capacity * 2 : 64;
+        L->forward = mm_realloc(L->forward, sizeof(int) * (size_t)L->forward_capacity);
+        L->phi_var = mm_realloc(L->phi_var, sizeof(int) * (size_t)L->forward_capacity);
+        if (!L->forward || !L->phi_var) out_of_memory();
+    }
+    L->forward[v] = v;
+    L->phi_var[v] = -1;
+    return v;
+}
+
+static int lower_block(Lower *L) {
+    int b = new_block(L->f);
+    if (b >= L->lb_capacity) {
+        L->lb_capacity = L->lb_capacity ? L->lb_capacity * 2 : 16;
+        L->lb = mm_realloc(L->lb, sizeof(LowBlock) * (size_t)L->lb_capacity);
+        if (!L->lb) out_of_memory();
+    }
+    L->lb[b].head = L->lb[b].tail = L->lb[b].incomplete = -1;
+    L->lb[b].count = 0;
+    L->lb[b].sealed = 0;
+    return b;
+}
+
+static void push(Lower *L, int value) {
+    L->stack = grow(L->stack, L->stack_count, &L->stack_capacity, sizeof(int));
+    L->stack[L->stack_count++] = value;
+}
+
+static int pop(Lower *L) {
+    return L->stack_count > 0 ? L->stack[--L->stack_count] : -1;
+}
+
+/* ----- Definições por bloco ----- */
+
+static unsigned def_hash(int block, int var) {
+    return (unsigned)block * 2654435761u ^ (unsigned)var * 40503u;
+}
+
+static int def_get(Lower *L, int block, int var) {
+    unsigned mask = (unsigned)L->def_capacity - 1, h;
+    if (L->def_capacity == 0) return -1;
+    for (h = def_hash(block, var) & mask; L->defs[h].block >= 0; h = (h + 1) & mask) {
+        if (L->defs[h].block == block && L->defs[h].var == var) return L->defs[h].value;
+    }
+    return -1;
+}
+
+static void def_set(Lower *L, int block, int var, int value) {
+    unsigned mask, h;
+    if ((L->def_count + 1) * 2 > L->def_capacity) {
+        LowDef *old = L->defs;
+        int old_capacity = L->def_capacity, i;
+        L->def_capacity = L->def_capacity ? L->def_capacity * 2 : 64;
+        L->defs = alloc(sizeof(LowDef) * (size_t)L->def_capacity);
+        for (i = 0; i < L->def_capacity; i++) L->defs[i].block = -1;
+        L->def_count = 0;
+        for (i = 0; i < old_capacity; i++) {
+            if (old[i].block >= 0) def_set(L, old[i].block, old[i].var, old[i].value);
+        }
+        if (old) mm_free(old);
+    }
+    mask = (unsigned)L->def_capacity - 1;
+    for (h = def_hash(block, var) & mask; L->defs[h].block >= 0; h = (h + 1) & mask) {
+        if (L->defs[h].block == block && L->defs[h].var == var) {
+            L->defs[h].value = value;
+            return;
+        }
+    }
+    L->defs[h].block = block;
+    L->defs[h].var = var;
+    L->defs[h].value = value;
+    L->def_count++;
+}
+
+/* ----- Construção de SSA ----- */
+
+static int find(Lower *L, int v) {
+    return chase(L->forward, v);
+}
+
+/* O IR_UNDEF da variável, na entrada (domina todo bloco alcançável) */
+static int undef_of(Lower *L, int var) {
+    if (L->undef[var] < 0) {
+        L->undef[var] = emit(L, IR_UNDEF, 0, L->vars[var].type, L->f->line);
+        L->f->insts[L->undef[var]].name = L->vars[var].name;
+    }
+    return L->undef[var];
+}
+
+static int new_phi(Lower *L, int block, int var) {
+    int phi = emit(L, IR_PHI, block, L->vars[var].type, L->f->line);
+    L->f->insts[phi].name = L->vars[var].name;
+    L->f->insts[phi].b = 0;
+    L->phi_var[phi] = var;
+    return phi;
+}
+
+/* O único valor dos argumentos além do próprio phi; -1 se só há o próprio,
+ * -2 se há mais de um */
+static int trivial_value(Lower *L, int phi) {
+    const IrInst *inst = &L->f->insts[phi];
+    int same = -1, i;
+    for (i = 0; i < inst->b; i++) {
+        int v = find(L, L->f->args[inst->a + i]);
+        if (v == same || v == phi) continue;
+        if (same >= 0) return -2;
+        same = v;
+    }
+    return same;
+}
+
+static int try_remove_trivial(Lower *L, int phi) {
+    int same = trivial_value(L, phi);
+    if (same == -2) return 0;
+    if (same < 0) same = undef_of(L, L->phi_var[phi]);
+    L->forward[phi] = same;
+    L->f->insts[phi].op = IR_NOP;
+    return 1;
+}
+
+/*
+ * Valor da variável no fim do bloco. Sobe pelos predecessores únicos sem
+ * recursão; num bloco ainda não selado, ou de junção, cria um phi e o deixa
+ * à espera dos argumentos (incompletos ou pending), o que também quebra os
+ * ciclos dos laços.
+ */
+static int read_var(Lower *L, int var, int block) {
+    int value, i;
+    L->path_count = 0;
+    for (;;) {
+        LowBlock *b = &L->lb[block];
+        value = def_get(L, block, var);
+        if (value >= 0) {
+            value = find(L, value);
+            break;
+        }
+        if (!b->sealed) {
+            value = new_phi(L, block, var);
+            L->phis = grow(L->phis, L->phi_count, &L->phi_capacity, sizeof(LowPhi));
+            L->phis[L->phi_count].var = var;
+            L->phis[L->phi_count].phi = value;
+            L->phis[L->phi_count].next = L->lb[block].incomplete;
+            L->lb[block].incomplete = L->phi_count++;
+            break;
+        }
+        if (b->count == 0) {
+            value = undef_of(L, var);
+            break;
+        }
+        if (b->count == 1) {
+            L->path = grow(L->path, L->path_count, &L->path_capacity, sizeof(int));
+            L->path[L->path_count++] = block;
+            block = L->edges[b->head].from;
+            continue;
+        }
+        value = new_phi(L, block, var);
+        L->pending = grow(L->pending, L->pending_count, &L->pending_capacity, sizeof(LowPhi));
+        L->pending[L->pending_count].var = var;
+        L->pending[L->pending_count++].phi = value;
+        break;
+    }
+    def_set(L, block, var, value);
+    for (i = 0; i < L->path_count; i++) def_set(L, L->path[i], var, value);
+    return value;
+}
+
+/* Preenche os phis pendentes: um argumento por predecessor, contíguos em args */
+static void drain(Lower *L) {
+    while (L->pending_count > 0) {
+        LowPhi p = L->pending[--L->pending_count];
+        IrFunc *f = L->f;
+        int block = f->insts[p.phi].block, first = f->arg_count, e;
+        for (e = L->lb[block].head; e >= 0; e = L->edges[e].next) {
+            int v = read_var(L, p.var, L->edges[e].from);
+            f->args = grow(f->args, f->arg_count, &f->arg_capacity, sizeof(int));
+            f->args[f->arg_count++] = v;
+        }
+        f->insts[p.phi].a = first;
+        f->insts[p.phi].b = f->arg_count - first;
+        try_remove_trivial(L, p.phi);
+    }
+}
+
+static int use_var(Lower *L, int var) {
+    int v = read_var(L, var, L->cur);
+    drain(L);
+    return find(L, v);
+}
+
+static void seal(Lower *L, int block) {
+    int i;
+    for (i = L->lb[block].incomplete; i >= 0; i = L->phis[i].next) {
+        L->pending = grow(L->pending, L->pending_count, &L->pending_capacity, sizeof(LowPhi));
+        L->pending[L->pending_count++] = L->phis[i];
+    }
+    L->lb[block].incomplete = -1;
+    L->lb[block].sealed = 1;
+    drain(L);
+}
+
+/* ----- Blocos ----- */
+
+static void add_edge(Lower *L, int from, int to) {
+    LowBlock *b = &L->lb[to];
+    L->edges = grow(L->edges, L->edge_count, &L->edge_capacity, sizeof(LowEdge));
+    L->edges[L->edge_count].from = from;
+    L->edges[L->edge_count].next = -1;
+    if (b->tail >= 0) L->edges[b->tail].next = L->edge_count;
+    else b->head = L->edge_count;
+    b->tail = L->edge_count++;
+    b->count++;
+}
+
+static void jump(Lower *L, int to) {
+    IrBlock *b = &L->f->blocks[L->cur];
+    b->term = IR_JUMP;
+    b->succ[0] = to;
+    add_edge(L, L->cur, to);
+}
+
+static void branch(Lower *L, int cond, int yes, int no) {
+    IrBlock *b = &L->f->blocks[L->cur];
+    b->term = IR_BRANCH;
+    b->value = cond;
+    b->succ[0] = yes;
+    b->succ[1] = no;
+    add_edge(L, L->cur, yes);
+    add_edge(L, L->cur, no);
+}
+
+/* ----- Variáveis e valores ----- */
+
+static int read_name(Lower *L, const ASTNode *id) {
+    int var = lookup(L, id->token.lexeme, id->token.offset), v;
+    if (var >= 0) return use_var(L, var);
+    v = emit(L, var == VAR_GLOBAL ? IR_LOAD : IR_UNDEF, L->cur, id->inferred_type, id->token.line);
+    L->f->insts[v].name = id->token.lexeme;
+    return v;
+}
+
+static void assign_name(Lower *L, const ASTNode *id, int value) {
+    int var = lookup(L, id->token.lexeme, id->token.offset), s;
+    if (var >= 0) {
+        def_set(L, L->cur, var, value);
+    } else if (var == VAR_GLOBAL) {
+        s = emit(L, IR_STORE, L->cur, L->f->insts[value].type, id->token.line);
+        L->f->insts[s].a = value;
+        L->f->insts[s].name = id->token.lexeme;
+    }
+}
+
+static TypeId name_type(Lower *L, const ASTNode *id) {
+    int var = lookup(L, id->token.lexeme, id->token.offset);
+    if (var >= 0) return L->vars[var].type;
+    return id->inferred_type;
+}
+
+static int literal(Lower *L, const ASTNode *node) {
+    FoldValue value;
+    int v;
+    if (fold_literal(node, &value)) {
+        v = emit(L, IR_CONST, L->cur, node->inferred_type, node->token.line);
+        L->f->insts[v].a = ir_add_const(L->f, &value);
+    } else {
+        v = emit(L, IR_LITERAL, L->cur, node->inferred_type, node->token.line);
+        L->f->insts[v].name = node->token.lexeme;
+    }
+    return v;
+}
+
+/* Instrução com os últimos count valores da pilha como args */
+static int emit_args(Lower *L, IrOp op, const ASTNode *node, int count) {
+    IrFunc *f = L->f;
+    int v = emit(L, op, L->cur, node->inferred_type, node->token.line), i;
+    f->insts[v].a = f->arg_count;
+    f->insts[v].b = count;
+    for (i = 0; i < count; i++) {
+        f->args = grow(f->args, f->arg_count, &f->arg_capacity, sizeof(int));
+        f->args[f->arg_count++] = L->stack[L->stack_count - count + i];
+    }
+    L->stack_count -= count;
+    return v;
+}
+
+/* ----- Comandos ----- */
+
+static LowCtx* top_ctx(Lower *L) {
+    return &L->ctx[L->ctx_count - 1];
+}
+
+static void push_ctx(Lower *L) {
+    L->ctx = grow(L->ctx, L->ctx_count, &L->ctx_capacity, sizeof(LowCtx));
+    L->ctx[L->ctx_count].join = L->ctx[L->ctx_count].other = -1;
+    L->ctx_count++;
+}
+
+/* Condição de 'se' avaliada: desvia para o então (e o senão) */
+static void if_then(Lower *L, const ASTNode *stmt) {
+    LowCtx *c = top_ctx(L);
+    int cond = pop(L), then_block = lower_block(L);
+    c->other = stmt->child_count > 2 ? lower_block(L) : -1;
+    c->join = lower_block(L);
+    branch(L, cond, then_block, c->other >= 0 ? c->other : c->join);
+    seal(L, then_block);
+    if (c->other >= 0) seal(L, c->other);
+    L->cur = then_block;
+}
+
+static void loop_header(Lower *L) {
+    int header = lower_block(L);
+    jump(L, header);
+    L->cur = header;
+    top_ctx(L)->join = header;
+}
+
+/* Condição do laço avaliada: desvia para o corpo ou a saída */
+static void loop_body(Lower *L) {
+    LowCtx *c = top_ctx(L);
+    int cond = pop(L), body = lower_block(L);
+    c->other = lower_block(L);
+    branch(L, cond, body, c->other);
+    seal(L, body);
+    seal(L, c->other);
+    L->cur = body;
+}
+
+static void loop_end(Lower *L) {
+    LowCtx *c = top_ctx(L);
+    jump(L, c->join);
+    seal(L, c->join);
+    L->cur = c->other;
+    L->ctx_count--;
+}
+
+static void declare(Lower *L, ASTNode *decl) {
+    int i = 0, k = L->decl_base;
+    while (i < decl->child_count && decl->children[i] &&
+           decl->children[i]->type == AST_IDENTIFIER) {
+        char arg = ast_declarator_arg(decl, i, L->source, L->len);
+        if (arg == '=' && k < L->stack_count) assign_name(L, decl->children[i], L->stack[k++]);
+        i += arg ? 2 : 1;
+    }
+    L->stack_count = L->decl_base;
+    L->decl = NULL;
+}
+
+static AstWalkAction lower_pre(AstWalker *w, ASTNode *node, void *data) {
+    Lower *L = (Lower*)data;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w);
+
+    ast_walk_set_tag(w, 0);
+    if (parent) {
+        switch (parent->type) {
+            case AST_IF_STMT:
+                if (index == 1) {
+                    if_then(L, parent);
+                } else if (index == 2) {
+                    jump(L, top_ctx(L)->join);
+                    L->cur = top_ctx(L)->other;
+                }
+                break;
+            case AST_WHILE_STMT:
+                if (index == 1) loop_body(L);
+                break;
+            case AST_FOR_STMT:
+                /* O incremento vem depois do corpo (em lower_post) */
+                if (index == 1) {
+                    loop_header(L);
+                } else if (index == 2) {
+                    loop_body(L);
+                    return AST_WALK_SKIP;
+                }
+                break;
+            case AST_DECLARATION:
+                /* Nomes declarados não são lidos */
+                if (parent == L->decl && index == L->next_declarator) {
+                    char arg = ast_declarator_arg(parent, index, L->source, L->len);
+                    L->next_declarator += arg ? 2 : 1;
+                    L->format_child = arg == '[' ? index + 1 : -1;
+                    ast_walk_set_tag(w, 1);
+                } else if (parent == L->decl && index == L->format_child) {
+                    ast_walk_set_tag(w, 1);
+                    return AST_WALK_SKIP;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (node->type) {
+        case AST_IF_STMT:
+        case AST_FOR_STMT:
+            push_ctx(L);
+            break;
+        case AST_WHILE_STMT:
+            push_ctx(L);
+            loop_header(L);
+            break;
+        case AST_DECLARATION:
+            L->decl = node;
+            L->decl_base = L->stack_count;
+            L->next_declarator = 0;
+            L->format_child = -1;
+            break;
+        case AST_FUNCTION_CALL:
+            /* O nome não é lido */
+            ast_walk_skip_to_child(w, 1);
+            break;
+        default:
+            break;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void lower_post(AstWalker *w, ASTNode *node, void *data) {
+    Lower *L = (Lower*)data;
+    IrFunc *f = L->f;
+    ASTNode *parent = ast_walk_parent(w);
+    int index = ast_walk_child_index(w), v, i;
+
+    if (ast_walk_tag(w)) return;
+    switch (node->type) {
+        case AST_LITERAL:
+            push(L, literal(L, node));
+            break;
+
+        case AST_IDENTIFIER:
+            if (!node->token.lexeme) break;
+            if (parent && ((parent->type == AST_ASSIGNMENT && index == 0) ||
+                           parent->type == AST_READ_STMT)) break;
+            push(L, read_name(L, node));
+            break;
+
+        case AST_BINARY_OP: {
+            int b = pop(L), a = pop(L);
+            v = emit(L, IR_BINARY, L->cur, node->inferred_type, node->token.line);
+            f->insts[v].sub = (unsigned char)node->token.type;
+            f->insts[v].a = a;
+            f->insts[v].b = b;
+            push(L, v);
+            break;
+        }
+
+        case AST_UNARY_OP: {
+            int a = pop(L);
+            v = emit(L, IR_UNARY, L->cur, node->inferred_type, node->token.line);
+            f->insts[v].sub = (unsigned char)node->token.type;
+            f->insts[v].a = a;
+            push(L, v);
+            break;
+        }
+
+        case AST_FUNCTION_CALL:
+            v = emit_args(L, IR_CALL, node, node->child_count > 0 ? node->child_count - 1 : 0);
+            if (node->child_count > 0 && node->children[0]) {
+                f->insts[v].name = node->children[0]->token.lexeme;
+            }
+            push(L, v);
+            break;
+
+        case AST_ASSIGNMENT:
+            if (parent && parent->type == AST_FOR_STMT && index == 2) break;
+            v = pop(L);
+            if (node->child_count > 0 && node->children[0] && v >= 0) {
+                assign_name(L, node->children[0], v);
+            }
+            break;
+
+        case AST_DECLARATION:
+            declare(L, node);
+            break;
+
+        case AST_READ_STMT:
+            for (i = 0; i < node->child_count; i++) {
+                ASTNode *id = node->children[i];
+                if (!id || !id->token.lexeme) continue;
+                v = emit(L, IR_READ, L->cur, name_type(L, id), node->token.line);
+                f->insts[v].name = id->token.lexeme;
+                assign_name(L, id, v);
+            }
+            break;
+
+        case AST_WRITE_STMT:
+            emit_args(L, IR_WRITE, node, node->child_count);
+            break;
+
+        case AST_RETURN_STMT:
+            /* O que segue no bloco é inalcançável: vai para um bloco sem
+             * predecessores */
+            v = node->child_count > 0 ? pop(L) : -1;
+            f->blocks[L->cur].term = IR_RETURN;
+            f->blocks[L->cur].value = v;
+            L->cur = lower_block(L);
+            seal(L, L->cur);
+            break;
+
+        case AST_IF_STMT:
+            jump(L, top_ctx(L)->join);
+            seal(L, top_ctx(L)->join);
+            L->cur = top_ctx(L)->join;
+            L->ctx_count--;
+            break;
+
+        case AST_WHILE_STMT:
+            loop_end(L);
+            break;
+
+        case AST_FOR_STMT:
+            if (node->child_count > 2) ast_walk(node->children[2], &L->visitor);
+            loop_end(L);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Começa uma função: entrada selada, parâmetros como valores */
+static IrFunc* begin_func(Lower *L, IrModule *m, const char *name, int line) {
+    IrFunc *f;
+    m->funcs = mm_realloc(m->funcs, sizeof(IrFunc) * (size_t)(m->func_count + 1));
+    if (!m->funcs) out_of_memory();
+    f = &m->funcs[m->func_count++];
+    memset(f, 0, sizeof(IrFunc));
+    f->name = name;
+    f->line = line;
+    L->f = f;
+    L->edge_count = L->phi_count = L->pending_count = L->stack_count = L->ctx_count = 0;
+    L->def_count = 0;
+    if (L->defs) {
+        int i;
+        for (i = 0; i < L->def_capacity; i++) L->defs[i].block = -1;
+    }
+    L->cur = lower_block(L);
+    seal(L, L->cur);
+    return f;
+}
+
+/* Fecha a função: retorno implícito, phis triviais, vetores planos */
+static void end_func(Lower *L) {
+    IrFunc *f = L->f;
+    int changed = 1, v, b, i;
+    int *count;
+
+    /* Um phi pode ficar trivial depois que um argumento foi substituído */
+    while (changed) {
+        changed = 0;
+        for (v = 0; v < f->inst_count; v++) {
+            if (f->insts[v].op == IR_PHI && try_remove_trivial(L, v)) changed = 1;
+        }
+    }
+    ir_replace_uses(f, L->forward);
+
+    /* Predecessores na ordem dos argumentos dos phis */
+    f->preds = alloc(sizeof(int) * (size_t)L->edge_count);
+    f->pred_total = 0;
+    for (b = 0; b < f->block_count; b++) {
+        int e;
+        f->blocks[b].pred_first = f->pred_total;
+        f->blocks[b].pred_count = L->lb[b].count;
+        for (e = L->lb[b].head; e >= 0; e = L->edges[e].next) f->preds[f->pred_total++] = L->edges[e].from;
+    }
+
+    /* code: por bloco, phis e depois o resto, na ordem de criação */
+    count = alloc_ints(f->block_count + 1, 0);
+    for (v = 0; v < f->inst_count; v++) count[f->insts[v].block + 1]++;
+    for (b = 0; b < f->block_count; b++) count[b + 1] += count[b];
+    f->code = alloc(sizeof(int) * (size_t)(f->inst_count + 1));
+    f->code_count = f->inst_count;
+    for (b = 0; b < f->block_count; b++) {
+        f->blocks[b].first = count[b];
+        f->blocks[b].count = count[b + 1] - count[b];
+    }
+    for (i = 0; i < 2; i++) {
+        for (v = 0; v < f->inst_count; v++) {
+            if ((f->insts[v].op == IR_PHI) == (i == 0)) f->code[count[f->insts[v].block]++] = v;
+        }
+    }
+    mm_free(count);
+    ir_compact(f);
+}
+
+static void lower_params(Lower *L, const ASTNode *def) {
+    IrFunc *f = L->f;
+    int i, k;
+    for (i = 1; i < def->child_count; i++) {
+        const ASTNode *decl = def->children[i];
+        if (!decl || decl->type != AST_DECLARATION) continue;
+        for (k = 0; k < decl->child_count; k++) {
+            const ASTNode *id = decl->children[k];
+            int var, v;
+            if (!id || id->type != AST_IDENTIFIER || !id->token.lexeme) continue;
+            var = lookup(L, id->token.lexeme, id->token.offset);
+            v = emit(L, IR_PARAM, 0, keyword_type(decl->token.type), id->token.line);
+            f->insts[v].a = f->param_count++;
+            f->insts[v].name = id->token.lexeme;
+            if (var >= 0) def_set(L, 0, var, v);
+        }
+    }
+}
+
+static void lower_function(Lower *L, IrModule *m, ASTNode *def) {
+    AstVisitor collect = {collect_pre, NULL, NULL, 0, 0};
+    const char *name = def->child_count > 0 && def->children[0] ? def->children[0]->token.lexeme : "?";
+    int i;
+
+    collect.data = L;
+    L->var_count = 0;
+    ast_walk(def, &collect);
+    L->var_count = sort_vars(L->vars, L->var_count);
+    if (L->undef) mm_free(L->undef);
+    L->undef = alloc_ints(L->var_count, -1);
+
+    begin_func(L, m, name, def->token.line);
+    lower_params(L, def);
+    for (i = 1; i < def->child_count; i++) {
+        if (def->children[i] && def->children[i]->type == AST_BLOCK) ast_walk(def->children[i], &L->visitor);
+    }
+    end_func(L);
+}
+
+/* Comandos de nível superior: a função "(globais)", ou o programa
+ * 'principal() { ... }' inteiro */
+static void lower_statements(Lower *L, IrModule *m, ASTNode *program, const char *name) {
+    int i;
+    if (L->undef) mm_free(L->undef);
+    L->undef = alloc_ints(L->var_count, -1);
+    begin_func(L, m, name, program->token.line);
+    for (i = 0; i < program->child_count; i++) {
+        ASTNode *item = program->children[i];
+        if (item && item->type != AST_FUNCTION_DEF) ast_walk(item, &L->visitor);
+    }
+    end_func(L);
+}
+
+IrModule* ir_lower(ASTNode *program, const char *source, size_t len) {
+    IrModule *m = alloc(sizeof(IrModule));
+    LowVar *globals = NULL;
+    int global_count = 0, global_capacity = 0, has_statements = 0, i;
+    Lower L;
+
+    m->funcs = NULL;
+    m->func_count = 0;
+    if (!program) return m;
+
+    memset(&L, 0, sizeof(Lower));
+    L.source = source;
+    L.len = len;
+    L.visitor.pre = lower_pre;
+    L.visitor.post = lower_post;
+    L.visitor.data = &L;
+
+    if (program->token.type == TOK_KW_PRINCIPAL) {
+        /* Sem globais: as declarações são locais de principal */
+        AstVisitor collect = {collect_pre, NULL, NULL, 0, 0};
+        collect.data = &L;
+        ast_walk(program, &collect);
+        L.var_count = sort_vars(L.vars, L.var_count);
+        lower_statements(&L, m, program, "principal");
+    } else {
+        /* Globais: as declarações de nível superior */
+        for (i = 0; i < program->child_count; i++) {
+            ASTNode *item = program->children[i];
+            if (!item || item->type == AST_FUNCTION_DEF) continue;
+            has_statements = 1;
+            if (item->type == AST_DECLARATION) {
+                collect_declaration(&L, item, &globals, &global_count, &global_capacity);
+            }
+        }
+        global_count = sort_vars(globals, global_count);
+        L.globals = globals;
+        L.global_count = global_count;
+        if (has_statements) lower_statements(&L, m, program, "(globais)");
+        for (i = 0; i < program->child_count; i++) {
+            ASTNode *item = program->children[i];
+            if (item && item->type == AST_FUNCTION_DEF) lower_function(&L, m, item);
+        }
+    }
+
+    if (globals) mm_free(globals);
+    if (L.vars) mm_free(L.vars);
+    if (L.undef) mm_free(L.undef);
+    if (L.lb) mm_free(L.lb);
+    if (L.edges) mm_free(L.edges);
+    if (L.phis) mm_free(L.phis);
+    if (L.pending) mm_free(L.pending);
+    if (L.defs) mm_free(L.defs);
+    if (L.forward) mm_free(L.forward);
+    if (L.phi_var) mm_free(L.phi_var);
+    if (L.path) mm_free(L.path);
+    if (L.stack) mm_free(L.stack);
+    if (L.ctx) mm_free(L.ctx);
+    return m;
+}
+
+void ir_free(IrModule *m) {
+    int i;
+    if (!m) return;
+    for (i = 0; i < m->func_count; i++) {
+        IrFunc *f = &m->funcs[i];
+        if (f->insts) mm_free(f->insts);
+        if (f->args) mm_free(f->args);
+        if (f->blocks) mm_free(f->blocks);
+        if (f->preds) mm_free(f->preds);
+        if (f->code) mm_free(f->code);
+        if (f->consts) mm_free(f->consts);
+    }
+    if (m->funcs) mm_free(m->funcs);
+    mm_free(m);
+}
+
+void ir_measure(const IrModule *m, long *insts, long *blocks, size_t *bytes) {
+    int i;
+    *insts = *blocks = 0;
+    *bytes = 0;
+    for (i = 0; i < m->func_count; i++) {
+        const IrFunc *f = &m->funcs[i];
+        *insts += f->inst_count;
+        *blocks += f->block_count;
+        *bytes += (size_t)f->inst_count * sizeof(IrInst) + (size_t)f->arg_count * sizeof(int) +
+                  (size_t)f->block_count * sizeof(IrBlock) + (size_t)f->pred_total * sizeof(int) +
+                  (size_t)f->code_count * sizeof(int) + (size_t)f->const_count * sizeof(FoldValue);
+    }
+}
+
+/* ---------- Impressão ---------- */
+
+static const char* op_symbol(TokenType op) {
+    switch (op) {
+        case TOK_PLUS:   return "+";
+        case TOK_MINUS:  return "-";
+        case TOK_STAR:   return "*";
+        case TOK_SLASH:  return "/";
+        case TOK_MODULO: return "%";
+        case TOK_CARET:  return "^";
+        case TOK_EQ:     return "==";
+        case TOK_NEQ:    return "<>";
+        case TOK_LT:     return "<";
+        case TOK_GT:     return ">";
+        case TOK_LE:     return "<=";
+        case TOK_GE:     return ">=";
+        case TOK_AND:    return "&&";
+        case TOK_OR:     return "||";
+        default:         return "?";
+    }
+}
+
+static void print_args(const IrFunc *f, const IrInst *inst) {
+    int i;
+    for (i = 0; i < inst->b; i++) printf("%sv%d", i ? ", " : "", f->args[inst->a + i]);
+}
+
+static void print_inst(const IrFunc *f, int v) {
+    const IrInst *inst = &f->insts[v];
+    const IrBlock *b = &f->blocks[inst->block];
+    int i;
+
+    if (inst->op != IR_STORE && inst->op != IR_WRITE) printf("    v%d = ", v);
+    else printf("    ");
+    switch (inst->op) {
+        case IR_CONST: {
+            TypeId type;
+            char *text = fold_value_text(&f->consts[inst->a], &type);
+            printf("%s", text);
+            mm_free(text);
+            break;
+        }
+        case IR_LITERAL:
+            if (type_kind(inst->type) == TY_TXT) printf("\"%s\"", inst->name);
+            else printf("%s", inst->name);
+            break;
+        case IR_PARAM:
+            printf("parametro %d %s", inst->a, inst->name);
+            break;
+        case IR_UNDEF:
+            printf("indefinido %s", inst->name ? inst->name : "");
+            break;
+        case IR_PHI:
+            printf("phi %s [", inst->name ? inst->name : "");
+            for (i = 0; i < inst->b; i++) {
+                printf("%sb%d: v%d", i ? ", " : "", f->preds[b->pred_first + i], f->args[inst->a + i]);
+            }
+            printf("]");
+            break;
+        case IR_BINARY:
+            printf("v%d %s v%d", inst->a, op_symbol((TokenType)inst->sub), inst->b);
+            break;
+        case IR_UNARY:
+            printf("%sv%d", op_symbol((TokenType)inst->sub), inst->a);
+            break;
+        case IR_LOAD:
+            printf("carrega %s", inst->name);
+            break;
+        case IR_STORE:
+            printf("guarda %s, v%d", inst->name, inst->a);
+            break;
+        case IR_CALL:
+            printf("chama %s(", inst->name ? inst->name : "?");
+            print_args(f, inst);
+            printf(")");
+            break;
+        case IR_READ:
+            printf("leia %s", inst->name);
+            break;
+        case IR_WRITE:
+            printf("escreva ");
+            print_args(f, inst);
+            break;
+        default:
+            printf("?");
+            break;
+    }
+    if (inst->op != IR_STORE && inst->op != IR_WRITE) printf(" : %s", symtab_type_str(inst->type));
+    printf("\n");
+}
+
+void ir_print(const IrModule *m) {
+    int i, b, k;
+    for (i = 0; i < m->func_count; i++) {
+        const IrFunc *f = &m->funcs[i];
+        printf("\nfuncao %s (linha %d, %d %s)\n", f->name, f->line, f->param_count,
+               f->param_count == 1 ? "parâmetro" : "parâmetros");
+        for (b = 0; b < f->block_count; b++) {
+            const IrBlock *blk = &f->blocks[b];
+            printf("b%d:", b);
+            for (k = 0; k < blk->pred_count; k++) {
+                printf("%sb%d", k ? ", " : "    ; de ", f->preds[blk->pred_first + k]);
+            }
+            printf("\n");
+            for (k = blk->first; k < blk->first + blk->count; k++) print_inst(f, f->code[k]);
+            switch (blk->term) {
+                case IR_JUMP:
+                    printf("    salta b%d\n", blk->succ[0]);
+                    break;
+                case IR_BRANCH:
+                    printf("    se v%d b%d senao b%d\n", blk->value, blk->succ[0], blk->succ[1]);
+                    break;
+                default:
+                    if (blk->value >= 0) printf("    retorna v%d\n", blk->value);
+                    else printf("    retorna\n");
+                    break;
+            }
+        }
+    }
+}
+
+/* ---------- Verificação ---------- */
+
+static int verify_error(const IrFunc *f, int block, const char *fmt, ...) {
+    va_list ap;
+    fprintf(stderr, "\033[31mIR inválida (%s, b%d): ", f->name, block);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "\033[0m\n");
+    return 1;
+}
+
+/* Definição de v disponível no ponto pos (de code) do bloco b */
+static int available(const IrFunc *f, const IrDomTree *t, const int *pos, int v, int b, int at) {
+    int d = f->insts[v].block;
+    if (d == b) return pos[v] < at;
+    return ir_dominates(t, d, b);
+}
+
+int ir_verify_func(const IrFunc *f) {
+    IrDomTree t;
+    int *pos, *seen, errors = 0, b, i, k;
+
+    if (f->block_count == 0) return verify_error(f, 0, "sem bloco de entrada");
+    pos = alloc_ints(f->inst_count, -1);
+    seen = alloc_ints(f->block_count, 0);
+
+    /* Cada instrução uma vez em code, no bloco certo, phis primeiro */
+    for (b = 0; b < f->block_count; b++) {
+        const IrBlock *blk = &f->blocks[b];
+        if (blk->first < 0 || blk->count < 0 || blk->first + blk->count > f->code_count) {
+            errors += verify_error(f, b, "instruções fora de code");
+            continue;
+        }
+        for (i = blk->first; i < blk->first + blk->count; i++) {
+            int v = f->code[i];
+            if (v < 0 || v >= f->inst_count || pos[v] >= 0) {
+                errors += verify_error(f, b, "instrução v%d repetida ou inexistente", v);
+                continue;
+            }
+            pos[v] = i;
+            if (f->insts[v].block != b) errors += verify_error(f, b, "v%d diz estar em b%d", v, f->insts[v].block);
+            if (f->insts[v].op == IR_NOP) errors += verify_error(f, b, "v%d removida ainda em code", v);
+            if ((f->insts[v].op == IR_PHI) != (i < blk->first + blk->phi_count)) {
+                errors += verify_error(f, b, "v%d fora da região dos phis", v);
+            }
+        }
+    }
+    if (errors > 0) {
+        mm_free(pos);
+        mm_free(seen);
+        return errors;
+    }
+
+    /* Arestas: os predecessores de cada bloco são os que saltam para ele */
+    for (b = 0; b < f->block_count; b++) {
+        const IrBlock *blk = &f->blocks[b];
+        for (k = 0; k < ir_succ_count(blk); k++) {
+            int s = blk->succ[k];
+            if (s < 0 || s >= f->block_count) {
+                errors += verify_error(f, b, "sucessor b%d inexistente", s);
+                continue;
+            }
+            seen[s]++;
+        }
+        if ((blk->term == IR_BRANCH && blk->value < 0) || blk->value >= f->inst_count) {
+            errors += verify_error(f, b, "terminador com valor inválido");
+        }
+    }
+    for (b = 0; b < f->block_count; b++) {
+        const IrBlock *blk = &f->blocks[b];
+        if (seen[b] != blk->pred_count) {
+            errors += verify_error(f, b, "%d predecessores, %d arestas chegando", blk->pred_count, seen[b]);
+        }
+        for (k = 0; k < blk->pred_count; k++) {
+            int p = f->preds[blk->pred_first + k];
+            if (p < 0 || p >= f->block_count || ir_succ_count(&f->blocks[p]) == 0 ||
+                (f->blocks[p].succ[0] != b && f->blocks[p].succ[1] != b)) {
+                errors += verify_error(f, b, "predecessor b%d não salta para cá", p);
+            }
+        }
+    }
+    if (errors > 0) {
+        mm_free(pos);
+        mm_free(seen);
+        return errors;
+    }
+
+    /* Operandos definidos, com a definição dominando o uso */
+    ir_dominators(f, &t);
+    for (b = 0; b < f->block_count; b++) {
+        const IrBlock *blk = &f->blocks[b];
+        int reachable = t.pre[b] >= 0;
+        for (i = blk->first; i < blk->first + blk->count; i++) {
+            const IrInst *inst = &f->insts[f->code[i]];
+            int n = ir_operand_count(inst);
+            if (inst->op == IR_PHI && n != blk->pred_count) {
+                errors += verify_error(f, b, "phi v%d com %d argumentos e %d predecessores",
+                                       f->code[i], n, blk->pred_count);
+                continue;
+            }
+            for (k = 0; k < n; k++) {
+                int v = ir_operand(f, inst, k);
+                if (v < 0 || v >= f->inst_count || pos[v] < 0) {
+                    errors += verify_error(f, b, "v%d usa v%d, inexistente", f->code[i], v);
+                } else if (inst->op == IR_PHI) {
+                    int p = f->preds[blk->pred_first + k];
+                    if (t.pre[p] >= 0 && !available(f, &t, pos, v, p, f->blocks[p].first + f->blocks[p].count)) {
+                        errors += verify_error(f, b, "phi v%d: v%d não domina b%d", f->code[i], v, p);
+                    }
+                } else if (reachable && !available(f, &t, pos, v, b, i)) {
+                    errors += verify_error(f, b, "v%d usa v%d antes da definição", f->code[i], v);
+                }
+            }
+        }
+        if (blk->value >= 0) {
+            if (pos[blk->value] < 0) {
+                errors += verify_error(f, b, "terminador usa v%d, inexistente", blk->value);
+            } else if (reachable && !available(f, &t, pos, blk->value, b, blk->first + blk->count)) {
+                errors += verify_error(f, b, "terminador usa v%d antes da definição", blk->value);
+            }
+        }
+    }
+    ir_dom_free(&t);
+    mm_free(pos);
+    mm_free(seen);
+    return errors;
+}
+
+int ir_verify(const IrModule *m) {
+    int i, errors = 0;
+    for (i = 0; i < m->func_count; i++) errors += ir_verify_func(&m->funcs[i]);
+    return errors;
+}
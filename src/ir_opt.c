@@ -0,0 +1,648 @@
+#include "ir.h"
+#include "memmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void* alloc(size_t size) {
+    void *p = mm_malloc(size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a representação intermediária\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static int* alloc_ints(int count, int fill) {
+    int *p = alloc(sizeof(int) * (size_t)count), i;
+    for (i = 0; i < count; i++) p[i] = fill;
+    return p;
+}
+
+static int* identity(int count) {
+    int *p = alloc(sizeof(int) * (size_t)count), i;
+    for (i = 0; i < count; i++) p[i] = i;
+    return p;
+}
+
+static int chase(int *forward, int v) {
+    if (v < 0) return v;
+    while (forward[v] != v) v = forward[v];
+    return v;
+}
+
+static int same_value(const FoldValue *x, const FoldValue *y) {
+    return x->kind == y->kind && x->m == y->m && x->scale == y->scale;
+}
+
+/* ---------- sccp ---------- */
+
+enum { LAT_TOP, LAT_CONST, LAT_BOTTOM };
+
+typedef struct {
+    IrFunc *f;
+    unsigned char *state;
+    FoldValue *value;
+    int *user_first, *users;        /* usuários de cada valor; -(b + 1) é o desvio de b */
+    unsigned char *block_exec;
+    unsigned char *edge_exec;       /* por posição em preds */
+    int *slot_block;                /* bloco de cada posição em preds */
+    unsigned char *succ_done;       /* 2 por bloco */
+    int *block_work, block_top;
+    int *value_work, value_top;
+} Sccp;
+
+static void lower_to(Sccp *s, int v, int state, const FoldValue *value) {
+    if (state <= s->state[v]) return;
+    s->state[v] = (unsigned char)state;
+    if (value) s->value[v] = *value;
+    s->value_work[s->value_top++] = v;
+}
+
+static void eval_inst(Sccp *s, int v) {
+    IrFunc *f = s->f;
+    const IrInst *inst = &f->insts[v];
+    const IrBlock *b = &f->blocks[inst->block];
+    FoldValue r;
+    int k;
+
+    switch (inst->op) {
+        case IR_CONST:
+            lower_to(s, v, LAT_CONST, &f->consts[inst->a]);
+            break;
+        case IR_PHI: {
+            int state = LAT_TOP;
+            const FoldValue *c = NULL;
+            for (k = 0; k < inst->b && state != LAT_BOTTOM; k++) {
+                int arg = f->args[inst->a + k];
+                if (!s->edge_exec[b->pred_first + k] || s->state[arg] == LAT_TOP) continue;
+                if (s->state[arg] == LAT_BOTTOM || (c && !same_value(c, &s->value[arg]))) {
+                    state = LAT_BOTTOM;
+                } else {
+                    state = LAT_CONST;
+                    c = &s->value[arg];
+                }
+            }
+            lower_to(s, v, state, state == LAT_CONST ? c : NULL);
+            break;
+        }
+        case IR_BINARY: {
+            int x = s->state[inst->a], y = s->state[inst->b];
+            if (x == LAT_BOTTOM || y == LAT_BOTTOM) lower_to(s, v, LAT_BOTTOM, NULL);
+            else if (x == LAT_CONST && y == LAT_CONST) {
+                if (fold_binary((TokenType)inst->sub, &s->value[inst->a], &s->value[inst->b], &r)) {
+                    lower_to(s, v, LAT_CONST, &r);
+                } else {
+                    lower_to(s, v, LAT_BOTTOM, NULL);
+                }
+            }
+            break;
+        }
+        case IR_UNARY: {
+            int x = s->state[inst->a];
+            if (x == LAT_BOTTOM) lower_to(s, v, LAT_BOTTOM, NULL);
+            else if (x == LAT_CONST) {
+                if (fold_unary((TokenType)inst->sub, &s->value[inst->a], &r)) lower_to(s, v, LAT_CONST, &r);
+                else lower_to(s, v, LAT_BOTTOM, NULL);
+            }
+            break;
+        }
+        default:
+            /* Parâmetros, globais, chamadas, leituras, textos e indefinidos */
+            lower_to(s, v, LAT_BOTTOM, NULL);
+            break;
+    }
+}
+
+/* Torna executável a aresta do i-ésimo sucessor de b */
+static void mark_edge(Sccp *s, int b, int i) {
+    IrFunc *f = s->f;
+    const IrBlock *to;
+    int k;
+    if (s->succ_done[2 * b + i]) return;
+    s->succ_done[2 * b + i] = 1;
+    to = &f->blocks[f->blocks[b].succ[i]];
+    for (k = 0; k < to->pred_count; k++) {
+        int slot = to->pred_first + k;
+        if (f->preds[slot] == b && !s->edge_exec[slot]) {
+            s->edge_exec[slot] = 1;
+            s->block_work[s->block_top++] = slot;
+            return;
+        }
+    }
+}
+
+static void eval_term(Sccp *s, int b) {
+    const IrBlock *blk = &s->f->blocks[b];
+    if (blk->term == IR_JUMP) {
+        mark_edge(s, b, 0);
+    } else if (blk->term == IR_BRANCH) {
+        int state = s->state[blk->value];
+        if (state == LAT_BOTTOM) {
+            mark_edge(s, b, 0);
+            mark_edge(s, b, 1);
+        } else if (state == LAT_CONST) {
+            mark_edge(s, b, s->value[blk->value].m != 0 ? 0 : 1);
+        }
+    }
+}
+
+static void visit_block(Sccp *s, int b, int phis_only) {
+    const IrBlock *blk = &s->f->blocks[b];
+    int i, end = blk->first + (phis_only ? blk->phi_count : blk->count);
+    for (i = blk->first; i < end; i++) eval_inst(s, s->f->code[i]);
+    if (!phis_only) eval_term(s, b);
+}
+
+/* Usuários em CSR: contagem, soma prefixa e preenchimento */
+static void build_users(Sccp *s) {
+    IrFunc *f = s->f;
+    int *fill = NULL, v, b, k, pass;
+    s->user_first = alloc_ints(f->inst_count + 1, 0);
+    for (pass = 0; pass < 2; pass++) {
+        for (v = 0; v < f->inst_count; v++) {
+            const IrInst *inst = &f->insts[v];
+            for (k = 0; k < ir_operand_count(inst); k++) {
+                int u = ir_operand(f, inst, k);
+                if (pass == 0) s->user_first[u + 1]++;
+                else s->users[fill[u]++] = v;
+            }
+        }
+        for (b = 0; b < f->block_count; b++) {
+            const IrBlock *blk = &f->blocks[b];
+            if (blk->term != IR_BRANCH) continue;
+            if (pass == 0) s->user_first[blk->value + 1]++;
+            else s->users[fill[blk->value]++] = -(b + 1);
+        }
+        if (pass == 0) {
+            for (v = 0; v < f->inst_count; v++) s->user_first[v + 1] += s->user_first[v];
+            s->users = alloc(sizeof(int) * (size_t)(s->user_first[f->inst_count] + 1));
+            fill = alloc(sizeof(int) * (size_t)(f->inst_count + 1));
+            memcpy(fill, s->user_first, sizeof(int) * (size_t)(f->inst_count + 1));
+        }
+    }
+    mm_free(fill);
+}
+
+/*
+ * Propagação esparsa de constantes condicional (Wegman e Zadeck): os valores
+ * descem no reticulado indefinido -> constante -> variável, e só contam as
+ * arestas já executáveis, de modo que um desvio com condição constante deixa
+ * o lado não tomado (e o que só ele alcança) fora.
+ */
+static unsigned long pass_sccp(IrFunc *f) {
+    Sccp s;
+    unsigned long changes = 0;
+    int n = f->inst_count, b, k, i;
+
+    s.f = f;
+    s.state = alloc((size_t)n + 1);
+    memset(s.state, LAT_TOP, (size_t)n + 1);
+    s.value = alloc(sizeof(FoldValue) * (size_t)(n + 1));
+    s.block_exec = alloc((size_t)f->block_count);
+    memset(s.block_exec, 0, (size_t)f->block_count);
+    s.edge_exec = alloc((size_t)f->pred_total + 1);
+    memset(s.edge_exec, 0, (size_t)f->pred_total + 1);
+    s.slot_block = alloc(sizeof(int) * (size_t)(f->pred_total + 1));
+    for (b = 0; b < f->block_count; b++) {
+        for (k = 0; k < f->blocks[b].pred_count; k++) s.slot_block[f->blocks[b].pred_first + k] = b;
+    }
+    s.succ_done = alloc((size_t)f->block_count * 2);
+    memset(s.succ_done, 0, (size_t)f->block_count * 2);
+    /* Cada aresta e cada rebaixamento entram uma vez só */
+    s.block_work = alloc(sizeof(int) * (size_t)(f->pred_total + 1));
+    s.value_work = alloc(sizeof(int) * (size_t)(2 * n + 1));
+    s.block_top = s.value_top = 0;
+    build_users(&s);
+
+    s.block_exec[0] = 1;
+    visit_block(&s, 0, 0);
+    while (s.block_top > 0 || s.value_top > 0) {
+        if (s.block_top > 0) {
+            int to = s.slot_block[s.block_work[--s.block_top]];
+            if (!s.block_exec[to]) {
+                s.block_exec[to] = 1;
+                visit_block(&s, to, 0);
+            } else {
+                visit_block(&s, to, 1);
+            }
+            continue;
+        }
+        {
+            int v = s.value_work[--s.value_top];
+            for (k = s.user_first[v]; k < s.user_first[v + 1]; k++) {
+                int u = s.users[k];
+                if (u < 0) {
+                    if (s.block_exec[-u - 1]) eval_term(&s, -u - 1);
+                } else if (s.block_exec[f->insts[u].block]) {
+                    eval_inst(&s, u);
+                }
+            }
+        }
+    }
+
+    /* Arestas não executáveis saem; desvios constantes viram saltos */
+    for (b = 0; b < f->block_count; b++) {
+        IrBlock *blk = &f->blocks[b];
+        if (!s.block_exec[b]) {
+            for (i = blk->first; i < blk->first + blk->count; i++) f->insts[f->code[i]].op = IR_NOP;
+            blk->dead = 1;
+            changes++;
+            continue;
+        }
+        for (k = blk->pred_count - 1; k >= 0; k--) {
+            if (!s.edge_exec[blk->pred_first + k]) ir_remove_pred(f, b, k);
+        }
+        if (blk->term == IR_BRANCH && s.state[blk->value] == LAT_CONST) {
+            blk->succ[0] = blk->succ[s.value[blk->value].m != 0 ? 0 : 1];
+            blk->succ[1] = -1;
+            blk->term = IR_JUMP;
+            blk->value = -1;
+            changes++;
+        }
+    }
+    for (b = 0; b < f->block_count; b++) {
+        if (!s.block_exec[b]) continue;
+        for (i = f->blocks[b].first; i < f->blocks[b].first + f->blocks[b].count; i++) {
+            IrInst *inst = &f->insts[f->code[i]];
+            int v = f->code[i];
+            if (s.state[v] != LAT_CONST || inst->op == IR_CONST) continue;
+            if (inst->op != IR_PHI && inst->op != IR_BINARY && inst->op != IR_UNARY) continue;
+            inst->op = IR_CONST;
+            inst->sub = 0;
+            inst->a = ir_add_const(f, &s.value[v]);
+            inst->b = -1;
+            changes++;
+        }
+    }
+
+    mm_free(s.state);
+    mm_free(s.value);
+    mm_free(s.block_exec);
+    mm_free(s.edge_exec);
+    mm_free(s.slot_block);
+    mm_free(s.succ_done);
+    mm_free(s.block_work);
+    mm_free(s.value_work);
+    mm_free(s.user_first);
+    mm_free(s.users);
+    return changes;
+}
+
+/* ---------- gvn ---------- */
+
+typedef struct {
+    int value, next;
+    unsigned bucket;
+} GvnEntry;
+
+typedef struct {
+    IrFunc *f;
+    int *forward;
+    int *head;
+    unsigned mask;
+    GvnEntry *entries;
+    int entry_count;
+} Gvn;
+
+static int commutative(TokenType op) {
+    return op == TOK_PLUS || op == TOK_STAR || op == TOK_EQ || op == TOK_NEQ ||
+           op == TOK_AND || op == TOK_OR;
+}
+
+/* Operandos já com as substituições feitas, os comutativos em ordem */
+static void gvn_operands(Gvn *g, const IrInst *inst, int *x, int *y) {
+    *x = chase(g->forward, inst->a);
+    *y = chase(g->forward, inst->b);
+    if (inst->op == IR_BINARY && commutative((TokenType)inst->sub) && *y < *x) {
+        int t = *x;
+        *x = *y;
+        *y = t;
+    }
+}
+
+static int gvn_numbered(const IrInst *inst) {
+    switch (inst->op) {
+        case IR_CONST:
+        case IR_LITERAL:
+        case IR_PARAM:
+        case IR_PHI:
+        case IR_BINARY:
+        case IR_UNARY:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static unsigned gvn_hash(Gvn *g, int v) {
+    const IrInst *inst = &g->f->insts[v];
+    unsigned h = (unsigned)inst->op * 31u + inst->sub;
+    int x, y, k;
+    h = h * 31u + (unsigned)inst->type;
+    switch (inst->op) {
+        case IR_CONST: {
+            const FoldValue *c = &g->f->consts[inst->a];
+            h = h * 31u + (unsigned)c->kind;
+            h = h * 31u + (unsigned)c->m;
+            h = h * 31u + (unsigned)c->scale;
+            break;
+        }
+        case IR_LITERAL: {
+            const char *p;
+            for (p = inst->name; *p; p++) h = h * 31u + (unsigned char)*p;
+            break;
+        }
+        case IR_PARAM:
+            h = h * 31u + (unsigned)inst->a;
+            break;
+        case IR_PHI:
+            h = h * 31u + (unsigned)inst->block;
+            for (k = 0; k < inst->b; k++) h = h * 31u + (unsigned)chase(g->forward, g->f->args[inst->a + k]);
+            break;
+        default:
+            gvn_operands(g, inst, &x, &y);
+            h = h * 31u + (unsigned)x;
+            h = h * 31u + (unsigned)y;
+            break;
+    }
+    return h * 2654435761u;
+}
+
+static int gvn_equal(Gvn *g, int v, int w) {
+    const IrInst *a = &g->f->insts[v], *b = &g->f->insts[w];
+    int ax, ay, bx, by, k;
+    if (a->op != b->op || a->sub != b->sub || a->type != b->type) return 0;
+    switch (a->op) {
+        case IR_CONST:
+            return same_value(&g->f->consts[a->a], &g->f->consts[b->a]);
+        case IR_LITERAL:
+            return strcmp(a->name, b->name) == 0;
+        case IR_PARAM:
+            return a->a == b->a;
+        case IR_PHI:
+            if (a->block != b->block || a->b != b->b) return 0;
+            for (k = 0; k < a->b; k++) {
+                if (chase(g->forward, g->f->args[a->a + k]) != chase(g->forward, g->f->args[b->a + k])) return 0;
+            }
+            return 1;
+        default:
+            gvn_operands(g, a, &ax, &ay);
+            gvn_operands(g, b, &bx, &by);
+            return ax == bx && ay == by;
+    }
+}
+
+/* O valor de um phi cujos argumentos são todos ele mesmo ou um só outro */
+static int gvn_trivial_phi(Gvn *g, int v) {
+    const IrInst *inst = &g->f->insts[v];
+    int same = -1, k;
+    for (k = 0; k < inst->b; k++) {
+        int arg = chase(g->forward, g->f->args[inst->a + k]);
+        if (arg == v || arg == same) continue;
+        if (same >= 0) return -1;
+        same = arg;
+    }
+    return same;
+}
+
+static int gvn_visit(Gvn *g, int v) {
+    IrInst *inst = &g->f->insts[v];
+    unsigned h;
+    int e;
+    if (!gvn_numbered(inst)) return 0;
+    if (inst->op == IR_PHI) {
+        int same = gvn_trivial_phi(g, v);
+        if (same >= 0) {
+            g->forward[v] = same;
+            inst->op = IR_NOP;
+            return 1;
+        }
+    }
+    h = gvn_hash(g, v);
+    for (e = g->head[h & g->mask]; e >= 0; e = g->entries[e].next) {
+        if (gvn_equal(g, v, g->entries[e].value)) {
+            g->forward[v] = g->entries[e].value;
+            inst->op = IR_NOP;
+            return 1;
+        }
+    }
+    g->entries[g->entry_count].value = v;
+    g->entries[g->entry_count].bucket = h & g->mask;
+    g->entries[g->entry_count].next = g->head[h & g->mask];
+    g->head[h & g->mask] = g->entry_count++;
+    return 0;
+}
+
+/*
+ * Numeração global de valores pela árvore de dominadores: uma instrução
+ * igual a outra de um bloco que domina o seu (mesma operação, mesmos
+ * operandos) é trocada por ela. A tabela é desfeita ao sair de cada
+ * subárvore, de modo que só as definições dominantes ficam visíveis.
+ */
+static unsigned long pass_gvn(IrFunc *f) {
+    Gvn g;
+    IrDomTree t;
+    int *stack, *next, *mark, top = 0, size = 16, i;
+    unsigned long changes = 0;
+
+    while (size < 2 * f->inst_count) size *= 2;
+    g.f = f;
+    g.forward = identity(f->inst_count + 1);
+    g.head = alloc_ints(size, -1);
+    g.mask = (unsigned)size - 1;
+    g.entries = alloc(sizeof(GvnEntry) * (size_t)(f->inst_count + 1));
+    g.entry_count = 0;
+
+    ir_dominators(f, &t);
+    stack = alloc(sizeof(int) * (size_t)(f->block_count + 1));
+    next = alloc(sizeof(int) * (size_t)(f->block_count + 1));
+    mark = alloc(sizeof(int) * (size_t)(f->block_count + 1));
+    if (f->block_count > 0) {
+        stack[top] = 0;
+        next[top] = t.child_first[0];
+        mark[top++] = 0;
+        for (i = f->blocks[0].first; i < f->blocks[0].first + f->blocks[0].count; i++) {
+            changes += (unsigned long)gvn_visit(&g, f->code[i]);
+        }
+    }
+    while (top > 0) {
+        int b = stack[top - 1];
+        if (next[top - 1] < t.child_first[b + 1]) {
+            int c = t.children[next[top - 1]++];
+            stack[top] = c;
+            next[top] = t.child_first[c];
+            mark[top++] = g.entry_count;
+            for (i = f->blocks[c].first; i < f->blocks[c].first + f->blocks[c].count; i++) {
+                changes += (unsigned long)gvn_visit(&g, f->code[i]);
+            }
+            continue;
+        }
+        while (g.entry_count > mark[top - 1]) {
+            GvnEntry *e = &g.entries[--g.entry_count];
+            g.head[e->bucket] = e->next;
+        }
+        top--;
+    }
+    ir_replace_uses(f, g.forward);
+
+    ir_dom_free(&t);
+    mm_free(stack);
+    mm_free(next);
+    mm_free(mark);
+    mm_free(g.forward);
+    mm_free(g.head);
+    mm_free(g.entries);
+    return changes;
+}
+
+/* ---------- dce ---------- */
+
+/* Remove as instruções puras cujo valor não chega a nenhum efeito: escrita,
+ * chamada, leitura, gravação de global, desvio ou retorno */
+static unsigned long pass_dce(IrFunc *f) {
+    unsigned char *live = alloc((size_t)f->inst_count + 1);
+    int *work = alloc(sizeof(int) * (size_t)(f->inst_count + 1)), top = 0, v, b, k;
+    unsigned long changes = 0;
+
+    memset(live, 0, (size_t)f->inst_count + 1);
+    for (v = 0; v < f->inst_count; v++) {
+        const IrInst *inst = &f->insts[v];
+        if (inst->op != IR_NOP && (!ir_is_pure(inst) || inst->op == IR_PARAM)) {
+            live[v] = 1;
+            work[top++] = v;
+        }
+    }
+    for (b = 0; b < f->block_count; b++) {
+        v = f->blocks[b].value;
+        if (!f->blocks[b].dead && v >= 0 && !live[v]) {
+            live[v] = 1;
+            work[top++] = v;
+        }
+    }
+    while (top > 0) {
+        const IrInst *inst = &f->insts[work[--top]];
+        for (k = 0; k < ir_operand_count(inst); k++) {
+            int u = ir_operand(f, inst, k);
+            if (u >= 0 && !live[u]) {
+                live[u] = 1;
+                work[top++] = u;
+            }
+        }
+    }
+    for (v = 0; v < f->inst_count; v++) {
+        if (!live[v] && f->insts[v].op != IR_NOP) {
+            f->insts[v].op = IR_NOP;
+            changes++;
+        }
+    }
+    mm_free(live);
+    mm_free(work);
+    return changes;
+}
+
+/* ---------- cfg ---------- */
+
+/* Une ao bloco o sucessor para o qual ele só salta, se esse não tiver outro
+ * predecessor; o sucessor vira parte dele (next_part) */
+static unsigned long pass_cfg(IrFunc *f) {
+    int *tail = identity(f->block_count + 1);
+    int *forward = identity(f->inst_count + 1);
+    unsigned char *absorbed = alloc((size_t)f->block_count + 1);
+    unsigned long changes = 0;
+    int b, k, i;
+
+    memset(absorbed, 0, (size_t)f->block_count + 1);
+    for (b = 0; b < f->block_count; b++) {
+        IrBlock *blk = &f->blocks[b];
+        if (blk->dead || absorbed[b]) continue;
+        while (blk->term == IR_JUMP) {
+            int s = blk->succ[0];
+            IrBlock *sb = &f->blocks[s];
+            if (s == b || s == 0 || sb->pred_count != 1 || absorbed[s]) break;
+            for (i = sb->first; i < sb->first + sb->phi_count; i++) {
+                IrInst *phi = &f->insts[f->code[i]];
+                forward[f->code[i]] = f->args[phi->a];
+                phi->op = IR_NOP;
+            }
+            absorbed[s] = 1;
+            f->blocks[tail[b]].next_part = s;
+            tail[b] = tail[s];
+            blk->term = sb->term;
+            blk->value = sb->value;
+            blk->succ[0] = sb->succ[0];
+            blk->succ[1] = sb->succ[1];
+            for (k = 0; k < ir_succ_count(blk); k++) {
+                IrBlock *t = &f->blocks[blk->succ[k]];
+                for (i = 0; i < t->pred_count; i++) {
+                    if (f->preds[t->pred_first + i] == s) f->preds[t->pred_first + i] = b;
+                }
+            }
+            changes++;
+        }
+    }
+    ir_replace_uses(f, forward);
+    mm_free(tail);
+    mm_free(forward);
+    mm_free(absorbed);
+    return changes;
+}
+
+/* ---------- Gerenciador de passos ---------- */
+
+typedef unsigned long (*IrPassFn)(IrFunc *f);
+
+static const struct {
+    const char *name;
+    IrPassFn run;
+} passes[] = {
+    {"sccp", pass_sccp},
+    {"gvn", pass_gvn},
+    {"dce", pass_dce},
+    {"cfg", pass_cfg}
+};
+
+int ir_parse_pipeline(const char *list, IrPipeline *p) {
+    p->count = 0;
+    if (strcmp(list, "none") == 0) return 1;
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        int i, found = 0;
+        for (i = 0; i < (int)(sizeof(passes) / sizeof(passes[0])); i++) {
+            if (strlen(passes[i].name) == len && strncmp(list, passes[i].name, len) == 0) {
+                if (p->count == IR_MAX_PASSES) return 0;
+                p->pass[p->count++] = i;
+                found = 1;
+            }
+        }
+        if (!found) return 0;
+        list += len;
+        if (*list == ',') list++;
+    }
+    return 1;
+}
+
+int ir_run_pipeline(IrModule *m, const IrPipeline *p, IrPassStat *stats) {
+    int i, k;
+    for (k = 0; k < p->count; k++) {
+        stats[k].name = passes[p->pass[k]].name;
+        stats[k].changes = 0;
+        stats[k].seconds = 0;
+    }
+    for (i = 0; i < m->func_count; i++) {
+        IrFunc *f = &m->funcs[i];
+        for (k = 0; k < p->count; k++) {
+            clock_t start = clock();
+            stats[k].changes += passes[p->pass[k]].run(f);
+            ir_compact(f);
+            stats[k].seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+            if (ir_verify_func(f) > 0) {
+                fprintf(stderr, "\033[31mErro: IR inválida depois do passo %s em %s\033[0m\n",
+                        stats[k].name, f->name);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
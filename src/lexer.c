@@ -6,6 +6,8 @@
 #include "lexer.h"
 #include "util.h"
 #include "error.h"
+#include "output.h"
+#include "spacing.h"
 #include "token.h"
 
 /* Helpers for building lexemes */
@@ -17,29 +19,29 @@ static char *make_lexeme(const char *start, size_t len) {
     return s;
 }
 
-static void skip_irrelevant(void) {
+static void skip_irrelevant(Scanner *sc) {
     int c;
-    while ((c = peek_char())) {
-        if (isspace(c)) { advance_char(); continue; }
+    while ((c = scanner_peek(sc))) {
+        if (isspace(c)) { scanner_advance(sc); continue; }
         /* Verificação de comentários desabilitada temporariamente */
-        /* O problema está na função retreat_char() */
+        /* O problema está na função scanner_retreat() */
         /*
         if (c == '/') {
-            advance_char();
-            int next = peek_char();
+            scanner_advance(sc);
+            int next = scanner_peek(sc);
             if (next == '/') {
-                while (peek_char() && advance_char() != '\n');
+                while (scanner_peek(sc) && scanner_advance(sc) != '\n');
                 continue;
             } else if (next == '*') {
-                advance_char();
+                scanner_advance(sc);
                 while (1) {
-                    int d = advance_char();
-                    if (d == '\0') lex_error(current_line(), "Comentário não terminado");
-                    if (d == '*' && peek_char() == '/') { advance_char(); break; }
+                    int d = scanner_advance(sc);
+                    if (d == '\0') lex_error(scanner_line(sc), "Comentário não terminado");
+                    if (d == '*' && scanner_peek(sc) == '/') { scanner_advance(sc); break; }
                 }
                 continue;
             } else {
-                retreat_char();
+                scanner_retreat(sc);
                 break;
             }
         }
@@ -48,28 +50,27 @@ static void skip_irrelevant(void) {
     }
 }
 
-Token next_token(void) {
-    skip_irrelevant();
-    int c = peek_char();
+static Token scan_token(Scanner *sc) {
+    int c = scanner_peek(sc);
     if (c == '\0') {
-        return (Token){.type = TOK_EOF, .lexeme = "", .line = current_line()};
+        return (Token){.type = TOK_EOF, .lexeme = "", .line = scanner_line(sc)};
     }
 
     /* Variável: ![a-z][a-zA-Z0-9]* */
     if (c == '!') {
-        int start_line = current_line();
-        advance_char();
-        if (peek_char() < 'a' || peek_char() > 'z') {
+        int start_line = scanner_line(sc);
+        scanner_advance(sc);
+        if (scanner_peek(sc) < 'a' || scanner_peek(sc) > 'z') {
             lex_error(start_line,
                       "Nome inválido para variável: esperado [a–z] após '!', recebido '%c'",
-                      peek_char());
+                      scanner_peek(sc));
         }
         char buf[256]; int len = 0;
         buf[len++] = '!';
-        buf[len++] = advance_char();
-        while (isalnum(peek_char())) {
-            if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-            else advance_char();
+        buf[len++] = scanner_advance(sc);
+        while (isalnum(scanner_peek(sc))) {
+            if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+            else scanner_advance(sc);
         }
         buf[len] = '\0';
         return (Token){.type = TOK_IDENTIFIER, .lexeme = make_lexeme(buf, len), .line = start_line};
@@ -77,26 +78,26 @@ Token next_token(void) {
 
     /* Nome de função: __[a-zA-Z0-9][a-zA-Z0-9]* */
     if (c == '_') {
-        int start_line = current_line();
-        if (peek_char() != '_') {
+        int start_line = scanner_line(sc);
+        if (scanner_peek(sc) != '_') {
             lex_error(start_line,
                       "Nome de função inválido: deve começar com '__' seguido de letra ou dígito");
         }
-        advance_char();
-        if (peek_char() != '_') {
+        scanner_advance(sc);
+        if (scanner_peek(sc) != '_') {
             lex_error(start_line,
                       "Nome de função inválido: deve começar com '__' seguido de letra ou dígito");
         }
         char buf[256]; int len = 0;
-        buf[len++] = advance_char();
-        buf[len++] = advance_char();
-        if (!isalnum(peek_char())) {
+        buf[len++] = scanner_advance(sc);
+        buf[len++] = scanner_advance(sc);
+        if (!isalnum(scanner_peek(sc))) {
             lex_error(start_line,
                       "Nome de função inválido: deve vir letra ou dígito após '__'");
         }
-        while (isalnum(peek_char())) {
-            if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-            else advance_char();
+        while (isalnum(scanner_peek(sc))) {
+            if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+            else scanner_advance(sc);
         }
         buf[len] = '\0';
         return (Token){.type = TOK_IDENTIFIER, .lexeme = make_lexeme(buf, len), .line = start_line};
@@ -104,11 +105,11 @@ Token next_token(void) {
 
     /* Palavra-chave ou erro: [a-zA-Z][a-zA-Z0-9_]* */
     if (isalpha(c)) {
-        int start_line = current_line();
+        int start_line = scanner_line(sc);
         char buf[256]; int len = 0;
-        while (isalnum(peek_char()) || peek_char() == '_') {
-            if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-            else advance_char();
+        while (isalnum(scanner_peek(sc)) || scanner_peek(sc) == '_') {
+            if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+            else scanner_advance(sc);
         }
         buf[len] = '\0';
         TokenType type = lookup_keyword(buf);
@@ -122,22 +123,22 @@ Token next_token(void) {
 
     /* Número literal (inteiro ou decimal) */
     if (isdigit(c)) {
-        int start_line = current_line();
+        int start_line = scanner_line(sc);
         char buf[64]; int len = 0;
-        while (isdigit(peek_char())) {
-            if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-            else advance_char();
+        while (isdigit(scanner_peek(sc))) {
+            if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+            else scanner_advance(sc);
         }
-        if (peek_char() == '.') {
-            if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-            else advance_char();
-            if (!isdigit(peek_char())) {
+        if (scanner_peek(sc) == '.') {
+            if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+            else scanner_advance(sc);
+            if (!isdigit(scanner_peek(sc))) {
                 lex_error(start_line,
                           "Número decimal inválido: faltando dígitos após o ponto '.'");
             }
-            while (isdigit(peek_char())) {
-                if (len < (int)sizeof(buf)-1) buf[len++] = advance_char();
-                else advance_char();
+            while (isdigit(scanner_peek(sc))) {
+                if (len < (int)sizeof(buf)-1) buf[len++] = scanner_advance(sc);
+                else scanner_advance(sc);
             }
             buf[len] = '\0';
             return (Token){.type=TOK_DECIMAL_LITERAL, .lexeme=make_lexeme(buf,len), .line=start_line};
@@ -148,22 +149,22 @@ Token next_token(void) {
 
     /* Literal de string */
     if (c == '"') {
-        int start_line = current_line(); advance_char();
+        int start_line = scanner_line(sc); scanner_advance(sc);
         char buf[512]; int len = 0;
-        while (peek_char() && peek_char() != '"') {
-            if (peek_char() == '\\') buf[len++] = advance_char();
-            buf[len++] = advance_char();
+        while (scanner_peek(sc) && scanner_peek(sc) != '"') {
+            if (scanner_peek(sc) == '\\') buf[len++] = scanner_advance(sc);
+            buf[len++] = scanner_advance(sc);
             if (len >= (int)sizeof(buf)-1) lex_error(start_line, "String muito longa");
         }
-        if (peek_char() != '"') lex_error(start_line, "String sem terminação");
-        advance_char();
+        if (scanner_peek(sc) != '"') lex_error(start_line, "String sem terminação");
+        scanner_advance(sc);
         buf[len] = '\0';
         return (Token){.type=TOK_STRING_LITERAL, .lexeme=make_lexeme(buf,len), .line=start_line};
     }
 
     /* Operadores e pontuação */
-    int start_line = current_line();
-    char first = advance_char();
+    int start_line = scanner_line(sc);
+    char first = scanner_advance(sc);
     switch (first) {
         case '+': return (Token){.type=TOK_PLUS,     .lexeme="+", .line=start_line};
         case '-': return (Token){.type=TOK_MINUS,    .lexeme="-", .line=start_line};
@@ -172,22 +173,22 @@ Token next_token(void) {
         case '%': return (Token){.type=TOK_MODULO,   .lexeme="%", .line=start_line};
         case '^': return (Token){.type=TOK_CARET,    .lexeme="^", .line=start_line};
         case '=':
-            if (peek_char() == '=') { advance_char();
+            if (scanner_peek(sc) == '=') { scanner_advance(sc);
                 return (Token){.type=TOK_EQ,    .lexeme=make_lexeme("==",2), .line=start_line}; }
             return (Token){.type=TOK_ASSIGN, .lexeme=make_lexeme("=",1),  .line=start_line};
         case '<':
-            if (peek_char()=='=') { advance_char();
+            if (scanner_peek(sc)=='=') { scanner_advance(sc);
                 return (Token){.type=TOK_LE,    .lexeme="<=",  .line=start_line}; }
-            if (peek_char()=='>') { advance_char();
+            if (scanner_peek(sc)=='>') { scanner_advance(sc);
                 return (Token){.type=TOK_NEQ,   .lexeme="<>",  .line=start_line}; }
             return (Token){.type=TOK_LT,      .lexeme="<",   .line=start_line};
         case '>':
-            if (peek_char()=='=') { advance_char();
+            if (scanner_peek(sc)=='=') { scanner_advance(sc);
                 return (Token){.type=TOK_GE,    .lexeme=">=",  .line=start_line}; }
             return (Token){.type=TOK_GT,      .lexeme=">",   .line=start_line};
         case '&':
-    if (peek_char() == '&') {
-        advance_char();
+    if (scanner_peek(sc) == '&') {
+        scanner_advance(sc);
         return (Token){ .type = TOK_AND,
                         .lexeme = make_lexeme("&&", 2),
                         .line   = start_line };
@@ -195,8 +196,8 @@ Token next_token(void) {
     lex_error(start_line, "Caractere inesperado: '%c'", first);
 
 case '|':
-    if (peek_char() == '|') {
-        advance_char();
+    if (scanner_peek(sc) == '|') {
+        scanner_advance(sc);
         return (Token){ .type = TOK_OR,
                         .lexeme = make_lexeme("||", 2),
                         .line   = start_line };
@@ -216,15 +217,96 @@ case '|':
     }
 }
 
-int lex_file(const char *path) {
+Token scanner_next_token(Scanner *sc) {
+    skip_irrelevant(sc);
+    size_t start = scanner_offset(sc);
+    Token tok = scan_token(sc);
+    tok.offset = (int)start;
+    tok.length = (int)(scanner_offset(sc) - start);
+    return tok;
+}
+
+Token next_token(void) {
+    return scanner_next_token(global_scanner());
+}
+
+int token_owns_lexeme(TokenType type) {
+    switch (type) {
+        case TOK_IDENTIFIER:
+        case TOK_INTEGER_LITERAL:
+        case TOK_DECIMAL_LITERAL:
+        case TOK_STRING_LITERAL:
+        case TOK_EQ:
+        case TOK_ASSIGN:
+        case TOK_AND:
+        case TOK_OR:
+        case TOK_ERROR:
+            return 1;
+        default:
+            return type >= TOK_KW_INTEIRO && type <= TOK_KW_ESCREVA;
+    }
+}
+
+/* Um token da listagem, no formato de --dump (ver output.h) */
+static void dump_token(OutSink *out, DumpFormat format, const Token *tok, int first) {
+    const char *lexeme = tok->lexeme ? tok->lexeme : "";
+    switch (format) {
+        case DUMP_TEXT:
+            out_long_pad(out, tok->line, 4);
+            out_str(out, ": ");
+            out_str_pad(out, token_type_name(tok->type), 15);
+            out_str(out, " '");
+            out_str(out, lexeme);
+            out_str(out, "'\n");
+            break;
+        case DUMP_JSON:
+            out_str(out, first ? "{\"tokens\":[{\"line\":" : ",{\"line\":");
+            out_long(out, tok->line);
+            out_str(out, ",\"type\":");
+            out_json_str(out, token_type_name(tok->type));
+            out_str(out, ",\"lexeme\":");
+            out_json_str(out, lexeme);
+            out_char(out, '}');
+            if (tok->type == TOK_EOF) out_str(out, "]}\n");
+            break;
+        case DUMP_BINARY:
+            if (first) out_write(out, "TOKS", 4);
+            out_u32(out, (uint32_t)tok->line);
+            out_u32(out, (uint32_t)tok->type);
+            out_u32(out, (uint32_t)strlen(lexeme));
+            out_str(out, lexeme);
+            break;
+        default:
+            break;
+    }
+}
+
+static int list_tokens(const char *path, int release) {
+    OutSink *out = out_stdout();
+    DumpFormat format = dump_format();
+    SpacingChecker *spacing = spacing_checker();
+    int first = 1;
     init_scanner(path);
+    spacing_init(spacing, spacing_rules());
     Token tok;
     do {
         tok = next_token();
-        printf("%4d: %-15s '%s'\n", tok.line,
-               token_type_name(tok.type), tok.lexeme);
+        dump_token(out, format, &tok, first);
+        /* As regras de espaçamento aproveitam esta passada (ver spacing.h) */
+        if (spacing->rules) spacing_feed(spacing, &tok);
+        first = 0;
+        if (release && token_owns_lexeme(tok.type)) mm_free(tok.lexeme);
     } while (tok.type != TOK_EOF);
+    out_flush(out);
     close_scanner();
     return 0;
 }
 
+int lex_file(const char *path) {
+    return list_tokens(path, 0);
+}
+
+int lex_file_release(const char *path) {
+    return list_tokens(path, 1);
+}
+
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ll1.h"
+#include "memmgr.h"
+
+/* Símbolos da pilha e das produções, em um byte:
+ *   0..63     terminais (TokenType)
+ *   64..127   não-terminais
+ *   128, 129  ações @add e @wrap
+ *   160..     ação @node(tipo) */
+#define LL1_NT(i)     (64 + (i))
+#define LL1_ADD       128
+#define LL1_WRAP      129
+#define LL1_NODE(t)   (160 + (t))
+
+#include "ll1_tables.h"
+
+typedef char ll1_terminals_fit[TOK_ERROR < 64 ? 1 : -1];
+typedef char ll1_nonterminals_fit[LL1_NONTERMINALS <= 64 ? 1 : -1];
+typedef char ll1_node_types_fit[AST_RETURN_STMT < 96 ? 1 : -1];
+
+size_t ll1_table_size(void) {
+    return sizeof(ll1_rhs) + sizeof(ll1_rhs_start) + sizeof(ll1_table) + sizeof(ll1_empty) +
+           sizeof(ll1_expected) + sizeof(ll1_terminal);
+}
+
+typedef struct {
+    unsigned char *symbols;
+    int symbol_count;
+    int symbol_capacity;
+    ASTNode **values;
+    int value_count;
+    int value_capacity;
+} LL1Stacks;
+
+static void reserve_symbols(LL1Stacks *st, int count) {
+    while (st->symbol_count + count > st->symbol_capacity) {
+        st->symbol_capacity = st->symbol_capacity == 0 ? 64 : st->symbol_capacity * 2;
+        st->symbols = mm_realloc(st->symbols, (size_t)st->symbol_capacity);
+    }
+}
+
+static void push_value(LL1Stacks *st, ASTNode *node) {
+    if (st->value_count >= st->value_capacity) {
+        st->value_capacity = st->value_capacity == 0 ? 16 : st->value_capacity * 2;
+        st->values = mm_realloc(st->values, st->value_capacity * sizeof(ASTNode*));
+    }
+    st->values[st->value_count++] = node;
+}
+
+/* Empilha o lado direito da produção, do último símbolo ao primeiro */
+static void push_production(LL1Stacks *st, int production) {
+    int i, first = ll1_rhs_start[production];
+    unsigned char *top;
+    reserve_symbols(st, ll1_rhs_start[production + 1] - first);
+    top = st->symbols + st->symbol_count;
+    for (i = ll1_rhs_start[production + 1] - 1; i >= first; i--) {
+        *top++ = ll1_rhs[i];
+    }
+    st->symbol_count = (int)(top - st->symbols);
+}
+
+static void expected(Parser *parser, const char *what) {
+    char message[128];
+    size_t len = strlen(what);
+    if (len > sizeof(message) - 10) len = sizeof(message) - 10;
+    memcpy(message, "Esperado ", 9);
+    memcpy(message + 9, what, len);
+    message[9 + len] = '\0';
+    parser_error(parser, message);
+}
+
+typedef enum {
+    LL1_RUNNING,
+    LL1_WAITING,                    /* casou um terminal; espera o próximo token */
+    LL1_DONE,                       /* pilha vazia: programa aceito */
+    LL1_FAILED
+} LL1Status;
+
+struct LL1Parser {
+    LL1Stacks st;
+    Parser *parser;                 /* token atual/anterior e erros */
+    LL1ItemHandler on_item;
+    void *data;
+    LL1Status status;
+};
+
+static void ll1_init(LL1Parser *p, Parser *parser, LL1ItemHandler on_item, void *data) {
+    memset(&p->st, 0, sizeof(p->st));
+    p->parser = parser;
+    p->on_item = on_item;
+    p->data = data;
+    p->status = LL1_RUNNING;
+    /* O nó PROGRAM fica na base da pilha de valores */
+    push_value(&p->st, ast_node_create(AST_PROGRAM, parser->current_token));
+    reserve_symbols(&p->st, 1);
+    p->st.symbols[p->st.symbol_count++] = LL1_START;
+}
+
+/* Libera os nós ainda não presos à árvore (todos, com keep_program == 0) */
+static void ll1_release(LL1Parser *p, int keep_program) {
+    LL1Stacks *st = &p->st;
+    while (st->value_count > keep_program) {
+        free_ast(st->values[--st->value_count]);
+    }
+    if (st->symbols) mm_free(st->symbols);
+    if (st->values) mm_free(st->values);
+}
+
+/*
+ * Executa a pilha com parser->current_token como lookahead. Com pull, cada
+ * terminal casado avança para o próximo token da fonte do parser. Sem pull,
+ * o motor para logo depois do casamento e das ações que o seguem (LL1_WAITING),
+ * e o próximo token é entregue por ll1_feed.
+ */
+static LL1Status ll1_run(LL1Parser *p, int pull) {
+    LL1Stacks *st = &p->st;
+    Parser *parser = p->parser;
+    int waiting = 0;
+
+    while (st->symbol_count > 0) {
+        unsigned char symbol = st->symbols[st->symbol_count - 1];
+
+        /* Terminais e não-terminais olham o token seguinte */
+        if (waiting && symbol < LL1_ADD) return LL1_WAITING;
+        st->symbol_count--;
+
+        if (symbol < LL1_NT(0)) {
+            if (parser->current_token.type != (TokenType)symbol) {
+                expected(parser, ll1_terminal[symbol]);
+                return LL1_FAILED;
+            }
+            if (pull) {
+                advance_token(parser);
+            } else {
+                parser->previous_token = parser->current_token;
+                waiting = 1;
+            }
+        } else if (symbol < LL1_ADD) {
+            int nt = symbol - LL1_NT(0);
+            int production = ll1_table[nt][parser->current_token.type];
+            if (!production) production = ll1_empty[nt];
+            if (!production) {
+                expected(parser, ll1_expected[nt]);
+                return LL1_FAILED;
+            }
+            push_production(st, production - 1);
+        } else if (symbol == LL1_ADD) {
+            ASTNode *child = st->values[--st->value_count];
+            if (st->value_count == 1 && p->on_item) {
+                /* Item de nível superior concluído */
+                p->on_item(child, p->data);
+            } else {
+                ast_node_add_child(st->values[st->value_count - 1], child);
+            }
+        } else if (symbol == LL1_WRAP) {
+            /* [esquerdo, nó] -> [nó(esquerdo)] */
+            ASTNode *node = st->values[--st->value_count];
+            ast_node_add_child(node, st->values[st->value_count - 1]);
+            st->values[st->value_count - 1] = node;
+        } else {
+            push_value(st, ast_node_create((ASTNodeType)(symbol - LL1_NODE(0)),
+                                           parser->previous_token));
+        }
+    }
+    return LL1_DONE;
+}
+
+ASTNode* ll1_parse_program(Parser *parser) {
+    LL1Parser p;
+    ASTNode *program;
+
+    ll1_init(&p, parser, NULL, NULL);
+    program = p.st.values[0];
+    ll1_run(&p, 1);
+    /* Com erro, os nós ainda na pilha não estão presos à árvore */
+    ll1_release(&p, 1);
+    return program;
+}
+
+LL1Parser* ll1_create(Parser *parser, LL1ItemHandler on_item, void *data) {
+    LL1Parser *p = mm_malloc(sizeof(LL1Parser));
+    if (!p) {
+        fprintf(stderr, "Erro: não foi possível alocar memória para parser\n");
+        exit(EXIT_FAILURE);
+    }
+    ll1_init(p, parser, on_item, data);
+    return p;
+}
+
+int ll1_feed(LL1Parser *p, Token token) {
+    if (p->status == LL1_RUNNING || p->status == LL1_WAITING) {
+        p->parser->current_token = token;
+        p->status = ll1_run(p, 0);
+    }
+    return p->status != LL1_FAILED;
+}
+
+int ll1_accepted(const LL1Parser *p) {
+    return p->status == LL1_DONE;
+}
+
+void ll1_free(LL1Parser *p) {
+    if (p) {
+        ll1_release(p, 0);
+        mm_free(p);
+    }
+}
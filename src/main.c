@@ -1,30 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "memmgr.h"
 #include "lexer.h"
 #include "parser.h"
 #include "util.h"
 #include "error.h"
 #include "semantics.h"
+#include "parse_parallel.h"
+#include "ast_binary.h"
+#include "output.h"
+#include "spacing.h"
+#include "stream.h"
+#include "frame.h"
+#include "fold.h"
+#include "inline.h"
+#include "ir.h"
 
-ASTNode* parse_file(const char *path) {
-    init_scanner(path);
-    
-    Parser *parser = parser_init();
-    if (!parser) {
-        fprintf(stderr, "Erro: não foi possível inicializar o parser\n");
-        close_scanner();
-        return NULL;
-    }
+/* source continua aberto com a AST: corpos adiados (--lazy) são lidos dele */
+ASTNode* parse_file(Scanner *source, int jobs) {
+    int had_error;
     
     printf("\033[34m=== ANÁLISE SINTÁTICA ===\033[0m\n");
-    ASTNode *ast = parse_program(parser);
+    ASTNode *ast = parse_program_parallel(source->src, source->len, jobs, &had_error);
     
-    if (parser->had_error) {
+    if (had_error) {
         printf("\033[31mErros encontrados durante a análise sintática.\033[0m\n");
         free_ast(ast);
-        parser_free(parser);
-        close_scanner();
         return NULL;
     }
     
@@ -33,49 +35,363 @@ ASTNode* parse_file(const char *path) {
     /* Validações adicionais */
     printf("\033[34m=== VALIDAÇÕES SINTÁTICAS ===\033[0m\n");
     
-    if (!validate_declaration_sequence(ast)) {
+    ValidationAlerts alerts;
+    int invalid = validate_program(ast, source->src, source->len, &alerts);
+    if (invalid & VALIDATE_DECLARATION_SEQUENCE) {
         printf("\033[31mErro: sequência de declarações inválida\033[0m\n");
         free_ast(ast);
-        parser_free(parser);
-        close_scanner();
         return NULL;
     }
     printf("\033[32m✓ Sequência de declarações válida\033[0m\n");
     
-    if (!validate_spacing_rules(ast)) {
+    if (invalid & VALIDATE_SPACING) {
         printf("\033[31mErro: regras de espaçamento não respeitadas\033[0m\n");
         free_ast(ast);
-        parser_free(parser);
-        close_scanner();
         return NULL;
     }
-    printf("\033[32m✓ Regras de espaçamento respeitadas\033[0m\n");
+    if (alerts.spacing > 0) {
+        printf("\033[33m⚠ Regras de espaçamento: %lu alerta(s)\033[0m\n", alerts.spacing);
+    } else {
+        printf("\033[32m✓ Regras de espaçamento respeitadas\033[0m\n");
+    }
     
-    if (!validate_variable_usage(ast)) {
+    if (invalid & VALIDATE_VARIABLE_USAGE) {
         printf("\033[31mErro: uso inválido de variáveis\033[0m\n");
         free_ast(ast);
-        parser_free(parser);
-        close_scanner();
         return NULL;
     }
-    printf("\033[32m✓ Uso de variáveis válido\033[0m\n");
+    if (alerts.variable_usage > 0) {
+        printf("\033[33m⚠ Uso de variáveis: %lu alerta(s)\033[0m\n", alerts.variable_usage);
+    } else {
+        printf("\033[32m✓ Uso de variáveis válido\033[0m\n");
+    }
 
     /* Imprimir AST */
     printf("\n\033[34m=== ÁRVORE SINTÁTICA ABSTRATA ===\033[0m\n");
     print_ast(ast, 0);
-
-    parser_free(parser);
-    close_scanner();
+    if (parser_lazy_errors() > 0) {
+        printf("\033[31mErros encontrados durante a análise sintática.\033[0m\n");
+        free_ast(ast);
+        return NULL;
+    }
 
     return ast;
 }
 
+/* Compilação função a função (--stream); retorna -1 se o programa só
+ * puder ser compilado em lote */
+static int stream_file(const char *path, size_t limit) {
+    Scanner source;
+    SemaContext *sc;
+    StreamResult result;
+
+    sc = sema_create(limit);
+    if (!sc) return EXIT_FAILURE;
+
+    scanner_open(&source, path);
+    result = compile_streaming(source.src, source.len, sc);
+    scanner_close(&source);
+
+    switch (result) {
+        case STREAM_UNSUPPORTED:
+            sema_destroy(sc);
+            return -1;
+        case STREAM_SYNTAX_ERROR:
+            printf("\033[31mErros encontrados durante a análise sintática.\033[0m\n");
+            sema_destroy(sc);
+            return EXIT_FAILURE;
+        case STREAM_INVALID:
+            printf("\033[31mErro: sequência de declarações inválida\033[0m\n");
+            sema_destroy(sc);
+            return EXIT_FAILURE;
+        case STREAM_SPACING:
+            printf("\033[31mErro: regras de espaçamento não respeitadas\033[0m\n");
+            sema_destroy(sc);
+            return EXIT_FAILURE;
+        default:
+            break;
+    }
+
+    printf("\033[32mAnálise semântica concluída com sucesso!\033[0m\n");
+    symtab_print(sc);
+    sema_destroy(sc);
+    return EXIT_SUCCESS;
+}
+
+/* Offset da coluna col (em bytes, a partir de 1) da linha line, ou -1 */
+static int source_offset(const Scanner *source, int line, int col) {
+    size_t pos = 0;
+    while (line > 1 && pos < source->len) {
+        if (source->src[pos++] == '\n') line--;
+    }
+    if (line > 1) return -1;
+    pos += (size_t)col - 1;
+    return pos < source->len ? (int)pos : -1;
+}
+
+static int source_column(const Scanner *source, int offset) {
+    int start = offset;
+    while (start > 0 && source->src[start - 1] != '\n') start--;
+    return offset - start + 1;
+}
+
+/* Consulta --symbol-at: o símbolo na posição, a declaração e os usos */
+static void print_symbol_at(const SymIndex *idx, const Scanner *source, int line, int col) {
+    int offset = source_offset(source, line, col);
+    int def = offset >= 0 ? symindex_symbol_at(idx, offset) : -1;
+
+    printf("\n\033[34m=== ÍNDICE DE SÍMBOLOS ===\033[0m\n");
+    if (def < 0) {
+        printf("%d:%d: nenhum símbolo\n", line, col);
+    } else {
+        const SymDef *d = symindex_def(idx, def);
+        const SymRef *refs;
+        int count, i;
+        printf("%d:%d: %s (%s, %s), declarado em %d:%d\n", line, col, symindex_name(idx, def),
+               symtab_class_str(d->sclass), symtab_type_str(d->type), d->line,
+               source_column(source, d->offset));
+        refs = symindex_refs(idx, def, &count);
+        printf("Referências (%d):", count);
+        for (i = 0; i < count; i++) {
+            printf(" %d:%d", refs[i].line, source_column(source, refs[i].offset));
+        }
+        printf("\n");
+    }
+    printf("Índice: %d definições, %d referências, %d escopos, %zu bytes\n",
+           symindex_def_count(idx), symindex_ref_count(idx), symindex_scope_count(idx),
+           symindex_size(idx));
+}
+
+static const char* keyword_str(TokenType keyword) {
+    switch (keyword) {
+        case TOK_KW_DECIMAL: return "decimal";
+        case TOK_KW_TEXTO:   return "texto";
+        default:             return "inteiro";
+    }
+}
+
+static void print_frame(const FrameReport *r, const FrameFunc *f) {
+    const FrameSlot *slots = frame_slots(r, f);
+    int i;
+
+    printf("%s: %d bytes, %d %s em %d bytes%s%s\n", f->name, f->size, f->slot_count,
+           f->slot_count == 1 ? "variável" : "variáveis", f->slot_bytes,
+           f->dynamic ? " + tamanho não constante" : "", f->recursive ? " (recursiva)" : "");
+    for (i = 0; i < f->slot_count; i++) {
+        char type[32];
+        if (slots[i].dynamic) {
+            sprintf(type, "%s[?]", keyword_str(slots[i].keyword));
+        } else if (slots[i].count > 0) {
+            sprintf(type, "%s[%d]", keyword_str(slots[i].keyword), slots[i].count);
+        } else {
+            sprintf(type, "%s", keyword_str(slots[i].keyword));
+        }
+        printf("  %5d %5d  %-14s %s%s%s\n", slots[i].offset, slots[i].size, type, slots[i].name,
+               slots[i].param ? " (parâmetro)" : "", slots[i].block ? " (bloco)" : "");
+    }
+}
+
+/* --frames: quadro de cada função e a pilha no pior caso */
+static void print_frames(const FrameReport *r) {
+    const int *recursion;
+    int count, entry = frame_entry(r), i;
+
+    printf("\n\033[34m=== QUADROS DE PILHA ===\033[0m\n");
+    if (frame_globals(r)->slot_count > 0) print_frame(r, frame_globals(r));
+    for (i = 0; i < frame_func_count(r); i++) print_frame(r, frame_func(r, i));
+    if (entry < 0) return;
+
+    printf("Pilha no pior caso a partir de %s: %ld bytes (", frame_func(r, entry)->name,
+           frame_func(r, entry)->depth);
+    for (i = entry; i >= 0; i = frame_func(r, i)->next) {
+        printf("%s%s%s", i == entry ? "" : " -> ", frame_func(r, i)->name,
+               frame_func(r, i)->recursive ? "*" : "");
+    }
+    printf(")\n");
+    recursion = frame_recursion(r, &count);
+    if (count > 0) {
+        printf("* recursão sem limite estático; cada função do componente conta uma vez:");
+        for (i = 0; i < count; i++) printf(" %s", frame_func(r, recursion[i])->name);
+        printf("\n");
+    }
+}
+
+/* --inline: decisão por chamada e a árvore com as expansões */
+static void print_inline(ASTNode *ast, const InlineReport *r) {
+    int i;
+    printf("\n\033[34m=== EXPANSÃO EM LINHA ===\033[0m\n");
+    for (i = 0; i < r->site_count; i++) {
+        const InlineSite *s = &r->sites[i];
+        printf("linha %d: %s em %s, %d laço(s), custo %d/%d: %s\n", s->line, s->callee,
+               s->caller, s->loop_depth, s->cost, s->limit, inline_decision_str(s->decision));
+    }
+    printf("%d de %d chamadas expandidas, %ld nós criados\n",
+           r->expanded, r->site_count, r->nodes_added);
+    if (r->expanded == 0) return;
+    printf("\n\033[34m=== ÁRVORE APÓS A EXPANSÃO ===\033[0m\n");
+    print_ast(ast, 0);
+}
+
+/* --fold: contagens e a árvore reescrita */
+static void print_fold(ASTNode *ast, const FoldStats *stats) {
+    printf("\n\033[34m=== DOBRAMENTO DE CONSTANTES ===\033[0m\n");
+    printf("%lu operações dobradas, %lu usos propagados de %lu variáveis constantes, "
+           "%lu divisões por zero\n",
+           stats->folded, stats->propagated, stats->constants, stats->div_zero);
+    if (stats->folded == 0 && stats->propagated == 0) return;
+    printf("\n\033[34m=== ÁRVORE APÓS O DOBRAMENTO ===\033[0m\n");
+    print_ast(ast, 0);
+}
+
+/* --ir: a IR gerada, os passos e a IR final */
+static void print_ir(ASTNode *ast, const Scanner *source, const IrPipeline *pipeline, int time_passes) {
+    IrPassStat stats[IR_MAX_PASSES];
+    IrModule *m = ir_lower(ast, source->src, source->len);
+    long insts, blocks;
+    size_t bytes;
+    int i;
+
+    printf("\n\033[34m=== REPRESENTAÇÃO INTERMEDIÁRIA (SSA) ===\033[0m\n");
+    ir_measure(m, &insts, &blocks, &bytes);
+    printf("Gerada: %ld instruções em %ld blocos, %d funções (%zu bytes)\n",
+           insts, blocks, m->func_count, bytes);
+    if (ir_verify(m) > 0 || !ir_run_pipeline(m, pipeline, stats)) {
+        ir_free(m);
+        return;
+    }
+    for (i = 0; i < pipeline->count; i++) {
+        printf("Passo %s: %lu alterações", stats[i].name, stats[i].changes);
+        if (time_passes) printf(" (%.3f ms)", stats[i].seconds * 1000.0);
+        printf("\n");
+    }
+    if (pipeline->count > 0) {
+        ir_measure(m, &insts, &blocks, &bytes);
+        printf("Final: %ld instruções em %ld blocos (%zu bytes)\n", insts, blocks, bytes);
+    }
+    ir_print(m);
+    ir_free(m);
+}
+
+static void print_memory_report(void) {
+    printf("\n\033[34m=== RELATÓRIO DE MEMÓRIA ===\033[0m\n");
+    printf("Uso atual: %zu bytes\n", mm_current_usage());
+    printf("Pico de uso: %zu bytes\n", mm_peak_usage());
+}
+
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <arquivo-fonte>\n", argv[0]);
+    const char *path = NULL;
+    const char *emit_ast = NULL;
+    int jobs = 1;
+    int stream = 0;
+    int lazy = 0;
+    int query_line = 0, query_col = 0;
+    int frames = 0;
+    int fold = 0;
+    int inline_calls = 0;
+    int ir = 0, time_passes = 0;
+    IrPipeline pipeline;
+    int sema_ok;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--emit-ast=", 11) == 0 && argv[i][11]) {
+            emit_ast = argv[i] + 11;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--hash-cons") == 0) {
+            parser_set_hash_consing(1);
+        } else if (strcmp(argv[i], "--lazy") == 0) {
+            lazy = 1;
+        } else if (strncmp(argv[i], "--spacing=", 10) == 0) {
+            unsigned rules;
+            if (!spacing_parse_rules(argv[i] + 10, &rules)) {
+                path = NULL;
+                break;
+            }
+            spacing_set_rules(rules);
+        } else if (strcmp(argv[i], "--spacing-strict") == 0) {
+            spacing_set_strict(1);
+        } else if (strncmp(argv[i], "--parser=", 9) == 0) {
+            ParserEngine engine;
+            if (!parser_parse_engine(argv[i] + 9, &engine)) {
+                path = NULL;
+                break;
+            }
+            parser_set_engine(engine);
+        } else if (strncmp(argv[i], "--symtab=", 9) == 0) {
+            SymTabDesign design;
+            if (!symtab_parse_design(argv[i] + 9, &design)) {
+                path = NULL;
+                break;
+            }
+            symtab_set_design(design);
+        } else if (strncmp(argv[i], "--dump=", 7) == 0) {
+            DumpFormat format;
+            if (!dump_parse_format(argv[i] + 7, &format)) {
+                path = NULL;
+                break;
+            }
+            dump_set_format(format);
+        } else if (strncmp(argv[i], "--symbol-at=", 12) == 0) {
+            if (sscanf(argv[i] + 12, "%d:%d", &query_line, &query_col) != 2 ||
+                query_line < 1 || query_col < 1) {
+                path = NULL;
+                break;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0) {
+            frames = 1;
+        } else if (strcmp(argv[i], "--inline") == 0) {
+            inline_calls = 1;
+        } else if (strcmp(argv[i], "--fold") == 0) {
+            fold = 1;
+        } else if (strcmp(argv[i], "--ir") == 0) {
+            ir = ir_parse_pipeline(IR_DEFAULT_PIPELINE, &pipeline);
+        } else if (strncmp(argv[i], "--ir=", 5) == 0) {
+            if (!ir_parse_pipeline(argv[i] + 5, &pipeline)) {
+                path = NULL;
+                break;
+            }
+            ir = 1;
+        } else if (strcmp(argv[i], "--time-passes") == 0) {
+            time_passes = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            path = NULL;
+            break;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Uso: %s [--jobs=N] [--emit-ast=arquivo] [--stream] [--hash-cons] [--lazy]\n"
+                        "       [--dump=none|text|json|binary] [--spacing=all|none|regra,...]\n"
+                        "       [--spacing-strict] [--parser=descent|ll1] [--symtab=scopes|global|hamt]\n"
+                        "       [--symbol-at=linha:coluna] [--frames] [--inline] [--fold]\n"
+                        "       [--ir[=passo,...|none]] [--time-passes]\n"
+                        "       <arquivo-fonte>\n", argv[0]);
         return EXIT_FAILURE;
     }
 
+    /* --emit-ast precisa da AST completa e analisada; no modo função a
+     * função cada corpo já é analisado logo após lido */
+    if (emit_ast) stream = lazy = 0;
+    if (stream) lazy = 0;
+    /* O dobramento reescreve a AST completa, depois da análise */
+    if (fold) stream = lazy = 0;
+    /* A IR é gerada do programa inteiro, já analisado */
+    if (ir) stream = lazy = 0;
+    /* O índice de símbolos, os quadros e a expansão em linha precisam de
+     * todos os corpos, e cada uso no seu próprio nó */
+    if (query_line || frames || inline_calls) {
+        stream = lazy = 0;
+        parser_set_hash_consing(0);
+    }
+    /* O analisador dirigido por tabela só analisa o programa inteiro */
+    if (parser_engine() == PARSER_LL1) stream = lazy = 0;
+    /* Listagens para ferramentas: a saída padrão fica só com elas */
+    if (dump_format() == DUMP_JSON || dump_format() == DUMP_BINARY) dump_claim_stdout();
+
     size_t LIMITE_MEMORIA = 2048 * 1024;
     const char *limit_env = getenv("MM_LIMIT");
     if (limit_env) {
@@ -87,7 +403,7 @@ int main(int argc, char **argv) {
     
     /* Análise léxica */
     printf("\033[34m=== ANÁLISE LÉXICA ===\033[0m\n");
-    int lex_result = lex_file(argv[1]);
+    int lex_result = stream ? lex_file_release(path) : lex_file(path);
     
     if (lex_result != EXIT_SUCCESS) {
         printf("\033[31mErros encontrados durante a análise léxica.\033[0m\n");
@@ -95,36 +411,94 @@ int main(int argc, char **argv) {
         return lex_result;
     }
     printf("\033[32mAnálise léxica concluída com sucesso!\033[0m\n\n");
+
+    /* Função a função, sem a AST completa (programas 'principal() {...}'
+     * seguem em lote) */
+    if (stream) {
+        int status = stream_file(path, LIMITE_MEMORIA);
+        if (status >= 0) {
+            if (status == EXIT_SUCCESS) print_memory_report();
+            mm_cleanup();
+            return status;
+        }
+    }
     
     /* Análise sintática */
-    ASTNode *ast = parse_file(argv[1]);
+    Scanner source;
+    scanner_open(&source, path);
+    if (lazy) parser_set_lazy_bodies(source.src);
+    ASTNode *ast = parse_file(&source, jobs);
     if (!ast) {
+        scanner_close(&source);
         mm_cleanup();
         return EXIT_FAILURE;
     }
 
-    /* Análise semântica */
+    /* Análise semântica: --jobs também reparte os corpos das funções */
+    sema_set_threads(jobs);
     SemaContext *sc = sema_create(LIMITE_MEMORIA);
     if (!sc) {
         free_ast(ast);
+        scanner_close(&source);
         mm_cleanup();
         return EXIT_FAILURE;
     }
-    if (!semantic_analyze(sc, ast)) {
+    if (query_line) sema_build_index(sc);
+    sema_ok = semantic_analyze(sc, ast);
+    if (!sema_ok) {
         printf("\033[31mErros encontrados durante a análise semântica.\033[0m\n");
+    } else if (parser_lazy_errors() > 0) {
+        /* Corpo alcançável, expandido só agora, com erro de sintaxe */
+        printf("\033[31mErros encontrados durante a análise sintática.\033[0m\n");
+        sema_destroy(sc);
+        free_ast(ast);
+        scanner_close(&source);
+        mm_cleanup();
+        return EXIT_FAILURE;
     } else {
         printf("\033[32mAnálise semântica concluída com sucesso!\033[0m\n");
     }
     symtab_print(sc);
+    if (query_line) {
+        SymIndex *index = sema_take_index(sc);
+        print_symbol_at(index, &source, query_line, query_col);
+        symindex_free(index);
+    }
+    /* A expansão resolve as chamadas pela tabela, antes de destruí-la */
+    if (inline_calls && sema_ok) {
+        InlineReport *report = inline_functions(ast, sc->symtab, source.src, source.len);
+        print_inline(ast, report);
+        inline_report_free(report);
+    }
     sema_destroy(sc);
 
+    /* Dobramento, quadros e IR, só de um programa sem erros semânticos */
+    if (fold && sema_ok) {
+        FoldStats stats;
+        fold_constants(ast, source.src, source.len, &stats);
+        print_fold(ast, &stats);
+    }
+
+    if (frames && sema_ok) {
+        FrameReport *report = frame_layout(ast, source.src, source.len);
+        print_frames(report);
+        frame_free(report);
+    }
+
+    if (ir && sema_ok) print_ir(ast, &source, &pipeline, time_passes);
+
+    /* AST binária, com os tipos inferidos */
+    if (emit_ast && ast_binary_write(ast, emit_ast)) {
+        printf("\033[32m✓ AST binária gravada em %s\033[0m\n", emit_ast);
+    }
+
     /* Limpeza da AST */
     free_ast(ast);
+    parser_set_lazy_bodies(NULL);
+    scanner_close(&source);
     
     /* Relatório de memória */
-    printf("\n\033[34m=== RELATÓRIO DE MEMÓRIA ===\033[0m\n");
-    printf("Uso atual: %zu bytes\n", mm_current_usage());
-    printf("Pico de uso: %zu bytes\n", mm_peak_usage());
+    print_memory_report();
     
     mm_cleanup();
 
@@ -2,17 +2,52 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 
 static size_t mm_limit       = 0;  
 static size_t mm_current     = 0;  
 static size_t mm_high_water  = 0;  
 
+/* Com várias threads alocando (análise paralela), as operações são
+   serializadas; fora disso o mutex não é tocado. */
+static pthread_mutex_t mm_lock = PTHREAD_MUTEX_INITIALIZER;
+static int mm_threaded = 0;
+
+#define MM_LOCK()   do { if (mm_threaded) pthread_mutex_lock(&mm_lock); } while (0)
+#define MM_UNLOCK() do { if (mm_threaded) pthread_mutex_unlock(&mm_lock); } while (0)
+
 typedef struct BlockHeader {
     size_t size;                
-    struct BlockHeader *next;   
+    size_t slot;                /* posição na tabela de blocos vivos */
 } BlockHeader;
 
-static BlockHeader *mm_head = NULL; 
+/* Tabela de blocos vivos: remoção O(1) trocando com o último elemento.
+   Fica fora da contabilidade, assim como o restante da infraestrutura. */
+static BlockHeader **mm_blocks = NULL;
+static size_t mm_block_count    = 0;
+static size_t mm_block_capacity = 0;
+
+static void mm_track(BlockHeader *h) {
+    if (mm_block_count == mm_block_capacity) {
+        size_t cap = mm_block_capacity ? mm_block_capacity * 2 : 256;
+        BlockHeader **blocks = (BlockHeader **)realloc(mm_blocks, cap * sizeof(BlockHeader *));
+        if (!blocks) {
+            fprintf(stderr, "\033[31mMemória Insuficiente\033[0m\n");
+            exit(EXIT_FAILURE);
+        }
+        mm_blocks = blocks;
+        mm_block_capacity = cap;
+    }
+    h->slot = mm_block_count;
+    mm_blocks[mm_block_count++] = h;
+}
+
+static void mm_untrack(BlockHeader *h) {
+    BlockHeader *last = mm_blocks[--mm_block_count];
+    mm_blocks[h->slot] = last;
+    last->slot = h->slot;
+}
+
 static void mm_check(size_t new_current) {
     if (new_current > mm_limit && mm_limit > 0) {
         fprintf(stderr, "\033[31mMemória Insuficiente\033[0m\n");
@@ -28,7 +63,11 @@ void mm_init(size_t max_bytes) {
     mm_limit      = max_bytes;
     mm_current    = 0;
     mm_high_water = 0;
-    mm_head       = NULL;
+    mm_block_count = 0;
+}
+
+void mm_set_threaded(int on) {
+    mm_threaded = on;
 }
 
 void *mm_malloc(size_t size) {
@@ -37,20 +76,20 @@ void *mm_malloc(size_t size) {
         fprintf(stderr, "Memória não inicializada\n");
         exit(EXIT_FAILURE);
     }
-    mm_check(mm_current + total);
-
     BlockHeader *h = (BlockHeader *)malloc(total);
     if (!h) {
         fprintf(stderr, "\033[31mMemória Insuficiente\033[0m\n");
         exit(EXIT_FAILURE);
     }
 
+    MM_LOCK();
+    mm_check(mm_current + total);
     h->size = size;
-    h->next = mm_head; /* encadeia */
-    mm_head = h;
+    mm_track(h);
 
     mm_current += total;
     mm_check(mm_current);
+    MM_UNLOCK();
     return (void *)(h + 1); /* retorna ponteiro após o cabeçalho */
 }
 
@@ -61,6 +100,7 @@ void *mm_realloc(void *ptr, size_t new_size) {
     size_t old_total  = sizeof(BlockHeader) + oldh->size;
     size_t new_total  = sizeof(BlockHeader) + new_size;
 
+    MM_LOCK();
     if (new_total > old_total) mm_check(mm_current + (new_total - old_total));
 
     BlockHeader *newh = (BlockHeader *)realloc(oldh, new_total);
@@ -69,18 +109,13 @@ void *mm_realloc(void *ptr, size_t new_size) {
         exit(EXIT_FAILURE);
     }
 
-    /* Se o bloco realocou em outro endereço, precisamos ajustar a lista */
-    if (mm_head == oldh) {
-        mm_head = newh;
-    } else {
-        BlockHeader *p = mm_head;
-        while (p && p->next != oldh) p = p->next;
-        if (p) p->next = newh;
-    }
+    /* Se o bloco realocou em outro endereço, precisamos ajustar a tabela */
+    mm_blocks[newh->slot] = newh;
 
     newh->size = new_size;
     mm_current += (new_total - old_total);
     mm_check(mm_current);
+    MM_UNLOCK();
     return (void *)(newh + 1);
 }
 
@@ -88,21 +123,23 @@ void mm_free(void *ptr) {
     if (!ptr) return;
     BlockHeader *h = (BlockHeader *)ptr - 1;
 
-    /* remove da lista */
-    if (mm_head == h) {
-        mm_head = h->next;
-    } else {
-        BlockHeader *p = mm_head;
-        while (p && p->next != h) p = p->next;
-        if (p) p->next = h->next;
-    }
+    MM_LOCK();
+    /* remove da tabela */
+    mm_untrack(h);
 
     size_t total = sizeof(BlockHeader) + h->size;
     mm_current -= total;
+    MM_UNLOCK();
     free(h);
 }
 
-size_t mm_current_usage(void) { return mm_current; }
+size_t mm_current_usage(void) {
+    size_t usage;
+    MM_LOCK();
+    usage = mm_current;
+    MM_UNLOCK();
+    return usage;
+}
 /* Limite máximo estabelecido via mm_init */
 size_t mm_max_usage(void) { return mm_limit; }
 /* Maior pico de uso observado */
@@ -122,13 +159,14 @@ void mm_usage_guard(void) {
 }
 
 void mm_cleanup(void) {
-    BlockHeader *h = mm_head;
-    while (h) {
-        BlockHeader *next = h->next;
-        free(h);
-        h = next;
+    size_t i;
+    for (i = 0; i < mm_block_count; i++) {
+        free(mm_blocks[i]);
     }
-    mm_head    = NULL;
+    free(mm_blocks);
+    mm_blocks         = NULL;
+    mm_block_count    = 0;
+    mm_block_capacity = 0;
     mm_current = 0;
 }
 
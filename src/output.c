@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "output.h"
+
+static DumpFormat current_format = DUMP_TEXT;
+
+void dump_set_format(DumpFormat format) {
+    current_format = format;
+}
+
+DumpFormat dump_format(void) {
+    return current_format;
+}
+
+int dump_parse_format(const char *name, DumpFormat *format) {
+    static const char *const names[] = {"none", "text", "json", "binary"};
+    int i;
+    for (i = 0; i < 4; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *format = (DumpFormat)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static char stdout_buffer[OUT_BUFFER_SIZE];
+static OutSink stdout_sink;
+static int listing_fd = STDOUT_FILENO;
+
+void dump_claim_stdout(void) {
+    int fd;
+
+    fflush(stdout);
+    fd = dup(STDOUT_FILENO);
+    if (fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        fprintf(stderr, "Erro: não foi possível separar as listagens da saída padrão\n");
+        exit(EXIT_FAILURE);
+    }
+    listing_fd = fd;
+    if (stdout_sink.buf) stdout_sink.fd = fd;
+}
+
+/* exit() no meio de uma listagem (erro léxico, memória esgotada) não perde
+ * o que já estava no buffer */
+static void flush_stdout_sink(void) {
+    out_flush(&stdout_sink);
+}
+
+OutSink* out_stdout(void) {
+    if (!stdout_sink.buf) {
+        out_init(&stdout_sink, listing_fd, stdout_buffer, sizeof(stdout_buffer));
+        atexit(flush_stdout_sink);
+    }
+    return &stdout_sink;
+}
+
+void out_init(OutSink *out, int fd, char *buf, size_t cap) {
+    out->fd = fd;
+    out->buf = buf;
+    out->cap = cap;
+    out->len = 0;
+    out->failed = 0;
+}
+
+/* writev até o fim, retomando após escritas parciais e interrupções */
+static void write_all(OutSink *out, struct iovec *iov, int count) {
+    /* O que o printf já acumulou vem antes, na ordem do programa (também
+     * quando stdout foi desviado para stderr por dump_claim_stdout) */
+    if (out->fd == listing_fd) fflush(stdout);
+
+    while (count > 0 && !out->failed) {
+        ssize_t n = writev(out->fd, iov, count);
+        if (n < 0) {
+            if (errno != EINTR) out->failed = 1;
+            continue;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+
+int out_flush(OutSink *out) {
+    if (out->len > 0) {
+        struct iovec iov;
+        iov.iov_base = out->buf;
+        iov.iov_len = out->len;
+        write_all(out, &iov, 1);
+        out->len = 0;
+    }
+    return !out->failed;
+}
+
+void out_write(OutSink *out, const void *data, size_t len) {
+    if (len == 0) return;
+    if (len <= out->cap - out->len) {
+        memcpy(out->buf + out->len, data, len);
+        out->len += len;
+    } else if (len >= out->cap / 2) {
+        /* Bloco grande: sai junto com o pendente, sem cópia */
+        struct iovec iov[2];
+        iov[0].iov_base = out->buf;
+        iov[0].iov_len = out->len;
+        iov[1].iov_base = (void*)data;
+        iov[1].iov_len = len;
+        write_all(out, iov, 2);
+        out->len = 0;
+    } else {
+        out_flush(out);
+        memcpy(out->buf, data, len);
+        out->len = len;
+    }
+}
+
+void out_str(OutSink *out, const char *s) {
+    out_write(out, s, strlen(s));
+}
+
+void out_char(OutSink *out, char c) {
+    if (out->len == out->cap) out_flush(out);
+    out->buf[out->len++] = c;
+}
+
+/* Dígitos de value no fim de buf; retorna o início */
+static char* format_long(char *end, long value) {
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    char *p = end;
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) *--p = '-';
+    return p;
+}
+
+void out_long(OutSink *out, long value) {
+    char buf[24];
+    char *start = format_long(buf + sizeof(buf), value);
+    out_write(out, start, (size_t)(buf + sizeof(buf) - start));
+}
+
+static void out_spaces(OutSink *out, int count) {
+    while (count-- > 0) out_char(out, ' ');
+}
+
+void out_str_pad(OutSink *out, const char *s, int width) {
+    size_t len = strlen(s);
+    out_write(out, s, len);
+    if ((size_t)width > len) out_spaces(out, width - (int)len);
+}
+
+void out_long_pad(OutSink *out, long value, int width) {
+    char buf[24];
+    char *start = format_long(buf + sizeof(buf), value);
+    int len = (int)(buf + sizeof(buf) - start);
+    out_spaces(out, width - len);
+    out_write(out, start, (size_t)len);
+}
+
+void out_json_str(OutSink *out, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run;
+
+    if (!s) {
+        out_str(out, "null");
+        return;
+    }
+    out_char(out, '"');
+    for (run = s; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out_write(out, run, (size_t)(s - run));
+        run = s + 1;
+        switch (c) {
+            case '"':  out_str(out, "\\\""); break;
+            case '\\': out_str(out, "\\\\"); break;
+            case '\n': out_str(out, "\\n"); break;
+            case '\t': out_str(out, "\\t"); break;
+            case '\r': out_str(out, "\\r"); break;
+            default:
+                out_str(out, "\\u00");
+                out_char(out, hex[c >> 4]);
+                out_char(out, hex[c & 0xF]);
+                break;
+        }
+    }
+    out_write(out, run, (size_t)(s - run));
+    out_char(out, '"');
+}
+
+void out_u32(OutSink *out, uint32_t value) {
+    out_write(out, &value, sizeof(value));
+}
+
+void out_i32(OutSink *out, int32_t value) {
+    out_write(out, &value, sizeof(value));
+}
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include "parse_parallel.h"
+#include "lexer.h"
+#include "memmgr.h"
+#include "util.h"
+
+/* Região do fonte analisada por uma única thread */
+typedef struct {
+    SourceRegion region;
+    ASTNode **items;                /* itens de nível superior, em ordem */
+    int item_count;
+    int item_capacity;
+    Token first;                    /* primeiro token da região */
+    int had_error;
+} Segment;
+
+typedef struct {
+    const char *text;
+    Segment *segments;
+    int count;
+    int next;                       /* próxima região ainda não analisada */
+    pthread_mutex_t lock;
+} ParallelJob;
+
+static void *parallel_alloc(void *ptr, size_t size) {
+    void *p = mm_realloc(ptr, size);
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a análise paralela\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/* 'word' começa em text[i] como palavra inteira (não parte de variável/função) */
+static int word_at(const char *text, size_t len, size_t i, const char *word) {
+    size_t n = strlen(word);
+    if (i + n > len || strncmp(text + i, word, n) != 0) return 0;
+    if (i > 0 && (isalnum((unsigned char)text[i - 1]) || text[i - 1] == '_' || text[i - 1] == '!')) {
+        return 0;
+    }
+    return i + n == len || !(isalnum((unsigned char)text[i + n]) || text[i + n] == '_');
+}
+
+int split_top_level(const char *text, size_t len, SourceRegion **regions) {
+    int count = 0, capacity = 0, depth = 0, line = 1;
+    size_t i = 0;
+
+    for (;;) {
+        int boundary = i == 0 || i >= len;
+        if (!boundary && depth == 0 &&
+            (word_at(text, len, i, "funcao") || word_at(text, len, i, "principal"))) {
+            boundary = 1;
+        }
+        if (boundary) {
+            if (regions && count > 0) (*regions)[count - 1].end = i;
+            if (i >= len || (!regions && count > 1)) break;
+            if (regions) {
+                if (count >= capacity) {
+                    capacity = capacity ? capacity * 2 : 64;
+                    *regions = parallel_alloc(*regions, capacity * sizeof(SourceRegion));
+                }
+                (*regions)[count].start = i;
+                (*regions)[count].end = i;
+                (*regions)[count].line = line;
+            }
+            count++;
+        }
+
+        if (text[i] == '"') {
+            /* Strings seguem a regra do lexer: '\' escapa o caractere seguinte */
+            for (i++; i < len && text[i] != '"'; i++) {
+                if (text[i] == '\\' && i + 1 < len) {
+                    if (text[i + 1] == '\n') line++;
+                    i++;
+                }
+                if (text[i] == '\n') line++;
+            }
+        } else if (text[i] == '\n') {
+            line++;
+        } else if (text[i] == '{') {
+            depth++;
+        } else if (text[i] == '}' && depth > 0) {
+            depth--;
+        } else if (isalpha((unsigned char)text[i]) || text[i] == '_' || text[i] == '!') {
+            /* Pula o resto da palavra para não reconhecer sufixos */
+            while (i + 1 < len && (isalnum((unsigned char)text[i + 1]) || text[i + 1] == '_')) i++;
+        }
+        i++;
+    }
+
+    return count;
+}
+
+static void parse_segment(Parser *parser, Segment *seg) {
+    parser->silent = 1;
+    seg->first = parser->current_token;
+
+    while (!parse_program_at_end(parser)) {
+        ASTNode *item = parse_program_item(parser);
+        if (!item) continue;
+        if (seg->item_count >= seg->item_capacity) {
+            seg->item_capacity = seg->item_capacity ? seg->item_capacity * 2 : 4;
+            seg->items = parallel_alloc(seg->items, seg->item_capacity * sizeof(ASTNode*));
+        }
+        seg->items[seg->item_count++] = item;
+    }
+    seg->had_error = parser->had_error;
+}
+
+static void *parse_worker(void *arg) {
+    ParallelJob *job = arg;
+    Parser *parser = NULL;
+    Scanner sc;
+
+    for (;;) {
+        Segment *seg;
+        int i;
+        pthread_mutex_lock(&job->lock);
+        i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->count) break;
+
+        /* Um Parser por thread, reaproveitado entre as regiões */
+        seg = &job->segments[i];
+        scanner_init_range(&sc, job->text, seg->region.start, seg->region.end, seg->region.line);
+        if (parser) parser_set_scanner(parser, &sc);
+        else parser = parser_init_scanner(&sc);
+        parse_segment(parser, seg);
+    }
+    if (parser) parser_free(parser);
+    return NULL;
+}
+
+static ASTNode* parse_sequential(const char *text, size_t len, int *had_error) {
+    Scanner sc;
+    Parser *parser;
+    ASTNode *program;
+
+    scanner_init_buffer(&sc, text, len, 1);
+    parser = parser_init_scanner(&sc);
+    program = parse_program(parser);
+    *had_error = parser->had_error;
+    parser_free(parser);
+    return program;
+}
+
+int starts_with_principal(const char *text, size_t len) {
+    size_t i = 0;
+    while (i < len && isspace((unsigned char)text[i])) i++;
+    return word_at(text, len, i, "principal");
+}
+
+ASTNode* parse_program_parallel(const char *text, size_t len, int threads, int *had_error) {
+    ParallelJob job;
+    SourceRegion *regions;
+    pthread_t *workers;
+    ASTNode *program = NULL;
+    int started = 0, failed = 0, i, j;
+
+    if (threads <= 1 || parser_engine() != PARSER_DESCENT || starts_with_principal(text, len)) {
+        return parse_sequential(text, len, had_error);
+    }
+
+    if (split_top_level(text, len, NULL) <= 1) {
+        return parse_sequential(text, len, had_error);
+    }
+    job.text = text;
+    job.next = 0;
+    regions = NULL;
+    job.count = split_top_level(text, len, &regions);
+    job.segments = parallel_alloc(NULL, job.count * sizeof(Segment));
+    memset(job.segments, 0, job.count * sizeof(Segment));
+    for (i = 0; i < job.count; i++) {
+        job.segments[i].region = regions[i];
+    }
+    mm_free(regions);
+    if (threads > job.count) threads = job.count;
+
+    pthread_mutex_init(&job.lock, NULL);
+    mm_set_threaded(1);
+    workers = malloc((threads - 1) * sizeof(pthread_t));
+    for (i = 0; workers && i < threads - 1; i++) {
+        if (pthread_create(&workers[i], NULL, parse_worker, &job) != 0) break;
+        started++;
+    }
+    parse_worker(&job);
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    mm_set_threaded(0);
+    pthread_mutex_destroy(&job.lock);
+
+    for (i = 0; i < job.count; i++) {
+        failed |= job.segments[i].had_error;
+    }
+    if (!failed) {
+        /* O nó PROGRAM leva o primeiro token do arquivo */
+        for (i = 0; i < job.count && job.segments[i].first.type == TOK_EOF; i++)
+            ;
+        program = ast_node_create(AST_PROGRAM, job.segments[i < job.count ? i : 0].first);
+    }
+    for (i = 0; i < job.count; i++) {
+        Segment *seg = &job.segments[i];
+        for (j = 0; j < seg->item_count; j++) {
+            if (failed) free_ast(seg->items[j]);
+            else ast_node_add_child(program, seg->items[j]);
+        }
+        if (seg->items) mm_free(seg->items);
+    }
+    mm_free(job.segments);
+
+    if (failed) {
+        return parse_sequential(text, len, had_error);
+    }
+    *had_error = 0;
+    return program;
+}
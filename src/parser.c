@@ -1,7 +1,16 @@
 #include "parser.h"
+#include "ast_binary.h"
+#include "ast_walk.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "hashcons.h"
 #include "lexer.h"
+#include "ll1.h"
 #include "memmgr.h"
 #include "error.h"
+#include "output.h"
+#include "spacing.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,14 +22,6 @@ ASTNode* parse_declaration(Parser *parser);
 ASTNode* parse_statement(Parser *parser);
 ASTNode* parse_assignment(Parser *parser);
 ASTNode* parse_expression(Parser *parser);
-ASTNode* parse_logical_or(Parser *parser);
-ASTNode* parse_logical_and(Parser *parser);
-ASTNode* parse_equality(Parser *parser);
-ASTNode* parse_comparison(Parser *parser);
-ASTNode* parse_term(Parser *parser);
-ASTNode* parse_factor(Parser *parser);
-ASTNode* parse_unary(Parser *parser);
-ASTNode* parse_primary(Parser *parser);
 ASTNode* parse_if_statement(Parser *parser);
 ASTNode* parse_while_statement(Parser *parser);
 ASTNode* parse_for_statement(Parser *parser);
@@ -28,9 +29,7 @@ ASTNode* parse_read_statement(Parser *parser);
 ASTNode* parse_write_statement(Parser *parser);
 ASTNode* parse_block(Parser *parser);
 ASTNode* parse_function_definition(Parser *parser);
-
-/* Variável global para o parser atual */
-static Parser *current_parser = NULL;
+static ASTNode* skip_block(Parser *parser);
 
 /* ========== Funções de criação e gerenciamento do AST ========== */
 
@@ -42,14 +41,15 @@ ASTNode* ast_node_create(ASTNodeType type, Token token) {
     }
     
     node->type = type;
+    node->refcount = 0;
+    node->lazy = 0;
     node->token = token;
     node->children = NULL;
     node->child_count = 0;
     node->child_capacity = 0;
     node->value = NULL;
-    node->inferred_type.kind = TY_INT;
-    node->inferred_type.info.dec.a = 0;
-    node->inferred_type.info.dec.b = 0;
+    node->inferred_type = TYPE_INT;
+    node->typed_version = 0;
     
     return node;
 }
@@ -72,79 +72,261 @@ void ast_node_add_child(ASTNode *parent, ASTNode *child) {
     parent->children[parent->child_count++] = child;
 }
 
-void free_ast(ASTNode *node) {
-    if (!node) return;
-    
-    int i;
-    for (i = 0; i < node->child_count; i++) {
-        free_ast(node->children[i]);
-    }
-    
+char ast_declarator_arg(const ASTNode *decl, int index, const char *source, size_t len) {
+    const Token *id = &decl->children[index]->token;
+    size_t pos = (size_t)id->offset + (size_t)id->length;
+    if (index + 1 >= decl->child_count) return '\0';
+    while (pos < len && isspace((unsigned char)source[pos])) pos++;
+    return pos < len && (source[pos] == '=' || source[pos] == '[') ? source[pos] : '\0';
+}
+
+/* Nó compartilhado: só perde esta referência, e os filhos não são visitados */
+static AstWalkAction free_ast_pre(AstWalker *w, ASTNode *node, void *data) {
+    (void)data;
+    if (node->refcount > 0) {
+        node->refcount--;
+        ast_walk_set_tag(w, 1);
+        return AST_WALK_SKIP;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void free_ast_post(AstWalker *w, ASTNode *node, void *data) {
+    (void)data;
+    if (ast_walk_tag(w)) return;
     if (node->children) mm_free(node->children);
     if (node->value) mm_free(node->value);
     mm_free(node);
 }
 
-void print_ast(ASTNode *node, int depth) {
-    if (!node) return;
-    
-    int i;
-    /* Indentação */
-    for (i = 0; i < depth; i++) {
-        printf("  ");
+void free_ast(ASTNode *node) {
+    AstVisitor visitor = {free_ast_pre, free_ast_post, NULL, 0, 0};
+    ast_walk(node, &visitor);
+}
+
+static const char *const ast_type_names[] = {
+    "PROGRAM", "DECLARATION", "ASSIGNMENT", "EXPRESSION", "IF_STMT",
+    "WHILE_STMT", "FOR_STMT", "READ_STMT", "WRITE_STMT", "BLOCK",
+    "BINARY_OP", "UNARY_OP", "LITERAL", "IDENTIFIER", "FUNCTION_DEF",
+    "FUNCTION_CALL", "RETURN_STMT"
+};
+
+static void print_indent(OutSink *out, int depth) {
+    static const char spaces[] = "                                ";
+    int n = depth * 2;
+    while (n > 0) {
+        int chunk = n < (int)sizeof(spaces) - 1 ? n : (int)sizeof(spaces) - 1;
+        out_write(out, spaces, (size_t)chunk);
+        n -= chunk;
     }
+}
+
+static AstWalkAction print_ast_pre(AstWalker *w, ASTNode *node, void *data) {
+    OutSink *out = out_stdout();
+    int depth = *(int*)data + ast_walk_depth(w);
+    ast_expand_body(node);
+    /* Indentação */
+    print_indent(out, depth);
     
     /* Imprimir tipo do nó */
-    const char *type_names[] = {
-        "PROGRAM", "DECLARATION", "ASSIGNMENT", "EXPRESSION", "IF_STMT",
-        "WHILE_STMT", "FOR_STMT", "READ_STMT", "WRITE_STMT", "BLOCK",
-        "BINARY_OP", "UNARY_OP", "LITERAL", "IDENTIFIER", "FUNCTION_DEF",
-        "FUNCTION_CALL", "RETURN_STMT"
-    };
-    
-    printf("%s", type_names[node->type]);
-    if (node->token.lexeme && strlen(node->token.lexeme) > 0) {
-        printf(" '%s'", node->token.lexeme);
+    out_str(out, ast_type_names[node->type]);
+    if (node->token.lexeme && node->token.lexeme[0]) {
+        out_str(out, " '");
+        out_str(out, node->token.lexeme);
+        out_char(out, '\'');
     }
     if (node->value) {
-        printf(" (%s)", node->value);
+        out_str(out, " (");
+        out_str(out, node->value);
+        out_char(out, ')');
     }
-    printf("\n");
-    
-    /* Imprimir filhos */
-    for (i = 0; i < node->child_count; i++) {
-        print_ast(node->children[i], depth + 1);
+    out_char(out, '\n');
+    return AST_WALK_CONTINUE;
+}
+
+/* Objeto JSON por nó; os filhos ficam em "children" */
+static AstWalkAction print_ast_json_pre(AstWalker *w, ASTNode *node, void *data) {
+    OutSink *out = out_stdout();
+    (void)data;
+    ast_expand_body(node);
+    out_str(out, ast_walk_child_index(w) > 0 ? ",{\"type\":" : "{\"type\":");
+    out_json_str(out, ast_type_names[node->type]);
+    out_str(out, ",\"line\":");
+    out_long(out, node->token.line);
+    if (node->token.lexeme && node->token.lexeme[0]) {
+        out_str(out, ",\"lexeme\":");
+        out_json_str(out, node->token.lexeme);
+    }
+    if (node->value) {
+        out_str(out, ",\"value\":");
+        out_json_str(out, node->value);
+    }
+    out_str(out, ",\"children\":[");
+    return AST_WALK_CONTINUE;
+}
+
+static void print_ast_json_post(AstWalker *w, ASTNode *node, void *data) {
+    (void)w;
+    (void)node;
+    (void)data;
+    out_str(out_stdout(), "]}");
+}
+
+/* Listagem da subárvore no formato de --dump; depth só vale para o texto */
+void print_ast(ASTNode *node, int depth) {
+    AstVisitor visitor = {print_ast_pre, NULL, NULL, 0, 0};
+    OutSink *out = out_stdout();
+
+    switch (dump_format()) {
+        case DUMP_TEXT:
+            visitor.data = &depth;
+            ast_walk(node, &visitor);
+            break;
+        case DUMP_JSON:
+            visitor.pre = print_ast_json_pre;
+            visitor.post = print_ast_json_post;
+            ast_walk(node, &visitor);
+            out_char(out, '\n');
+            break;
+        case DUMP_BINARY:
+            ast_binary_emit(node, out);
+            break;
+        default:
+            break;
     }
+    out_flush(out);
 }
 
 /* ========== Funções de controle do parser ========== */
 
-Parser* parser_init(void) {
+static int hash_consing = 0;
+
+void parser_set_hash_consing(int on) {
+    hash_consing = on;
+}
+
+static ParserEngine engine = PARSER_DESCENT;
+
+void parser_set_engine(ParserEngine e) {
+    engine = e;
+}
+
+ParserEngine parser_engine(void) {
+    return engine;
+}
+
+int parser_parse_engine(const char *name, ParserEngine *e) {
+    if (strcmp(name, "descent") == 0) {
+        *e = PARSER_DESCENT;
+    } else if (strcmp(name, "ll1") == 0) {
+        *e = PARSER_LL1;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static const char *lazy_source = NULL;
+static int lazy_errors = 0;
+
+void parser_set_lazy_bodies(const char *source) {
+    lazy_source = source;
+}
+
+int parser_lazy_bodies(void) {
+    return lazy_source != NULL;
+}
+
+int parser_lazy_errors(void) {
+    return lazy_errors;
+}
+
+/* Registra o nó de expressão na tabela do parser, se houver */
+static ASTNode* expr_node(Parser *parser, ASTNode *node) {
+    return parser->hashcons ? hashcons_intern(parser->hashcons, node) : node;
+}
+
+static Parser* parser_create(const Token *tokens, Scanner *scanner) {
     Parser *parser = mm_malloc(sizeof(Parser));
     if (!parser) {
         fprintf(stderr, "Erro: não foi possível alocar memória para parser\n");
         exit(EXIT_FAILURE);
     }
     
-    parser->current_token = next_token();
+    parser->tokens = tokens;
+    parser->token_pos = 0;
+    parser->scanner = scanner;
+    parser->current_token = tokens ? tokens[parser->token_pos++] : scanner_next_token(scanner);
     parser->previous_token = (Token){.type = TOK_EOF, .lexeme = "", .line = 0};
     parser->had_error = 0;
     parser->panic_mode = 0;
+    parser->silent = 0;
+    parser->program_mode = PROGRAM_FUNCTIONS;
+    parser->expr_ops = NULL;
+    parser->expr_op_count = 0;
+    parser->expr_op_capacity = 0;
+    parser->expr_operands = NULL;
+    parser->expr_operand_count = 0;
+    parser->expr_operand_capacity = 0;
+    parser->stmt_frames = NULL;
+    parser->stmt_frame_count = 0;
+    parser->stmt_frame_capacity = 0;
+    parser->hashcons = hash_consing ? hashcons_create() : NULL;
     
-    current_parser = parser;
     return parser;
 }
 
+Parser* parser_init(void) {
+    return parser_create(NULL, global_scanner());
+}
+
+Parser* parser_init_tokens(const Token *tokens) {
+    return parser_create(tokens, NULL);
+}
+
+Parser* parser_init_scanner(Scanner *scanner) {
+    return parser_create(NULL, scanner);
+}
+
+void parser_set_scanner(Parser *parser, Scanner *scanner) {
+    parser->tokens = NULL;
+    parser->token_pos = 0;
+    parser->scanner = scanner;
+    parser->current_token = scanner_next_token(scanner);
+    parser->previous_token = (Token){.type = TOK_EOF, .lexeme = "", .line = 0};
+    parser->had_error = 0;
+    parser->panic_mode = 0;
+    parser->program_mode = PROGRAM_FUNCTIONS;
+}
+
+void parser_set_tokens(Parser *parser, const Token *tokens) {
+    parser->tokens = tokens;
+    parser->token_pos = 0;
+    parser->scanner = NULL;
+    parser->current_token = tokens[parser->token_pos++];
+    parser->previous_token = (Token){.type = TOK_EOF, .lexeme = "", .line = 0};
+    parser->had_error = 0;
+    parser->panic_mode = 0;
+    parser->program_mode = PROGRAM_FUNCTIONS;
+}
+
 void parser_free(Parser *parser) {
     if (parser) {
+        if (parser->expr_ops) mm_free(parser->expr_ops);
+        if (parser->expr_operands) mm_free(parser->expr_operands);
+        if (parser->stmt_frames) mm_free(parser->stmt_frames);
+        hashcons_destroy(parser->hashcons);
         mm_free(parser);
     }
-    current_parser = NULL;
 }
 
 void advance_token(Parser *parser) {
     parser->previous_token = parser->current_token;
-    parser->current_token = next_token();
+    if (!parser->tokens) {
+        parser->current_token = scanner_next_token(parser->scanner);
+    } else if (parser->current_token.type != TOK_EOF) {
+        parser->current_token = parser->tokens[parser->token_pos++];
+    }
 }
 
 int check_token(Parser *parser, TokenType type) {
@@ -164,6 +346,7 @@ void parser_error(Parser *parser, const char *message) {
     
     parser->panic_mode = 1;
     parser->had_error = 1;
+    if (parser->silent) return;
     
     fprintf(stderr, "\033[31mErro sintático na linha %d: %s\033[0m\n", 
             parser->current_token.line, message);
@@ -203,12 +386,14 @@ void synchronize(Parser *parser) {
 
 /* ========== Funções de parsing específicas ========== */
 
-ASTNode* parse_program(Parser *parser) {
+ASTNode* parse_program_begin(Parser *parser) {
     ASTNode *program = ast_node_create(AST_PROGRAM, parser->current_token);
     
     /* Verificar se começa com 'principal' ou função */
+    parser->program_mode = PROGRAM_FUNCTIONS;
     if (check_token(parser, TOK_KW_PRINCIPAL)) {
         advance_token(parser);
+        parser->program_mode = PROGRAM_DONE;
         
         if (!match_token(parser, TOK_LPAREN)) {
             parser_error(parser, "Esperado '(' após 'principal'");
@@ -225,48 +410,103 @@ ASTNode* parse_program(Parser *parser) {
             return program;
         }
         
-        /* Parse do corpo do programa principal */
-        while (!check_token(parser, TOK_RBRACE) && !check_token(parser, TOK_EOF)) {
-            ASTNode *stmt = parse_statement(parser);
-            if (stmt) {
-                ast_node_add_child(program, stmt);
-            }
-            
-            if (parser->panic_mode) {
-                synchronize(parser);
-            }
-        }
-        
+        parser->program_mode = PROGRAM_PRINCIPAL;
+    }
+    
+    return program;
+}
+
+int parse_program_at_end(Parser *parser) {
+    switch (parser->program_mode) {
+        case PROGRAM_PRINCIPAL:
+            return check_token(parser, TOK_RBRACE) || check_token(parser, TOK_EOF);
+        case PROGRAM_FUNCTIONS:
+            return check_token(parser, TOK_EOF);
+        default:
+            return 1;
+    }
+}
+
+/* 'principal() { ... }' depois de outras funções vira uma FUNCTION_DEF */
+static ASTNode* parse_principal_definition(Parser *parser) {
+    ASTNode *func_def = ast_node_create(AST_FUNCTION_DEF, parser->current_token);
+    ASTNode *name = ast_node_create(AST_IDENTIFIER, parser->current_token);
+    ast_node_add_child(func_def, name);
+    advance_token(parser); /* consume 'principal' */
+    
+    if (!match_token(parser, TOK_LPAREN)) {
+        parser_error(parser, "Esperado '(' após 'principal'");
+        return func_def;
+    }
+    
+    if (!match_token(parser, TOK_RPAREN)) {
+        parser_error(parser, "Esperado ')' após '('");
+        return func_def;
+    }
+    
+    ASTNode *body = parse_block(parser);
+    if (body) {
+        ast_node_add_child(func_def, body);
+    }
+    
+    return func_def;
+}
+
+ASTNode* parse_program_item(Parser *parser) {
+    ASTNode *item;
+    
+    /* Itens de um programa com funções não compartilham expressões entre si
+     * (podem ser liberados um a um, como em --stream) */
+    if (parser->hashcons && parser->program_mode == PROGRAM_FUNCTIONS) {
+        hashcons_reset(parser->hashcons);
+    }
+    
+    if (parser->program_mode == PROGRAM_FUNCTIONS && check_token(parser, TOK_KW_FUNCAO)) {
+        item = parse_function_definition(parser);
+    } else if (parser->program_mode == PROGRAM_FUNCTIONS && check_token(parser, TOK_KW_PRINCIPAL)) {
+        item = parse_principal_definition(parser);
+    } else {
+        item = parse_statement(parser);
+    }
+    
+    if (parser->panic_mode) {
+        synchronize(parser);
+    }
+    
+    return item;
+}
+
+void parse_program_end(Parser *parser) {
+    if (parser->program_mode == PROGRAM_PRINCIPAL) {
         if (!match_token(parser, TOK_RBRACE)) {
             parser_error(parser, "Esperado '}' para fechar programa principal");
         }
-    } else {
-        /* Parse de funções e declarações globais */
-        while (!check_token(parser, TOK_EOF)) {
-            if (check_token(parser, TOK_KW_FUNCAO)) {
-                ASTNode *func = parse_function_definition(parser);
-                if (func) {
-                    ast_node_add_child(program, func);
-                }
-            } else {
-                ASTNode *stmt = parse_statement(parser);
-                if (stmt) {
-                    ast_node_add_child(program, stmt);
-                }
-            }
-            
-            if (parser->panic_mode) {
-                synchronize(parser);
-            }
+        parser->program_mode = PROGRAM_DONE;
+    }
+}
+
+ASTNode* parse_program(Parser *parser) {
+    if (engine == PARSER_LL1) return ll1_parse_program(parser);
+    
+    ASTNode *program = parse_program_begin(parser);
+    
+    while (!parse_program_at_end(parser)) {
+        ASTNode *item = parse_program_item(parser);
+        if (item) {
+            ast_node_add_child(program, item);
         }
     }
     
+    parse_program_end(parser);
     return program;
 }
 
 ASTNode* parse_declaration(Parser *parser) {
     ASTNode *decl = ast_node_create(AST_DECLARATION, parser->current_token);
     
+    /* A declaração pode mudar o tipo de um identificador já compartilhado */
+    if (parser->hashcons) hashcons_reset(parser->hashcons);
+    
     /* Tipo da variável */
     TokenType type = parser->current_token.type;
     if (type != TOK_KW_INTEIRO && type != TOK_KW_DECIMAL && type != TOK_KW_TEXTO) {
@@ -334,7 +574,139 @@ ASTNode* parse_declaration(Parser *parser) {
     return decl;
 }
 
-ASTNode* parse_statement(Parser *parser) {
+/* ========== Comandos aninhados ========== */
+
+/*
+ * Como as expressões, os comandos aninhados não usam a pilha de C: cada
+ * 'se', 'enquanto', 'para' e bloco aberto é um quadro em parser->stmt_frames
+ * esperando o próximo comando interno. parse_nested analisa um comando de
+ * cada vez (os simples por inteiro, os compostos só até o cabeçalho) e,
+ * quando um termina, o entrega ao quadro do topo, que pede outro ou fecha.
+ */
+
+typedef enum {
+    STMT_FRAME_BLOCK,   /* bloco: comandos até '}' */
+    STMT_FRAME_THEN,    /* 'se' esperando o comando do então */
+    STMT_FRAME_ELSE,    /* 'se' esperando o comando do senão */
+    STMT_FRAME_BODY     /* 'enquanto' ou 'para' esperando o corpo */
+} StmtFrameKind;
+
+struct StmtFrame {
+    StmtFrameKind kind;
+    ASTNode *node;
+};
+
+static void stmt_push_frame(Parser *parser, StmtFrameKind kind, ASTNode *node) {
+    if (parser->stmt_frame_count >= parser->stmt_frame_capacity) {
+        int new_capacity = parser->stmt_frame_capacity == 0 ? 4 : parser->stmt_frame_capacity * 2;
+        parser->stmt_frames = mm_realloc(parser->stmt_frames,
+                                         new_capacity * sizeof(struct StmtFrame));
+        parser->stmt_frame_capacity = new_capacity;
+    }
+    parser->stmt_frames[parser->stmt_frame_count].kind = kind;
+    parser->stmt_frames[parser->stmt_frame_count].node = node;
+    parser->stmt_frame_count++;
+}
+
+static ASTNode* parse_simple_statement(Parser *parser);
+static int parse_if_header(Parser *parser, ASTNode *if_stmt);
+static int parse_while_header(Parser *parser, ASTNode *while_stmt);
+static int parse_for_header(Parser *parser, ASTNode *for_stmt);
+
+/* O bloco do topo pede mais um comando (1), ou fecha em '}' e vai para
+ * *done (0) */
+static int block_next(Parser *parser, ASTNode **done) {
+    if (!check_token(parser, TOK_RBRACE) && !check_token(parser, TOK_EOF)) return 1;
+    if (!match_token(parser, TOK_RBRACE)) {
+        parser_error(parser, "Esperado '}' para fechar bloco");
+    }
+    *done = parser->stmt_frames[--parser->stmt_frame_count].node;
+    return 0;
+}
+
+/* Começa um comando: o simples termina em *done (0); o composto abre um
+ * quadro que pede o comando interno (1) */
+static int statement_begin(Parser *parser, ASTNode **done) {
+    ASTNode *node;
+    switch (parser->current_token.type) {
+        case TOK_KW_SE:
+            node = ast_node_create(AST_IF_STMT, parser->current_token);
+            if (!parse_if_header(parser, node)) break;
+            stmt_push_frame(parser, STMT_FRAME_THEN, node);
+            return 1;
+        
+        case TOK_KW_ENQUANTO:
+            node = ast_node_create(AST_WHILE_STMT, parser->current_token);
+            if (!parse_while_header(parser, node)) break;
+            stmt_push_frame(parser, STMT_FRAME_BODY, node);
+            return 1;
+        
+        case TOK_KW_PARA:
+            node = ast_node_create(AST_FOR_STMT, parser->current_token);
+            if (!parse_for_header(parser, node)) break;
+            stmt_push_frame(parser, STMT_FRAME_BODY, node);
+            return 1;
+        
+        case TOK_LBRACE:
+            node = ast_node_create(AST_BLOCK, parser->current_token);
+            advance_token(parser); /* consume '{' */
+            stmt_push_frame(parser, STMT_FRAME_BLOCK, node);
+            return block_next(parser, done);
+        
+        default:
+            node = parse_simple_statement(parser);
+            break;
+    }
+    *done = node;
+    return 0;
+}
+
+/* Analisa até fechar os quadros acima de base; open diz se o topo espera um
+ * comando novo (senão, é um bloco a continuar) */
+static ASTNode* parse_nested(Parser *parser, int base, int open) {
+    ASTNode *done = NULL;
+    
+    if (!open) open = block_next(parser, &done);
+    for (;;) {
+        struct StmtFrame *top;
+        
+        if (open) {
+            done = NULL;
+            open = statement_begin(parser, &done);
+            continue;
+        }
+        if (parser->stmt_frame_count == base) return done;
+        
+        /* done terminou: é o comando interno do quadro do topo */
+        top = &parser->stmt_frames[parser->stmt_frame_count - 1];
+        if (done) {
+            ast_node_add_child(top->node, done);
+        }
+        done = NULL;
+        switch (top->kind) {
+            case STMT_FRAME_BLOCK:
+                if (parser->panic_mode) {
+                    synchronize(parser);
+                }
+                open = block_next(parser, &done);
+                break;
+            case STMT_FRAME_THEN:
+                if (match_token(parser, TOK_KW_SENAO)) {
+                    top->kind = STMT_FRAME_ELSE;
+                    open = 1;
+                    break;
+                }
+                /* fall through */
+            default:
+                done = parser->stmt_frames[--parser->stmt_frame_count].node;
+                break;
+        }
+    }
+}
+
+/* Comando sem comandos dentro: declaração, atribuição, leia, escreva e
+ * retorne */
+static ASTNode* parse_simple_statement(Parser *parser) {
     switch (parser->current_token.type) {
         case TOK_KW_INTEIRO:
         case TOK_KW_DECIMAL:
@@ -354,15 +726,6 @@ ASTNode* parse_statement(Parser *parser) {
             return assign;
         }
         
-        case TOK_KW_SE:
-            return parse_if_statement(parser);
-        
-        case TOK_KW_ENQUANTO:
-            return parse_while_statement(parser);
-        
-        case TOK_KW_PARA:
-            return parse_for_statement(parser);
-        
         case TOK_KW_LEIA:
             return parse_read_statement(parser);
         
@@ -386,9 +749,6 @@ ASTNode* parse_statement(Parser *parser) {
             return ret;
         }
         
-        case TOK_LBRACE:
-            return parse_block(parser);
-        
         default:
             parser_error(parser, "Comando não reconhecido");
             advance_token(parser);
@@ -396,6 +756,10 @@ ASTNode* parse_statement(Parser *parser) {
     }
 }
 
+ASTNode* parse_statement(Parser *parser) {
+    return parse_nested(parser, parser->stmt_frame_count, 1);
+}
+
 ASTNode* parse_assignment(Parser *parser) {
     ASTNode *assign = ast_node_create(AST_ASSIGNMENT, parser->current_token);
     
@@ -418,175 +782,210 @@ ASTNode* parse_assignment(Parser *parser) {
     return assign;
 }
 
-ASTNode* parse_expression(Parser *parser) {
-    return parse_logical_or(parser);
-}
+/* ========== Analisador de expressões por precedência de operadores ========== */
 
-ASTNode* parse_logical_or(Parser *parser) {
-    ASTNode *expr = parse_logical_and(parser);
-    
-    while (match_token(parser, TOK_OR)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_logical_and(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
-    }
-    
-    return expr;
-}
+/*
+ * As expressões são analisadas por um motor de precedência (shunting-yard)
+ * com pilhas explícitas de operadores e operandos, em vez de uma função
+ * recursiva por nível de precedência. Parênteses e chamadas de função são
+ * empilhados como marcadores, de modo que o aninhamento não consome a pilha
+ * de C. Todos os operadores binários são associativos à esquerda e o unário
+ * (+/-) tem precedência maior que qualquer binário, gerando a mesma AST da
+ * antiga cadeia parse_logical_or -> ... -> parse_primary.
+ */
 
-ASTNode* parse_logical_and(Parser *parser) {
-    ASTNode *expr = parse_equality(parser);
-    
-    while (match_token(parser, TOK_AND)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_equality(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
-    }
-    
-    return expr;
-}
+typedef enum {
+    EXPR_OP_BINARY,     /* operador binário */
+    EXPR_OP_UNARY,      /* operador unário prefixo */
+    EXPR_OP_GROUP,      /* '(' de agrupamento */
+    EXPR_OP_CALL        /* '(' de chamada de função */
+} ExprOpKind;
 
-ASTNode* parse_equality(Parser *parser) {
-    ASTNode *expr = parse_comparison(parser);
-    
-    while (match_token(parser, TOK_EQ) || match_token(parser, TOK_NEQ)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_comparison(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
-    }
-    
-    return expr;
-}
+struct ExprOp {
+    ExprOpKind kind;
+    int precedence;     /* 0 para marcadores de agrupamento/chamada */
+    Token token;
+    ASTNode *call;      /* nó AST_FUNCTION_CALL em construção */
+};
 
-ASTNode* parse_comparison(Parser *parser) {
-    ASTNode *expr = parse_term(parser);
-    
-    while (match_token(parser, TOK_GT) || match_token(parser, TOK_GE) ||
-           match_token(parser, TOK_LT) || match_token(parser, TOK_LE)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_term(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
-    }
-    
-    return expr;
+#define PREC_UNARY 7
+
+/* Precedência dos operadores binários; 0 indica que o token não é binário */
+static const unsigned char binary_precedence[TOK_ERROR + 1] = {
+    [TOK_OR]     = 1,
+    [TOK_AND]    = 2,
+    [TOK_EQ]     = 3, [TOK_NEQ] = 3,
+    [TOK_GT]     = 4, [TOK_GE]  = 4, [TOK_LT] = 4, [TOK_LE] = 4,
+    [TOK_MINUS]  = 5, [TOK_PLUS] = 5,
+    [TOK_SLASH]  = 6, [TOK_STAR] = 6, [TOK_MODULO] = 6, [TOK_CARET] = 6
+};
+
+static void expr_push_op(Parser *parser, ExprOpKind kind, int precedence,
+                         Token token, ASTNode *call) {
+    if (parser->expr_op_count >= parser->expr_op_capacity) {
+        int new_capacity = parser->expr_op_capacity == 0 ? 4 : parser->expr_op_capacity * 2;
+        parser->expr_ops = mm_realloc(parser->expr_ops,
+                                      new_capacity * sizeof(struct ExprOp));
+        parser->expr_op_capacity = new_capacity;
+    }
+    parser->expr_ops[parser->expr_op_count].kind = kind;
+    parser->expr_ops[parser->expr_op_count].precedence = precedence;
+    parser->expr_ops[parser->expr_op_count].token = token;
+    parser->expr_ops[parser->expr_op_count].call = call;
+    parser->expr_op_count++;
 }
 
-ASTNode* parse_term(Parser *parser) {
-    ASTNode *expr = parse_factor(parser);
-    
-    while (match_token(parser, TOK_MINUS) || match_token(parser, TOK_PLUS)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_factor(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
+static void expr_push_operand(Parser *parser, ASTNode *node) {
+    if (parser->expr_operand_count >= parser->expr_operand_capacity) {
+        int new_capacity = parser->expr_operand_capacity == 0 ? 4 : parser->expr_operand_capacity * 2;
+        parser->expr_operands = mm_realloc(parser->expr_operands,
+                                           new_capacity * sizeof(ASTNode*));
+        parser->expr_operand_capacity = new_capacity;
     }
-    
-    return expr;
+    parser->expr_operands[parser->expr_operand_count++] = node;
 }
 
-ASTNode* parse_factor(Parser *parser) {
-    ASTNode *expr = parse_unary(parser);
-    
-    while (match_token(parser, TOK_SLASH) || match_token(parser, TOK_STAR) ||
-           match_token(parser, TOK_MODULO) || match_token(parser, TOK_CARET)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_unary(parser);
-        
-        ASTNode *binary = ast_node_create(AST_BINARY_OP, operator);
-        ast_node_add_child(binary, expr);
-        ast_node_add_child(binary, right);
-        expr = binary;
-    }
-    
-    return expr;
+static ASTNode* expr_pop_operand(Parser *parser, int base) {
+    if (parser->expr_operand_count <= base) return NULL;
+    return parser->expr_operands[--parser->expr_operand_count];
 }
 
-ASTNode* parse_unary(Parser *parser) {
-    if (match_token(parser, TOK_MINUS) || match_token(parser, TOK_PLUS)) {
-        Token operator = parser->previous_token;
-        ASTNode *right = parse_unary(parser);
-        
-        ASTNode *unary = ast_node_create(AST_UNARY_OP, operator);
-        ast_node_add_child(unary, right);
-        return unary;
+/* Reduz os operadores do topo com precedência >= min_prec (marcadores param) */
+static void expr_reduce(Parser *parser, int op_base, int operand_base, int min_prec) {
+    while (parser->expr_op_count > op_base) {
+        struct ExprOp *op = &parser->expr_ops[parser->expr_op_count - 1];
+        if (op->precedence == 0 || op->precedence < min_prec) break;
+
+        if (op->kind == EXPR_OP_UNARY) {
+            ASTNode *operand = expr_pop_operand(parser, operand_base);
+            ASTNode *unary = ast_node_create(AST_UNARY_OP, op->token);
+            ast_node_add_child(unary, operand);
+            expr_push_operand(parser, expr_node(parser, unary));
+        } else {
+            ASTNode *right = expr_pop_operand(parser, operand_base);
+            ASTNode *left = expr_pop_operand(parser, operand_base);
+            ASTNode *binary = ast_node_create(AST_BINARY_OP, op->token);
+            ast_node_add_child(binary, left);
+            ast_node_add_child(binary, right);
+            expr_push_operand(parser, expr_node(parser, binary));
+        }
+        parser->expr_op_count--;
     }
-    
-    return parse_primary(parser);
 }
 
-ASTNode* parse_primary(Parser *parser) {
-    if (match_token(parser, TOK_INTEGER_LITERAL) ||
-        match_token(parser, TOK_DECIMAL_LITERAL) ||
-        match_token(parser, TOK_STRING_LITERAL)) {
-        return ast_node_create(AST_LITERAL, parser->previous_token);
-    }
+ASTNode* parse_expression(Parser *parser) {
+    int op_base = parser->expr_op_count;
+    int operand_base = parser->expr_operand_count;
+    int expect_operand = 1;
     
-    if (match_token(parser, TOK_IDENTIFIER)) {
-        ASTNode *id = ast_node_create(AST_IDENTIFIER, parser->previous_token);
+    for (;;) {
+        TokenType type = parser->current_token.type;
         
-        /* Verificar se é chamada de função */
-        if (match_token(parser, TOK_LPAREN)) {
-            ASTNode *call = ast_node_create(AST_FUNCTION_CALL, parser->previous_token);
-            ast_node_add_child(call, id);
+        if (expect_operand) {
+            if (type == TOK_MINUS || type == TOK_PLUS) {
+                advance_token(parser);
+                expr_push_op(parser, EXPR_OP_UNARY, PREC_UNARY, parser->previous_token, NULL);
+                continue;
+            }
+            
+            if (type == TOK_LPAREN) {
+                advance_token(parser);
+                expr_push_op(parser, EXPR_OP_GROUP, 0, parser->previous_token, NULL);
+                continue;
+            }
+            
+            if (type == TOK_INTEGER_LITERAL || type == TOK_DECIMAL_LITERAL ||
+                type == TOK_STRING_LITERAL) {
+                advance_token(parser);
+                expr_push_operand(parser, expr_node(parser, ast_node_create(AST_LITERAL,
+                                                                            parser->previous_token)));
+                expect_operand = 0;
+                continue;
+            }
             
-            /* Parse argumentos */
-            if (!check_token(parser, TOK_RPAREN)) {
-                do {
-                    ASTNode *arg = parse_expression(parser);
-                    if (arg) {
-                        ast_node_add_child(call, arg);
+            if (type == TOK_IDENTIFIER) {
+                advance_token(parser);
+                ASTNode *id = ast_node_create(AST_IDENTIFIER, parser->previous_token);
+                
+                /* Verificar se é chamada de função */
+                if (match_token(parser, TOK_LPAREN)) {
+                    ASTNode *call = ast_node_create(AST_FUNCTION_CALL, parser->previous_token);
+                    ast_node_add_child(call, id);
+                    
+                    if (match_token(parser, TOK_RPAREN)) {
+                        expr_push_operand(parser, call);
+                        expect_operand = 0;
+                    } else {
+                        /* Argumentos são analisados na própria pilha */
+                        expr_push_op(parser, EXPR_OP_CALL, 0, parser->previous_token, call);
                     }
-                } while (match_token(parser, TOK_COMMA));
+                    continue;
+                }
+                
+                expr_push_operand(parser, expr_node(parser, id));
+                expect_operand = 0;
+                continue;
+            }
+            
+            parser_error(parser, "Esperado expressão");
+            expr_push_operand(parser, NULL);
+            expect_operand = 0;
+            continue;
+        }
+        
+        if (binary_precedence[type] > 0) {
+            expr_reduce(parser, op_base, operand_base, binary_precedence[type]);
+            advance_token(parser);
+            expr_push_op(parser, EXPR_OP_BINARY, binary_precedence[type],
+                         parser->previous_token, NULL);
+            expect_operand = 1;
+            continue;
+        }
+        
+        /* Fim de subexpressão: fecha o agrupamento ou chamada mais interna */
+        expr_reduce(parser, op_base, operand_base, 1);
+        if (parser->expr_op_count == op_base) break;
+        
+        {
+            struct ExprOp *group = &parser->expr_ops[parser->expr_op_count - 1];
+            
+            if (group->kind == EXPR_OP_GROUP) {
+                if (!match_token(parser, TOK_RPAREN)) {
+                    parser_error(parser, "Esperado ')' após expressão");
+                }
+                parser->expr_op_count--;
+                continue;
             }
             
+            /* EXPR_OP_CALL: o operando do topo é o argumento concluído */
+            ast_node_add_child(group->call, expr_pop_operand(parser, operand_base));
+            if (match_token(parser, TOK_COMMA)) {
+                expect_operand = 1;
+                continue;
+            }
             if (!match_token(parser, TOK_RPAREN)) {
                 parser_error(parser, "Esperado ')' após argumentos da função");
             }
-            
-            return call;
+            parser->expr_op_count--;
+            expr_push_operand(parser, group->call);
         }
-        
-        return id;
     }
     
-    if (match_token(parser, TOK_LPAREN)) {
-        ASTNode *expr = parse_expression(parser);
-        if (!match_token(parser, TOK_RPAREN)) {
-            parser_error(parser, "Esperado ')' após expressão");
-        }
-        return expr;
+    /* A raiz fica com o token desta ocorrência (linhas dos alertas) */
+    if (parser->hashcons) {
+        return hashcons_unshare(parser->hashcons, expr_pop_operand(parser, operand_base));
     }
-    
-    parser_error(parser, "Esperado expressão");
-    return NULL;
+    return expr_pop_operand(parser, operand_base);
 }
 
-ASTNode* parse_if_statement(Parser *parser) {
-    ASTNode *if_stmt = ast_node_create(AST_IF_STMT, parser->current_token);
+/* Cabeçalhos de 'se', 'enquanto' e 'para', até o ')' antes do comando
+ * interno; retornam 0 (com o erro) se ele não vem */
+static int parse_if_header(Parser *parser, ASTNode *if_stmt) {
     advance_token(parser); /* consume 'se' */
     
     if (!match_token(parser, TOK_LPAREN)) {
         parser_error(parser, "Esperado '(' após 'se'");
-        return if_stmt;
+        return 0;
     }
     
     ASTNode *condition = parse_expression(parser);
@@ -596,31 +995,17 @@ ASTNode* parse_if_statement(Parser *parser) {
     
     if (!match_token(parser, TOK_RPAREN)) {
         parser_error(parser, "Esperado ')' após condição do 'se'");
-        return if_stmt;
-    }
-    
-    ASTNode *then_stmt = parse_statement(parser);
-    if (then_stmt) {
-        ast_node_add_child(if_stmt, then_stmt);
+        return 0;
     }
-    
-    if (match_token(parser, TOK_KW_SENAO)) {
-        ASTNode *else_stmt = parse_statement(parser);
-        if (else_stmt) {
-            ast_node_add_child(if_stmt, else_stmt);
-        }
-    }
-    
-    return if_stmt;
+    return 1;
 }
 
-ASTNode* parse_while_statement(Parser *parser) {
-    ASTNode *while_stmt = ast_node_create(AST_WHILE_STMT, parser->current_token);
+static int parse_while_header(Parser *parser, ASTNode *while_stmt) {
     advance_token(parser); /* consume 'enquanto' */
     
     if (!match_token(parser, TOK_LPAREN)) {
         parser_error(parser, "Esperado '(' após 'enquanto'");
-        return while_stmt;
+        return 0;
     }
     
     ASTNode *condition = parse_expression(parser);
@@ -630,24 +1015,17 @@ ASTNode* parse_while_statement(Parser *parser) {
     
     if (!match_token(parser, TOK_RPAREN)) {
         parser_error(parser, "Esperado ')' após condição do 'enquanto'");
-        return while_stmt;
-    }
-    
-    ASTNode *body = parse_statement(parser);
-    if (body) {
-        ast_node_add_child(while_stmt, body);
+        return 0;
     }
-    
-    return while_stmt;
+    return 1;
 }
 
-ASTNode* parse_for_statement(Parser *parser) {
-    ASTNode *for_stmt = ast_node_create(AST_FOR_STMT, parser->current_token);
+static int parse_for_header(Parser *parser, ASTNode *for_stmt) {
     advance_token(parser); /* consume 'para' */
     
     if (!match_token(parser, TOK_LPAREN)) {
         parser_error(parser, "Esperado '(' após 'para'");
-        return for_stmt;
+        return 0;
     }
     
     /* Inicialização */
@@ -658,7 +1036,7 @@ ASTNode* parse_for_statement(Parser *parser) {
     
     if (!match_token(parser, TOK_SEMICOLON)) {
         parser_error(parser, "Esperado ';' após inicialização do 'para'");
-        return for_stmt;
+        return 0;
     }
     
     /* Condição */
@@ -669,7 +1047,7 @@ ASTNode* parse_for_statement(Parser *parser) {
     
     if (!match_token(parser, TOK_SEMICOLON)) {
         parser_error(parser, "Esperado ';' após condição do 'para'");
-        return for_stmt;
+        return 0;
     }
     
     /* Incremento */
@@ -680,15 +1058,33 @@ ASTNode* parse_for_statement(Parser *parser) {
     
     if (!match_token(parser, TOK_RPAREN)) {
         parser_error(parser, "Esperado ')' após incremento do 'para'");
-        return for_stmt;
+        return 0;
     }
-    
-    ASTNode *body = parse_statement(parser);
-    if (body) {
-        ast_node_add_child(for_stmt, body);
-    }
-    
-    return for_stmt;
+    return 1;
+}
+
+ASTNode* parse_if_statement(Parser *parser) {
+    ASTNode *if_stmt = ast_node_create(AST_IF_STMT, parser->current_token);
+    int base = parser->stmt_frame_count;
+    if (!parse_if_header(parser, if_stmt)) return if_stmt;
+    stmt_push_frame(parser, STMT_FRAME_THEN, if_stmt);
+    return parse_nested(parser, base, 1);
+}
+
+ASTNode* parse_while_statement(Parser *parser) {
+    ASTNode *while_stmt = ast_node_create(AST_WHILE_STMT, parser->current_token);
+    int base = parser->stmt_frame_count;
+    if (!parse_while_header(parser, while_stmt)) return while_stmt;
+    stmt_push_frame(parser, STMT_FRAME_BODY, while_stmt);
+    return parse_nested(parser, base, 1);
+}
+
+ASTNode* parse_for_statement(Parser *parser) {
+    ASTNode *for_stmt = ast_node_create(AST_FOR_STMT, parser->current_token);
+    int base = parser->stmt_frame_count;
+    if (!parse_for_header(parser, for_stmt)) return for_stmt;
+    stmt_push_frame(parser, STMT_FRAME_BODY, for_stmt);
+    return parse_nested(parser, base, 1);
 }
 
 ASTNode* parse_read_statement(Parser *parser) {
@@ -754,24 +1150,10 @@ ASTNode* parse_write_statement(Parser *parser) {
 
 ASTNode* parse_block(Parser *parser) {
     ASTNode *block = ast_node_create(AST_BLOCK, parser->current_token);
+    int base = parser->stmt_frame_count;
     advance_token(parser); /* consume '{' */
-    
-    while (!check_token(parser, TOK_RBRACE) && !check_token(parser, TOK_EOF)) {
-        ASTNode *stmt = parse_statement(parser);
-        if (stmt) {
-            ast_node_add_child(block, stmt);
-        }
-        
-        if (parser->panic_mode) {
-            synchronize(parser);
-        }
-    }
-    
-    if (!match_token(parser, TOK_RBRACE)) {
-        parser_error(parser, "Esperado '}' para fechar bloco");
-    }
-    
-    return block;
+    stmt_push_frame(parser, STMT_FRAME_BLOCK, block);
+    return parse_nested(parser, base, 0);
 }
 
 ASTNode* parse_function_definition(Parser *parser) {
@@ -816,7 +1198,8 @@ ASTNode* parse_function_definition(Parser *parser) {
     }
     
     /* Corpo da função */
-    ASTNode *body = parse_block(parser);
+    ASTNode *body = lazy_source && check_token(parser, TOK_LBRACE)
+                    ? skip_block(parser) : parse_block(parser);
     if (body) {
         ast_node_add_child(func_def, body);
     }
@@ -824,56 +1207,187 @@ ASTNode* parse_function_definition(Parser *parser) {
     return func_def;
 }
 
+/* Corpo adiado: avança até a '}' correspondente sem montar nós; lexemas
+ * lidos do scanner são liberados na hora */
+static ASTNode* skip_block(Parser *parser) {
+    ASTNode *block = ast_node_create(AST_BLOCK, parser->current_token);
+    int depth = 0;
+    
+    do {
+        if (check_token(parser, TOK_LBRACE)) depth++;
+        else if (check_token(parser, TOK_RBRACE)) depth--;
+        if (!parser->tokens && token_owns_lexeme(parser->current_token.type)) {
+            mm_free(parser->current_token.lexeme);
+            parser->current_token.lexeme = "";
+        }
+        advance_token(parser);
+    } while (depth > 0 && !check_token(parser, TOK_EOF));
+    
+    if (depth > 0) {
+        parser_error(parser, "Esperado '}' para fechar bloco");
+        return block;
+    }
+    block->lazy = 1;
+    block->token.length = parser->previous_token.offset + parser->previous_token.length -
+                          block->token.offset;
+    return block;
+}
+
+int ast_expand_body(ASTNode *block) {
+    Scanner source;
+    Parser *parser;
+    ASTNode *full;
+    int ok;
+    
+    if (!block || !block->lazy) return 1;
+    scanner_init_range(&source, lazy_source, (size_t)block->token.offset,
+                       (size_t)(block->token.offset + block->token.length), block->token.line);
+    parser = parser_init_scanner(&source);
+    full = parse_block(parser);
+    ok = !parser->had_error;
+    if (!ok) lazy_errors++;
+    parser_free(parser);
+    
+    /* O BLOCK adiado (já referenciado pela função) recebe os filhos */
+    block->token = full->token;
+    block->children = full->children;
+    block->child_count = full->child_count;
+    block->child_capacity = full->child_capacity;
+    block->lazy = 0;
+    full->children = NULL;
+    full->child_count = 0;
+    free_ast(full);
+    return ok;
+}
+
 /* ========== Funções de validação sintática ========== */
 
-int validate_declaration_sequence(ASTNode *program) {
-    if (!program || program->type != AST_PROGRAM) return 0;
-    
-    int found_non_declaration = 0;
-    int i;
-    
+/*
+ * Cada regra é um gancho chamado para cada item de nível superior, na mesma
+ * passada; a regra para de ser consultada depois da primeira violação.
+ */
+typedef struct {
+    int found_non_declaration;
+    ASTNode *program;
+    const char *source;             /* texto da AST (ast_declarator_arg) */
+    size_t len;
+    ValidationAlerts alerts;
+} ValidationState;
+
+typedef struct {
+    int rule;                       /* bit VALIDATE_* */
+    int (*check_item)(ValidationState *state, ASTNode *item);
+    int (*finish)(ValidationState *state);  /* após o último item; pode ser NULL */
+} ItemValidator;
+
+static unsigned long validation_walks = 0;
+
+static int check_declaration_sequence(ValidationState *state, ASTNode *item) {
+    if (item->type != AST_DECLARATION) {
+        state->found_non_declaration = 1;
+        return 1;
+    }
+    if (state->found_non_declaration) {
+        fprintf(stderr, "Erro: declaração após comando não-declarativo na linha %d\n",
+               item->token.line);
+        return 0;
+    }
+    return 1;
+}
+
+/* Fluxo de dados de um corpo: os achados são alertas, que não reprovam o
+ * programa (dataflow.h) */
+static void check_body_usage(ValidationState *state, ASTNode *body) {
+    VarUsageStats stats = {0, 0, 0, 0};
+    Cfg *g = cfg_build(body, state->source, state->len);
+    validation_walks++;
+    dataflow_check_usage(g, &stats);
+    cfg_free(g);
+    state->alerts.variable_usage += stats.uninitialized + stats.maybe +
+                                    stats.dead_stores + stats.unread;
+}
+
+static int check_variable_usage(ValidationState *state, ASTNode *item) {
+    ASTNode *body;
+    if (!state->source || item->type != AST_FUNCTION_DEF || item->child_count == 0) return 1;
+    /* Corpo adiado (--lazy): verificado só se for expandido */
+    body = item->children[item->child_count - 1];
+    if (body && body->lazy) return 1;
+    check_body_usage(state, item);
+    return 1;
+}
+
+/* Programa 'principal() { ... }': um único corpo, os itens */
+static int check_principal_usage(ValidationState *state) {
+    if (state->source && state->program->token.type == TOK_KW_PRINCIPAL) {
+        check_body_usage(state, state->program);
+    }
+    return 1;
+}
+
+/* O espaçamento não depende dos itens: a passada da listagem de tokens já
+ * alimentou o verificador (spacing.h) */
+static int check_spacing(ValidationState *state) {
+    unsigned long violations = spacing_report(spacing_checker());
+    if (violations > 0 && spacing_strict()) return 0;
+    state->alerts.spacing = violations;
+    return 1;
+}
+
+static const ItemValidator item_validators[] = {
+    {VALIDATE_DECLARATION_SEQUENCE, check_declaration_sequence, NULL},
+    {VALIDATE_SPACING,              NULL,                       check_spacing},
+    {VALIDATE_VARIABLE_USAGE,       check_variable_usage,       check_principal_usage}
+};
+
+#define ITEM_VALIDATOR_COUNT ((int)(sizeof(item_validators) / sizeof(item_validators[0])))
+
+int validate_program(ASTNode *program, const char *source, size_t len, ValidationAlerts *alerts) {
+    ValidationState state;
+    int failed = 0;
+    int i, j;
+    
+    /* Sem programa, só a sequência de declarações falha */
+    if (!program || program->type != AST_PROGRAM) return VALIDATE_DECLARATION_SEQUENCE;
+    
+    state.found_non_declaration = 0;
+    state.program = program;
+    state.source = source;
+    state.len = len;
+    state.alerts.spacing = 0;
+    state.alerts.variable_usage = 0;
+    validation_walks++;
     for (i = 0; i < program->child_count; i++) {
-        ASTNode *child = program->children[i];
-        
-        if (child->type == AST_DECLARATION) {
-            if (found_non_declaration) {
-                fprintf(stderr, "Erro: declaração após comando não-declarativo na linha %d\n",
-                       child->token.line);
-                return 0;
+        for (j = 0; j < ITEM_VALIDATOR_COUNT; j++) {
+            const ItemValidator *v = &item_validators[j];
+            if (v->check_item && !(failed & v->rule) &&
+                !v->check_item(&state, program->children[i])) {
+                failed |= v->rule;
             }
-        } else {
-            found_non_declaration = 1;
         }
     }
-    
-    return 1;
+    for (j = 0; j < ITEM_VALIDATOR_COUNT; j++) {
+        const ItemValidator *v = &item_validators[j];
+        if (v->finish && !(failed & v->rule) && !v->finish(&state)) failed |= v->rule;
+    }
+    if (alerts) *alerts = state.alerts;
+    return failed;
+}
+
+unsigned long validate_walk_count(void) {
+    return validation_walks;
+}
+
+int validate_declaration_sequence(ASTNode *program) {
+    return !(validate_program(program, NULL, 0, NULL) & VALIDATE_DECLARATION_SEQUENCE);
 }
 
 int validate_spacing_rules(ASTNode *program) {
-    if (!program || program->type != AST_PROGRAM) return 1;
-    
-    /* Verificação básica de espaçamento */
-    /* Esta função pode ser expandida para verificar regras específicas */
-    
-    /* Por exemplo:
-     * - Verificar se há espaços entre operadores
-     * - Verificar espaçamento em declarações
-     * - Verificar espaçamento em estruturas de controle
-     * - Verificar indentação consistente
-     */
-    
-    /* Por enquanto, retorna sucesso */
-    /* Em uma implementação completa, seria necessário analisar o código fonte original */
-    /* para verificar espaços, não apenas a AST */
-    
-    return 1;
+    return !(validate_program(program, NULL, 0, NULL) & VALIDATE_SPACING);
 }
 
-int validate_variable_usage(ASTNode *program) {
-    (void)program; /* Evitar warning de parâmetro não utilizado */
-    /* Implementação para verificar se variáveis foram declaradas antes de usar */
-    /* Pode ser expandida com tabela de símbolos */
-    return 1;
+int validate_variable_usage(ASTNode *program, const char *source, size_t len) {
+    return !(validate_program(program, source, len, NULL) & VALIDATE_VARIABLE_USAGE);
 }
 
 
@@ -0,0 +1,180 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "push_parser.h"
+#include "error.h"
+#include "lexer.h"
+#include "ll1.h"
+#include "memmgr.h"
+
+struct PushParser {
+    Parser *parser;                 /* tokens atual/anterior e erros */
+    LL1Parser *ll1;                 /* criado com o primeiro token */
+    PushItemHandler on_item;
+    void *data;
+
+    /* Bytes recebidos e ainda não transformados em token: o fim do pedaço
+     * anterior (um token possivelmente cortado) seguido do pedaço atual */
+    char *pending;
+    size_t pending_len;
+    size_t pending_capacity;
+    size_t base;                    /* deslocamento de pending[0] na entrada */
+    int line;                       /* linha de pending[0] */
+    size_t cut;                     /* início do token cortado, após os espaços */
+
+    Scanner sc;                     /* fora da pilha: lido depois do longjmp */
+    size_t token_start;             /* onde começa o token em análise */
+    int token_line;
+    int failed;
+};
+
+/* Fonte de tokens do Parser: o motor recebe os tokens por ll1_feed */
+static const Token no_tokens[] = {{TOK_EOF, 0, "", 0, 0}};
+
+PushParser* parser_push_create(PushItemHandler on_item, void *data) {
+    PushParser *ctx = mm_malloc(sizeof(PushParser));
+    if (!ctx) {
+        fprintf(stderr, "Erro: não foi possível alocar memória para parser\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(ctx, 0, sizeof(PushParser));
+    ctx->parser = parser_init_tokens(no_tokens);
+    ctx->on_item = on_item;
+    ctx->data = data;
+    ctx->line = 1;
+    return ctx;
+}
+
+void parser_push_free(PushParser *ctx) {
+    if (ctx) {
+        ll1_free(ctx->ll1);
+        parser_free(ctx->parser);
+        if (ctx->pending) mm_free(ctx->pending);
+        mm_free(ctx);
+    }
+}
+
+static int deliver(PushParser *ctx, Token tok) {
+    if (!ctx->ll1) {
+        /* O nó AST_PROGRAM leva o primeiro token, como em parse_program */
+        ctx->parser->current_token = tok;
+        ctx->ll1 = ll1_create(ctx->parser, ctx->on_item, ctx->data);
+    }
+    if (!ll1_feed(ctx->ll1, tok)) ctx->failed = 1;
+    return !ctx->failed;
+}
+
+/* Descarta de pending tudo antes de ctx->token_start */
+static void keep_from_token_start(PushParser *ctx) {
+    size_t start = ctx->token_start;
+    memmove(ctx->pending, ctx->pending + start, ctx->pending_len - start);
+    ctx->pending_len -= start;
+    ctx->base += start;
+    ctx->line = ctx->token_line;
+    ctx->cut = 0;
+    while (ctx->cut < ctx->pending_len && isspace((unsigned char)ctx->pending[ctx->cut])) {
+        ctx->cut++;
+    }
+}
+
+/*
+ * Os bytes só estendem o token cortado: letras e dígitos depois de um nome
+ * ('!a', '__f' ou palavra), dígitos depois de um número. Eles não fecham o
+ * token nem mudam um erro, e a nova análise fica para o primeiro byte que
+ * pode fechá-lo; sem isso, um token longo em pedaços pequenos seria relido
+ * a cada pedaço (quadrático no tamanho do token).
+ */
+static int extends_cut_token(const PushParser *ctx, const char *bytes, size_t len) {
+    const char *token = ctx->pending + ctx->cut;
+    size_t token_len = ctx->pending_len - ctx->cut, i;
+    int number;
+
+    if (token_len == 0) return 0;
+    if (isdigit((unsigned char)token[0])) {
+        number = 1;
+    } else if ((token[0] == '!' && token_len >= 2) || (token[0] == '_' && token_len >= 3) ||
+               isalpha((unsigned char)token[0])) {
+        number = 0;
+    } else {
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (number ? !isdigit(c) : !isalnum(c)) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Entrega ao motor os tokens de pending. Sem final, um token que chega ao fim
+ * dos bytes pode continuar no próximo pedaço (o léxico olhou além dele e viu
+ * o fim): ele fica em pending e é analisado de novo. O mesmo vale para um
+ * erro léxico no fim dos bytes ('!' sem a letra, '12.' sem os decimais).
+ */
+static int lex_pending(PushParser *ctx, int final) {
+    jmp_buf lex_env;
+    Token tok;
+
+    scanner_init_buffer(&ctx->sc, ctx->pending, ctx->pending_len, ctx->line);
+    if (setjmp(lex_env)) {
+        lex_error_set_recovery(NULL);
+        lex_error_set_quiet(0);
+        if (final || ctx->sc.pos < ctx->pending_len) {
+            fprintf(stderr, "%s\n", lex_error_message());
+            ctx->failed = 1;
+            return 0;
+        }
+        keep_from_token_start(ctx);
+        return 1;
+    }
+    lex_error_set_recovery(&lex_env);
+    lex_error_set_quiet(1);
+
+    for (;;) {
+        ctx->token_start = ctx->sc.pos;
+        ctx->token_line = ctx->sc.line;
+        tok = scanner_next_token(&ctx->sc);
+        if (!final && (tok.type == TOK_EOF || ctx->sc.pos >= ctx->pending_len)) {
+            if (tok.type == TOK_EOF) {
+                /* Só espaços até o fim: não precisam ser guardados */
+                ctx->token_start = ctx->sc.pos;
+                ctx->token_line = ctx->sc.line;
+            } else if (token_owns_lexeme(tok.type)) {
+                mm_free(tok.lexeme);
+            }
+            break;
+        }
+        tok.offset += (int)ctx->base;
+        if (!deliver(ctx, tok) || tok.type == TOK_EOF || ll1_accepted(ctx->ll1)) break;
+    }
+    lex_error_set_recovery(NULL);
+    lex_error_set_quiet(0);
+    if (!ctx->failed) keep_from_token_start(ctx);
+    return !ctx->failed;
+}
+
+int parser_feed(PushParser *ctx, const char *bytes, size_t len) {
+    int extends;
+    if (ctx->failed) return 0;
+    /* Depois de 'principal() {...}' o resto da entrada é ignorado */
+    if (ctx->ll1 && ll1_accepted(ctx->ll1)) return 1;
+    if (ctx->pending_len + len > ctx->pending_capacity) {
+        while (ctx->pending_len + len > ctx->pending_capacity) {
+            ctx->pending_capacity = ctx->pending_capacity == 0 ? 256 : ctx->pending_capacity * 2;
+        }
+        ctx->pending = mm_realloc(ctx->pending, ctx->pending_capacity);
+    }
+    extends = extends_cut_token(ctx, bytes, len);
+    memcpy(ctx->pending + ctx->pending_len, bytes, len);
+    ctx->pending_len += len;
+    return extends ? 1 : lex_pending(ctx, 0);
+}
+
+int parser_finish(PushParser *ctx) {
+    if (ctx->failed) return 0;
+    if (!ctx->ll1 || !ll1_accepted(ctx->ll1)) {
+        if (!lex_pending(ctx, 1)) return 0;
+    }
+    return ll1_accepted(ctx->ll1);
+}
@@ -1,5 +1,7 @@
 #include "sema_report.h"
+#include "memmgr.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 void sema_report_error(const char *msg) {
     fprintf(stderr, "\033[31mErro semântico: %s\033[0m\n", msg);
@@ -9,3 +11,26 @@ void sema_report_alert(const char *msg, int line) {
     fprintf(stderr, "\033[33mAlerta semântico (linha %d): %s\033[0m\n", line, msg);
 }
 
+void sema_alerts_add(SemaAlerts *alerts, const char *msg, int line) {
+    if (alerts->count >= alerts->capacity) {
+        alerts->capacity = alerts->capacity ? alerts->capacity * 2 : 8;
+        alerts->items = mm_realloc(alerts->items, alerts->capacity * sizeof(SemaAlert));
+        if (!alerts->items) {
+            fprintf(stderr, "Erro: memória insuficiente para os alertas semânticos\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    alerts->items[alerts->count].msg = msg;
+    alerts->items[alerts->count].line = line;
+    alerts->count++;
+}
+
+void sema_alerts_flush(SemaAlerts *alerts) {
+    int i;
+    for (i = 0; i < alerts->count; i++) {
+        sema_report_alert(alerts->items[i].msg, alerts->items[i].line);
+    }
+    if (alerts->items) mm_free(alerts->items);
+    alerts->items = NULL;
+    alerts->count = alerts->capacity = 0;
+}
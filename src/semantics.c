@@ -1,54 +1,164 @@
 #include "semantics.h"
 #include "memmgr.h"
 #include "sema_report.h"
+#include "ast_walk.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
-/* Cria um tipo básico com metadados zerados */
-static Type make_type(TypeKind kind) {
-    Type t;
-    t.kind = kind;
-    if (kind == TY_DEC) {
-        t.info.dec.a = 0;
-        t.info.dec.b = 0;
-    } else if (kind == TY_TXT) {
-        t.info.txt.n = 0;
-    } else {
-        memset(&t.info, 0, sizeof(t.info));
+/* Medições das análises já destruídas (sema_destroy soma as do contexto) */
+static unsigned long walk_count = 0;
+static unsigned long types_resolved = 0;
+static unsigned long types_reused = 0;
+
+/* Todo percurso da análise passa por aqui, para a contagem de sema_walk_count */
+static void sema_walk(SemaContext *sc, ASTNode *node, const AstVisitor *visitor) {
+    sc->walks++;
+    ast_walk(node, visitor);
+}
+
+unsigned long sema_walk_count(void) {
+    return walk_count;
+}
+
+/* Alertas vão para o buffer do contexto, se houver (análise paralela) */
+static void sema_alert(SemaContext *sc, const char *msg, int line) {
+    if (sc->alerts) sema_alerts_add(sc->alerts, msg, line);
+    else sema_report_alert(msg, line);
+}
+
+/* Índice de símbolos: a definição recém-inserida e os usos resolvidos */
+static void index_def(SemaContext *sc, const Token *id) {
+    Symbol *sym;
+    if (!sc->index) return;
+    sym = symtab_lookup(sc->symtab, id->lexeme);
+    sym->index_id = (unsigned int)symindex_add_def(sc->index, sym, id) + 1;
+}
+
+static void index_ref(SemaContext *sc, const Symbol *sym, const Token *id) {
+    if (sc->index && sym && sym->index_id) symindex_add_ref(sc->index, (int)sym->index_id - 1, id);
+}
+
+static AstWalkAction index_call_pre(AstWalker *w, ASTNode *node, void *data) {
+    SemaContext *sc = (SemaContext*)data;
+    (void)w;
+    symindex_extend(sc->index, &node->token);
+    if (node->type == AST_IDENTIFIER && node->token.lexeme) {
+        index_ref(sc, symtab_lookup(sc->symtab, node->token.lexeme), &node->token);
     }
-    return t;
+    return AST_WALK_CONTINUE;
 }
 
-/* Infere o tipo de uma expressão e anota no nó */
-static Type resolve_expr_type(SemaContext *sc, ASTNode *node) {
-    Type t = make_type(TY_INT);
-    if (!node) return t;
+/* Nomes dentro de uma chamada em expressão, que a tipagem não visita */
+static void index_call(SemaContext *sc, ASTNode *call) {
+    AstVisitor visitor = {index_call_pre, NULL, NULL, 0, 0};
+    visitor.data = sc;
+    sema_walk(sc, call, &visitor);
+}
+
+/* Tipo declarado pela palavra-chave de uma declaração (metadados zerados) */
+static TypeId declared_type(TokenType keyword) {
+    switch (keyword) {
+        case TOK_KW_DECIMAL: return TYPE_DEC;
+        case TOK_KW_TEXTO:   return TYPE_TXT;
+        case TOK_KW_INTEIRO: default: return TYPE_INT;
+    }
+}
+
+/* Nós cujo tipo não depende dos filhos (ex.: chamadas): dentro de uma
+   expressão, os filhos não são visitados e o nó recebe o tipo padrão */
+#define RESOLVE_PRUNE (~(AST_WALK_MASK(AST_LITERAL) | AST_WALK_MASK(AST_IDENTIFIER) | \
+                         AST_WALK_MASK(AST_BINARY_OP) | AST_WALK_MASK(AST_UNARY_OP) | \
+                         AST_WALK_MASK(AST_EXPRESSION)))
+
+/* Tipo já anotado no filho i, ou inteiro se ausente */
+static TypeId child_type(ASTNode *node, int i) {
+    if (i < node->child_count && node->children[i]) return node->children[i]->inferred_type;
+    return TYPE_INT;
+}
+
+/*
+ * Versão dos escopos: muda a cada análise criada e a cada mudança que a
+ * análise faz na tabela de símbolos (declaração, entrada e saída de escopo).
+ * Um nó anotado na versão atual já tem o tipo certo, pois nenhum
+ * identificador dentro dele passaria a outro símbolo; a subárvore não é
+ * tipada de novo. As versões vêm de um contador único, para que as de
+ * análises diferentes (e de threads diferentes) nunca coincidam; 0 marca
+ * um nó nunca tipado.
+ */
+static unsigned int last_version = 0;
+static pthread_mutex_t version_lock = PTHREAD_MUTEX_INITIALIZER;
+static int version_threaded = 0;
+
+static void scope_changed(SemaContext *sc) {
+    if (version_threaded) pthread_mutex_lock(&version_lock);
+    if (++last_version == 0) last_version = 1;
+    sc->scope_version = last_version;
+    if (version_threaded) pthread_mutex_unlock(&version_lock);
+}
+
+void sema_type_stats(unsigned long *resolved, unsigned long *reused) {
+    *resolved = types_resolved;
+    *reused = types_reused;
+}
+
+/* Ganchos de inferência de tipos do percurso de análise: o tipo de cada nó
+   de uma expressão é inferido em pós-ordem, com os filhos já anotados */
+/* Subárvores compartilhadas (hashcons.h) são inferidas na primeira visita */
+static AstWalkAction resolve_pre(AstWalker *w, ASTNode *node, void *data) {
+    SemaContext *sc = (SemaContext*)data;
+    (void)w;
+    if (node->typed_version == sc->scope_version) {
+        sc->reused++;
+        return AST_WALK_SKIP;
+    }
+    return AST_WALK_CONTINUE;
+}
+
+static void resolve_post(AstWalker *w, ASTNode *node, void *data) {
+    SemaContext *sc = (SemaContext*)data;
+    TypeId t = TYPE_INT;
+    (void)w;
+
+    /* Já anotado: resolve_pre não desceu */
+    if (node->typed_version == sc->scope_version) return;
+    node->typed_version = sc->scope_version;
+    sc->typed++;
 
     switch (node->type) {
         case AST_LITERAL:
             switch (node->token.type) {
                 case TOK_INTEGER_LITERAL:
-                    t = make_type(TY_INT);
+                    t = TYPE_INT;
                     break;
                 case TOK_DECIMAL_LITERAL:
-                    t = make_type(TY_DEC);
                     if (node->token.lexeme) {
                         const char *dot = strchr(node->token.lexeme, '.');
+                        Type lit;
+                        lit.kind = TY_DEC;
                         if (dot) {
-                            t.info.dec.a = (int)(dot - node->token.lexeme);
-                            t.info.dec.b = (int)strlen(dot + 1);
+                            lit.info.dec.a = (int)(dot - node->token.lexeme);
+                            lit.info.dec.b = (int)strlen(dot + 1);
                         } else {
-                            t.info.dec.a = (int)strlen(node->token.lexeme);
-                            t.info.dec.b = 0;
+                            lit.info.dec.a = (int)strlen(node->token.lexeme);
+                            lit.info.dec.b = 0;
                         }
+                        t = type_intern(&lit);
+                    } else {
+                        t = TYPE_DEC;
                     }
                     break;
                 case TOK_STRING_LITERAL:
-                    t = make_type(TY_TXT);
                     if (node->token.lexeme) {
                         size_t len = strlen(node->token.lexeme);
+                        Type lit;
                         if (len >= 2) len -= 2; /* remove aspas */
-                        t.info.txt.n = len;
+                        lit.kind = TY_TXT;
+                        lit.info.txt.n = len;
+                        t = type_intern(&lit);
+                    } else {
+                        t = TYPE_TXT;
                     }
                     break;
                 default:
@@ -58,13 +168,19 @@ static Type resolve_expr_type(SemaContext *sc, ASTNode *node) {
 
         case AST_IDENTIFIER: {
             Symbol *sym = symtab_lookup(sc->symtab, node->token.lexeme);
-            if (sym && sym->type) t = *sym->type;
+            if (sym) t = sym->type;
+            index_ref(sc, sym, &node->token);
             break;
         }
 
+        case AST_FUNCTION_CALL:
+            /* Os filhos não são tipados, mas os seus nomes vão para o índice */
+            if (sc->index) index_call(sc, node);
+            break;
+
         case AST_BINARY_OP: {
-            Type left = resolve_expr_type(sc, node->children[0]);
-            Type right = resolve_expr_type(sc, node->children[1]);
+            TypeKind left = type_kind(child_type(node, 0));
+            TypeKind right = type_kind(child_type(node, 1));
             switch (node->token.type) {
                 case TOK_PLUS:
                 case TOK_MINUS:
@@ -72,10 +188,7 @@ static Type resolve_expr_type(SemaContext *sc, ASTNode *node) {
                 case TOK_SLASH:
                 case TOK_MODULO:
                 case TOK_CARET:
-                    if (left.kind == TY_DEC || right.kind == TY_DEC)
-                        t = make_type(TY_DEC);
-                    else
-                        t = make_type(TY_INT);
+                    t = left == TY_DEC || right == TY_DEC ? TYPE_DEC : TYPE_INT;
                     break;
                 case TOK_EQ:
                 case TOK_NEQ:
@@ -83,31 +196,26 @@ static Type resolve_expr_type(SemaContext *sc, ASTNode *node) {
                 case TOK_GT:
                 case TOK_LE:
                 case TOK_GE:
-                    if (left.kind != right.kind ||
-                        (left.kind != TY_INT && left.kind != TY_DEC)) {
-                        sema_report_alert("comparação com tipos incompatíveis", node->token.line);
+                    if (left != right || (left != TY_INT && left != TY_DEC)) {
+                        sema_alert(sc, "comparação com tipos incompatíveis", node->token.line);
                     }
-                    t = make_type(TY_BOOL);
+                    t = TYPE_BOOL;
                     break;
                 case TOK_AND:
                 case TOK_OR:
-                    t = make_type(TY_BOOL);
+                    t = TYPE_BOOL;
                     break;
                 default:
-                    t = make_type(TY_INT);
+                    t = TYPE_INT;
                     break;
             }
             break;
         }
 
         case AST_UNARY_OP:
-            if (node->child_count > 0)
-                t = resolve_expr_type(sc, node->children[0]);
-            break;
-
         case AST_EXPRESSION:
             if (node->child_count > 0)
-                t = resolve_expr_type(sc, node->children[0]);
+                t = child_type(node, 0);
             break;
 
         default:
@@ -115,254 +223,373 @@ static Type resolve_expr_type(SemaContext *sc, ASTNode *node) {
     }
 
     node->inferred_type = t;
-    return t;
 }
 
-/* Analisa os nós da AST e resolve tipos */
-static void analyze_node(SemaContext *sc, ASTNode *node, ASTNodeType parent) {
-    if (!node) return;
+/* Insere as variáveis de uma declaração; o tipo vem do nó de declaração */
+static void declare_variable(SemaContext *sc, ASTNode *decl, ASTNode *id) {
+    mm_usage_guard();
+    Symbol s = {0};
+    s.name = id->token.lexeme;
+    s.sclass = SYM_VAR;
+    s.type = declared_type(decl->token.type);
+    s.line_decl = id->token.line;
+    s.extra = NULL;
+    if (!symtab_insert(sc->symtab, &s)) {
+        sema_alert(sc, "símbolo redeclarado", id->token.line);
+    } else {
+        index_def(sc, &id->token);
+    }
+    scope_changed(sc);
+}
 
-    switch (node->type) {
-        case AST_DECLARATION: {
-            if (parent == AST_READ_STMT || parent == AST_WRITE_STMT ||
-                parent == AST_IF_STMT   || parent == AST_FOR_STMT) {
-                sema_report_alert("declaração fora de escopo permitido", node->token.line);
-            }
+/* Estado de um percurso de análise. Os 'retorne' de um corpo são conferidos
+ * no mesmo percurso que analisa os comandos */
+typedef struct {
+    SemaContext *sc;
+    TypeKind ret_kind;              /* tipo do primeiro 'retorne' */
+    int ret_line;                   /* -1 até o primeiro 'retorne' */
+    int ret_mismatches;             /* 'retorne' de tipo diferente do primeiro */
+} Analysis;
 
-            TypeKind kind = TY_INT;
-            switch (node->token.type) {
-                case TOK_KW_DECIMAL: kind = TY_DEC; break;
-                case TOK_KW_TEXTO:   kind = TY_TXT; break;
-                case TOK_KW_INTEIRO: default: kind = TY_INT; break;
-            }
+/* Tag dos quadros dentro de uma expressão */
+#define EXPR_TAG (-1)
 
-            int i;
-            for (i = 0; i < node->child_count; i++) {
-                ASTNode *child = node->children[i];
-                if (child->type == AST_IDENTIFIER && child->token.lexeme) {
-                    Type *t = (Type*)mm_malloc(sizeof(Type));
-                    mm_usage_guard();
-                    if (t) *t = make_type(kind);
-                    Symbol s = {0};
-                    s.name = child->token.lexeme;
-                    s.sclass = SYM_VAR;
-                    s.type = t;
-                    s.line_decl = child->token.line;
-                    s.extra = NULL;
-                    if (!symtab_insert(sc->symtab, &s)) {
-                        sema_report_alert("símbolo redeclarado", child->token.line);
-                    }
-                } else {
-                    analyze_node(sc, child, node->type);
-                }
-            }
-            return;
+static int is_expression(const ASTNode *node) {
+    return !(RESOLVE_PRUNE & AST_WALK_MASK(node->type));
+}
+
+/* Tipo de um valor (lado direito, 'retorne'): o inferido quando é uma
+ * expressão; chamadas e demais nós valem inteiro */
+static TypeKind value_kind(const ASTNode *value) {
+    return value && is_expression(value) ? type_kind(value->inferred_type) : TY_INT;
+}
+
+static void note_return(Analysis *a, TypeKind kind, int line) {
+    if (a->ret_line == -1) {
+        a->ret_kind = kind;
+        a->ret_line = line;
+    } else if (kind != a->ret_kind) {
+        a->ret_mismatches++;
+    }
+}
+
+/* A partir de node, os quadros são de expressão; só os nós de expressão
+ * descem aos filhos */
+static AstWalkAction begin_expression(AstWalker *w, ASTNode *node, SemaContext *sc) {
+    ast_walk_set_tag(w, EXPR_TAG);
+    return is_expression(node) ? resolve_pre(w, node, sc) : AST_WALK_SKIP;
+}
+
+/*
+ * Analisa os nós da AST e resolve tipos em um único percurso. A tag de cada
+ * quadro guarda o tipo do nó "pai" visto pelos filhos: blocos repassam a tag
+ * recebida, os demais nós passam o próprio tipo. Nas expressões a tag é
+ * EXPR_TAG, e a pré-ordem só decide se desce; os tipos e as verificações que
+ * dependem deles (atribuição, condições, 'retorne') ficam na pós-ordem.
+ */
+static AstWalkAction analyze_pre(AstWalker *w, ASTNode *node, void *data) {
+    Analysis *a = (Analysis*)data;
+    SemaContext *sc = a->sc;
+    int parent = ast_walk_parent_tag(w);
+    ASTNode *parent_node = ast_walk_parent(w);
+
+    if (sc->index) symindex_extend(sc->index, &node->token);
+    if (parent == EXPR_TAG) {
+        return is_expression(node) ? resolve_pre(w, node, sc) : AST_WALK_SKIP;
+    }
+
+    /* Papéis definidos pela posição no nó pai */
+    if (parent_node) {
+        int index = ast_walk_child_index(w);
+
+        if (parent_node->type == AST_DECLARATION &&
+            node->type == AST_IDENTIFIER && node->token.lexeme) {
+            declare_variable(sc, parent_node, node);
+            return AST_WALK_SKIP;
         }
 
-        case AST_BLOCK: {
-            int i;
-            for (i = 0; i < node->child_count; i++) {
-                analyze_node(sc, node->children[i], parent);
-            }
-            return;
+        if ((parent_node->type == AST_IF_STMT && index == 0) ||
+            (parent_node->type == AST_FOR_STMT && index == 1)) {
+            return begin_expression(w, node, sc);
         }
+    }
+
+    ast_walk_set_tag(w, node->type);
+
+    switch (node->type) {
+        case AST_DECLARATION:
+            if (parent == AST_READ_STMT || parent == AST_WRITE_STMT ||
+                parent == AST_IF_STMT   || parent == AST_FOR_STMT) {
+                sema_alert(sc, "declaração fora de escopo permitido", node->token.line);
+            }
+            return AST_WALK_CONTINUE;
+
+        case AST_BLOCK:
+            ast_walk_set_tag(w, parent);
+            return AST_WALK_CONTINUE;
 
         case AST_ASSIGNMENT: {
+            /* A compatibilidade de tipos é conferida na pós-ordem */
             if (node->child_count >= 2) {
                 ASTNode *lhs = node->children[0];
-                ASTNode *rhs = node->children[1];
-                Symbol *sym = symtab_lookup(sc->symtab, lhs->token.lexeme);
-                if (!sym) {
-                    sema_report_alert("variável não declarada", lhs->token.line);
-                } else {
-                    Type rt = resolve_expr_type(sc, rhs);
-                    if (sym->type && sym->type->kind != rt.kind) {
-                        sema_report_alert("atribuição com tipos incompatíveis", lhs->token.line);
-                    }
+                if (!symtab_lookup(sc->symtab, lhs->token.lexeme)) {
+                    sema_alert(sc, "variável não declarada", lhs->token.line);
                 }
             }
-            break;
+            return AST_WALK_CONTINUE;
         }
 
         case AST_READ_STMT: {
             if (node->child_count > 0) {
                 ASTNode *id = node->children[0];
                 if (!symtab_lookup(sc->symtab, id->token.lexeme)) {
-                    sema_report_alert("variável não declarada em 'leia'", id->token.line);
-                }
-            }
-            break;
-        }
-
-        case AST_WRITE_STMT: {
-            int i;
-            for (i = 0; i < node->child_count; i++) {
-                resolve_expr_type(sc, node->children[i]);
-            }
-            break;
-        }
-
-        case AST_IF_STMT: {
-            if (node->child_count > 0) {
-                Type cond = resolve_expr_type(sc, node->children[0]);
-                if (cond.kind != TY_BOOL) {
-                    sema_report_alert("condição do 'se' deve ser booleana", node->children[0]->token.line);
+                    sema_alert(sc, "variável não declarada em 'leia'", id->token.line);
                 }
             }
-            int i;
-            for (i = 1; i < node->child_count; i++) {
-                analyze_node(sc, node->children[i], node->type);
-            }
-            return;
+            return AST_WALK_CONTINUE;
         }
 
-        case AST_FOR_STMT: {
-            if (node->child_count >= 4) {
-                analyze_node(sc, node->children[0], node->type);
-                Type cond = resolve_expr_type(sc, node->children[1]);
-                if (cond.kind != TY_BOOL) {
-                    sema_report_alert("condição do 'para' deve ser booleana", node->children[1]->token.line);
-                }
-                analyze_node(sc, node->children[2], node->type);
-                analyze_node(sc, node->children[3], node->type);
-            }
-            return;
-        }
+        case AST_FOR_STMT:
+            return node->child_count >= 4 ? AST_WALK_CONTINUE : AST_WALK_SKIP;
 
         case AST_BINARY_OP:
         case AST_LITERAL:
         case AST_IDENTIFIER:
         case AST_UNARY_OP:
         case AST_EXPRESSION:
-            resolve_expr_type(sc, node);
-            return;
+            return begin_expression(w, node, sc);
 
         default:
-            break;
+            return AST_WALK_CONTINUE;
     }
+}
 
-    int i;
-    for (i = 0; i < node->child_count; i++) {
-        analyze_node(sc, node->children[i], node->type);
-    }
-}
-
-static void check_returns(SemaContext *sc, ASTNode *node, TypeKind *ret_kind, int *ret_line, bool *has_ret) {
-    if (!node) return;
-    if (node->type == AST_RETURN_STMT) {
-        *has_ret = true;
-        Type t = make_type(TY_INT);
-        if (node->child_count > 0) t = resolve_expr_type(sc, node->children[0]);
-        if (*ret_line == -1) {
-            *ret_kind = t.kind;
-            *ret_line = node->token.line;
-        } else if (*ret_kind != t.kind) {
-            sema_report_alert("tipos de retorno inconsistentes", node->token.line);
+static void analyze_post(AstWalker *w, ASTNode *node, void *data) {
+    Analysis *a = (Analysis*)data;
+
+    if (ast_walk_tag(w) == EXPR_TAG) {
+        ASTNode *parent_node = ast_walk_parent(w);
+        resolve_post(w, node, a->sc);
+
+        /* Raiz de uma condição */
+        if (parent_node && ast_walk_parent_tag(w) != EXPR_TAG) {
+            int index = ast_walk_child_index(w);
+            if (((parent_node->type == AST_IF_STMT && index == 0) ||
+                 (parent_node->type == AST_FOR_STMT && index == 1)) &&
+                node->inferred_type != TYPE_BOOL) {
+                sema_alert(a->sc, parent_node->type == AST_IF_STMT
+                                      ? "condição do 'se' deve ser booleana"
+                                      : "condição do 'para' deve ser booleana",
+                           node->token.line);
+            }
         }
         return;
     }
-    int i;
-    for (i = 0; i < node->child_count; i++) {
-        check_returns(sc, node->children[i], ret_kind, ret_line, has_ret);
+
+    switch (node->type) {
+        case AST_ASSIGNMENT:
+            if (node->child_count >= 2) {
+                ASTNode *lhs = node->children[0];
+                Symbol *sym = symtab_lookup(a->sc->symtab, lhs->token.lexeme);
+                if (sym && type_kind(sym->type) != value_kind(node->children[1])) {
+                    sema_alert(a->sc, "atribuição com tipos incompatíveis", lhs->token.line);
+                }
+            }
+            break;
+
+        case AST_RETURN_STMT:
+            note_return(a, value_kind(node->child_count > 0 ? node->children[0] : NULL),
+                        node->token.line);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void analyze_walk(Analysis *a, ASTNode *node, ASTNodeType parent) {
+    AstVisitor visitor = {analyze_pre, analyze_post, NULL, 0, 0};
+    visitor.data = a;
+    visitor.root_tag = parent;
+    sema_walk(a->sc, node, &visitor);
+}
+
+static void analyze_node(SemaContext *sc, ASTNode *node, ASTNodeType parent) {
+    Analysis a;
+    a.sc = sc;
+    a.ret_line = -1;
+    a.ret_mismatches = 0;
+    analyze_walk(&a, node, parent);
+}
+
+/* Alerta nos 'retorne' cujo tipo (já anotado) difere do primeiro; só roda
+ * quando a análise do corpo encontrou algum */
+static AstWalkAction report_returns_pre(AstWalker *w, ASTNode *node, void *data) {
+    const Analysis *a = (const Analysis*)data;
+    ASTNode *value;
+    (void)w;
+    if (node->type != AST_RETURN_STMT) return AST_WALK_CONTINUE;
+
+    value = node->child_count > 0 ? node->children[0] : NULL;
+    if (value_kind(value) != a->ret_kind) {
+        sema_alert(a->sc, "tipos de retorno inconsistentes", node->token.line);
     }
+    return AST_WALK_SKIP;
 }
 
-static void analyze_function(SemaContext *sc, ASTNode *func) {
+void sema_analyze_function(SemaContext *sc, ASTNode *func) {
     if (!func || func->child_count == 0) return;
 
     symtab_enter_scope(sc->symtab);
+    scope_changed(sc);
+    if (sc->index) symindex_enter_scope(sc->index, &func->token);
 
     int i;
     for (i = 1; i < func->child_count - 1; i++) {
         ASTNode *param = func->children[i];
         if (param->type != AST_DECLARATION) continue;
-        TypeKind kind = TY_INT;
-        switch (param->token.type) {
-            case TOK_KW_DECIMAL: kind = TY_DEC; break;
-            case TOK_KW_TEXTO:   kind = TY_TXT; break;
-            case TOK_KW_INTEIRO: default: kind = TY_INT; break;
-        }
+        TypeId type = declared_type(param->token.type);
         int j;
         for (j = 0; j < param->child_count; j++) {
             ASTNode *id = param->children[j];
             if (id->type != AST_IDENTIFIER) continue;
-            Type *t = (Type*)mm_malloc(sizeof(Type));
             mm_usage_guard();
-            if (t) *t = make_type(kind);
             Symbol s = {0};
             s.name = id->token.lexeme;
             s.sclass = SYM_PARAM;
-            s.type = t;
+            s.type = type;
             s.line_decl = id->token.line;
             s.extra = NULL;
             if (!symtab_insert(sc->symtab, &s)) {
-                sema_report_alert("parâmetro redeclarado", id->token.line);
+                sema_alert(sc, "parâmetro redeclarado", id->token.line);
+            } else {
+                index_def(sc, &id->token);
             }
+            scope_changed(sc);
         }
     }
 
     ASTNode *body = func->children[func->child_count - 1];
-    analyze_node(sc, body, func->type);
-
-    TypeKind rk = TY_INT;
-    int rline = -1;
-    bool has_ret = false;
-    check_returns(sc, body, &rk, &rline, &has_ret);
-    if (!has_ret) {
-        sema_report_alert("função sem retorno", func->children[0]->token.line);
+    Analysis a;
+    a.sc = sc;
+    a.ret_line = -1;
+    a.ret_mismatches = 0;
+    ast_expand_body(body);
+    analyze_walk(&a, body, func->type);
+
+    if (a.ret_mismatches > 0) {
+        AstVisitor visitor = {report_returns_pre, NULL, NULL, 0, 0};
+        visitor.data = &a;
+        sema_walk(sc, body, &visitor);
+    }
+    if (a.ret_line == -1 && strcmp(func->children[0]->token.lexeme, "principal") != 0) {
+        sema_alert(sc, "função sem retorno", func->children[0]->token.line);
     }
 
+    if (sc->index) symindex_leave_scope(sc->index);
     symtab_leave_scope(sc->symtab);
+    scope_changed(sc);
 }
 
-static int build_function_index(SemaContext *sc, ASTNode *program, ASTNode **funcs) {
-    int count = 0;
-    int principal_count = 0;
-
-    /* O nó raiz representa implicitamente a função principal() */
-    if (program->token.lexeme && strcmp(program->token.lexeme, "principal") == 0) {
-        principal_count = 1;
-    }
-
-    int i;
-    for (i = 0; i < program->child_count; i++) {
-        ASTNode *child = program->children[i];
-        if (child->type == AST_FUNCTION_DEF && child->child_count > 0) {
-            ASTNode *name = child->children[0];
-            const char *fname = name->token.lexeme;
-            if (strcmp(fname, "principal") == 0) {
-                principal_count++;
-                if (child->child_count > 2) {
-                    sema_report_alert("principal() não deve ter parâmetros", name->token.line);
-                }
-            } else {
-                if (!fname || strncmp(fname, "__", 2) != 0) {
-                    sema_report_alert("nome de função inválido", name->token.line);
-                }
+/* Registra a assinatura de uma função ou analisa um item global; com
+   keep_node, o símbolo da função guarda o nó em extra */
+static bool declare_item(SemaContext *sc, ASTNode *child, int *principal_count, bool keep_node) {
+    if (child->type == AST_FUNCTION_DEF && child->child_count > 0) {
+        ASTNode *name = child->children[0];
+        const char *fname = name->token.lexeme;
+        if (strcmp(fname, "principal") == 0) {
+            (*principal_count)++;
+            if (child->child_count > 2) {
+                sema_alert(sc, "principal() não deve ter parâmetros", name->token.line);
             }
-            Type *t = (Type*)mm_malloc(sizeof(Type));
-            mm_usage_guard();
-            if (t) *t = make_type(TY_INT);
-            Symbol s = {0};
-            s.name = (char*)fname;
-            s.sclass = SYM_FUNC;
-            s.type = t;
-            s.line_decl = name->token.line;
-            s.extra = child;
-            if (!symtab_insert(sc->symtab, &s)) {
-                sema_report_alert("função redeclarada", name->token.line);
+        } else {
+            if (!fname || strncmp(fname, "__", 2) != 0) {
+                sema_alert(sc, "nome de função inválido", name->token.line);
             }
-            funcs[count++] = child;
-        } else if (child->type == AST_DECLARATION) {
-            analyze_node(sc, child, AST_PROGRAM);
+        }
+        mm_usage_guard();
+        Symbol s = {0};
+        s.name = (char*)fname;
+        s.sclass = SYM_FUNC;
+        s.type = TYPE_INT;
+        s.line_decl = name->token.line;
+        s.extra = keep_node ? child : NULL;
+        if (!symtab_insert(sc->symtab, &s)) {
+            sema_alert(sc, "função redeclarada", name->token.line);
         } else {
-            analyze_node(sc, child, AST_PROGRAM);
+            index_def(sc, &name->token);
         }
+        scope_changed(sc);
+        return true;
     }
+    analyze_node(sc, child, AST_PROGRAM);
+    return false;
+}
+
+bool sema_declare_item(SemaContext *sc, ASTNode *item, int *principal_count) {
+    return declare_item(sc, item, principal_count, false);
+}
+
+void sema_check_principal(int principal_count, int line) {
     if (principal_count != 1) {
-        sema_report_alert("deve existir exatamente uma função principal()", program->token.line);
+        sema_report_alert("deve existir exatamente uma função principal()", line);
+    }
+}
+
+/* Percurso único do programa: registra as funções na ordem do fonte e
+   analisa os itens globais sem descer nos corpos, que ficam para
+   analyze_functions */
+typedef struct {
+    Analysis a;                     /* primeiro membro: analyze_pre/post */
+    ASTNode *program;
+    ASTNode **funcs;
+    int count;
+    int principal_count;
+} FunctionIndex;
+
+static AstWalkAction index_pre(AstWalker *w, ASTNode *node, void *data) {
+    FunctionIndex *fi = (FunctionIndex*)data;
+
+    if (node == fi->program) {
+        ast_walk_set_tag(w, AST_PROGRAM);
+        return AST_WALK_CONTINUE;
+    }
+    if (ast_walk_parent(w) == fi->program && node->type == AST_FUNCTION_DEF) {
+        if (declare_item(fi->a.sc, node, &fi->principal_count, true)) {
+            fi->funcs[fi->count++] = node;
+        }
+        return AST_WALK_SKIP;
     }
-    return count;
+    return analyze_pre(w, node, &fi->a);
+}
+
+static void index_post(AstWalker *w, ASTNode *node, void *data) {
+    FunctionIndex *fi = (FunctionIndex*)data;
+    if (node != fi->program) analyze_post(w, node, &fi->a);
+}
+
+static int build_function_index(SemaContext *sc, ASTNode *program, ASTNode **funcs) {
+    AstVisitor visitor = {index_pre, index_post, NULL, 0, 0};
+    FunctionIndex fi;
+
+    fi.a.sc = sc;
+    fi.a.ret_line = -1;
+    fi.a.ret_mismatches = 0;
+    fi.program = program;
+    fi.funcs = funcs;
+    fi.count = 0;
+    fi.principal_count = 0;
+
+    /* O nó raiz representa implicitamente a função principal() */
+    if (program->token.lexeme && strcmp(program->token.lexeme, "principal") == 0) {
+        fi.principal_count = 1;
+    }
+
+    visitor.data = &fi;
+    visitor.root_tag = AST_PROGRAM;
+    sema_walk(sc, program, &visitor);
+    sema_check_principal(fi.principal_count, program->token.line);
+    return fi.count;
 }
 
 SemaContext* sema_create(size_t mem_limit_bytes) {
@@ -370,14 +597,318 @@ SemaContext* sema_create(size_t mem_limit_bytes) {
     mm_usage_guard();
     if (!sc) return NULL;
     sc->mem_limit = mem_limit_bytes;
+    sc->alerts = NULL;
+    sc->index = NULL;
+    sc->walks = sc->typed = sc->reused = 0;
     sc->symtab = symtab_create();
     if (!sc->symtab) {
         mm_free(sc);
         return NULL;
     }
+    /* Anotações de análises anteriores não valem com a tabela nova */
+    scope_changed(sc);
     return sc;
 }
 
+/* ========== Corpos adiados (--lazy) ========== */
+
+typedef struct {
+    ASTNode *node;
+    int index;                      /* posição em funcs (ordem do fonte) */
+} FuncEntry;
+
+typedef struct {
+    SemaContext *sc;
+    FuncEntry *entries;             /* ordenadas por endereço do nó */
+    int count;
+    char *reached;
+    int *worklist;
+    int pending;
+} Reach;
+
+static int compare_func_entry(const void *a, const void *b) {
+    const ASTNode *x = ((const FuncEntry*)a)->node;
+    const ASTNode *y = ((const FuncEntry*)b)->node;
+    return x < y ? -1 : x > y;
+}
+
+static void reach_function(Reach *r, ASTNode *func) {
+    FuncEntry key, *found;
+    key.node = func;
+    found = bsearch(&key, r->entries, (size_t)r->count, sizeof(FuncEntry), compare_func_entry);
+    if (found && !r->reached[found->index]) {
+        r->reached[found->index] = 1;
+        r->worklist[r->pending++] = found->index;
+    }
+}
+
+static AstWalkAction reach_calls_pre(AstWalker *w, ASTNode *node, void *data) {
+    Reach *r = (Reach*)data;
+    Symbol *sym;
+    (void)w;
+    if (node->type != AST_FUNCTION_CALL || node->child_count == 0 || !node->children[0]) {
+        return AST_WALK_CONTINUE;
+    }
+    sym = symtab_lookup(r->sc->symtab, node->children[0]->token.lexeme);
+    if (sym && sym->sclass == SYM_FUNC && sym->extra) reach_function(r, (ASTNode*)sym->extra);
+    return AST_WALK_CONTINUE;
+}
+
+static void reach_calls(Reach *r, ASTNode *node) {
+    AstVisitor visitor = {reach_calls_pre, NULL, NULL, 0, 0};
+    visitor.data = r;
+    sema_walk(r->sc, node, &visitor);
+}
+
+/* Marca em reached as funções alcançáveis a partir de principal() e das
+ * chamadas nos itens globais, expandindo só os corpos delas */
+static void mark_reachable(SemaContext *sc, ASTNode *program, ASTNode **funcs, int count,
+                           char *reached) {
+    Reach r;
+    int i;
+
+    r.sc = sc;
+    r.count = count;
+    r.reached = reached;
+    r.pending = 0;
+    r.entries = (FuncEntry*)mm_malloc(sizeof(FuncEntry) * (size_t)(count + 1));
+    mm_usage_guard();
+    r.worklist = (int*)mm_malloc(sizeof(int) * (size_t)(count + 1));
+    mm_usage_guard();
+    for (i = 0; i < count; i++) {
+        r.entries[i].node = funcs[i];
+        r.entries[i].index = i;
+    }
+    qsort(r.entries, (size_t)count, sizeof(FuncEntry), compare_func_entry);
+
+    for (i = 0; i < count; i++) {
+        const char *name = funcs[i]->children[0]->token.lexeme;
+        if (name && strcmp(name, "principal") == 0) {
+            reach_function(&r, funcs[i]);
+        }
+    }
+    for (i = 0; i < program->child_count; i++) {
+        if (program->children[i]->type != AST_FUNCTION_DEF) reach_calls(&r, program->children[i]);
+    }
+    while (r.pending > 0) {
+        ASTNode *func = funcs[r.worklist[--r.pending]];
+        ASTNode *body = func->children[func->child_count - 1];
+        ast_expand_body(body);
+        reach_calls(&r, body);
+    }
+
+    mm_free(r.worklist);
+    mm_free(r.entries);
+}
+
+/* ========== Análise paralela das funções ========== */
+
+/*
+ * Cada corpo de função só lê o escopo global (preenchido por
+ * build_function_index) e declara no próprio escopo. Com sema_set_threads(N),
+ * o escopo global é congelado (symtab_freeze) e cada thread analisa funções
+ * com uma visão própria da tabela (symtab_view) e um SemaContext próprio.
+ *
+ * Repartição por roubo de trabalho, por tamanho: as funções são ordenadas
+ * da maior para a menor e distribuídas em rodízio pelas filas das threads.
+ * Cada thread tira da própria fila pelo início (as maiores primeiro) e,
+ * vazia a sua, rouba do fim da fila das outras (as menores), o que equilibra
+ * o final da análise. Os alertas de cada função ficam guardados e saem, ao
+ * final, na ordem do fonte: a saída é a da análise sequencial. Só os
+ * alertas de uso de memória, impressos pelo gerenciador na hora, podem sair
+ * em outra ordem.
+ */
+static int sema_thread_count = 1;
+
+void sema_set_threads(int threads) {
+    sema_thread_count = threads;
+}
+
+typedef struct {
+    ASTNode *func;
+    int index;                      /* ordem do fonte */
+    int size;                       /* estimativa do trabalho: linhas */
+    SemaAlerts alerts;
+} SemaTask;
+
+typedef struct {
+    int *tasks;                     /* índices de SemaTask, maiores primeiro */
+    int head;                       /* próxima do dono */
+    int tail;                       /* após a próxima a ser roubada */
+    pthread_mutex_t lock;
+} SemaQueue;
+
+typedef struct {
+    SemaTask *tasks;
+    SemaQueue *queues;
+    int workers;
+} SemaPool;
+
+typedef struct {
+    SemaPool *pool;
+    int index;
+    SemaContext *sc;
+} SemaWorker;
+
+/* Da linha do nome à do item seguinte; a última função vai até o último
+ * comando do corpo */
+static void estimate_sizes(SemaTask *tasks, int count) {
+    int i;
+    for (i = 0; i < count; i++) {
+        ASTNode *func = tasks[i].func;
+        ASTNode *body = func->children[func->child_count - 1];
+        int first = func->children[0]->token.line, last = first;
+        if (i + 1 < count) {
+            last = tasks[i + 1].func->children[0]->token.line;
+        } else if (body->child_count > 0 && body->children[body->child_count - 1]) {
+            last = body->children[body->child_count - 1]->token.line + 1;
+        }
+        tasks[i].size = last > first ? last - first : 1;
+    }
+}
+
+static int compare_task_size(const void *a, const void *b) {
+    const SemaTask *x = (const SemaTask*)a, *y = (const SemaTask*)b;
+    if (x->size != y->size) return x->size > y->size ? -1 : 1;
+    return x->index - y->index;
+}
+
+/* Próxima função para a thread self, da própria fila ou roubada; -1 quando
+ * todas as filas estão vazias (nenhuma tarefa nova surge durante a análise) */
+static int pool_next(SemaPool *pool, int self) {
+    int task = -1, i;
+    for (i = 0; task < 0 && i < pool->workers; i++) {
+        SemaQueue *q = &pool->queues[(self + i) % pool->workers];
+        pthread_mutex_lock(&q->lock);
+        if (q->head < q->tail) task = i == 0 ? q->tasks[q->head++] : q->tasks[--q->tail];
+        pthread_mutex_unlock(&q->lock);
+    }
+    return task;
+}
+
+static void *sema_worker(void *arg) {
+    SemaWorker *wk = (SemaWorker*)arg;
+    int task;
+    while ((task = pool_next(wk->pool, wk->index)) >= 0) {
+        wk->sc->alerts = &wk->pool->tasks[task].alerts;
+        sema_analyze_function(wk->sc, wk->pool->tasks[task].func);
+    }
+    wk->sc->alerts = NULL;
+    return NULL;
+}
+
+static void* pool_alloc(size_t size) {
+    void *p = mm_malloc(size);
+    mm_usage_guard();
+    if (!p) {
+        fprintf(stderr, "Erro: memória insuficiente para a análise paralela\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void analyze_parallel(SemaContext *sc, ASTNode **funcs, int count, int threads) {
+    SemaPool pool;
+    SemaWorker *workers;
+    SemaTask *order;
+    pthread_t *ids;
+    int started = 0, i;
+
+    pool.workers = threads;
+    pool.tasks = (SemaTask*)pool_alloc(sizeof(SemaTask) * (size_t)count);
+    memset(pool.tasks, 0, sizeof(SemaTask) * (size_t)count);
+    for (i = 0; i < count; i++) {
+        pool.tasks[i].func = funcs[i];
+        pool.tasks[i].index = i;
+    }
+    estimate_sizes(pool.tasks, count);
+
+    /* Rodízio por tamanho decrescente: a fila w recebe a w-ésima maior, a
+     * (w + threads)-ésima... */
+    order = (SemaTask*)pool_alloc(sizeof(SemaTask) * (size_t)count);
+    memcpy(order, pool.tasks, sizeof(SemaTask) * (size_t)count);
+    qsort(order, (size_t)count, sizeof(SemaTask), compare_task_size);
+    pool.queues = (SemaQueue*)pool_alloc(sizeof(SemaQueue) * (size_t)threads);
+    for (i = 0; i < threads; i++) {
+        SemaQueue *q = &pool.queues[i];
+        q->tasks = (int*)pool_alloc(sizeof(int) * (size_t)(count / threads + 1));
+        q->head = q->tail = 0;
+        pthread_mutex_init(&q->lock, NULL);
+    }
+    for (i = 0; i < count; i++) {
+        SemaQueue *q = &pool.queues[i % threads];
+        q->tasks[q->tail++] = order[i].index;
+    }
+    mm_free(order);
+
+    symtab_freeze(sc->symtab);
+    workers = (SemaWorker*)pool_alloc(sizeof(SemaWorker) * (size_t)threads);
+    for (i = 0; i < threads; i++) {
+        SemaContext *wsc = (SemaContext*)pool_alloc(sizeof(SemaContext));
+        wsc->mem_limit = sc->mem_limit;
+        wsc->symtab = symtab_view(sc->symtab);
+        wsc->alerts = NULL;
+        wsc->index = NULL;
+        wsc->walks = wsc->typed = wsc->reused = 0;
+        scope_changed(wsc);
+        if (!wsc->symtab) {
+            fprintf(stderr, "Erro: memória insuficiente para a análise paralela\n");
+            exit(EXIT_FAILURE);
+        }
+        workers[i].pool = &pool;
+        workers[i].index = i;
+        workers[i].sc = wsc;
+    }
+
+    mm_set_threaded(1);
+    types_set_threaded(1);
+    version_threaded = 1;
+    ids = malloc((size_t)(threads - 1) * sizeof(pthread_t));
+    for (i = 1; ids && i < threads; i++) {
+        if (pthread_create(&ids[i - 1], NULL, sema_worker, &workers[i]) != 0) break;
+        started++;
+    }
+    /* Filas de threads que não puderam ser criadas são roubadas pelas outras */
+    sema_worker(&workers[0]);
+    for (i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    free(ids);
+    version_threaded = 0;
+    types_set_threaded(0);
+    mm_set_threaded(0);
+
+    for (i = 0; i < count; i++) {
+        sema_alerts_flush(&pool.tasks[i].alerts);
+    }
+    for (i = 0; i < threads; i++) {
+        SemaContext *wsc = workers[i].sc;
+        sc->walks += wsc->walks;
+        sc->typed += wsc->typed;
+        sc->reused += wsc->reused;
+        symtab_view_free(wsc->symtab);
+        mm_free(wsc);
+        pthread_mutex_destroy(&pool.queues[i].lock);
+        mm_free(pool.queues[i].tasks);
+    }
+    mm_free(workers);
+    mm_free(pool.queues);
+    mm_free(pool.tasks);
+}
+
+/* Analisa os corpos das funções, em paralelo se configurado */
+static void analyze_functions(SemaContext *sc, ASTNode **funcs, int count) {
+    int threads = sema_thread_count < count ? sema_thread_count : count;
+    int i;
+    if (threads > 1 && !sc->index) {
+        analyze_parallel(sc, funcs, count, threads);
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        sema_analyze_function(sc, funcs[i]);
+    }
+}
+
 bool semantic_analyze(SemaContext* sc, ASTNode* ast) {
     if (!sc || !ast) return false;
     if (ast->type != AST_PROGRAM) {
@@ -389,9 +920,20 @@ bool semantic_analyze(SemaContext* sc, ASTNode* ast) {
     mm_usage_guard();
     int count = build_function_index(sc, ast, funcs);
     int i;
-    for (i = 0; i < count; i++) {
-        analyze_function(sc, funcs[i]);
+    if (parser_lazy_bodies()) {
+        char *reached = (char*)mm_malloc((size_t)count + 1);
+        int analyzed = 0;
+        mm_usage_guard();
+        memset(reached, 0, (size_t)count + 1);
+        mark_reachable(sc, ast, funcs, count, reached);
+        /* Só as alcançadas, na ordem do fonte */
+        for (i = 0; i < count; i++) {
+            if (reached[i]) funcs[analyzed++] = funcs[i];
+        }
+        mm_free(reached);
+        count = analyzed;
     }
+    analyze_functions(sc, funcs, count);
     mm_free(funcs);
     return true;
 }
@@ -402,8 +944,24 @@ void symtab_print(SemaContext* sc) {
     symtab_dump(sc->symtab);
 }
 
+void sema_build_index(SemaContext* sc) {
+    if (sc && !sc->index) sc->index = symindex_builder_create();
+}
+
+SymIndex* sema_take_index(SemaContext* sc) {
+    SymIndex *idx;
+    if (!sc || !sc->index) return NULL;
+    idx = symindex_finish(sc->index);
+    sc->index = NULL;
+    return idx;
+}
+
 void sema_destroy(SemaContext* sc) {
     if (!sc) return;
+    symindex_builder_free(sc->index);
+    walk_count += sc->walks;
+    types_resolved += sc->typed;
+    types_reused += sc->reused;
     symtab_destroy(sc->symtab);
     mm_free(sc);
 }
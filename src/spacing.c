@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <string.h>
+#include "spacing.h"
+
+static unsigned active_rules = SPACING_DEFAULT_RULES;
+static int strict_mode = 0;
+
+void spacing_set_rules(unsigned rules) {
+    active_rules = rules;
+}
+
+unsigned spacing_rules(void) {
+    return active_rules;
+}
+
+void spacing_set_strict(int strict) {
+    strict_mode = strict;
+}
+
+int spacing_strict(void) {
+    return strict_mode;
+}
+
+int spacing_parse_rules(const char *spec, unsigned *rules) {
+    static const char *const names[] = {
+        "operadores", "virgulas", "ponto-e-virgula", "parenteses",
+        "palavras-chave", "chaves", "declaracoes"
+    };
+    unsigned result = 0;
+
+    if (strcmp(spec, "all") == 0) {
+        *rules = SPACING_ALL_RULES;
+        return 1;
+    }
+    if (strcmp(spec, "none") == 0) {
+        *rules = 0;
+        return 1;
+    }
+    while (*spec) {
+        size_t len = strcspn(spec, ",");
+        int i, found = 0;
+        for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+            if (strlen(names[i]) == len && strncmp(spec, names[i], len) == 0) {
+                result |= 1u << i;
+                found = 1;
+            }
+        }
+        if (!found) return 0;
+        spec += len;
+        if (*spec == ',') spec++;
+    }
+    *rules = result;
+    return 1;
+}
+
+void spacing_init(SpacingChecker *sc, unsigned rules) {
+    memset(sc, 0, sizeof(*sc));
+    sc->rules = rules;
+}
+
+static void violate(SpacingChecker *sc, SpacingRule rule, int line, const char *message) {
+    if (!(sc->rules & rule)) return;
+    if (sc->reported < SPACING_MAX_REPORTED) {
+        SpacingViolation *v = &sc->violation[sc->reported++];
+        v->line = line;
+        v->rule = rule;
+        v->message = message;
+    }
+    sc->violations++;
+}
+
+static void expect_after(SpacingChecker *sc, SpacingRule rule, int space, const char *message) {
+    sc->after_rule = rule;
+    sc->after_space = space;
+    sc->after_message = message;
+}
+
+static int ends_operand(TokenType type) {
+    switch (type) {
+        case TOK_IDENTIFIER:
+        case TOK_INTEGER_LITERAL:
+        case TOK_DECIMAL_LITERAL:
+        case TOK_STRING_LITERAL:
+        case TOK_RPAREN:
+        case TOK_RBRACKET:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* '+' e '-' são binários só depois de um operando */
+static int binary_operator(const SpacingChecker *sc, TokenType type) {
+    switch (type) {
+        case TOK_PLUS:
+        case TOK_MINUS:
+            return sc->has_prev && sc->prev_operand;
+        case TOK_STAR:
+        case TOK_SLASH:
+        case TOK_MODULO:
+        case TOK_CARET:
+        case TOK_EQ:
+        case TOK_NEQ:
+        case TOK_LT:
+        case TOK_GT:
+        case TOK_LE:
+        case TOK_GE:
+        case TOK_AND:
+        case TOK_OR:
+        case TOK_ASSIGN:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void spacing_feed(SpacingChecker *sc, const Token *tok) {
+    /* Espaço em branco entre o anterior e tok, e se ele fica na mesma linha */
+    int space = 1, inline_space = 0;
+    if (sc->has_prev && tok->type != TOK_EOF) {
+        int gap = tok->offset - sc->prev_end;
+        space = gap > 0 || tok->line != sc->prev_line;
+        inline_space = gap > 0 && tok->line == sc->prev_line;
+    }
+
+    if (sc->after_rule) {
+        if (sc->after_space ? !space : inline_space) {
+            violate(sc, (SpacingRule)sc->after_rule, sc->prev_line, sc->after_message);
+        }
+        sc->after_rule = 0;
+    }
+
+    if (binary_operator(sc, tok->type)) {
+        if (!space) violate(sc, SPACING_OPERATORS, tok->line, "espaço ausente antes de operador");
+        expect_after(sc, SPACING_OPERATORS, 1, "espaço ausente após operador");
+    } else {
+        switch (tok->type) {
+            case TOK_COMMA:
+                if (inline_space) violate(sc, SPACING_COMMAS, tok->line, "espaço antes de ','");
+                expect_after(sc, SPACING_COMMAS, 1, "espaço ausente após ','");
+                break;
+            case TOK_SEMICOLON:
+                /* 'para (;;)' e afins: o espaço é de quem vem antes */
+                if (inline_space && sc->prev_type != TOK_SEMICOLON && sc->prev_type != TOK_LPAREN) {
+                    violate(sc, SPACING_SEMICOLONS, tok->line, "espaço antes de ';'");
+                }
+                break;
+            case TOK_LPAREN:
+                if (inline_space && sc->has_prev &&
+                    (sc->prev_type == TOK_IDENTIFIER || sc->prev_type == TOK_KW_LEIA ||
+                     sc->prev_type == TOK_KW_ESCREVA || sc->prev_type == TOK_KW_PRINCIPAL)) {
+                    violate(sc, SPACING_KEYWORDS, tok->line, "espaço entre o nome e '('");
+                }
+                expect_after(sc, SPACING_PARENS, 0, "espaço após '('");
+                break;
+            case TOK_LBRACKET:
+                expect_after(sc, SPACING_PARENS, 0, "espaço após '['");
+                break;
+            case TOK_RPAREN:
+            case TOK_RBRACKET:
+                if (inline_space && sc->prev_type != TOK_LPAREN && sc->prev_type != TOK_LBRACKET) {
+                    violate(sc, SPACING_PARENS, tok->line,
+                            tok->type == TOK_RPAREN ? "espaço antes de ')'" : "espaço antes de ']'");
+                }
+                break;
+            case TOK_LBRACE:
+                if (!space) violate(sc, SPACING_BRACES, tok->line, "espaço ausente antes de '{'");
+                break;
+            case TOK_KW_SE:
+            case TOK_KW_ENQUANTO:
+            case TOK_KW_PARA:
+                expect_after(sc, SPACING_KEYWORDS, 1, "espaço ausente após 'se', 'enquanto' ou 'para'");
+                break;
+            case TOK_KW_INTEIRO:
+            case TOK_KW_DECIMAL:
+            case TOK_KW_TEXTO:
+                expect_after(sc, SPACING_DECLARATIONS, 1, "espaço ausente após o tipo");
+                break;
+            default:
+                break;
+        }
+    }
+
+    sc->has_prev = 1;
+    sc->prev_type = tok->type;
+    sc->prev_end = tok->offset + tok->length;
+    sc->prev_line = tok->line;
+    sc->prev_operand = ends_operand(tok->type);
+}
+
+unsigned long spacing_report(const SpacingChecker *sc) {
+    int i;
+    /* Depois do que já foi impresso em stdout (ex.: o cabeçalho da validação) */
+    if (sc->violations > 0) fflush(stdout);
+    for (i = 0; i < sc->reported; i++) {
+        if (strict_mode) {
+            fprintf(stderr, "Erro: espaçamento na linha %d: %s\n",
+                    sc->violation[i].line, sc->violation[i].message);
+        } else {
+            fprintf(stderr, "\033[33mAlerta de espaçamento (linha %d): %s\033[0m\n",
+                    sc->violation[i].line, sc->violation[i].message);
+        }
+    }
+    if (sc->violations > (unsigned long)sc->reported) {
+        fprintf(stderr, strict_mode ? "Erro: mais %lu violação(ões) de espaçamento\n"
+                                    : "\033[33mAlerta: mais %lu violação(ões) de espaçamento\033[0m\n",
+                sc->violations - (unsigned long)sc->reported);
+    }
+    return sc->violations;
+}
+
+SpacingChecker* spacing_checker(void) {
+    static SpacingChecker checker;
+    return &checker;
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "stream.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "lexer.h"
+#include "memmgr.h"
+#include "parse_parallel.h"
+#include "parser.h"
+#include "spacing.h"
+#include "util.h"
+
+typedef enum {
+    PASS_SYNTAX,                    /* só análise sintática */
+    PASS_VALIDATE,                  /* validações, sem erros de sintaxe */
+    PASS_SIGNATURES,
+    PASS_BODIES
+} StreamPass;
+
+typedef struct {
+    const char *text;
+    size_t len;
+    SemaContext *sc;
+    StreamPass pass;
+    Parser *parser;                 /* reaproveitado entre as regiões */
+
+    Token *tokens;                  /* tokens da região atual, + TOK_EOF */
+    int token_count;
+    int token_capacity;
+
+    int first_line;                 /* linha do primeiro token do programa */
+    int printed_root;
+    int principal_count;
+    int functions;
+    int found_non_declaration;
+    int misordered;                 /* sequência de declarações já reprovada */
+    StreamResult result;
+} StreamState;
+
+static void lex_region(StreamState *st, const SourceRegion *region) {
+    Scanner sc;
+    Token tok;
+
+    scanner_init_range(&sc, st->text, region->start, region->end, region->line);
+    st->token_count = 0;
+    do {
+        tok = scanner_next_token(&sc);
+        if (st->token_count >= st->token_capacity) {
+            st->token_capacity = st->token_capacity ? st->token_capacity * 2 : 64;
+            st->tokens = mm_realloc(st->tokens, st->token_capacity * sizeof(Token));
+            if (!st->tokens) {
+                fprintf(stderr, "Erro: memória insuficiente para a compilação por função\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        st->tokens[st->token_count++] = tok;
+    } while (tok.type != TOK_EOF);
+}
+
+static void release_region(StreamState *st) {
+    int i;
+    for (i = 0; i < st->token_count; i++) {
+        if (token_owns_lexeme(st->tokens[i].type)) mm_free(st->tokens[i].lexeme);
+    }
+    st->token_count = 0;
+}
+
+/* Linha 'PROGRAM ...' da AST, com o primeiro token do programa */
+static void print_root(Token first) {
+    ASTNode *root = ast_node_create(AST_PROGRAM, first);
+    print_ast(root, 0);
+    free_ast(root);
+}
+
+/* Mesma regra de validate_declaration_sequence, que também só informa a
+ * primeira declaração fora de lugar */
+static void check_declaration_order(StreamState *st, ASTNode *item) {
+    if (item->type != AST_DECLARATION) {
+        st->found_non_declaration = 1;
+    } else if (st->found_non_declaration && !st->misordered) {
+        fprintf(stderr, "Erro: declaração após comando não-declarativo na linha %d\n",
+               item->token.line);
+        st->misordered = 1;
+    }
+}
+
+/* Mesma regra de validate_variable_usage; corpos adiados ficam de fora */
+static void check_variable_usage(StreamState *st, ASTNode *item) {
+    VarUsageStats stats = {0, 0, 0, 0};
+    Cfg *g;
+
+    if (item->type != AST_FUNCTION_DEF) return;
+    if (item->child_count > 0 && item->children[item->child_count - 1]->lazy) return;
+    g = cfg_build(item, st->text, st->len);
+    dataflow_check_usage(g, &stats);
+    cfg_free(g);
+}
+
+static void process_region(StreamState *st, const SourceRegion *region) {
+    lex_region(st, region);
+    if (st->parser) parser_set_tokens(st->parser, st->tokens);
+    else st->parser = parser_init_tokens(st->tokens);
+    st->parser->silent = 1;
+
+    if (st->tokens[0].type != TOK_EOF) {
+        if (st->first_line == 0) st->first_line = st->tokens[0].line;
+        if (st->pass == PASS_BODIES && !st->printed_root) {
+            print_root(st->tokens[0]);
+            st->printed_root = 1;
+        }
+    }
+
+    while (st->result == STREAM_OK && !parse_program_at_end(st->parser)) {
+        ASTNode *item = parse_program_item(st->parser);
+        if (st->parser->had_error) {
+            st->result = STREAM_SYNTAX_ERROR;
+        } else if (item && st->pass == PASS_VALIDATE) {
+            check_declaration_order(st, item);
+            check_variable_usage(st, item);
+        } else if (item && st->pass == PASS_SIGNATURES) {
+            if (sema_declare_item(st->sc, item, &st->principal_count)) st->functions++;
+        } else if (item && st->pass == PASS_BODIES) {
+            print_ast(item, 1);
+            if (item->type == AST_FUNCTION_DEF) sema_analyze_function(st->sc, item);
+        }
+        if (item) free_ast(item);
+    }
+
+    release_region(st);
+}
+
+StreamResult compile_streaming(const char *text, size_t len, SemaContext *sc) {
+    StreamState st = {0};
+    SourceRegion *regions = NULL;
+    int count, i;
+
+    if (starts_with_principal(text, len)) return STREAM_UNSUPPORTED;
+
+    st.text = text;
+    st.len = len;
+    st.sc = sc;
+    st.result = STREAM_OK;
+    count = split_top_level(text, len, &regions);
+
+    /* Como na compilação em lote, os erros sintáticos vêm antes de tudo:
+     * as validações (sequência de declarações, uso de variáveis) só são
+     * feitas, numa segunda passada, se todas as regiões forem válidas */
+    printf("\033[34m=== ANÁLISE SINTÁTICA (POR FUNÇÃO) ===\033[0m\n");
+    st.pass = PASS_SYNTAX;
+    for (i = 0; i < count && st.result == STREAM_OK; i++) {
+        process_region(&st, &regions[i]);
+    }
+
+    if (st.result == STREAM_SYNTAX_ERROR) {
+        /* Reanálise sequencial só para emitir as mensagens na forma usual */
+        int had_error;
+        free_ast(parse_program_parallel(text, len, 1, &had_error));
+    } else {
+        printf("\033[32mAnálise sintática concluída com sucesso!\033[0m\n");
+        st.pass = PASS_VALIDATE;
+        for (i = 0; i < count; i++) {
+            process_region(&st, &regions[i]);
+        }
+        if (st.misordered) st.result = STREAM_INVALID;
+    }
+
+    if (st.result == STREAM_OK) {
+        printf("\033[32m✓ Sequência de declarações válida\033[0m\n");
+        /* O espaçamento já foi verificado na listagem de tokens */
+        if (spacing_report(spacing_checker()) > 0 && spacing_strict()) st.result = STREAM_SPACING;
+    }
+
+    if (st.result == STREAM_OK) {
+        printf("\n\033[34m=== ASSINATURAS ===\033[0m\n");
+        st.pass = PASS_SIGNATURES;
+        for (i = 0; i < count; i++) {
+            process_region(&st, &regions[i]);
+        }
+        if (st.first_line == 0) st.first_line = 1;
+        sema_check_principal(st.principal_count, st.first_line);
+        printf("\033[32m✓ %d função(ões) registrada(s) no escopo global\033[0m\n", st.functions);
+
+        printf("\n\033[34m=== ÁRVORE SINTÁTICA ABSTRATA (POR FUNÇÃO) ===\033[0m\n");
+        st.pass = PASS_BODIES;
+        for (i = 0; i < count; i++) {
+            process_region(&st, &regions[i]);
+        }
+        if (!st.printed_root) {
+            Token eof = {TOK_EOF, 0, "", 0, 0};
+            eof.line = st.first_line;
+            print_root(eof);
+        }
+    }
+
+    if (st.parser) parser_free(st.parser);
+    if (st.tokens) mm_free(st.tokens);
+    mm_free(regions);
+    return st.result;
+}
@@ -0,0 +1,339 @@
+#include "symindex.h"
+#include "memmgr.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SymIndexBuilder {
+    SymDef *defs;
+    int def_count, def_capacity;
+    SymRef *refs;                   /* na ordem da análise */
+    int ref_count, ref_capacity;
+    SymScope *scopes;               /* na ordem de entrada, que é a de início */
+    int scope_count, scope_capacity;
+    int *open;                      /* pilha dos escopos abertos */
+    int open_count, open_capacity;
+    char *names;
+    size_t names_size, names_capacity;
+};
+
+/* Tudo em um bloco, na ordem dos campos */
+struct SymIndex {
+    SymDef *defs;
+    SymRef *refs;                   /* agrupadas por definição, cada grupo em ordem de posição */
+    int *ref_order;                 /* refs em ordem de posição */
+    int *def_order;                 /* defs em ordem de posição */
+    int *scope_defs;                /* defs agrupadas por escopo, em ordem de nome */
+    SymScope *scopes;
+    char *names;
+    int def_count;
+    int ref_count;
+    int scope_count;
+    size_t size;
+};
+
+static void* grow(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    items = mm_realloc(items, (size_t)*capacity * size);
+    if (!items) {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+static void open_scope(SymIndexBuilder *b, int start, int end) {
+    SymScope *s;
+    b->scopes = grow(b->scopes, b->scope_count, &b->scope_capacity, sizeof(SymScope));
+    b->open = grow(b->open, b->open_count, &b->open_capacity, sizeof(int));
+    s = &b->scopes[b->scope_count];
+    s->start = start;
+    s->end = end;
+    s->parent = b->open_count > 0 ? b->open[b->open_count - 1] : -1;
+    s->first_def = s->def_count = 0;
+    b->open[b->open_count++] = b->scope_count++;
+}
+
+SymIndexBuilder* symindex_builder_create(void) {
+    SymIndexBuilder *b = mm_malloc(sizeof(SymIndexBuilder));
+    if (!b) {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(b, 0, sizeof(SymIndexBuilder));
+    open_scope(b, 0, INT_MAX);
+    return b;
+}
+
+void symindex_builder_free(SymIndexBuilder *b) {
+    if (!b) return;
+    if (b->defs) mm_free(b->defs);
+    if (b->refs) mm_free(b->refs);
+    if (b->scopes) mm_free(b->scopes);
+    if (b->open) mm_free(b->open);
+    if (b->names) mm_free(b->names);
+    mm_free(b);
+}
+
+void symindex_extend(SymIndexBuilder *b, const Token *tok) {
+    SymScope *s = &b->scopes[b->open[b->open_count - 1]];
+    if (tok->offset + tok->length > s->end) s->end = tok->offset + tok->length;
+}
+
+void symindex_enter_scope(SymIndexBuilder *b, const Token *start) {
+    open_scope(b, start->offset, start->offset + start->length);
+}
+
+void symindex_leave_scope(SymIndexBuilder *b) {
+    SymScope *s;
+    if (b->open_count <= 1) return;
+    s = &b->scopes[b->open[--b->open_count]];
+    if (s->end > b->scopes[s->parent].end) b->scopes[s->parent].end = s->end;
+}
+
+int symindex_add_def(SymIndexBuilder *b, const Symbol *sym, const Token *id) {
+    size_t len = strlen(sym->name) + 1;
+    SymDef *d;
+
+    b->defs = grow(b->defs, b->def_count, &b->def_capacity, sizeof(SymDef));
+    if (b->names_size + len > b->names_capacity) {
+        while (b->names_size + len > b->names_capacity) {
+            b->names_capacity = b->names_capacity ? b->names_capacity * 2 : 256;
+        }
+        b->names = mm_realloc(b->names, b->names_capacity);
+        if (!b->names) {
+            fprintf(stderr, "Erro: memória insuficiente para o índice de símbolos\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(b->names + b->names_size, sym->name, len);
+
+    d = &b->defs[b->def_count];
+    d->name = (unsigned int)b->names_size;
+    d->sclass = sym->sclass;
+    d->type = sym->type;
+    d->line = id->line;
+    d->offset = id->offset;
+    d->length = id->length;
+    d->scope = b->open[b->open_count - 1];
+    d->first_ref = d->ref_count = 0;
+    b->names_size += len;
+    symindex_extend(b, id);
+    return b->def_count++;
+}
+
+void symindex_add_ref(SymIndexBuilder *b, int def, const Token *id) {
+    SymRef *r;
+    b->refs = grow(b->refs, b->ref_count, &b->ref_capacity, sizeof(SymRef));
+    r = &b->refs[b->ref_count++];
+    r->offset = id->offset;
+    r->line = id->line;
+    r->def = def;
+    symindex_extend(b, id);
+}
+
+/* Chave de ordenação das definições */
+typedef struct {
+    const char *name;
+    int key;                        /* posição, ou escopo */
+    int def;
+} DefKey;
+
+static int compare_ref_offset(const void *a, const void *b) {
+    const SymRef *x = (const SymRef*)a, *y = (const SymRef*)b;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+static int compare_key(const void *a, const void *b) {
+    const DefKey *x = (const DefKey*)a, *y = (const DefKey*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->def > y->def) - (x->def < y->def);
+}
+
+static int compare_key_name(const void *a, const void *b) {
+    const DefKey *x = (const DefKey*)a, *y = (const DefKey*)b;
+    int c;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    c = strcmp(x->name, y->name);
+    if (c != 0) return c;
+    return (x->def > y->def) - (x->def < y->def);
+}
+
+SymIndex* symindex_finish(SymIndexBuilder *b) {
+    int defs = b->def_count, refs = b->ref_count, scopes = b->scope_count;
+    size_t size = sizeof(SymIndex) + defs * sizeof(SymDef) + refs * sizeof(SymRef) +
+                  (refs + 2 * (size_t)defs) * sizeof(int) + scopes * sizeof(SymScope) +
+                  b->names_size;
+    char *block = mm_malloc(size);
+    SymIndex *idx = (SymIndex*)block;
+    DefKey *keys;
+    int i, first;
+
+    if (!block) {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    idx->defs = (SymDef*)(block + sizeof(SymIndex));
+    idx->refs = (SymRef*)(idx->defs + defs);
+    idx->ref_order = (int*)(idx->refs + refs);
+    idx->def_order = idx->ref_order + refs;
+    idx->scope_defs = idx->def_order + defs;
+    idx->scopes = (SymScope*)(idx->scope_defs + defs);
+    idx->names = (char*)(idx->scopes + scopes);
+    idx->def_count = defs;
+    idx->ref_count = refs;
+    idx->scope_count = scopes;
+    idx->size = size;
+
+    if (defs > 0) memcpy(idx->defs, b->defs, defs * sizeof(SymDef));
+    if (scopes > 0) memcpy(idx->scopes, b->scopes, scopes * sizeof(SymScope));
+    if (b->names_size > 0) memcpy(idx->names, b->names, b->names_size);
+
+    /* Referências agrupadas por definição: em ordem de posição e depois
+     * distribuídas, estavelmente, pelos grupos */
+    if (refs > 0) qsort(b->refs, refs, sizeof(SymRef), compare_ref_offset);
+    for (i = 0; i < refs; i++) idx->defs[b->refs[i].def].ref_count++;
+    for (i = 0, first = 0; i < defs; i++) {
+        idx->defs[i].first_ref = first;
+        first += idx->defs[i].ref_count;
+        idx->defs[i].ref_count = 0;
+    }
+    for (i = 0; i < refs; i++) {
+        SymDef *d = &idx->defs[b->refs[i].def];
+        int slot = d->first_ref + d->ref_count++;
+        idx->refs[slot] = b->refs[i];
+        idx->ref_order[i] = slot;
+    }
+
+    keys = defs > 0 ? mm_malloc(defs * sizeof(DefKey)) : NULL;
+    if (defs > 0 && !keys) {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < defs; i++) {
+        keys[i].name = idx->names + idx->defs[i].name;
+        keys[i].key = idx->defs[i].offset;
+        keys[i].def = i;
+    }
+    if (defs > 0) qsort(keys, defs, sizeof(DefKey), compare_key);
+    for (i = 0; i < defs; i++) idx->def_order[i] = keys[i].def;
+
+    /* Definições de cada escopo, em ordem de nome */
+    for (i = 0; i < defs; i++) {
+        keys[i].name = idx->names + idx->defs[i].name;
+        keys[i].key = idx->defs[i].scope;
+        keys[i].def = i;
+    }
+    if (defs > 0) qsort(keys, defs, sizeof(DefKey), compare_key_name);
+    for (i = 0; i < defs; i++) {
+        SymScope *s = &idx->scopes[keys[i].key];
+        if (s->def_count == 0) s->first_def = i;
+        s->def_count++;
+        idx->scope_defs[i] = keys[i].def;
+    }
+    if (keys) mm_free(keys);
+
+    symindex_builder_free(b);
+    return idx;
+}
+
+void symindex_free(SymIndex *idx) {
+    if (idx) mm_free(idx);
+}
+
+/* Último elemento de order (índices em posição crescente) que começa até
+ * offset, ou -1 */
+static int last_at_or_before(const int *order, int count, const SymIndex *idx, int is_ref,
+                             int offset) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int start = is_ref ? idx->refs[order[mid]].offset : idx->defs[order[mid]].offset;
+        if (start <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo - 1;
+}
+
+int symindex_symbol_at(const SymIndex *idx, int offset) {
+    int i = last_at_or_before(idx->ref_order, idx->ref_count, idx, 1, offset);
+    if (i >= 0) {
+        const SymRef *r = &idx->refs[idx->ref_order[i]];
+        if (offset < r->offset + idx->defs[r->def].length) return r->def;
+    }
+    i = last_at_or_before(idx->def_order, idx->def_count, idx, 0, offset);
+    if (i >= 0) {
+        const SymDef *d = &idx->defs[idx->def_order[i]];
+        if (offset < d->offset + d->length) return idx->def_order[i];
+    }
+    return -1;
+}
+
+const SymDef* symindex_def(const SymIndex *idx, int def) {
+    return &idx->defs[def];
+}
+
+const char* symindex_name(const SymIndex *idx, int def) {
+    return idx->names + idx->defs[def].name;
+}
+
+const SymRef* symindex_refs(const SymIndex *idx, int def, int *count) {
+    *count = idx->defs[def].ref_count;
+    return idx->refs + idx->defs[def].first_ref;
+}
+
+/* Os intervalos são aninhados ou disjuntos: o último a começar até offset
+ * é o mais interno que pode contê-lo, e se ele termina antes, algum
+ * ancestral o contém */
+int symindex_scope_at(const SymIndex *idx, int offset) {
+    int lo = 0, hi = idx->scope_count, s;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (idx->scopes[mid].start <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    s = lo > 0 ? lo - 1 : 0;
+    while (s > 0 && offset >= idx->scopes[s].end) s = idx->scopes[s].parent;
+    return s;
+}
+
+const SymScope* symindex_scope(const SymIndex *idx, int scope) {
+    return &idx->scopes[scope];
+}
+
+int symindex_resolve(const SymIndex *idx, const char *name, int offset) {
+    int s = symindex_scope_at(idx, offset);
+    for (; s >= 0; s = idx->scopes[s].parent) {
+        const SymScope *scope = &idx->scopes[s];
+        int lo = 0, hi = scope->def_count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            int def = idx->scope_defs[scope->first_def + mid];
+            if (strcmp(idx->names + idx->defs[def].name, name) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < scope->def_count) {
+            int def = idx->scope_defs[scope->first_def + lo];
+            if (strcmp(idx->names + idx->defs[def].name, name) == 0) return def;
+        }
+    }
+    return -1;
+}
+
+int symindex_def_count(const SymIndex *idx) {
+    return idx->def_count;
+}
+
+int symindex_ref_count(const SymIndex *idx) {
+    return idx->ref_count;
+}
+
+int symindex_scope_count(const SymIndex *idx) {
+    return idx->scope_count;
+}
+
+size_t symindex_size(const SymIndex *idx) {
+    return idx->size;
+}
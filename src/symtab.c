@@ -1,11 +1,10 @@
 #include "symtab.h"
 #include "memmgr.h"
+#include "output.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#define SYMTAB_BUCKETS 64
-
 /* Assumimos tamanhos: inteiro=4B, decimal=8B, texto[n]=nB */
 
 /* Hash simples para strings (djb2) */
@@ -18,87 +17,560 @@ static unsigned long sym_hash(const char *str) {
     return hash;
 }
 
+static SymTabDesign design = SYMTAB_SCOPES;
+
+void symtab_set_design(SymTabDesign d) {
+    design = d;
+}
+
+SymTabDesign symtab_design(void) {
+    return design;
+}
+
+int symtab_parse_design(const char *name, SymTabDesign *d) {
+    if (strcmp(name, "scopes") == 0) {
+        *d = SYMTAB_SCOPES;
+    } else if (strcmp(name, "global") == 0) {
+        *d = SYMTAB_GLOBAL;
+    } else if (strcmp(name, "hamt") == 0) {
+        *d = SYMTAB_HAMT;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/* Com SYMTAB_GLOBAL, cada símbolo é alocado como ligação: o símbolo (no
+ * início, para que Symbol* e Binding* coincidam), a ligação do mesmo nome
+ * que ele esconde e o hash do nome */
+typedef struct {
+    Symbol sym;
+    Symbol *shadowed;
+    unsigned long hash;
+} Binding;
+
+/* Vaga da tabela de nomes: a ligação mais interna do nome */
+typedef struct {
+    unsigned long hash;
+    Symbol *top;           /* NULL: vaga livre; &removed: nome sem ligações */
+} NameSlot;
+
+struct SymNames {
+    NameSlot *slots;
+    size_t slot_count;     /* potência de 2 */
+    size_t used;           /* vagas não livres (inclusive as de &removed) */
+    size_t live;
+};
+
+/* Marca a vaga de um nome cujas ligações saíram todas de escopo; a busca
+ * continua depois dela, e uma inserção pode reaproveitá-la */
+static Symbol removed;
+
+#define NAMES_NONE ((size_t)-1)
+
+/*
+ * SYMTAB_HAMT. Cada nível do trie consome HAMT_BITS bits do hash; um nó
+ * guarda só as posições ocupadas (bitmap), em ordem, e leaves diz quais
+ * delas são símbolos (as demais são nós filhos). Hashes iguais até o fim
+ * caem em um nó de colisão (bitmap 0), que só tem símbolos. Os nós são
+ * compartilhados entre os mapas dos escopos, das visões e das cópias, com
+ * contagem de referências atômica; um nó com uma só referência pode ser
+ * alterado no lugar, menos os do mapa congelado (symtab_freeze), que as
+ * visões de outras threads percorrem sem contar referência. Os símbolos pertencem aos escopos, como nas outras
+ * organizações, e não são contados.
+ */
+#define HAMT_BITS 5
+#define HASH_BITS (sizeof(unsigned long) * 8)
+
+typedef struct {
+    Symbol sym;            /* no início: Symbol* e HamtSymbol* coincidem */
+    unsigned long hash;
+} HamtSymbol;
+
+typedef struct HamtNode {
+    unsigned int refs;
+    unsigned int bitmap;
+    unsigned int leaves;
+    unsigned int count : 31;
+    unsigned int pinned : 1;   /* alcançável do mapa congelado: nunca no lugar */
+    void *entries[1];      /* count entradas */
+} HamtNode;
+
+#define HAMT_SIZE(count) (sizeof(HamtNode) + ((count) > 0 ? (count) - 1 : 0) * sizeof(void*))
+
+static unsigned int hamt_bit(unsigned long hash, unsigned int shift) {
+    return 1u << ((hash >> shift) & ((1u << HAMT_BITS) - 1));
+}
+
+static unsigned int hamt_pos(const HamtNode *n, unsigned int bit) {
+    return (unsigned int)__builtin_popcount(n->bitmap & (bit - 1));
+}
+
+static void hamt_retain(HamtNode *n) {
+    if (n) __sync_add_and_fetch(&n->refs, 1);
+}
+
+/* Aplica fn aos filhos de n (as entradas que não são símbolos) */
+static void hamt_each_child(HamtNode *n, void (*fn)(HamtNode*)) {
+    unsigned int bits = n->bitmap, i;
+    for (i = 0; bits; bits &= bits - 1, i++) {
+        if (!(n->leaves & (bits & (0u - bits)))) fn((HamtNode*)n->entries[i]);
+    }
+}
+
+static void hamt_release(HamtNode *n) {
+    if (!n || __sync_sub_and_fetch(&n->refs, 1) > 0) return;
+    hamt_each_child(n, hamt_release);
+    mm_free(n);
+}
+
+static HamtNode* hamt_alloc(unsigned int count) {
+    HamtNode *n = (HamtNode*)mm_malloc(HAMT_SIZE(count));
+    mm_usage_guard();
+    if (!n) {
+        fprintf(stderr, "Erro: memória insuficiente para a tabela de símbolos\n");
+        exit(EXIT_FAILURE);
+    }
+    n->refs = 1;
+    n->bitmap = n->leaves = 0;
+    n->count = count;
+    n->pinned = 0;
+    return n;
+}
+
+/* Um nó só desta referência, com espaço para extra entradas a mais: o
+ * próprio n, se ninguém mais o enxerga, ou uma cópia que compartilha os
+ * filhos (a referência a n passa para a cópia) */
+static HamtNode* hamt_own(HamtNode *n, unsigned int extra) {
+    HamtNode *copy;
+    /* A contagem muda em outras threads (hamt_retain, hamt_release) */
+    if (!n->pinned && __atomic_load_n(&n->refs, __ATOMIC_ACQUIRE) == 1) {
+        if (extra) {
+            n = (HamtNode*)mm_realloc(n, HAMT_SIZE(n->count + extra));
+            mm_usage_guard();
+            if (!n) {
+                fprintf(stderr, "Erro: memória insuficiente para a tabela de símbolos\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        return n;
+    }
+    copy = hamt_alloc(n->count + extra);
+    copy->bitmap = n->bitmap;
+    copy->leaves = n->leaves;
+    copy->count = n->count;
+    memcpy(copy->entries, n->entries, n->count * sizeof(void*));
+    hamt_each_child(copy, hamt_retain);
+    hamt_release(n);
+    return copy;
+}
+
+/* Marca n e os nós abaixo dele; antes de as threads começarem */
+static void hamt_pin(HamtNode *n) {
+    if (n->pinned) return;
+    n->pinned = 1;
+    hamt_each_child(n, hamt_pin);
+}
+
+/* Nó com dois símbolos cujos hashes coincidem nos níveis acima de shift */
+static HamtNode* hamt_pair(HamtSymbol *a, HamtSymbol *b, unsigned int shift) {
+    unsigned int bit_a, bit_b;
+    HamtNode *n;
+    if (shift >= HASH_BITS) {
+        /* Nó de colisão */
+        n = hamt_alloc(2);
+        n->entries[0] = a;
+        n->entries[1] = b;
+        return n;
+    }
+    bit_a = hamt_bit(a->hash, shift);
+    bit_b = hamt_bit(b->hash, shift);
+    if (bit_a == bit_b) {
+        n = hamt_alloc(1);
+        n->bitmap = bit_a;
+        n->entries[0] = hamt_pair(a, b, shift + HAMT_BITS);
+        return n;
+    }
+    n = hamt_alloc(2);
+    n->bitmap = n->leaves = bit_a | bit_b;
+    n->entries[bit_a < bit_b ? 0 : 1] = a;
+    n->entries[bit_a < bit_b ? 1 : 0] = b;
+    return n;
+}
+
+/* Mapa com sym (no lugar de um símbolo do mesmo nome, que ele esconde);
+ * consome a referência a n */
+static HamtNode* hamt_insert(HamtNode *n, HamtSymbol *sym, unsigned int shift) {
+    unsigned int bit, i;
+
+    if (!n) {
+        n = hamt_alloc(1);
+        n->bitmap = n->leaves = hamt_bit(sym->hash, shift);
+        n->entries[0] = sym;
+        return n;
+    }
+    if (n->bitmap == 0) {
+        for (i = 0; i < n->count; i++) {
+            if (strcmp(((HamtSymbol*)n->entries[i])->sym.name, sym->sym.name) == 0) {
+                n = hamt_own(n, 0);
+                n->entries[i] = sym;
+                return n;
+            }
+        }
+        n = hamt_own(n, 1);
+        n->entries[n->count++] = sym;
+        return n;
+    }
+
+    bit = hamt_bit(sym->hash, shift);
+    i = hamt_pos(n, bit);
+    if (!(n->bitmap & bit)) {
+        n = hamt_own(n, 1);
+        memmove(&n->entries[i + 1], &n->entries[i], (n->count - i) * sizeof(void*));
+        n->entries[i] = sym;
+        n->bitmap |= bit;
+        n->leaves |= bit;
+        n->count++;
+    } else if (n->leaves & bit) {
+        HamtSymbol *old = (HamtSymbol*)n->entries[i];
+        n = hamt_own(n, 0);
+        if (old->hash == sym->hash && strcmp(old->sym.name, sym->sym.name) == 0) {
+            n->entries[i] = sym;
+        } else {
+            n->entries[i] = hamt_pair(old, sym, shift + HAMT_BITS);
+            n->leaves &= ~bit;
+        }
+    } else {
+        n = hamt_own(n, 0);
+        n->entries[i] = hamt_insert((HamtNode*)n->entries[i], sym, shift + HAMT_BITS);
+    }
+    return n;
+}
+
+static Symbol* hamt_find(const HamtNode *n, const char *name, unsigned long hash) {
+    unsigned int shift = 0;
+    while (n) {
+        unsigned int bit, i;
+        if (n->bitmap == 0) {
+            for (i = 0; i < n->count; i++) {
+                HamtSymbol *leaf = (HamtSymbol*)n->entries[i];
+                if (strcmp(leaf->sym.name, name) == 0) return &leaf->sym;
+            }
+            return NULL;
+        }
+        bit = hamt_bit(hash, shift);
+        if (!(n->bitmap & bit)) return NULL;
+        i = hamt_pos(n, bit);
+        if (n->leaves & bit) {
+            HamtSymbol *leaf = (HamtSymbol*)n->entries[i];
+            return leaf->hash == hash && strcmp(leaf->sym.name, name) == 0 ? &leaf->sym : NULL;
+        }
+        n = (const HamtNode*)n->entries[i];
+        shift += HAMT_BITS;
+    }
+    return NULL;
+}
+
 static Scope* scope_new(size_t id, Scope *parent) {
     Scope *s = (Scope*)mm_malloc(sizeof(Scope));
     mm_usage_guard();
     if (!s) return NULL;
     s->id = id;
     s->parent = parent;
-    s->bucket_count = SYMTAB_BUCKETS;
-    s->buckets = (Symbol**)mm_malloc(sizeof(Symbol*) * s->bucket_count);
+    s->symbols = s->inline_symbols;
+    s->count = 0;
+    s->capacity = SCOPE_INLINE;
+    s->slots = NULL;
+    s->slot_count = 0;
+    s->map = NULL;
+    return s;
+}
+
+static bool names_resize(struct SymNames *names, size_t slot_count) {
+    NameSlot *slots = (NameSlot*)mm_malloc(sizeof(NameSlot) * slot_count);
+    size_t i;
     mm_usage_guard();
-    if (!s->buckets) {
-        mm_free(s);
-        return NULL;
+    if (!slots) return false;
+    memset(slots, 0, sizeof(NameSlot) * slot_count);
+    for (i = 0; i < names->slot_count; ++i) {
+        NameSlot *old = &names->slots[i];
+        if (old->top && old->top != &removed) {
+            size_t j = old->hash & (slot_count - 1);
+            while (slots[j].top) j = (j + 1) & (slot_count - 1);
+            slots[j] = *old;
+        }
     }
-    {
-        size_t i;
-        for (i = 0; i < s->bucket_count; ++i) s->buckets[i] = NULL;
+    if (names->slots) mm_free(names->slots);
+    names->slots = slots;
+    names->slot_count = slot_count;
+    names->used = names->live;
+    return true;
+}
+
+/* Vaga do nome com ligação ativa, ou NAMES_NONE; em *free_slot, a primeira
+ * vaga livre ou de &removed do caminho (onde o nome entraria) */
+static size_t names_probe(const struct SymNames *names, const char *name,
+                          unsigned long hash, size_t *free_slot) {
+    size_t mask = names->slot_count - 1, i;
+    *free_slot = NAMES_NONE;
+    for (i = hash & mask; names->slots[i].top; i = (i + 1) & mask) {
+        Symbol *top = names->slots[i].top;
+        if (top == &removed) {
+            if (*free_slot == NAMES_NONE) *free_slot = i;
+        } else if (names->slots[i].hash == hash && strcmp(top->name, name) == 0) {
+            return i;
+        }
     }
-    return s;
+    if (*free_slot == NAMES_NONE) *free_slot = i;
+    return NAMES_NONE;
 }
 
-SymTab* symtab_create(void) {
+/* Desfaz a ligação ao sair do escopo: o nome volta à ligação escondida */
+static void names_unbind(struct SymNames *names, Binding *b) {
+    size_t mask = names->slot_count - 1, i = b->hash & mask;
+    while (names->slots[i].top != &b->sym) i = (i + 1) & mask;
+    if (b->shadowed) {
+        names->slots[i].top = b->shadowed;
+    } else {
+        names->slots[i].top = &removed;
+        names->live--;
+    }
+}
+
+static SymTab* table_create(SymTabDesign design) {
     SymTab *st = (SymTab*)mm_malloc(sizeof(SymTab));
     mm_usage_guard();
     if (!st) return NULL;
     st->next_id = 1; /* global = 0 */
+    st->names = NULL;
+    st->design = design;
+    if (design == SYMTAB_GLOBAL) {
+        st->names = (struct SymNames*)mm_malloc(sizeof(struct SymNames));
+        mm_usage_guard();
+        if (!st->names) {
+            mm_free(st);
+            return NULL;
+        }
+        memset(st->names, 0, sizeof(struct SymNames));
+        if (!names_resize(st->names, 16)) {
+            mm_free(st->names);
+            mm_free(st);
+            return NULL;
+        }
+    }
     st->current = scope_new(0, NULL);
     if (!st->current) {
+        if (st->names) {
+            mm_free(st->names->slots);
+            mm_free(st->names);
+        }
         mm_free(st);
         return NULL;
     }
     return st;
 }
 
-static void free_symbols(Symbol *sym) {
-    while (sym) {
-        Symbol *next = sym->next;
-        mm_free(sym->name);
-        mm_free(sym);
-        sym = next;
-    }
+SymTab* symtab_create(void) {
+    return table_create(design);
 }
 
 void symtab_leave_scope(SymTab *st) {
     if (!st || !st->current) return;
     Scope *to_pop = st->current;
     st->current = to_pop->parent;
+    hamt_release(to_pop->map);
     {
-        size_t i;
-        for (i = 0; i < to_pop->bucket_count; ++i) {
-            free_symbols(to_pop->buckets[i]);
+        /* Da última declaração para a primeira (a lista de desfazer) */
+        size_t i = to_pop->count;
+        while (i > 0) {
+            Symbol *sym = to_pop->symbols[--i];
+            if (st->names) names_unbind(st->names, (Binding*)sym);
+            mm_free(sym->name);
+            mm_free(sym);
         }
     }
-    mm_free(to_pop->buckets);
+    if (to_pop->symbols != to_pop->inline_symbols) mm_free(to_pop->symbols);
+    if (to_pop->slots) mm_free(to_pop->slots);
     mm_free(to_pop);
 }
 
 void symtab_destroy(SymTab *st) {
     if (!st) return;
     while (st->current) symtab_leave_scope(st);
+    if (st->names) {
+        mm_free(st->names->slots);
+        mm_free(st->names);
+    }
     mm_free(st);
 }
 
 void symtab_enter_scope(SymTab *st) {
     if (!st) return;
     Scope *s = scope_new(st->next_id++, st->current);
-    if (s) st->current = s;
+    if (!s) return;
+    if (st->design == SYMTAB_HAMT && st->current) {
+        /* O escopo novo começa enxergando o mesmo que o pai */
+        hamt_retain(st->current->map);
+        s->map = st->current->map;
+    }
+    st->current = s;
+}
+
+static void slot_put(ScopeSlot *slots, size_t slot_count, unsigned long hash, Symbol *sym) {
+    size_t i = hash & (slot_count - 1);
+    while (slots[i].sym) i = (i + 1) & (slot_count - 1);
+    slots[i].hash = hash;
+    slots[i].sym = sym;
+}
+
+/* Cria ou dobra o índice, reaproveitando os hashes guardados */
+static bool scope_grow_index(Scope *s) {
+    size_t slot_count = s->slot_count ? s->slot_count * 2 : 4 * SCOPE_INLINE;
+    ScopeSlot *slots;
+    size_t i;
+    /* Um escopo grande sem índice (symtab_freeze) o ganha já com folga */
+    while (2 * s->count > slot_count) slot_count *= 2;
+    slots = (ScopeSlot*)mm_malloc(sizeof(ScopeSlot) * slot_count);
+    mm_usage_guard();
+    if (!slots) return false;
+    memset(slots, 0, sizeof(ScopeSlot) * slot_count);
+    if (s->slots) {
+        for (i = 0; i < s->slot_count; ++i) {
+            if (s->slots[i].sym) slot_put(slots, slot_count, s->slots[i].hash, s->slots[i].sym);
+        }
+        mm_free(s->slots);
+    } else {
+        for (i = 0; i < s->count; ++i) {
+            slot_put(slots, slot_count, sym_hash(s->symbols[i]->name), s->symbols[i]);
+        }
+    }
+    s->slots = slots;
+    s->slot_count = slot_count;
+    return true;
+}
+
+static Symbol* scope_find(const Scope *s, const char *name, unsigned long hash) {
+    size_t i;
+    if (!s->slots) {
+        for (i = 0; i < s->count; ++i) {
+            if (strcmp(s->symbols[i]->name, name) == 0) return s->symbols[i];
+        }
+        return NULL;
+    }
+    for (i = hash & (s->slot_count - 1); s->slots[i].sym; i = (i + 1) & (s->slot_count - 1)) {
+        if (s->slots[i].hash == hash && strcmp(s->slots[i].sym->name, name) == 0) {
+            return s->slots[i].sym;
+        }
+    }
+    return NULL;
+}
+
+void symtab_freeze(SymTab *st) {
+    Scope *s = st ? st->current : NULL;
+    /* Com SYMTAB_GLOBAL os escopos não têm índice, e as visões buscam
+     * escopo a escopo; com SYMTAB_HAMT, as visões buscam no mapa, que já
+     * pode ser compartilhado, e cujos nós deixam de ser alterados no lugar */
+    if (st && st->design == SYMTAB_HAMT) {
+        if (s && s->map) hamt_pin(s->map);
+        return;
+    }
+    if (s && !s->slots && s->count > SCOPE_INLINE) scope_grow_index(s);
+}
+
+SymTab* symtab_view(SymTab *frozen) {
+    SymTab *view;
+    if (!frozen) return NULL;
+    view = (SymTab*)mm_malloc(sizeof(SymTab));
+    mm_usage_guard();
+    if (!view) return NULL;
+    view->current = frozen->current;
+    view->next_id = frozen->next_id;
+    view->names = NULL;
+    view->design = frozen->design == SYMTAB_GLOBAL ? SYMTAB_SCOPES : frozen->design;
+    return view;
+}
+
+void symtab_view_free(SymTab *view) {
+    if (view) mm_free(view);
+}
+
+SymTab* symtab_snapshot(SymTab *st) {
+    SymTab *copy;
+    if (!st || !st->current) return NULL;
+    copy = table_create(st->design);
+    if (!copy) return NULL;
+    if (st->design == SYMTAB_HAMT) {
+        hamt_retain(st->current->map);
+        copy->current->map = st->current->map;
+    } else {
+        /* Do escopo mais interno ao global: a primeira cópia de cada nome
+         * é a visível, e as seguintes são recusadas como duplicadas */
+        Scope *s;
+        for (s = st->current; s; s = s->parent) {
+            size_t i;
+            for (i = 0; i < s->count; i++) symtab_insert(copy, s->symbols[i]);
+        }
+    }
+    /* Os escopos da cópia não repetem os ids dos símbolos compartilhados */
+    copy->next_id = st->next_id;
+    symtab_enter_scope(copy);
+    return copy;
+}
+
+/* Acrescenta o símbolo ao vetor e, com indexed, ao índice do escopo */
+static bool scope_add(Scope *s, Symbol *sym, unsigned long hash, bool indexed) {
+    if (s->count == s->capacity) {
+        size_t capacity = s->capacity * 2;
+        Symbol **symbols = (Symbol**)mm_malloc(sizeof(Symbol*) * capacity);
+        mm_usage_guard();
+        if (!symbols) return false;
+        memcpy(symbols, s->symbols, sizeof(Symbol*) * s->count);
+        if (s->symbols != s->inline_symbols) mm_free(s->symbols);
+        s->symbols = symbols;
+        s->capacity = capacity;
+    }
+    s->symbols[s->count++] = sym;
+    if (s->slots) {
+        /* Sem memória para dobrar, o índice atual ainda tem vagas livres */
+        if (2 * s->count > s->slot_count) scope_grow_index(s);
+        slot_put(s->slots, s->slot_count, hash, sym);
+    } else if (indexed && s->count > SCOPE_INLINE) {
+        /* scope_grow_index já inclui o novo símbolo */
+        scope_grow_index(s);
+    }
+    return true;
 }
 
 bool symtab_insert(SymTab *st, const Symbol *sym) {
     if (!st || !st->current || !sym || !sym->name) return false;
-    unsigned long h = sym_hash(sym->name) % st->current->bucket_count;
+    unsigned long h = sym_hash(sym->name);
+    struct SymNames *names = st->names;
+    size_t slot = NAMES_NONE, free_slot = NAMES_NONE;
 
     /* Verifica se já existe no escopo atual */
-    {
-        Symbol *it;
-        for (it = st->current->buckets[h]; it; it = it->next) {
-            if (strcmp(it->name, sym->name) == 0) return false; /* duplicado */
+    if (st->design == SYMTAB_HAMT) {
+        Symbol *visible = hamt_find(st->current->map, sym->name, h);
+        if (visible && visible->scope_id == st->current->id) {
+            return false; /* duplicado */
         }
+    } else if (names) {
+        /* Ocupação até 1/2, contando as vagas de &removed */
+        if (2 * (names->used + 1) > names->slot_count) {
+            names_resize(names, 4 * (names->live + 1) > names->slot_count
+                                    ? 2 * names->slot_count : names->slot_count);
+        }
+        slot = names_probe(names, sym->name, h, &free_slot);
+        /* A ligação mais interna é a do escopo atual, se houver uma */
+        if (slot != NAMES_NONE && names->slots[slot].top->scope_id == st->current->id) {
+            return false; /* duplicado */
+        }
+    } else if (scope_find(st->current, sym->name, h)) {
+        return false; /* duplicado */
     }
 
-    Symbol *copy = (Symbol*)mm_malloc(sizeof(Symbol));
+    Symbol *copy = (Symbol*)mm_malloc(names ? sizeof(Binding)
+                                      : st->design == SYMTAB_HAMT ? sizeof(HamtSymbol)
+                                                                  : sizeof(Symbol));
     mm_usage_guard();
     if (!copy) return false;
     memcpy(copy, sym, sizeof(Symbol));
@@ -112,28 +584,61 @@ bool symtab_insert(SymTab *st, const Symbol *sym) {
     }
     strcpy(copy->name, sym->name);
     copy->scope_id = st->current->id;
-    copy->next = st->current->buckets[h];
-    st->current->buckets[h] = copy;
+    if (!scope_add(st->current, copy, h, st->design == SYMTAB_SCOPES)) {
+        mm_free(copy->name);
+        mm_free(copy);
+        return false;
+    }
 
+    if (names) {
+        Binding *b = (Binding*)copy;
+        b->hash = h;
+        if (slot != NAMES_NONE) {
+            b->shadowed = names->slots[slot].top;
+        } else {
+            b->shadowed = NULL;
+            slot = free_slot;
+            if (!names->slots[slot].top) names->used++;
+            names->slots[slot].hash = h;
+            names->live++;
+        }
+        names->slots[slot].top = copy;
+    } else if (st->design == SYMTAB_HAMT) {
+        ((HamtSymbol*)copy)->hash = h;
+        st->current->map = hamt_insert(st->current->map, (HamtSymbol*)copy, 0);
+    }
     return true;
 }
 
 Symbol* symtab_lookup(SymTab *st, const char *name) {
     if (!st || !name) return NULL;
+    if (st->design == SYMTAB_HAMT) {
+        return st->current ? hamt_find(st->current->map, name, sym_hash(name)) : NULL;
+    }
+    if (st->names) {
+        size_t free_slot;
+        size_t slot = names_probe(st->names, name, sym_hash(name), &free_slot);
+        return slot != NAMES_NONE ? st->names->slots[slot].top : NULL;
+    }
     {
+        /* O hash só é calculado ao chegar no primeiro escopo com índice */
+        unsigned long h = 0;
+        int hashed = 0;
         Scope *s;
         for (s = st->current; s; s = s->parent) {
-            unsigned long h = sym_hash(name) % s->bucket_count;
             Symbol *it;
-            for (it = s->buckets[h]; it; it = it->next) {
-                if (strcmp(it->name, name) == 0) return it;
+            if (s->slots && !hashed) {
+                h = sym_hash(name);
+                hashed = 1;
             }
+            it = scope_find(s, name, h);
+            if (it) return it;
         }
     }
     return NULL;
 }
 
-static const char* class_str(SymClass c) {
+const char* symtab_class_str(SymClass c) {
     switch (c) {
         case SYM_VAR:   return "var";
         case SYM_PARAM: return "param";
@@ -142,8 +647,8 @@ static const char* class_str(SymClass c) {
     }
 }
 
-static const char* type_str(const Type *t) {
-    if (!t) return "?";
+const char* symtab_type_str(TypeId id) {
+    const Type *t = type_get(id);
     switch (t->kind) {
         case TY_INT:
             return "int";
@@ -167,7 +672,88 @@ static const char* type_str(const Type *t) {
 /* Imprime todo o conteúdo da tabela de símbolos, preservando a ordem de
    criação de escopos. A função também reporta o pico de memória observado
    pelo gerenciador. */
+static void dump_scopes_text(OutSink *out, Scope **order, size_t count) {
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        Scope *sc = order[i];
+        size_t j;
+        out_str(out, "Escopo ");
+        out_long(out, (long)sc->id);
+        out_str(out, ":\n");
+        for (j = 0; j < sc->count; ++j) {
+            Symbol *sym = sc->symbols[j];
+            out_str(out, "  ");
+            out_str(out, sym->name);
+            out_str(out, " (");
+            out_str(out, symtab_class_str(sym->sclass));
+            out_str(out, ", ");
+            out_str(out, symtab_type_str(sym->type));
+            out_str(out, ", linha ");
+            out_long(out, sym->line_decl);
+            out_str(out, ")\n");
+        }
+        out_char(out, '\n');
+    }
+}
+
+static void dump_scopes_json(OutSink *out, Scope **order, size_t count) {
+    size_t i;
+    out_str(out, "{\"scopes\":[");
+    for (i = 0; i < count; ++i) {
+        Scope *sc = order[i];
+        size_t j;
+        out_str(out, i > 0 ? ",{\"id\":" : "{\"id\":");
+        out_long(out, (long)sc->id);
+        out_str(out, ",\"symbols\":[");
+        for (j = 0; j < sc->count; ++j) {
+            Symbol *sym = sc->symbols[j];
+            out_str(out, j > 0 ? ",{\"name\":" : "{\"name\":");
+            out_json_str(out, sym->name);
+            out_str(out, ",\"class\":");
+            out_json_str(out, symtab_class_str(sym->sclass));
+            out_str(out, ",\"type\":");
+            out_json_str(out, symtab_type_str(sym->type));
+            out_str(out, ",\"line\":");
+            out_long(out, sym->line_decl);
+            out_char(out, '}');
+        }
+        out_str(out, "]}");
+    }
+    out_str(out, "],\"peak\":");
+    out_long(out, (long)mm_peak_usage());
+    out_str(out, "}\n");
+}
+
+static void dump_scopes_binary(OutSink *out, Scope **order, size_t count) {
+    size_t i;
+    out_write(out, "SYMS", 4);
+    out_u32(out, (uint32_t)count);
+    for (i = 0; i < count; ++i) {
+        Scope *sc = order[i];
+        size_t j;
+        out_u32(out, (uint32_t)sc->id);
+        out_u32(out, (uint32_t)sc->count);
+        for (j = 0; j < sc->count; ++j) {
+            Symbol *sym = sc->symbols[j];
+            const Type t = *type_get(sym->type);
+            out_u32(out, (uint32_t)sym->sclass);
+            out_u32(out, (uint32_t)t.kind);
+            if (t.kind == TY_TXT) {
+                out_i32(out, (int32_t)t.info.txt.n);
+                out_i32(out, 0);
+            } else {
+                out_i32(out, t.info.dec.a);
+                out_i32(out, t.info.dec.b);
+            }
+            out_i32(out, sym->line_decl);
+            out_u32(out, (uint32_t)strlen(sym->name));
+            out_str(out, sym->name);
+        }
+    }
+}
+
 void symtab_dump(SymTab *st) {
+    OutSink *out = out_stdout();
     if (!st) return;
 
     size_t count = 0;
@@ -185,30 +771,26 @@ void symtab_dump(SymTab *st) {
         }
     }
 
-    {
-        size_t i;
-        for (i = 0; i < count; ++i) {
-            Scope *sc = order[i];
-            printf("Escopo %zu:\n", sc->id);
-            {
-                size_t b;
-                for (b = 0; b < sc->bucket_count; ++b) {
-                    Symbol *sym;
-                    for (sym = sc->buckets[b]; sym; sym = sym->next) {
-                        printf("  %s (%s, %s, linha %d)\n",
-                               sym->name,
-                               class_str(sym->sclass),
-                               type_str(sym->type),
-                               sym->line_decl);
-                    }
-                }
-            }
-            printf("\n");
-        }
+    switch (dump_format()) {
+        case DUMP_TEXT:
+            dump_scopes_text(out, order, count);
+            break;
+        case DUMP_JSON:
+            dump_scopes_json(out, order, count);
+            break;
+        case DUMP_BINARY:
+            dump_scopes_binary(out, order, count);
+            break;
+        default:
+            break;
     }
     mm_free(order);
 
-    size_t peak = mm_peak_usage();
-    printf("Pico de memória: %zu bytes (inteiro=4B, decimal=8B, texto[n]=nB)\n", peak);
+    if (dump_format() == DUMP_TEXT) {
+        out_str(out, "Pico de memória: ");
+        out_long(out, (long)mm_peak_usage());
+        out_str(out, " bytes (inteiro=4B, decimal=8B, texto[n]=nB)\n");
+    }
+    out_flush(out);
 }
 
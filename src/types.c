@@ -0,0 +1,160 @@
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/*
+ * Tabela de tipos internados. Um programa usa poucos tipos distintos (os
+ * básicos e os decimal[a.b]/texto[n] de seus literais), então os primeiros
+ * TYPES_INITIAL ficam em vetores estáticos; acima disso a tabela cresce com
+ * malloc, em pedaços de tamanho dobrado (16, 32, 64...) que nunca mudam de
+ * lugar: um Type não é movido nem liberado depois de internado, e type_get
+ * lê sem a trava enquanto outra thread interna um tipo (análise semântica
+ * paralela). Só o índice é refeito ao crescer, e ele só é lido com a trava.
+ * Fica fora da contabilidade de memmgr, como a tabela de blocos: os tipos
+ * valem para todas as análises do processo, e mm_cleanup não os libera.
+ *
+ * O identificador é (posição na tabela + 1) * 4 + categoria, e os básicos
+ * são só a categoria: type_kind não consulta a tabela.
+ */
+#define TYPES_INITIAL 16
+/* Pedaços possíveis: os identificadores de 32 bits esgotam antes */
+#define TYPES_CHUNKS  28
+
+static const Type basic_types[TYPE_BOOL + 1] = {
+    {TY_INT,  {{0, 0}}},
+    {TY_DEC,  {{0, 0}}},
+    {TY_TXT,  {{0, 0}}},
+    {TY_BOOL, {{0, 0}}}
+};
+
+static Type initial_types[TYPES_INITIAL];
+/* Índice por endereçamento aberto: identificador, ou 0 se vazia (o
+ * identificador 0 é TYPE_INT, que não entra no índice) */
+static TypeId initial_index[2 * TYPES_INITIAL];
+
+/* Pedaço k: TYPES_INITIAL << k tipos, a partir da posição
+ * TYPES_INITIAL * (2^k - 1) */
+static Type *type_chunks[TYPES_CHUNKS] = {initial_types};
+static int chunk_count = 1;
+static size_t types_count = 0;
+static size_t types_capacity = TYPES_INITIAL;
+static TypeId *type_index = initial_index;
+static size_t index_size = 2 * TYPES_INITIAL;
+
+/* Com várias threads internando, type_intern é serializado */
+static pthread_mutex_t types_lock = PTHREAD_MUTEX_INITIALIZER;
+static int types_threaded = 0;
+
+#define TYPE_ID(pos, kind) ((TypeId)(((pos) + 1) * 4 + (kind)))
+#define TYPE_POS(id)       ((size_t)((id) / 4 - 1))
+
+void types_set_threaded(int threaded) {
+    types_threaded = threaded;
+}
+
+static void* types_alloc(size_t size) {
+    void *p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "\033[31mMemória Insuficiente\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/* O tipo na posição pos da tabela */
+static Type* type_at(size_t pos) {
+    size_t q = pos / TYPES_INITIAL + 1;
+    int k = 0;
+
+    while (q >>= 1) k++;
+    return &type_chunks[k][pos - TYPES_INITIAL * (((size_t)1 << k) - 1)];
+}
+
+static unsigned long type_hash(const Type *t) {
+    unsigned long h = (unsigned long)t->kind * 2654435761UL;
+    if (t->kind == TY_DEC) {
+        h ^= (unsigned long)t->info.dec.a * 40503UL + (unsigned long)t->info.dec.b;
+    } else if (t->kind == TY_TXT) {
+        h ^= (unsigned long)t->info.txt.n * 40503UL;
+    }
+    return h ^ (h >> 15);
+}
+
+/* Só os metadados da categoria contam */
+static int type_equal(const Type *x, const Type *y) {
+    if (x->kind != y->kind) return 0;
+    if (x->kind == TY_DEC) return x->info.dec.a == y->info.dec.a && x->info.dec.b == y->info.dec.b;
+    if (x->kind == TY_TXT) return x->info.txt.n == y->info.txt.n;
+    return 1;
+}
+
+/* Vaga do tipo no índice, ou a vaga livre onde entraria */
+static TypeId* index_probe(const Type *t) {
+    size_t mask = index_size - 1;
+    size_t i = type_hash(t) & mask;
+    while (type_index[i] && !type_equal(type_at(TYPE_POS(type_index[i])), t)) {
+        i = (i + 1) & mask;
+    }
+    return &type_index[i];
+}
+
+static void types_grow(void) {
+    size_t chunk = (size_t)TYPES_INITIAL << chunk_count;
+    size_t i;
+
+    if (chunk_count == TYPES_CHUNKS) {
+        fprintf(stderr, "\033[31mMemória Insuficiente\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+    type_chunks[chunk_count++] = types_alloc(chunk * sizeof(Type));
+    types_capacity += chunk;
+    if (type_index != initial_index) free(type_index);
+    index_size = (size_t)TYPES_INITIAL << (chunk_count + 1);
+    type_index = types_alloc(index_size * sizeof(TypeId));
+    memset(type_index, 0, index_size * sizeof(TypeId));
+    for (i = 0; i < types_count; i++) {
+        Type *t = type_at(i);
+        *index_probe(t) = TYPE_ID(i, t->kind);
+    }
+}
+
+/* Tipos com metadados zerados são os básicos */
+static int is_basic(const Type *t) {
+    if (t->kind == TY_DEC) return t->info.dec.a == 0 && t->info.dec.b == 0;
+    if (t->kind == TY_TXT) return t->info.txt.n == 0;
+    return 1;
+}
+
+TypeId type_intern(const Type *t) {
+    TypeId *slot, id;
+
+    if (is_basic(t)) return (TypeId)t->kind;
+    if (types_threaded) pthread_mutex_lock(&types_lock);
+    slot = index_probe(t);
+    if (!*slot) {
+        if (types_count == types_capacity) {
+            types_grow();
+            slot = index_probe(t);
+        }
+        *type_at(types_count) = *t;
+        *slot = TYPE_ID(types_count, t->kind);
+        types_count++;
+    }
+    id = *slot;
+    if (types_threaded) pthread_mutex_unlock(&types_lock);
+    return id;
+}
+
+const Type* type_get(TypeId id) {
+    return id <= TYPE_BOOL ? &basic_types[id] : type_at(TYPE_POS(id));
+}
+
+TypeKind type_kind(TypeId id) {
+    return (TypeKind)(id % 4);
+}
+
+size_t type_count(void) {
+    return types_count + TYPE_BOOL + 1;
+}
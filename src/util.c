@@ -1,40 +1,96 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "util.h"
 
-static FILE *src = NULL;
-static int  line_num;
-static int  last_char;
+/* O fonte é mantido inteiro em memória; o scanner percorre o buffer */
+static Scanner global = {NULL, 0, 0, 1, NULL};
 
-void init_scanner(const char *path) {
-    src = fopen(path, "r");
-    if (!src) { perror(path); exit(EXIT_FAILURE); }
-    line_num = 1;
-    last_char = fgetc(src);
+void scanner_open(Scanner *sc, const char *path) {
+    FILE *f = fopen(path, "rb");
+    size_t cap = 4096, len = 0, n;
+    char *buf;
+    if (!f) { perror(path); exit(EXIT_FAILURE); }
+    buf = malloc(cap);
+    if (!buf) { perror(path); exit(EXIT_FAILURE); }
+    while ((n = fread(buf + len, 1, cap - len, f)) > 0) {
+        len += n;
+        if (len == cap) {
+            cap *= 2;
+            buf = realloc(buf, cap);
+            if (!buf) { perror(path); exit(EXIT_FAILURE); }
+        }
+    }
+    fclose(f);
+    scanner_init_buffer(sc, buf, len, 1);
+    sc->owned = buf;
 }
 
-void close_scanner(void) {
-    if (src) fclose(src);
+void scanner_init_buffer(Scanner *sc, const char *text, size_t len, int first_line) {
+    scanner_init_range(sc, text, 0, len, first_line);
+}
+
+void scanner_init_range(Scanner *sc, const char *text, size_t start, size_t end, int first_line) {
+    sc->src = text;
+    sc->len = end;
+    sc->pos = start;
+    sc->line = first_line;
+    sc->owned = NULL;
+}
+
+void scanner_close(Scanner *sc) {
+    free(sc->owned);
+    sc->owned = NULL;
+    sc->src = NULL;
 }
 
-int peek_char(void) {
-    return (last_char == EOF ? '\0' : last_char);
+int scanner_peek(Scanner *sc) {
+    return sc->pos < sc->len ? (unsigned char)sc->src[sc->pos] : '\0';
 }
 
-int advance_char(void) {
-    int c = peek_char();
+int scanner_advance(Scanner *sc) {
+    int c = scanner_peek(sc);
     if (c == '\0') return '\0';
-    last_char = fgetc(src);
-    if (c == '\n') line_num++;
+    sc->pos++;
+    if (c == '\n') sc->line++;
     return c;
 }
 
-void retreat_char(void) {
-    ungetc(last_char, src);
-    last_char = fgetc(src);
+void scanner_retreat(Scanner *sc) {
+    if (sc->pos > 0) {
+        sc->pos--;
+        if (sc->src[sc->pos] == '\n') sc->line--;
+    }
 }
 
+int scanner_line(const Scanner *sc) {
+    return sc->line;
+}
+
+size_t scanner_offset(const Scanner *sc) {
+    return sc->pos;
+}
+
+Scanner *global_scanner(void) {
+    return &global;
+}
+
+void init_scanner(const char *path) {
+    scanner_open(&global, path);
+}
+
+void init_scanner_buffer(const char *text, size_t len, int first_line) {
+    scanner_init_buffer(&global, text, len, first_line);
+}
+
+void close_scanner(void) {
+    scanner_close(&global);
+}
 
 int current_line(void) {
-    return line_num;
+    return global.line;
+}
+
+size_t current_offset(void) {
+    return global.pos;
 }
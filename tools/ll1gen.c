@@ -0,0 +1,535 @@
+/*
+ * Gerador das tabelas LL(1) do analisador dirigido por tabela (src/ll1.c).
+ * Lê a gramática (formato descrito em grammar/linguagem.ll), calcula FIRST e
+ * FOLLOW, recusa a gramática se houver conflito LL(1) não declarado com
+ * %greedy e escreve um cabeçalho C com:
+ *   ll1_rhs / ll1_rhs_start  lado direito de cada produção (símbolos do
+ *                            motor: TokenType, LL1_NT(i), LL1_ADD, LL1_WRAP,
+ *                            LL1_NODE(AST_...))
+ *   ll1_table                produção + 1 por não-terminal e token (0: nenhuma)
+ *   ll1_empty                produção anulável + 1 de cada não-terminal, usada
+ *                            quando o token não está na tabela
+ *   ll1_expected             descrição de cada não-terminal (mensagens de erro)
+ *   ll1_terminal             descrição de cada terminal
+ * Uso: ll1gen <gramatica> <cabecalho-de-saida>
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TERMINALS    64
+#define MAX_NONTERMINALS 64
+#define MAX_PRODUCTIONS  254         /* cabe em unsigned char, com 0 livre */
+#define MAX_RHS          32
+#define MAX_NAME         64
+
+typedef enum { SYM_TERMINAL, SYM_NONTERMINAL, SYM_ADD, SYM_WRAP, SYM_NODE } SymbolKind;
+
+typedef struct {
+    SymbolKind kind;
+    int index;                      /* terminal ou não-terminal */
+    char node[MAX_NAME];            /* tipo de @node, sem o prefixo AST_ */
+} Symbol;
+
+typedef struct {
+    char name[MAX_NAME];            /* como escrito na gramática */
+    char token[MAX_NAME];           /* constante TokenType */
+    char display[MAX_NAME * 2];
+} Terminal;
+
+typedef struct {
+    char name[MAX_NAME];
+    char display[MAX_NAME * 2];
+    int defined;
+    int greedy;
+    int nullable;
+    unsigned char first[MAX_TERMINALS];
+    unsigned char follow[MAX_TERMINALS];
+} Nonterminal;
+
+typedef struct {
+    int lhs;
+    int length;
+    Symbol rhs[MAX_RHS];
+} Production;
+
+static Terminal terminals[MAX_TERMINALS];
+static int terminal_count;
+static Nonterminal nonterminals[MAX_NONTERMINALS];
+static int nonterminal_count;
+static Production productions[MAX_PRODUCTIONS];
+static int production_count;
+static int start_symbol = -1;
+
+/* ========== Leitura da gramática ========== */
+
+static const char *grammar_path;
+static const char *text;
+static int line = 1;
+
+static void fail(const char *message, const char *detail) {
+    fprintf(stderr, "%s:%d: %s%s%s\n", grammar_path, line, message,
+            detail ? ": " : "", detail ? detail : "");
+    exit(EXIT_FAILURE);
+}
+
+static void skip_space(void) {
+    for (;;) {
+        while (isspace((unsigned char)*text)) {
+            if (*text == '\n') line++;
+            text++;
+        }
+        if (*text != '#') return;
+        while (*text && *text != '\n') text++;
+    }
+}
+
+/* Próxima palavra: nome, 'terminal', "descrição", %diretiva, @ação ou um
+ * dos sinais ':' '|' ';' '(' ')'. Retorna 0 no fim do arquivo. */
+static int next_word(char *word) {
+    const char *start;
+    size_t len;
+
+    skip_space();
+    if (!*text) return 0;
+    start = text;
+    if (*text == '\'' || *text == '"') {
+        char quote = *text++;
+        while (*text && *text != quote && *text != '\n') text++;
+        if (*text != quote) fail("aspas não fechadas", NULL);
+        text++;
+    } else if (strchr(":|;()", *text)) {
+        text++;
+    } else {
+        if (*text == '%' || *text == '@') text++;
+        while (isalnum((unsigned char)*text) || *text == '_') text++;
+        if (text == start || (text == start + 1 && !isalnum((unsigned char)*start))) {
+            fail("caractere inesperado", NULL);
+        }
+    }
+    len = (size_t)(text - start);
+    if (len >= MAX_NAME) fail("nome longo demais", NULL);
+    memcpy(word, start, len);
+    word[len] = '\0';
+    return 1;
+}
+
+static int is_name(const char *word) {
+    return isalpha((unsigned char)word[0]) || word[0] == '_';
+}
+
+static int find_terminal(const char *name) {
+    int i;
+    for (i = 0; i < terminal_count; i++) {
+        if (strcmp(terminals[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int find_nonterminal(const char *name) {
+    int i;
+    for (i = 0; i < nonterminal_count; i++) {
+        if (strcmp(nonterminals[i].name, name) == 0) return i;
+    }
+    if (nonterminal_count == MAX_NONTERMINALS) fail("não-terminais demais", NULL);
+    strcpy(nonterminals[i].name, name);
+    strcpy(nonterminals[i].display, name);
+    nonterminal_count++;
+    return i;
+}
+
+static void add_terminal(const char *name, const char *token, const char *display) {
+    Terminal *t;
+    if (find_terminal(name) >= 0) fail("terminal repetido", name);
+    if (terminal_count == MAX_TERMINALS) fail("terminais demais", NULL);
+    t = &terminals[terminal_count++];
+    strcpy(t->name, name);
+    strcpy(t->token, token);
+    strcpy(t->display, display);
+}
+
+/* "x" -> x, para as descrições */
+static void unquote(char *dst, const char *word) {
+    size_t len = strlen(word);
+    memcpy(dst, word + 1, len - 2);
+    dst[len - 2] = '\0';
+}
+
+static void read_directive(const char *directive) {
+    char name[MAX_NAME], token[MAX_NAME];
+
+    if (!next_word(name)) fail("diretiva incompleta", directive);
+    if (strcmp(directive, "%token") == 0) {
+        const char *after;
+        char display[MAX_NAME * 2];
+        if (!next_word(token) || strncmp(token, "TOK_", 4) != 0) {
+            fail("esperado TokenType em %token", name);
+        }
+        /* Descrição opcional; sem ela, o próprio nome ('x' com as aspas) */
+        after = text;
+        skip_space();
+        if (*text == '"') {
+            char word[MAX_NAME];
+            next_word(word);
+            unquote(display, word);
+        } else {
+            text = after;
+            strcpy(display, name);
+        }
+        add_terminal(name, token, display);
+    } else if (strcmp(directive, "%start") == 0) {
+        start_symbol = find_nonterminal(name);
+    } else if (strcmp(directive, "%greedy") == 0) {
+        nonterminals[find_nonterminal(name)].greedy = 1;
+    } else {
+        fail("diretiva desconhecida", directive);
+    }
+}
+
+static void read_symbol(Production *p, const char *word) {
+    Symbol *s;
+    if (p->length == MAX_RHS) fail("produção longa demais", NULL);
+    s = &p->rhs[p->length++];
+
+    if (word[0] == '@') {
+        if (strcmp(word, "@add") == 0) {
+            s->kind = SYM_ADD;
+        } else if (strcmp(word, "@wrap") == 0) {
+            s->kind = SYM_WRAP;
+        } else if (strcmp(word, "@node") == 0) {
+            char paren[MAX_NAME];
+            s->kind = SYM_NODE;
+            if (!next_word(paren) || strcmp(paren, "(") != 0 ||
+                !next_word(s->node) || !is_name(s->node) ||
+                !next_word(paren) || strcmp(paren, ")") != 0) {
+                fail("esperado @node(TIPO)", NULL);
+            }
+        } else {
+            fail("ação desconhecida", word);
+        }
+    } else if ((s->index = find_terminal(word)) >= 0) {
+        s->kind = SYM_TERMINAL;
+    } else if (is_name(word)) {
+        s->kind = SYM_NONTERMINAL;
+        s->index = find_nonterminal(word);
+    } else {
+        fail("terminal não declarado", word);
+    }
+}
+
+static void read_rule(const char *name) {
+    char word[MAX_NAME];
+    int lhs = find_nonterminal(name);
+    Nonterminal *nt = &nonterminals[lhs];
+
+    if (nt->defined) fail("não-terminal definido duas vezes", name);
+    nt->defined = 1;
+    if (!next_word(word)) fail("regra incompleta", name);
+    if (word[0] == '"') {
+        unquote(nt->display, word);
+        if (!next_word(word)) fail("regra incompleta", name);
+    }
+    if (strcmp(word, ":") != 0) fail("esperado ':'", name);
+
+    for (;;) {
+        Production *p;
+        if (production_count == MAX_PRODUCTIONS) fail("produções demais", NULL);
+        p = &productions[production_count++];
+        p->lhs = lhs;
+        p->length = 0;
+        for (;;) {
+            if (!next_word(word)) fail("regra sem ';'", name);
+            if (strcmp(word, "|") == 0 || strcmp(word, ";") == 0) break;
+            read_symbol(p, word);
+        }
+        if (word[0] == ';') return;
+    }
+}
+
+static void read_grammar(void) {
+    char word[MAX_NAME];
+
+    /* Terminal implícito: fim do arquivo */
+    add_terminal("$", "TOK_EOF", "fim do arquivo");
+    while (next_word(word)) {
+        if (word[0] == '%') read_directive(word);
+        else if (is_name(word)) read_rule(word);
+        else fail("esperado regra ou diretiva", word);
+    }
+    if (start_symbol < 0) fail("falta %start", NULL);
+}
+
+/* ========== FIRST, FOLLOW e tabela ========== */
+
+/* Acrescenta src a dst; retorna 1 se dst mudou */
+static int merge(unsigned char *dst, const unsigned char *src) {
+    int i, changed = 0;
+    for (i = 0; i < terminal_count; i++) {
+        if (src[i] && !dst[i]) dst[i] = changed = 1;
+    }
+    return changed;
+}
+
+/* FIRST de rhs[from..] em set; retorna 1 se o resto é anulável */
+static int first_of(const Production *p, int from, unsigned char *set) {
+    int i;
+    for (i = from; i < p->length; i++) {
+        const Symbol *s = &p->rhs[i];
+        if (s->kind == SYM_TERMINAL) {
+            set[s->index] = 1;
+            return 0;
+        }
+        if (s->kind == SYM_NONTERMINAL) {
+            merge(set, nonterminals[s->index].first);
+            if (!nonterminals[s->index].nullable) return 0;
+        }
+    }
+    return 1;
+}
+
+static void compute_sets(void) {
+    int changed, i, j;
+
+    do {
+        changed = 0;
+        for (i = 0; i < production_count; i++) {
+            Production *p = &productions[i];
+            Nonterminal *nt = &nonterminals[p->lhs];
+            unsigned char set[MAX_TERMINALS];
+            memset(set, 0, sizeof(set));
+            if (first_of(p, 0, set) && !nt->nullable) nt->nullable = changed = 1;
+            changed |= merge(nt->first, set);
+        }
+    } while (changed);
+
+    nonterminals[start_symbol].follow[0] = 1;       /* '$' */
+    do {
+        changed = 0;
+        for (i = 0; i < production_count; i++) {
+            Production *p = &productions[i];
+            for (j = 0; j < p->length; j++) {
+                Nonterminal *nt;
+                unsigned char set[MAX_TERMINALS];
+                if (p->rhs[j].kind != SYM_NONTERMINAL) continue;
+                nt = &nonterminals[p->rhs[j].index];
+                memset(set, 0, sizeof(set));
+                if (first_of(p, j + 1, set)) merge(set, nonterminals[p->lhs].follow);
+                changed |= merge(nt->follow, set);
+            }
+        }
+    } while (changed);
+}
+
+static unsigned char table[MAX_NONTERMINALS][MAX_TERMINALS];
+static unsigned char empty[MAX_NONTERMINALS];
+
+static void conflict(int nt, int terminal, int a, int b) {
+    fprintf(stderr, "%s: conflito LL(1) em %s com %s: produções %d e %d\n",
+            grammar_path, nonterminals[nt].name, terminals[terminal].name, a, b);
+}
+
+/* Retorna o número de conflitos */
+static int build_table(void) {
+    int conflicts = 0, i, t;
+
+    for (i = 0; i < production_count; i++) {
+        Production *p = &productions[i];
+        unsigned char set[MAX_TERMINALS];
+        memset(set, 0, sizeof(set));
+        if (first_of(p, 0, set)) {
+            if (empty[p->lhs]) {
+                fprintf(stderr, "%s: %s tem duas produções anuláveis: %d e %d\n",
+                        grammar_path, nonterminals[p->lhs].name, empty[p->lhs] - 1, i);
+                conflicts++;
+            }
+            empty[p->lhs] = (unsigned char)(i + 1);
+        }
+        for (t = 0; t < terminal_count; t++) {
+            if (!set[t]) continue;
+            if (table[p->lhs][t]) {
+                conflict(p->lhs, t, table[p->lhs][t] - 1, i);
+                conflicts++;
+            }
+            table[p->lhs][t] = (unsigned char)(i + 1);
+        }
+    }
+
+    /* FIRST/FOLLOW: o token que segue o não-terminal também inicia uma
+     * alternativa não vazia */
+    for (i = 0; i < nonterminal_count; i++) {
+        Nonterminal *nt = &nonterminals[i];
+        if (!nt->defined) {
+            fprintf(stderr, "%s: não-terminal sem regra: %s\n", grammar_path, nt->name);
+            conflicts++;
+            continue;
+        }
+        if (!empty[i] || nt->greedy) continue;
+        for (t = 0; t < terminal_count; t++) {
+            if (nt->follow[t] && table[i][t] && table[i][t] != empty[i]) {
+                conflict(i, t, table[i][t] - 1, empty[i] - 1);
+                conflicts++;
+            }
+        }
+    }
+    return conflicts;
+}
+
+/* ========== Saída ========== */
+
+static void print_symbol(FILE *out, const Symbol *s, int c_form) {
+    switch (s->kind) {
+        case SYM_TERMINAL:
+            fprintf(out, "%s", c_form ? terminals[s->index].token : terminals[s->index].name);
+            break;
+        case SYM_NONTERMINAL:
+            if (c_form) fprintf(out, "LL1_NT(%d)", s->index);
+            else fprintf(out, "%s", nonterminals[s->index].name);
+            break;
+        case SYM_ADD:
+            fprintf(out, c_form ? "LL1_ADD" : "@add");
+            break;
+        case SYM_WRAP:
+            fprintf(out, c_form ? "LL1_WRAP" : "@wrap");
+            break;
+        case SYM_NODE:
+            fprintf(out, c_form ? "LL1_NODE(AST_%s)" : "@node(%s)", s->node);
+            break;
+    }
+}
+
+static void print_c_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_tables(FILE *out) {
+    int i, j, t, offset = 0;
+
+    fprintf(out, "/* Gerado por tools/ll1gen a partir de %s; não editar. */\n\n", grammar_path);
+    fprintf(out, "#define LL1_NONTERMINALS %d\n", nonterminal_count);
+    fprintf(out, "#define LL1_PRODUCTIONS  %d\n", production_count);
+    fprintf(out, "#define LL1_START        LL1_NT(%d)\n\n", start_symbol);
+
+    fprintf(out, "static const unsigned char ll1_rhs[] = {\n");
+    for (i = 0; i < production_count; i++) {
+        Production *p = &productions[i];
+        fprintf(out, "    /* %3d %s ->", i, nonterminals[p->lhs].name);
+        for (j = 0; j < p->length; j++) {
+            fputc(' ', out);
+            print_symbol(out, &p->rhs[j], 0);
+        }
+        fprintf(out, " */\n");
+        if (p->length == 0) continue;
+        fprintf(out, "   ");
+        for (j = 0; j < p->length; j++) {
+            fputc(' ', out);
+            print_symbol(out, &p->rhs[j], 1);
+            fputc(',', out);
+        }
+        fputc('\n', out);
+    }
+    /* Nenhuma produção usa o último elemento: evita vetor vazio */
+    fprintf(out, "    0\n};\n\n");
+
+    fprintf(out, "static const unsigned short ll1_rhs_start[LL1_PRODUCTIONS + 1] = {");
+    for (i = 0; i <= production_count; i++) {
+        fprintf(out, "%s%d", i % 16 ? ", " : (i ? ",\n    " : "\n    "), offset);
+        if (i < production_count) offset += productions[i].length;
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const unsigned char ll1_table[LL1_NONTERMINALS][TOK_ERROR + 1] = {\n");
+    for (i = 0; i < nonterminal_count; i++) {
+        int first = 1;
+        fprintf(out, "    /* %s */ {", nonterminals[i].name);
+        for (t = 0; t < terminal_count; t++) {
+            if (!table[i][t]) continue;
+            fprintf(out, "%s[%s] = %d", first ? "" : ", ", terminals[t].token, table[i][t]);
+            first = 0;
+        }
+        fprintf(out, "%s},\n", first ? "0" : "");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const unsigned char ll1_empty[LL1_NONTERMINALS] = {");
+    for (i = 0; i < nonterminal_count; i++) {
+        fprintf(out, "%s%d", i % 16 ? ", " : (i ? ",\n    " : "\n    "), empty[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const char *const ll1_expected[LL1_NONTERMINALS] = {\n");
+    for (i = 0; i < nonterminal_count; i++) {
+        fprintf(out, "    ");
+        print_c_string(out, nonterminals[i].display);
+        fprintf(out, ",\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const char *const ll1_terminal[TOK_ERROR + 1] = {\n");
+    for (t = 0; t < terminal_count; t++) {
+        fprintf(out, "    [%s] = ", terminals[t].token);
+        print_c_string(out, terminals[t].display);
+        fprintf(out, ",\n");
+    }
+    fprintf(out, "};\n");
+}
+
+static char* read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    char *buf;
+    long size;
+
+    if (!f) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc((size_t)size + 1);
+    if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "Erro ao ler %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    buf[size] = '\0';
+    fclose(f);
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    char *source;
+    FILE *out;
+
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s <gramatica> <cabecalho-de-saida>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    grammar_path = argv[1];
+    source = read_file(grammar_path);
+    text = source;
+    read_grammar();
+    compute_sets();
+    if (build_table() > 0) {
+        fprintf(stderr, "%s: a gramática não é LL(1)\n", grammar_path);
+        return EXIT_FAILURE;
+    }
+
+    out = fopen(argv[2], "w");
+    if (!out) {
+        perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+    write_tables(out);
+    if (fclose(out) != 0) {
+        perror(argv[2]);
+        remove(argv[2]);
+        return EXIT_FAILURE;
+    }
+    free(source);
+    return EXIT_SUCCESS;
+}